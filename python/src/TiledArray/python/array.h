@@ -27,6 +27,8 @@
 
 #include <TiledArray/conversions/eigen.h>
 #include <TiledArray/dist_array.h>
+#include <exception>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -45,21 +47,24 @@ namespace array {
 //   );
 // }
 
+// copies data into a new tile; data is converted (copied) first only if it is
+// not a C-contiguous array of T
 template <typename T>
 auto make_tile(py::buffer data) {
-  auto shape = data.request().shape;
-  py::array_t<T> tmp(shape);
-  int result =
-      py::detail::npy_api::get().PyArray_CopyInto_(tmp.ptr(), data.ptr());
-  if (result < 0) throw py::error_already_set();
-  return Tensor<T>(Range(shape), tmp.data());
+  typedef py::array_t<T, py::array::c_style | py::array::forcecast> array_t;
+  auto array = array_t::ensure(data);
+  if (!array) throw py::error_already_set();
+  std::vector<ssize_t> shape(array.shape(), array.shape() + array.ndim());
+  return Tensor<T>(Range(shape), array.data());
 }
 
 // std::function<py::buffer(const Range&)>
 template <class Array>
 void init_tiles(Array &a, py::object f) {
-  py::gil_scoped_release gil;
-  auto op = [f](const Range &range) {
+  SubmissionLock lock;
+  // f is captured by reference, since Python objects must not be copied
+  // without holding the GIL; the tasks are done by the fence below
+  auto op = [&f](const Range &range) {
     Tensor<double> tile;
     {
       py::gil_scoped_acquire acquire;
@@ -79,7 +84,13 @@ std::shared_ptr<Array> make_array(const Trange &... args, World *world,
   if (!world) {
     world = &get_default_world();
   }
-  auto array = std::make_shared<Array>(*world, trange::make_trange(args...));
+  auto tr = trange::make_trange(args...);
+  // arrays are distributed objects, hence are created in program order
+  std::shared_ptr<Array> array;
+  {
+    SubmissionLock lock;
+    array = std::make_shared<Array>(*world, tr);
+  }
   if (!op.is_none()) {
     init_tiles(*array, op);
   }
@@ -150,28 +161,154 @@ inline void setitem(Array &array, std::vector<int64_t> idx, py::buffer data) {
   array.set(idx, tile);
 }
 
+// a read-only NumPy view of tile; tile data is shared, not copied, so the
+// view must not be written to
+template <typename T>
+py::array make_tile_view(const Tensor<T> &tile) {
+  auto owner = new Tensor<T>(tile);
+  py::capsule base(owner,
+                   [](void *p) { delete reinterpret_cast<Tensor<T> *>(p); });
+  py::array view(make_buffer_info(*owner), base);
+  py::detail::array_proxy(view.ptr())->flags &=
+      ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+  return view;
+}
+
 template <class Array, class Idx>
 inline py::array getitem(const Array &array, Idx idx) {
   auto tile = array.find(idx);
-  if (!tile.probe()) {
+  if (!tile.probe() && array.is_local(idx)) {
     auto str = py::str(py::cast(idx));
     throw std::runtime_error("TArray[" + py::cast<std::string>(str) +
                              "] tile is not set");
   }
-  return py::array(make_buffer_info(tile.get()));
+  // remote tiles are fetched without holding the GIL
+  if (!tile.probe()) {
+    py::gil_scoped_release gil;
+    tile.get();
+  }
+  return make_tile_view(tile.get());
+}
+
+// counts the finished tile transfer tasks; the first exception thrown by a
+// task is kept, to be rethrown on the thread that waits for the tasks
+class TaskCounter {
+ public:
+  TaskCounter() { count_ = 0; }
+
+  // runs f and counts it as finished, even if it throws
+  template <typename F>
+  void run(F &&f) {
+    try {
+      f();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) error_ = std::current_exception();
+    }
+    count_++;
+  }
+
+  // waits until n tasks have finished, then rethrows the first exception
+  void wait(World &world, const int n) {
+    world.await([this, n]() { return count_ == n; });
+    if (error_) std::rethrow_exception(error_);
+  }
+
+ private:
+  madness::AtomicInt count_;
+  std::mutex mutex_;
+  std::exception_ptr error_;
+};
+
+// copies tile into its block of the row-major buffer of the array elements
+template <typename T>
+void counted_tile_to_buffer(const Tensor<T> &tile, const Range *elements,
+                            T *buffer, TaskCounter *counter) {
+  counter->run([&]() {
+    auto dst_view = make_map(
+        buffer, BlockRange(*elements, tile.range().lobound(),
+                           tile.range().upbound()));
+    dst_view = make_const_map(tile.data(), tile.range());
+  });
 }
 
+// sets tile i of array to its block of the row-major buffer of the elements
+template <class Array, typename T>
+void counted_buffer_to_tile(const T *buffer, Array *array,
+                            const typename Array::ordinal_type i,
+                            TaskCounter *counter) {
+  counter->run([&]() {
+    const auto &elements = array->trange().elements_range();
+    typename Array::value_type tile(array->trange().make_tile_range(i));
+    auto dst_view = make_map(tile.data(), tile.range());
+    dst_view = make_const_map(
+        buffer,
+        BlockRange(elements, tile.range().lobound(), tile.range().upbound()));
+    array->set(i, tile);
+  });
+}
+
+// gathers all tiles of a into a new NumPy array; the tiles are requested
+// at once and copied in parallel by tasks as they arrive
 template <class Array>
-py::buffer_info make_buffer(Array &a) {
+py::array_t<typename Array::scalar_type> to_numpy(const Array &a) {
   typedef typename Array::scalar_type T;
-  auto buffer = py::array_t<T>(shape(a));
-  for (size_t i = 0; i < a.size(); ++i) {
-    // if (a.is_zero(i)) continue;
-    auto range = range::slice(a.trange().make_tile_range(i));
-    // py::print(i,range);
-    buffer[range] = getitem(a, i);
+  py::array_t<T> result(shape(a));
+  T *buffer = result.mutable_data();
+  const Range elements = a.trange().elements_range();
+  TaskCounter counter;
+  int n = 0;
+  {
+    SubmissionLock lock;
+    if (!a.shape().is_dense())
+      std::fill_n(buffer, elements.volume(), T(0));
+
+    for (size_t i = 0; i < a.size(); ++i) {
+      if (a.is_zero(i)) continue;
+      a.world().taskq.add(&counted_tile_to_buffer<T>, a.find(i), &elements,
+                          buffer, &counter);
+      ++n;
+    }
   }
-  return buffer.request();
+  {
+    py::gil_scoped_release gil;
+    counter.wait(a.world(), n);
+  }
+  return result;
+}
+
+// sets the local non-zero tiles of a from the NumPy array data, which holds
+// all elements of a, in parallel
+template <class Array>
+void from_numpy(Array &a,
+                py::array_t<typename Array::scalar_type,
+                            py::array::c_style | py::array::forcecast>
+                    data) {
+  typedef typename Array::scalar_type T;
+  const auto expected = shape(a);
+  if (std::vector<size_t>(data.shape(), data.shape() + data.ndim()) !=
+      expected)
+    throw std::invalid_argument(
+        "from_numpy: data shape must match array shape");
+  const T *buffer = data.data();
+  TaskCounter counter;
+  int n = 0;
+  {
+    SubmissionLock lock;
+    for (size_t i = 0; i < a.size(); ++i) {
+      if (!a.is_local(i) || a.is_zero(i)) continue;
+      a.world().taskq.add(&counted_buffer_to_tile<Array, T>, buffer, &a, i,
+                          &counter);
+      ++n;
+    }
+  }
+  py::gil_scoped_release gil;
+  counter.wait(a.world(), n);
+}
+
+template <class Array>
+py::buffer_info make_buffer(Array &a) {
+  return to_numpy(a).request();
 }
 
 template <class Array>
@@ -211,6 +348,8 @@ void make_array_class(py::object m, const char *name) {
           .def("fill", &Array::fill, py::arg("value"),
                py::arg("skip_set") = false)
           .def("init", &array::init_tiles<Array>)
+          .def("to_numpy", &array::to_numpy<Array>)
+          .def("from_numpy", &array::from_numpy<Array>, py::arg("data"))
           // Array object needs be alive while iterator is used */
           .def("__iter__", &array::make_iterator<Array>, py::keep_alive<0, 1>())
           .def("__getitem__", &expression::getitem<Array>)
@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "expression.h"
+#include "future.h"
 
 namespace TiledArray {
 namespace python {
@@ -150,8 +151,9 @@ namespace einsum {
 
   }
 
+  // the tensor arguments of einsum, the last one is the result
   template<class Array>
-  void einsum(std::string expr, Array* a0, py::args args) {
+  std::vector<Array*> arguments(Array* a0, py::args args) {
     std::vector<Array*> argv{a0};
     for (auto o : args) {
       auto *ptr = py::cast<Array*>(o);
@@ -160,12 +162,33 @@ namespace einsum {
       }
       argv.push_back(ptr);
     }
+    return argv;
+  }
+
+  template<class Array>
+  void einsum(std::string expr, Array* a0, py::args args) {
+    auto argv = arguments<Array>(a0, args);
+    // the evaluation does not touch Python objects
+    SubmissionLock lock;
+    evaluate<Array>(expr, argv);
+  }
+
+  // starts the evaluation of einsum and returns without waiting; the waits
+  // for its evaluators are deferred to the returned Future
+  template<class Array>
+  auto einsum_async(std::string expr, Array* a0, py::args args) {
+    auto argv = arguments<Array>(a0, args);
+    SubmissionLock lock;
+    LazyEvalScope lazy;
     evaluate<Array>(expr, argv);
+    return future::make_future(*argv.back(), lazy.release());
   }
 
   void __init__(py::module m) {
     m.def("einsum", &einsum::einsum< TArray<double> >);
     m.def("einsum", &einsum::einsum< TSpArray<double> >);
+    m.def("einsum_async", &einsum::einsum_async< TArray<double> >);
+    m.def("einsum_async", &einsum::einsum_async< TSpArray<double> >);
   }
 
 }
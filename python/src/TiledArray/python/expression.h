@@ -20,6 +20,7 @@
 #ifndef TA_PYTHON_EXPRESSION_H
 #define TA_PYTHON_EXPRESSION_H
 
+#include "future.h"
 #include "python.h"
 
 #include <tiledarray.h>
@@ -125,16 +126,30 @@ namespace expression {
     return std::visit(visitor, index(a), index(b));
   }
 
+  // submits a statement, see SubmissionLock
+  template<class F>
+  auto submit(F &&f) {
+    SubmissionLock lock;
+    return f();
+  }
+
+  // waits for the result of a submitted statement without holding the GIL
+  template<class Future>
+  auto wait_result(Future &&f) {
+    py::gil_scoped_release gil;
+    return f.get();
+  }
+
 #define TA_PYTHON_EXPRESSION_REDUCE(EXPRESSION, OP)                     \
   [](const EXPRESSION &e) {                                             \
     auto op = [](auto &&e) { return e.OP(); };                          \
-    return evaluate(op, e).get();                                       \
+    return wait_result(submit([&]() { return evaluate(op, e); }));      \
   }
 
 #define TA_PYTHON_EXPRESSION_REDUCE2(EXPRESSION, OP)                    \
   [](const EXPRESSION &a, const EXPRESSION &b) {                        \
     auto op = [](auto &&a, auto &&b) { return a.OP(b); };               \
-    return evaluate(op, a, b).get();                                    \
+    return wait_result(submit([&]() { return evaluate(op, a, b); }));   \
   }
 
   template<class Array>
@@ -144,10 +159,25 @@ namespace expression {
 
   template<class Array>
   inline void setitem(Array &array, std::string idx, const Expression<Array> &e) {
+    // expressions do not touch Python objects
+    SubmissionLock lock;
+    auto op = [&](auto &&e) {
+      array(idx) = e;
+    };
+    evaluate(op, e);
+  }
+
+  // starts the evaluation of array(idx) = e and returns without waiting;
+  // the waits for its evaluators are deferred to the returned Future
+  template<class Array>
+  inline auto evaluate_async(Array &array, std::string idx, const Expression<Array> &e) {
+    SubmissionLock lock;
+    LazyEvalScope lazy;
     auto op = [&](auto &&e) {
       array(idx) = e;
     };
     evaluate(op, e);
+    return future::make_future(array, lazy.release());
   }
 
   template<class Array>
@@ -169,6 +199,10 @@ namespace expression {
   inline void __init__(py::module m) {
     make_array_expression_class< TArray<double> >(m, "Expression");
     make_array_expression_class< TSpArray<double> >(m, "SparseExpression");
+    m.def("evaluate_async", &evaluate_async< TArray<double> >,
+          py::arg("result"), py::arg("index"), py::arg("expression"));
+    m.def("evaluate_async", &evaluate_async< TSpArray<double> >,
+          py::arg("result"), py::arg("index"), py::arg("expression"));
   }
 
 }
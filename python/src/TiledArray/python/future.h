@@ -0,0 +1,93 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TA_PYTHON_FUTURE_H
+#define TA_PYTHON_FUTURE_H
+
+#include "python.h"
+
+#include <tiledarray.h>
+#include <vector>
+
+namespace TiledArray {
+namespace python {
+namespace future {
+
+  // completion handle of an asynchronous evaluation, i.e. the futures of the
+  // local tiles of the result and the deferred waits of its evaluators; the
+  // tiles are computed by MADNESS tasks
+  template<class Tile>
+  struct Future {
+
+    bool done() const {
+      for (const auto &w : waits) {
+        if (!w.probe()) return false;
+      }
+      for (const auto &tile : tiles) {
+        if (!tile.probe()) return false;
+      }
+      return true;
+    }
+
+    // waits without holding the GIL, so that other Python threads and
+    // tasks that call into Python can run meanwhile
+    void wait() {
+      py::gil_scoped_release gil;
+      for (auto &w : waits) {
+        w.wait();
+      }
+      for (const auto &tile : tiles) {
+        tile.get();
+      }
+    }
+
+    std::vector< madness::Future<Tile> > tiles;
+    std::vector<LazyEvalScope::Deferred> waits;
+
+  };
+
+  template<class Array>
+  inline Future<typename Array::value_type> make_future(
+    const Array &array, std::vector<LazyEvalScope::Deferred> waits)
+  {
+    Future<typename Array::value_type> f;
+    for (auto it = array.begin(); it != array.end(); ++it) {
+      f.tiles.push_back((*it).future());
+    }
+    f.waits = std::move(waits);
+    return f;
+  }
+
+  inline void __init__(py::module m) {
+    using Future = Future< Tensor<double> >;
+    py::class_<Future>(m, "Future")
+      .def("done", &Future::done)
+      .def("wait", &Future::wait)
+      .def_property_readonly(
+        "deferred",
+        [](const Future &f) { return f.waits.size(); }
+      )
+      ;
+  }
+
+}
+}
+}
+
+#endif // TA_PYTHON_FUTURE_H
@@ -23,6 +23,7 @@
 #include "array.h"
 #include "expression.h"
 #include "einsum.h"
+#include "future.h"
 
 #include <tiledarray.h>
 #include <dlfcn.h>
@@ -77,7 +78,11 @@ namespace python {
       // )
       .def_property_readonly("rank", &TiledArray::World::rank)
       .def_property_readonly("size", &TiledArray::World::size)
-      .def("fence", [](TiledArray::World &world) { world.gop.fence(); })
+      .def("fence",
+           [](TiledArray::World &world) {
+             SubmissionLock lock;
+             world.gop.fence();
+           })
       ;
 
     m.def("get_default_world", &default_world);
@@ -86,6 +91,7 @@ namespace python {
 
     range::__init__(m);
     trange::__init__(m);
+    future::__init__(m);
     expression::__init__(m);
     array::__init__(m);
     einsum::__init__(m);
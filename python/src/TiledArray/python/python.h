@@ -29,6 +29,8 @@
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
 
+#include <mutex>
+
 #ifndef TA_PYTHON_MAX_EXPRESSION
 #define TA_PYTHON_MAX_EXPRESSION 5
 #endif
@@ -53,4 +55,35 @@ namespace detail {
 }
 }
 
+namespace TiledArray {
+namespace python {
+
+  // serializes the statements that Python threads submit to TiledArray;
+  // the GIL is released while a statement is submitted, so that tasks that
+  // call into Python can run meanwhile, and the mutex keeps each statement's
+  // collective operations (e.g. the creation of distributed objects and
+  // fences) from interleaving with those of another statement and guards
+  // the process-wide state of the expression engine (the active
+  // LazyEvalScope, ExprDAG and CloneCounter); the results of a statement are
+  // waited for after the lock is released; threads that submit statements
+  // on several ranks must still submit them in the same order on every rank
+  class SubmissionLock {
+  public:
+    SubmissionLock() : gil_(), lock_(mutex()) {}
+    SubmissionLock(const SubmissionLock&) = delete;
+    SubmissionLock& operator=(const SubmissionLock&) = delete;
+
+  private:
+    static std::mutex& mutex() {
+      static std::mutex m;
+      return m;
+    }
+
+    py::gil_scoped_release gil_;  // released before the mutex is locked
+    std::unique_lock<std::mutex> lock_;
+  };
+
+}
+}
+
 #endif // TA_PYTHON_H
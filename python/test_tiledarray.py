@@ -14,6 +14,7 @@
 #  You should have received a copy of the GNU General Public License
 #  along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+import threading
 import unittest
 import tiledarray as ta
 
@@ -59,6 +60,45 @@ def make_test_case(Array):
       ta.einsum("ik,kj,ab->ijab", a, b, c, d)
       ta.get_default_world().fence()
 
+    def test_async(self):
+      a = Array([4,8],  block=2)
+      b = Array([8,12], block=2)
+      c = Array([4,12], block=2)
+      d = Array([4,12], block=2)
+      a.fill(1, False)
+      b.fill(1, False)
+      f = ta.einsum_async("ik,kj->ij", a, b, c)
+      g = ta.evaluate_async(d, "i,j", 2*c["i,j"])
+      # the evaluators are waited for by the futures, not by the calls
+      self.assertGreater(f.deferred, 0)
+      self.assertGreater(g.deferred, 0)
+      f.wait()
+      g.wait()
+      self.assertTrue(f.done() and g.done())
+      self.assertAlmostEqual(d["i,j"].min(), 16)
+      ta.get_default_world().fence()
+
+    def test_threads(self):
+      # statements submitted by several threads are serialized; the order of
+      # the threads differs between ranks, hence this runs on one rank only
+      if ta.get_default_world().size > 1:
+        self.skipTest("requires a single rank")
+      results = [None]*4
+      def run(i):
+        a = Array([4,8],  block=2)
+        b = Array([8,4], block=2)
+        c = Array([4,4], block=2)
+        a.fill(i+1, False)
+        b.fill(1, False)
+        ta.einsum("ik,kj->ij", a, b, c)
+        results[i] = c["i,j"].min()
+      threads = [ threading.Thread(target=run, args=(i,)) for i in range(4) ]
+      for t in threads: t.start()
+      for t in threads: t.join()
+      for i in range(4):
+        self.assertAlmostEqual(results[i], 8*(i+1))
+      ta.get_default_world().fence()
+
     def test_tile_setitem_getitem(self):
       import numpy as np
       world = ta.get_default_world()
@@ -102,6 +142,20 @@ def make_test_case(Array):
       self.assertEqual(b.shape, a.shape)
       #print (b[...])
 
+    def test_numpy(self):
+      import numpy as np
+      world = ta.get_default_world()
+      a = Array([5,7],  block=3, world=world)
+      data = np.arange(35.0).reshape(5,7)
+      a.from_numpy(data)
+      world.fence()
+      self.assertTrue((a.to_numpy() == data).all())
+      self.assertTrue((np.array(a) == data).all())
+      self.assertTrue((a[1,1] == data[3:5,3:6]).all())
+      # tile views share the tile data, hence are read-only
+      self.assertFalse(a[1,1].flags.writeable)
+      world.fence()
+
   return TestCase
 
 class ArrayTest(make_test_case(ta.TArray)): pass
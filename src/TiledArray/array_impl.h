@@ -469,7 +469,15 @@ class ArrayImpl : public TensorImpl<Policy> {
                                         detail::is_integral_range_v<Index>>>
   future get(const Index& i) const {
     TA_ASSERT(!TensorImpl_::is_zero(i));
-    return data_.get(TensorImpl_::trange().tiles_range().ordinal(i));
+    const auto ord = TensorImpl_::trange().tiles_range().ordinal(i);
+    // The remote tile cache reserves the size of a dense tile while the tile
+    // is in flight
+    const std::size_t expected_bytes =
+        (data_.is_local(ord)
+             ? 0ul
+             : TensorImpl_::trange().make_tile_range(ord).volume() *
+                   sizeof(numeric_type));
+    return data_.get(ord, expected_bytes);
   }
 
   /// Tile future accessor
@@ -0,0 +1,1479 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_COMPRESSED_SPARSE_SHAPE_H__INCLUDED
+#define TILEDARRAY_COMPRESSED_SPARSE_SHAPE_H__INCLUDED
+
+#include <TiledArray/sparse_shape.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+
+/// Compressed storage for the norms of the tiles of a very sparse tensor
+
+/// CompressedSparseShape has the same semantics as SparseShape, i.e. it
+/// holds the (scaled, per-element) Frobenius norms of the tiles and screens
+/// them with SparseShape<T>::threshold() , but only stores the nonzero norms,
+/// as a sequence of tile ordinals sorted in ascending order and the
+/// corresponding norms. Thus the memory footprint, and the cost of the shape
+/// arithmetic used by the expression layer (perm, scale, add, mult, gemm,
+/// etc.), are proportional to the number of nonzero tiles rather than to the
+/// number of tiles. Use it via CompressedSparsePolicy , for arrays with many
+/// tiles and very few nonzero tiles; for moderately sparse arrays SparseShape
+/// is faster.
+/// \note Element access (operator[] , is_zero ) requires a binary search.
+///       data() and tile_norms() return dense tensors that are constructed on
+///       each call, hence should be avoided for very large shapes.
+/// \tparam T The sparse element value type
+template <typename T>
+class CompressedSparseShape {
+ public:
+  typedef CompressedSparseShape<T> CompressedSparseShape_;  ///< This type
+  typedef T value_type;  ///< The norm value type
+  using index1_type = TA_1INDEX_TYPE;
+  typedef typename Tensor<value_type>::size_type size_type;  ///< Size type
+  typedef Range::ordinal_type ordinal_type;  ///< Tile ordinal type
+
+ private:
+  // T must be a numeric type
+  static_assert(std::is_floating_point<T>::value,
+                "CompressedSparseShape template type T must be a floating "
+                "point type");
+
+  // Internal typedefs
+  typedef detail::ValArray<value_type> vector_type;
+  typedef std::vector<index1_type> bound_type;
+
+  /// The nonzero tiles of the shape
+  struct Data {
+    std::vector<ordinal_type> ordinals;  ///< Tile ordinals, sorted
+    std::vector<value_type> norms;       ///< Scaled tile norms
+  };
+
+  Range range_;                       ///< The range of tiles
+  std::shared_ptr<const Data> data_;  ///< The nonzero tiles
+  std::shared_ptr<vector_type>
+      size_vectors_;  ///< Tile size information; size_vectors_.get()[d][i]
+                      ///< reports the size of i-th tile in dimension d
+
+  static std::shared_ptr<vector_type> initialize_size_vectors(
+      const TiledRange& trange) {
+    const unsigned int dim = trange.tiles_range().rank();
+    std::shared_ptr<vector_type> size_vectors(
+        new vector_type[dim], std::default_delete<vector_type[]>());
+
+    for (unsigned int i = 0ul; i != dim; ++i) {
+      const size_type n = trange.data()[i].tiles_range().second -
+                          trange.data()[i].tiles_range().first;
+
+      size_vectors.get()[i] =
+          vector_type(n, &(*trange.data()[i].begin()),
+                      [](const TiledRange1::range_type& tile) {
+                        return value_type(tile.second - tile.first);
+                      });
+    }
+
+    return size_vectors;
+  }
+
+  std::shared_ptr<vector_type> perm_size_vectors(
+      const Permutation& perm) const {
+    const unsigned int n = range_.rank();
+    std::shared_ptr<vector_type> result_size_vectors(
+        new vector_type[n], std::default_delete<vector_type[]>());
+    for (unsigned int i = 0u; i < n; ++i)
+      result_size_vectors.get()[perm[i]] = size_vectors_.get()[i];
+    return result_size_vectors;
+  }
+
+  /// \param idx the index of a tile
+  /// \param first the first dimension
+  /// \param last the last dimension
+  /// \return the product of the extents of tile \p idx in dimensions
+  /// [ \p first , \p last )
+  template <typename Index>
+  value_type tile_volume(const Index& idx, const unsigned int first,
+                         const unsigned int last) const {
+    const auto* MADNESS_RESTRICT const lobound = range_.lobound_data();
+    value_type volume = 1;
+    for (unsigned int d = first; d != last; ++d)
+      volume *= size_vectors_.get()[d][idx[d] - lobound[d]];
+    return volume;
+  }
+
+  template <typename Index>
+  value_type tile_volume(const Index& idx) const {
+    return tile_volume(idx, 0u, range_.rank());
+  }
+
+  /// \return the position of tile \p ord in the nonzero tiles, or the number
+  /// of nonzero tiles if tile \p ord is zero
+  size_type find(const ordinal_type ord) const {
+    const auto& ordinals = data_->ordinals;
+    const auto it = std::lower_bound(ordinals.begin(), ordinals.end(), ord);
+    return (it != ordinals.end() && *it == ord) ? it - ordinals.begin()
+                                                : ordinals.size();
+  }
+
+  /// Constructs the nonzero tile data from {ordinal,scaled norm} pairs
+
+  /// Norms below the threshold are dropped.
+  /// \param pairs {ordinal,scaled norm} pairs sorted by ordinal, with unique
+  /// ordinals
+  static std::shared_ptr<const Data> make_data(
+      const std::vector<std::pair<ordinal_type, value_type>>& pairs) {
+    const value_type threshold = SparseShape<T>::threshold();
+    auto data = std::make_shared<Data>();
+    for (const auto& pair : pairs) {
+      if (pair.second < threshold) continue;
+      data->ordinals.push_back(pair.first);
+      data->norms.push_back(pair.second);
+    }
+    return data;
+  }
+
+  /// Sorts {ordinal,norm} pairs by ordinal and removes duplicates
+
+  /// \param pairs {ordinal,norm} pairs
+  /// \param keep_max if true, the maximum norm of the duplicates is kept,
+  /// otherwise the last one (in the original order)
+  static void sort_unique(
+      std::vector<std::pair<ordinal_type, value_type>>& pairs,
+      const bool keep_max) {
+    if (keep_max)
+      std::sort(pairs.begin(), pairs.end(),
+                [](const auto& left, const auto& right) {
+                  return left.first < right.first ||
+                         (left.first == right.first &&
+                          left.second > right.second);
+                });
+    else {
+      std::reverse(pairs.begin(), pairs.end());
+      std::stable_sort(pairs.begin(), pairs.end(),
+                       [](const auto& left, const auto& right) {
+                         return left.first < right.first;
+                       });
+    }
+    pairs.erase(std::unique(pairs.begin(), pairs.end(),
+                            [](const auto& left, const auto& right) {
+                              return left.first == right.first;
+                            }),
+                pairs.end());
+  }
+
+  /// Collects the scaled norms of a dense tensor of tile norms
+  std::shared_ptr<const Data> compress(const Tensor<value_type>& tile_norms,
+                                       const bool do_not_scale) const {
+    TA_ASSERT(!tile_norms.empty());
+    TA_ASSERT(tile_norms.range() == range_);
+    const value_type threshold = SparseShape<T>::threshold();
+    auto data = std::make_shared<Data>();
+    const auto volume = range_.volume();
+    for (ordinal_type ord = 0ul; ord != volume; ++ord) {
+      if (tile_norms[ord] == value_type(0)) continue;
+      const value_type norm =
+          do_not_scale ? tile_norms[ord]
+                       : tile_norms[ord] / tile_volume(range_.idx(ord));
+      if (norm < threshold) continue;
+      data->ordinals.push_back(ord);
+      data->norms.push_back(norm);
+    }
+    return data;
+  }
+
+  /// Converts a sparse sequence of tile norms to {ordinal,scaled norm} pairs
+  template <typename SparseNormSequence>
+  std::vector<std::pair<ordinal_type, value_type>> scaled_pairs(
+      const SparseNormSequence& tile_norms, const bool do_not_scale) const {
+    std::vector<std::pair<ordinal_type, value_type>> pairs;
+    for (const auto& pair_idx_norm : tile_norms) {
+      const ordinal_type ord = range_.ordinal(pair_idx_norm.first);
+      pairs.emplace_back(
+          ord, do_not_scale ? pair_idx_norm.second
+                            : pair_idx_norm.second /
+                                  tile_volume(range_.idx(ord)));
+    }
+    return pairs;
+  }
+
+  CompressedSparseShape(const Range& range,
+                        std::shared_ptr<const Data> data,
+                        const std::shared_ptr<vector_type>& size_vectors)
+      : range_(range), data_(std::move(data)), size_vectors_(size_vectors) {}
+
+  /// Combines the nonzero tiles of this and \p other
+
+  /// \tparam Union if true, the result includes the tiles that are nonzero
+  /// in either shape, otherwise the tiles that are nonzero in both
+  /// \param op the operation that computes the result norm of a tile from
+  /// its ordinal and its norms in this and \p other (zero if missing)
+  template <bool Union, typename Op>
+  std::shared_ptr<const Data> merge(const CompressedSparseShape_& other,
+                                    const Op& op) const {
+    TA_ASSERT(!empty());
+    TA_ASSERT(!other.empty());
+    TA_ASSERT(range_ == other.range_);
+    const value_type threshold = SparseShape<T>::threshold();
+    const auto& left = *data_;
+    const auto& right = *other.data_;
+    auto result = std::make_shared<Data>();
+
+    auto push = [&result, threshold](const ordinal_type ord,
+                                     const value_type norm) {
+      if (norm < threshold) return;
+      result->ordinals.push_back(ord);
+      result->norms.push_back(norm);
+    };
+
+    size_type l = 0ul, r = 0ul;
+    const size_type l_end = left.ordinals.size(),
+                    r_end = right.ordinals.size();
+    while (l != l_end && r != r_end) {
+      const ordinal_type l_ord = left.ordinals[l];
+      const ordinal_type r_ord = right.ordinals[r];
+      if (l_ord == r_ord) {
+        push(l_ord, op(l_ord, left.norms[l], right.norms[r]));
+        ++l;
+        ++r;
+      } else if (l_ord < r_ord) {
+        if (Union) push(l_ord, op(l_ord, left.norms[l], value_type(0)));
+        ++l;
+      } else {
+        if (Union) push(r_ord, op(r_ord, value_type(0), right.norms[r]));
+        ++r;
+      }
+    }
+    if (Union) {
+      for (; l != l_end; ++l)
+        push(left.ordinals[l], op(left.ordinals[l], left.norms[l], 0));
+      for (; r != r_end; ++r)
+        push(right.ordinals[r], op(right.ordinals[r], 0, right.norms[r]));
+    }
+
+    return result;
+  }
+
+  /// Maps the nonzero tiles of this with a unary operation
+  template <typename Op>
+  CompressedSparseShape_ map(const Op& op) const {
+    TA_ASSERT(!empty());
+    const value_type threshold = SparseShape<T>::threshold();
+    auto result = std::make_shared<Data>();
+    const size_type n = data_->ordinals.size();
+    for (size_type i = 0ul; i != n; ++i) {
+      const value_type norm = op(data_->norms[i]);
+      if (norm < threshold) continue;
+      result->ordinals.push_back(data_->ordinals[i]);
+      result->norms.push_back(norm);
+    }
+    return CompressedSparseShape_(range_, std::move(result), size_vectors_);
+  }
+
+  template <typename Index1, typename Index2>
+  static std::pair<bound_type, bound_type> make_bounds(
+      const Index1& lower_bound, const Index2& upper_bound) {
+    using std::begin;
+    using std::end;
+    return std::make_pair(bound_type(begin(lower_bound), end(lower_bound)),
+                          bound_type(begin(upper_bound), end(upper_bound)));
+  }
+
+  template <typename PairRange>
+  static std::pair<bound_type, bound_type> make_bounds(
+      const PairRange& bounds) {
+    std::pair<bound_type, bound_type> result;
+    for (auto&& bound_d : bounds) {
+      result.first.push_back(detail::at(bound_d, 0));
+      result.second.push_back(detail::at(bound_d, 1));
+    }
+    return result;
+  }
+
+  /// makes a scaled subblock of the shape
+  CompressedSparseShape_ make_block(
+      const std::pair<bound_type, bound_type>& bounds,
+      const value_type abs_factor) const {
+    TA_ASSERT(!empty());
+    const auto rank = range_.rank();
+    const auto& lower = bounds.first;
+    const auto& upper = bounds.second;
+    TA_ASSERT(lower.size() == rank);
+    TA_ASSERT(upper.size() == rank);
+
+    std::shared_ptr<vector_type> size_vectors(
+        new vector_type[rank], std::default_delete<vector_type[]>());
+    bound_type extent(rank);
+    for (unsigned int d = 0u; d != rank; ++d) {
+      // Check that the input indices are in range
+      TA_ASSERT(lower[d] >= range_.lobound(d));
+      TA_ASSERT(lower[d] < upper[d]);
+      TA_ASSERT(upper[d] <= range_.upbound(d));
+
+      extent[d] = upper[d] - lower[d];
+      size_vectors.get()[d] = vector_type(
+          extent[d], size_vectors_.get()[d].data() + lower[d] -
+                         range_.lobound(d));
+    }
+
+    // The tiles of the block are visited in order, hence the result ordinals
+    // are sorted
+    const value_type threshold = SparseShape<T>::threshold();
+    auto result = std::make_shared<Data>();
+    const size_type n = data_->ordinals.size();
+    for (size_type i = 0ul; i != n; ++i) {
+      const auto idx = range_.idx(data_->ordinals[i]);
+      bool included = true;
+      ordinal_type ord = 0ul;
+      for (unsigned int d = 0u; d != rank && included; ++d) {
+        included = (idx[d] >= lower[d]) && (idx[d] < upper[d]);
+        ord = ord * extent[d] + (idx[d] - lower[d]);
+      }
+      if (!included) continue;
+      const value_type norm = data_->norms[i] * abs_factor;
+      if (norm < threshold) continue;
+      result->ordinals.push_back(ord);
+      result->norms.push_back(norm);
+    }
+
+    return CompressedSparseShape_(Range(extent), std::move(result),
+                                  size_vectors);
+  }
+
+  /// Replaces a sub-block of this with the contents of \p other
+  CompressedSparseShape_ make_update_block(
+      const std::pair<bound_type, bound_type>& bounds,
+      const CompressedSparseShape_& other) const {
+    TA_ASSERT(!empty());
+    TA_ASSERT(!other.empty());
+    const auto rank = range_.rank();
+    const auto& lower = bounds.first;
+    const auto& upper = bounds.second;
+    TA_ASSERT(lower.size() == rank);
+    TA_ASSERT(upper.size() == rank);
+    TA_ASSERT(other.range_.rank() == rank);
+
+    auto included = [&lower, &upper, rank](const auto& idx) {
+      for (unsigned int d = 0u; d != rank; ++d)
+        if (idx[d] < lower[d] || idx[d] >= upper[d]) return false;
+      return true;
+    };
+
+    // The nonzero tiles of this outside the block, sorted
+    std::vector<std::pair<ordinal_type, value_type>> outside;
+    const size_type n = data_->ordinals.size();
+    for (size_type i = 0ul; i != n; ++i) {
+      if (included(range_.idx(data_->ordinals[i]))) continue;
+      outside.emplace_back(data_->ordinals[i], data_->norms[i]);
+    }
+
+    // The nonzero tiles of other, mapped to this range; they are visited in
+    // order, hence sorted
+    std::vector<std::pair<ordinal_type, value_type>> inside;
+    const auto* MADNESS_RESTRICT const other_lobound =
+        other.range_.lobound_data();
+    Range::index_type idx(rank);
+    const size_type n_other = other.data_->ordinals.size();
+    for (size_type i = 0ul; i != n_other; ++i) {
+      const auto other_idx = other.range_.idx(other.data_->ordinals[i]);
+      for (unsigned int d = 0u; d != rank; ++d)
+        idx[d] = lower[d] + (other_idx[d] - other_lobound[d]);
+      TA_ASSERT(included(idx));
+      inside.emplace_back(range_.ordinal(idx), other.data_->norms[i]);
+    }
+
+    std::vector<std::pair<ordinal_type, value_type>> pairs;
+    pairs.reserve(outside.size() + inside.size());
+    std::merge(outside.begin(), outside.end(), inside.begin(), inside.end(),
+               std::back_inserter(pairs));
+
+    return CompressedSparseShape_(range_, make_data(pairs), size_vectors_);
+  }
+
+ public:
+  /// Default constructor
+
+  /// Construct a shape with no data.
+  CompressedSparseShape() = default;
+
+  /// "Dense" Constructor
+
+  /// This constructor set the tile norms to the same value.
+  /// \param tile_norm the value of the (per-element) norm for every tile
+  /// \param trange The tiled range of the tensor
+  /// \note this ctor *does not* scale tile norms
+  /// \note if @c tile_norm is less than the threshold then all tile norms are
+  /// set to zero
+  CompressedSparseShape(const value_type& tile_norm, const TiledRange& trange)
+      : range_(trange.tiles_range()),
+        size_vectors_(initialize_size_vectors(trange)) {
+    auto data = std::make_shared<Data>();
+    if (tile_norm >= threshold()) {
+      data->ordinals.resize(range_.volume());
+      std::iota(data->ordinals.begin(), data->ordinals.end(), ordinal_type(0));
+      data->norms.resize(range_.volume(), tile_norm);
+    }
+    data_ = std::move(data);
+  }
+
+  /// "Dense" constructor
+
+  /// This constructor will scale the tile norms, i.e. multiply each tile norm
+  /// by the inverse of its volume, and keep the nonzero ones.
+  /// \param tile_norms The Frobenius norm of tiles by default
+  /// \param trange The tiled range of the tensor
+  /// \param do_not_scale if true, assume that the tile norms in \c tile_norms
+  /// are already scaled
+  CompressedSparseShape(const Tensor<value_type>& tile_norms,
+                        const TiledRange& trange, bool do_not_scale = false)
+      : range_(trange.tiles_range()),
+        size_vectors_(initialize_size_vectors(trange)) {
+    data_ = compress(tile_norms, do_not_scale);
+  }
+
+  /// "Sparse" constructor
+
+  /// This constructor uses tile norms given as a sparse tensor,
+  /// represented as a sequence of {index,value_type} data.
+  /// The tile norms are scaled by the inverse of the corresponding tile's
+  /// volumes.
+  /// \tparam SparseNormSequence the sequence of \c std::pair<index,value_type>
+  ///         objects, where \c index is a tile ordinal or a
+  ///         directly-addressable sequence of indices.
+  /// \param tile_norms The Frobenius norm of tiles
+  /// \param trange The tiled range of the tensor
+  /// \param do_not_scale if true, assume that the tile norms in \c tile_norms
+  /// are already scaled
+  template <typename SparseNormSequence,
+            typename = std::enable_if_t<
+                TiledArray::detail::has_member_function_begin_anyreturn<
+                    std::decay_t<SparseNormSequence>>::value &&
+                TiledArray::detail::has_member_function_end_anyreturn<
+                    std::decay_t<SparseNormSequence>>::value>>
+  CompressedSparseShape(const SparseNormSequence& tile_norms,
+                        const TiledRange& trange, bool do_not_scale = false)
+      : range_(trange.tiles_range()),
+        size_vectors_(initialize_size_vectors(trange)) {
+    auto pairs = scaled_pairs(tile_norms, do_not_scale);
+    sort_unique(pairs, false);
+    data_ = make_data(pairs);
+  }
+
+  /// Collective "dense" constructor
+
+  /// This constructor uses tile norms given as a dense tensor.
+  /// The tile norms are max-reduced across all processes (via
+  /// an all reduce), then scaled by the inverse of the corresponding tile's
+  /// volumes.
+  /// \param world The world where the shape will live
+  /// \param tile_norms The Frobenius norm of tiles by default; expected to
+  ///        contain nonzeros for this rank's subset of tiles, or be
+  ///        replicated.
+  /// \param trange The tiled range of the tensor
+  /// \param do_not_scale if true, assume that the tile norms in \c tile_norms
+  /// are already scaled
+  CompressedSparseShape(World& world, const Tensor<value_type>& tile_norms,
+                        const TiledRange& trange, bool do_not_scale = false)
+      : range_(trange.tiles_range()),
+        size_vectors_(initialize_size_vectors(trange)) {
+    TA_ASSERT(!tile_norms.empty());
+    Tensor<value_type> reduced_tile_norms = tile_norms.clone();
+    world.gop.max(reduced_tile_norms.data(), reduced_tile_norms.size());
+    data_ = compress(reduced_tile_norms, do_not_scale);
+  }
+
+  /// Collective "sparse" constructor
+
+  /// This constructor uses tile norms given as a sparse tensor,
+  /// represented as a sequence of {index,value_type} data.
+  /// The tile norms are scaled to per-element norms by dividing each
+  /// norm by the tile's volume, and max-reduced across all processes.
+  /// Only the nonzero norms are communicated.
+  /// \tparam SparseNormSequence the sequence of \c std::pair<index,value_type>
+  ///         objects, where \c index is a tile ordinal or a
+  ///         directly-addressable sequence of indices.
+  /// \param world The world where the shape will live
+  /// \param tile_norms The Frobenius norm of tiles; expected to contain
+  ///        nonzeros for this rank's subset of tiles, or be replicated.
+  /// \param trange The tiled range of the tensor
+  /// \param do_not_scale if true, assume that the tile norms in \c tile_norms
+  /// are already scaled
+  template <typename SparseNormSequence>
+  CompressedSparseShape(World& world, const SparseNormSequence& tile_norms,
+                        const TiledRange& trange, bool do_not_scale = false)
+      : range_(trange.tiles_range()),
+        size_vectors_(initialize_size_vectors(trange)) {
+    auto local_pairs = scaled_pairs(tile_norms, do_not_scale);
+
+    // Gather the number of norms of every rank
+    const auto nproc = world.size();
+    const auto rank = world.rank();
+    std::vector<size_type> counts(nproc, 0);
+    counts[rank] = local_pairs.size();
+    world.gop.sum(counts.data(), nproc);
+    const size_type offset =
+        std::accumulate(counts.begin(), counts.begin() + rank, size_type(0));
+    const size_type count =
+        std::accumulate(counts.begin() + rank, counts.end(), offset);
+
+    // Exchange the norms; each rank fills its own segment
+    std::vector<ordinal_type> ordinals(count, 0);
+    std::vector<value_type> norms(count, value_type(0));
+    for (size_type i = 0ul; i != local_pairs.size(); ++i) {
+      ordinals[offset + i] = local_pairs[i].first;
+      norms[offset + i] = local_pairs[i].second;
+    }
+    if (count > 0ul) {
+      world.gop.sum(ordinals.data(), count);
+      world.gop.sum(norms.data(), count);
+    }
+
+    std::vector<std::pair<ordinal_type, value_type>> pairs;
+    pairs.reserve(count);
+    for (size_type i = 0ul; i != count; ++i)
+      pairs.emplace_back(ordinals[i], norms[i]);
+    sort_unique(pairs, true);
+    data_ = make_data(pairs);
+  }
+
+  /// Conversion from SparseShape
+
+  /// \param shape a SparseShape object
+  /// \param trange The tiled range of \p shape
+  CompressedSparseShape(const SparseShape<T>& shape, const TiledRange& trange)
+      : CompressedSparseShape(shape.data(), trange, true) {}
+
+  CompressedSparseShape(const CompressedSparseShape<T>&) = default;
+  CompressedSparseShape(CompressedSparseShape<T>&&) = default;
+  CompressedSparseShape<T>& operator=(const CompressedSparseShape<T>&) =
+      default;
+  CompressedSparseShape<T>& operator=(CompressedSparseShape<T>&&) = default;
+
+  /// Validate shape range
+
+  /// \return \c true when range matches the range of this shape
+  bool validate(const Range& range) const {
+    if (empty()) return false;
+    return (range == range_);
+  }
+
+  /// Check that a tile is zero
+
+  /// \tparam Index The type of the index
+  /// \return true if tile \p i is zero
+  template <typename Index>
+  bool is_zero(const Index& i) const {
+    TA_ASSERT(!empty());
+    return find(range_.ordinal(i)) == data_->ordinals.size();
+  }
+
+  /// Check density
+
+  /// \return false
+  static constexpr bool is_dense() { return false; }
+
+  /// Sparsity of the shape
+
+  /// \return The fraction of tiles that are zero.
+  float sparsity() const {
+    TA_ASSERT(!empty());
+    return float(range_.volume() - data_->ordinals.size()) /
+           float(range_.volume());
+  }
+
+  /// Threshold accessor
+
+  /// The threshold is shared with SparseShape<T>
+  /// \return The current threshold
+  static value_type threshold() { return SparseShape<T>::threshold(); }
+
+  /// Set threshold to \c thresh
+
+  /// \param thresh The new threshold
+  static void threshold(const value_type thresh) {
+    SparseShape<T>::threshold(thresh);
+  }
+
+  /// Tile norm accessor
+
+  /// \tparam Index The index type
+  /// \param index The index of the tile norm to retrieve
+  /// \return The (scaled) norm of the tile at \c index
+  template <typename Index>
+  value_type operator[](const Index& index) const {
+    TA_ASSERT(!empty());
+    const size_type i = find(range_.ordinal(index));
+    return i == data_->ordinals.size() ? value_type(0) : data_->norms[i];
+  }
+
+  /// \return The number of nonzero tiles
+  size_type nnz() const {
+    TA_ASSERT(!empty());
+    return data_->ordinals.size();
+  }
+
+  /// \return The ordinals of the nonzero tiles, in ascending order
+  const std::vector<ordinal_type>& ordinals() const {
+    TA_ASSERT(!empty());
+    return data_->ordinals;
+  }
+
+  /// \return The scaled norms of the nonzero tiles, in the order of
+  /// ordinals()
+  const std::vector<value_type>& norms() const {
+    TA_ASSERT(!empty());
+    return data_->norms;
+  }
+
+  /// Transform the norm tensor with an operation
+
+  /// \return The shape obtained from the (dense) scaled norms transformed by
+  /// \p op
+  /// \note This is an O(number of tiles) operation
+  template <typename Op>
+  CompressedSparseShape_ transform(Op&& op) const {
+    Tensor<T> new_norms = op(data());
+    return CompressedSparseShape_(range_, compress(new_norms, true),
+                                  size_vectors_);
+  }
+
+  /// Data accessor
+
+  /// \return A \c Tensor object with the scaled (per-element) Frobenius norms
+  /// of tiles
+  /// \note This is an O(number of tiles) operation
+  Tensor<value_type> data() const {
+    TA_ASSERT(!empty());
+    Tensor<value_type> result(range_, value_type(0));
+    const size_type n = data_->ordinals.size();
+    for (size_type i = 0ul; i != n; ++i)
+      result[data_->ordinals[i]] = data_->norms[i];
+    return result;
+  }
+
+  /// Data accessor
+
+  /// \return A \c Tensor object with the Frobenius norms of tiles
+  /// \note This is an O(number of tiles) operation
+  Tensor<value_type> tile_norms() const {
+    TA_ASSERT(!empty());
+    Tensor<value_type> result(range_, value_type(0));
+    const size_type n = data_->ordinals.size();
+    for (size_type i = 0ul; i != n; ++i) {
+      const auto ord = data_->ordinals[i];
+      result[ord] = data_->norms[i] * tile_volume(range_.idx(ord));
+    }
+    return result;
+  }
+
+  /// Initialization check
+
+  /// \return \c true when this shape has been initialized.
+  bool empty() const { return !data_; }
+
+  /// Compute union of two shapes
+
+  /// \param mask The input shape, hard zeros are used to mask the output.
+  /// \return A shape that is masked by the mask.
+  CompressedSparseShape_ mask(const CompressedSparseShape_& mask_shape) const {
+    return CompressedSparseShape_(
+        range_,
+        merge<false>(mask_shape,
+                     [](const ordinal_type, const value_type left,
+                        const value_type) { return left; }),
+        size_vectors_);
+  }
+
+  // clang-format off
+  /// Creates a copy of this with a sub-block updated with contents of another shape
+
+  /// \tparam Index1 An integral range type
+  /// \tparam Index2 An integral range type
+  /// \param lower_bound The lower bound of the sub-block to be updated
+  /// \param upper_bound The upper bound of the sub-block to be updated
+  /// \param other The shape that will be used to update the sub-block
+  /// \return A new shape object where the sub-block defined by \p lower_bound and \p upper_bound contains
+  /// the data of \c other.
+  // clang-format on
+  template <typename Index1, typename Index2,
+            typename = std::enable_if_t<detail::is_integral_range_v<Index1> &&
+                                        detail::is_integral_range_v<Index2>>>
+  CompressedSparseShape update_block(
+      const Index1& lower_bound, const Index2& upper_bound,
+      const CompressedSparseShape& other) const {
+    return make_update_block(make_bounds(lower_bound, upper_bound), other);
+  }
+
+  // clang-format off
+  /// Creates a copy of this with a sub-block updated with contents of another shape
+
+  /// \tparam Index1 An integral type
+  /// \tparam Index2 An integral type
+  /// \param lower_bound The lower bound of the sub-block to be updated
+  /// \param upper_bound The upper bound of the sub-block to be updated
+  /// \param other The shape that will be used to update the sub-block
+  /// \return A new shape object where the sub-block defined by \p lower_bound and \p upper_bound contains
+  /// the data of \c other.
+  // clang-format on
+  template <typename Index1, typename Index2,
+            typename = std::enable_if_t<std::is_integral_v<Index1> &&
+                                        std::is_integral_v<Index2>>>
+  CompressedSparseShape update_block(
+      const std::initializer_list<Index1>& lower_bound,
+      const std::initializer_list<Index2>& upper_bound,
+      const CompressedSparseShape& other) const {
+    return make_update_block(make_bounds(lower_bound, upper_bound), other);
+  }
+
+  // clang-format off
+  /// Creates a copy of this with a sub-block updated with contents of another shape
+
+  /// \tparam PairRange Type representing a range of generalized pairs (see TiledArray::detail::is_gpair_v )
+  /// \param bounds The {lower,upper} bounds of the sub-block
+  /// \param other The shape that will be used to update the sub-block
+  /// \return A new shape object where the sub-block defined by \p bounds contains
+  /// the data of \c other.
+  // clang-format on
+  template <typename PairRange,
+            typename = std::enable_if_t<detail::is_gpair_range_v<PairRange>>>
+  CompressedSparseShape update_block(
+      const PairRange& bounds, const CompressedSparseShape& other) const {
+    return make_update_block(make_bounds(bounds), other);
+  }
+
+  // clang-format off
+  /// Creates a copy of this with a sub-block updated with contents of another shape
+
+  /// \tparam Index An integral type
+  /// \param bounds The {lower,upper} bounds of the sub-block
+  /// \param other The shape that will be used to update the sub-block
+  /// \return A new shape object where the sub-block defined by \p bounds contains
+  /// the data of \c other.
+  // clang-format on
+  template <typename Index,
+            typename = std::enable_if_t<std::is_integral_v<Index>>>
+  CompressedSparseShape update_block(
+      const std::initializer_list<std::initializer_list<Index>>& bounds,
+      const CompressedSparseShape& other) const {
+    return make_update_block(make_bounds(bounds), other);
+  }
+
+  /// Bitwise comparison
+
+  /// \param other a CompressedSparseShape object
+  /// \return true if this object and @c other object are bitwise identical
+  bool operator==(const CompressedSparseShape<T>& other) const {
+    if (empty() || other.empty()) return empty() && other.empty();
+    bool equal = (range_ == other.range_);
+    const unsigned int dim = range_.rank();
+    for (unsigned d = 0; d != dim && equal; ++d)
+      equal = (size_vectors_.get()[d] == other.size_vectors_.get()[d]);
+    return equal && (data_->ordinals == other.data_->ordinals) &&
+           (data_->norms == other.data_->norms);
+  }
+
+  /// Create a copy of a sub-block of the shape
+
+  /// \tparam Index1 An integral range type
+  /// \tparam Index2 An integral range type
+  /// \param lower_bound The lower bound of the sub-block
+  /// \param upper_bound The upper bound of the sub-block
+  template <typename Index1, typename Index2,
+            typename = std::enable_if_t<detail::is_integral_range_v<Index1> &&
+                                        detail::is_integral_range_v<Index2>>>
+  CompressedSparseShape block(const Index1& lower_bound,
+                              const Index2& upper_bound) const {
+    return make_block(make_bounds(lower_bound, upper_bound), value_type(1));
+  }
+
+  /// Create a copy of a sub-block of the shape
+
+  /// \tparam Index1 An integral type
+  /// \tparam Index2 An integral type
+  /// \param lower_bound The lower bound of the sub-block
+  /// \param upper_bound The upper bound of the sub-block
+  template <typename Index1, typename Index2,
+            typename = std::enable_if_t<std::is_integral_v<Index1> &&
+                                        std::is_integral_v<Index2>>>
+  CompressedSparseShape block(
+      const std::initializer_list<Index1>& lower_bound,
+      const std::initializer_list<Index2>& upper_bound) const {
+    return make_block(make_bounds(lower_bound, upper_bound), value_type(1));
+  }
+
+  /// Create a copy of a sub-block of the shape
+
+  /// \tparam PairRange Type representing a range of generalized pairs (see
+  /// TiledArray::detail::is_gpair_v )
+  /// \param bounds The {lower,upper} bounds of the sub-block
+  template <typename PairRange,
+            typename = std::enable_if_t<detail::is_gpair_range_v<PairRange>>>
+  CompressedSparseShape block(const PairRange& bounds) const {
+    return make_block(make_bounds(bounds), value_type(1));
+  }
+
+  /// Create a copy of a sub-block of the shape
+
+  /// \tparam Index An integral type
+  /// \param bounds A range of {lower,upper} bounds for each dimension
+  template <typename Index,
+            typename = std::enable_if_t<std::is_integral_v<Index>>>
+  CompressedSparseShape block(
+      const std::initializer_list<std::initializer_list<Index>>& bounds) const {
+    return make_block(make_bounds(bounds), value_type(1));
+  }
+
+  /// Create a scaled sub-block of the shape
+
+  /// \tparam Index1 An integral range type
+  /// \tparam Index2 An integral range type
+  /// \tparam Scalar A numeric type
+  /// \param lower_bound The lower bound of the sub-block
+  /// \param upper_bound The upper bound of the sub-block
+  /// \param factor the scaling factor
+  template <typename Index1, typename Index2, typename Scalar,
+            typename = std::enable_if_t<detail::is_integral_range_v<Index1> &&
+                                        detail::is_integral_range_v<Index2> &&
+                                        detail::is_numeric_v<Scalar>>>
+  CompressedSparseShape block(const Index1& lower_bound,
+                              const Index2& upper_bound,
+                              const Scalar factor) const {
+    return make_block(make_bounds(lower_bound, upper_bound),
+                      to_abs_factor(factor));
+  }
+
+  /// Create a scaled sub-block of the shape
+
+  /// \tparam Index1 An integral type
+  /// \tparam Index2 An integral type
+  /// \tparam Scalar A numeric type
+  /// \param lower_bound The lower bound of the sub-block
+  /// \param upper_bound The upper bound of the sub-block
+  /// \param factor the scaling factor
+  template <typename Index1, typename Index2, typename Scalar,
+            typename = std::enable_if_t<std::is_integral_v<Index1> &&
+                                        std::is_integral_v<Index2> &&
+                                        detail::is_numeric_v<Scalar>>>
+  CompressedSparseShape block(const std::initializer_list<Index1>& lower_bound,
+                              const std::initializer_list<Index2>& upper_bound,
+                              const Scalar factor) const {
+    return make_block(make_bounds(lower_bound, upper_bound),
+                      to_abs_factor(factor));
+  }
+
+  /// Create a scaled sub-block of the shape
+
+  /// \tparam PairRange Type representing a range of generalized pairs (see
+  /// TiledArray::detail::is_gpair_v )
+  /// \tparam Scalar A numeric type
+  /// \param bounds A range of {lower,upper} bounds for each dimension
+  /// \param factor the scaling factor
+  template <typename PairRange, typename Scalar,
+            typename = std::enable_if_t<detail::is_numeric_v<Scalar> &&
+                                        detail::is_gpair_range_v<PairRange>>>
+  CompressedSparseShape block(const PairRange& bounds,
+                              const Scalar factor) const {
+    return make_block(make_bounds(bounds), to_abs_factor(factor));
+  }
+
+  /// Create a scaled sub-block of the shape
+
+  /// \tparam Index An integral type
+  /// \tparam Scalar A numeric type
+  /// \param bounds A range of {lower,upper} bounds for each dimension
+  /// \param factor the scaling factor
+  template <typename Index, typename Scalar,
+            typename = std::enable_if_t<detail::is_numeric_v<Scalar> &&
+                                        std::is_integral_v<Index>>>
+  CompressedSparseShape block(
+      const std::initializer_list<std::initializer_list<Index>>& bounds,
+      const Scalar factor) const {
+    return make_block(make_bounds(bounds), to_abs_factor(factor));
+  }
+
+  /// Create a permuted sub-block of the shape
+
+  /// \tparam Index1 An integral range type
+  /// \tparam Index2 An integral range type
+  /// \param lower_bound The lower bound of the sub-block
+  /// \param upper_bound The upper bound of the sub-block
+  /// \param perm permutation to apply
+  template <typename Index1, typename Index2,
+            typename = std::enable_if_t<detail::is_integral_range_v<Index1> &&
+                                        detail::is_integral_range_v<Index2>>>
+  CompressedSparseShape block(const Index1& lower_bound,
+                              const Index2& upper_bound,
+                              const Permutation& perm) const {
+    return block(lower_bound, upper_bound).perm(perm);
+  }
+
+  /// Create a permuted sub-block of the shape
+
+  /// \tparam Index1 An integral type
+  /// \tparam Index2 An integral type
+  /// \param lower_bound The lower bound of the sub-block
+  /// \param upper_bound The upper bound of the sub-block
+  /// \param perm permutation to apply
+  template <typename Index1, typename Index2,
+            typename = std::enable_if_t<std::is_integral_v<Index1> &&
+                                        std::is_integral_v<Index2>>>
+  CompressedSparseShape block(const std::initializer_list<Index1>& lower_bound,
+                              const std::initializer_list<Index2>& upper_bound,
+                              const Permutation& perm) const {
+    return block(lower_bound, upper_bound).perm(perm);
+  }
+
+  /// Create a permuted sub-block of the shape
+
+  /// \tparam PairRange Type representing a range of generalized pairs (see
+  /// TiledArray::detail::is_gpair_v )
+  /// \param bounds A range of {lower,upper} bounds for each dimension
+  /// \param perm permutation to apply
+  template <typename PairRange,
+            typename = std::enable_if_t<detail::is_gpair_range_v<PairRange>>>
+  CompressedSparseShape block(const PairRange& bounds,
+                              const Permutation& perm) const {
+    return block(bounds).perm(perm);
+  }
+
+  /// Create a permuted sub-block of the shape
+
+  /// \tparam Index An integral type
+  /// \param bounds A range of {lower,upper} bounds for each dimension
+  /// \param perm permutation to apply
+  template <typename Index,
+            typename = std::enable_if_t<std::is_integral_v<Index>>>
+  CompressedSparseShape block(
+      const std::initializer_list<std::initializer_list<Index>>& bounds,
+      const Permutation& perm) const {
+    return block(bounds).perm(perm);
+  }
+
+  /// Create a permuted scaled sub-block of the shape
+
+  /// \tparam Index1 An integral range type
+  /// \tparam Index2 An integral range type
+  /// \tparam Scalar A numeric type
+  /// \param lower_bound The lower bound of the sub-block
+  /// \param upper_bound The upper bound of the sub-block
+  /// \param factor the scaling factor
+  /// \param perm permutation to apply
+  template <typename Index1, typename Index2, typename Scalar,
+            typename = std::enable_if_t<detail::is_integral_range_v<Index1> &&
+                                        detail::is_integral_range_v<Index2> &&
+                                        detail::is_numeric_v<Scalar>>>
+  CompressedSparseShape block(const Index1& lower_bound,
+                              const Index2& upper_bound, const Scalar factor,
+                              const Permutation& perm) const {
+    return block(lower_bound, upper_bound, factor).perm(perm);
+  }
+
+  /// Create a permuted scaled sub-block of the shape
+
+  /// \tparam Index1 An integral type
+  /// \tparam Index2 An integral type
+  /// \tparam Scalar A numeric type
+  /// \param lower_bound The lower bound of the sub-block
+  /// \param upper_bound The upper bound of the sub-block
+  /// \param factor the scaling factor
+  /// \param perm permutation to apply
+  template <typename Index1, typename Index2, typename Scalar,
+            typename = std::enable_if_t<std::is_integral_v<Index1> &&
+                                        std::is_integral_v<Index2> &&
+                                        detail::is_numeric_v<Scalar>>>
+  CompressedSparseShape block(const std::initializer_list<Index1>& lower_bound,
+                              const std::initializer_list<Index2>& upper_bound,
+                              const Scalar factor,
+                              const Permutation& perm) const {
+    return block(lower_bound, upper_bound, factor).perm(perm);
+  }
+
+  /// Create a permuted scaled sub-block of the shape
+
+  /// \tparam PairRange Type representing a range of generalized pairs (see
+  /// TiledArray::detail::is_gpair_v )
+  /// \tparam Scalar A numeric type
+  /// \param bounds A range of {lower,upper} bounds for each dimension
+  /// \param factor the scaling factor
+  /// \param perm permutation to apply
+  template <typename PairRange, typename Scalar,
+            typename = std::enable_if_t<detail::is_numeric_v<Scalar> &&
+                                        detail::is_gpair_range_v<PairRange>>>
+  CompressedSparseShape block(const PairRange& bounds, const Scalar factor,
+                              const Permutation& perm) const {
+    return block(bounds, factor).perm(perm);
+  }
+
+  /// Create a permuted scaled sub-block of the shape
+
+  /// \tparam Index An integral type
+  /// \tparam Scalar A numeric type
+  /// \param bounds A range of {lower,upper} bounds for each dimension
+  /// \param factor the scaling factor
+  /// \param perm permutation to apply
+  template <typename Index, typename Scalar,
+            typename = std::enable_if_t<detail::is_numeric_v<Scalar> &&
+                                        std::is_integral_v<Index>>>
+  CompressedSparseShape block(
+      const std::initializer_list<std::initializer_list<Index>>& bounds,
+      const Scalar factor, const Permutation& perm) const {
+    return block(bounds, factor).perm(perm);
+  }
+
+  /// Create a permuted shape of this shape
+
+  /// Only the nonzero tiles are permuted, i.e. this is an
+  /// O(nnz log(nnz)) operation.
+  /// \param perm The permutation to be applied
+  /// \return A new, permuted shape
+  CompressedSparseShape_ perm(const Permutation& perm) const {
+    TA_ASSERT(!empty());
+    const Range result_range = perm * range_;
+    const unsigned int rank = range_.rank();
+
+    std::vector<std::pair<ordinal_type, value_type>> pairs;
+    pairs.reserve(data_->ordinals.size());
+    Range::index_type result_idx(rank);
+    const size_type n = data_->ordinals.size();
+    for (size_type i = 0ul; i != n; ++i) {
+      const auto idx = range_.idx(data_->ordinals[i]);
+      for (unsigned int d = 0u; d != rank; ++d) result_idx[perm[d]] = idx[d];
+      pairs.emplace_back(result_range.ordinal(result_idx), data_->norms[i]);
+    }
+    std::sort(pairs.begin(), pairs.end(),
+              [](const auto& left, const auto& right) {
+                return left.first < right.first;
+              });
+
+    return CompressedSparseShape_(result_range, make_data(pairs),
+                                  perm_size_vectors(perm));
+  }
+
+  /// Scale shape
+
+  /// \tparam Scalar A numeric type
+  /// \param factor The scaling factor
+  /// \return A new, scaled shape
+  template <typename Scalar,
+            typename = std::enable_if_t<detail::is_numeric_v<Scalar>>>
+  CompressedSparseShape_ scale(const Scalar factor) const {
+    const value_type abs_factor = to_abs_factor(factor);
+    return map([abs_factor](const value_type norm) {
+      return norm * abs_factor;
+    });
+  }
+
+  /// Scale and permute shape
+
+  /// \tparam Factor The scaling factor type
+  /// \param factor The scaling factor
+  /// \param perm The permutation that will be applied to this tensor.
+  /// \return A new, scaled-and-permuted shape
+  template <typename Factor>
+  CompressedSparseShape_ scale(const Factor factor,
+                               const Permutation& perm) const {
+    return scale(factor).perm(perm);
+  }
+
+  /// Add shapes
+
+  /// The result norms are the sums of the norms of this and \p other , i.e.
+  /// the nonzero tiles of the result are the union of the nonzero tiles of
+  /// the arguments.
+  /// \param other The shape to be added to this shape
+  /// \return A sum of shapes
+  CompressedSparseShape_ add(const CompressedSparseShape_& other) const {
+    return CompressedSparseShape_(
+        range_,
+        merge<true>(other,
+                    [](const ordinal_type, const value_type left,
+                       const value_type right) { return left + right; }),
+        size_vectors_);
+  }
+
+  /// Add and permute shapes
+
+  /// \param other The shape to be added to this shape
+  /// \param perm The permutation that is applied to the result
+  /// \return the new shape
+  CompressedSparseShape_ add(const CompressedSparseShape_& other,
+                             const Permutation& perm) const {
+    return add(other).perm(perm);
+  }
+
+  /// Add and scale shapes
+
+  /// \tparam Factor The scaling factor type
+  /// \param other The shape to be added to this shape
+  /// \param factor The scaling factor
+  /// \return A scaled sum of shapes
+  template <typename Factor>
+  CompressedSparseShape_ add(const CompressedSparseShape_& other,
+                             const Factor factor) const {
+    const value_type abs_factor = to_abs_factor(factor);
+    return CompressedSparseShape_(
+        range_,
+        merge<true>(other,
+                    [abs_factor](const ordinal_type, const value_type left,
+                                 const value_type right) {
+                      return (left + right) * abs_factor;
+                    }),
+        size_vectors_);
+  }
+
+  /// Add, scale, and permute shapes
+
+  /// \tparam Factor The scaling factor type
+  /// \param other The shape to be added to this shape
+  /// \param factor The scaling factor
+  /// \param perm The permutation that is applied to the result
+  /// \return A scaled and permuted sum of shapes
+  template <typename Factor>
+  CompressedSparseShape_ add(const CompressedSparseShape_& other,
+                             const Factor factor,
+                             const Permutation& perm) const {
+    return add(other, factor).perm(perm);
+  }
+
+  /// Add a constant to a shape
+
+  /// \param value The constant to be added
+  /// \return The shape of this with a constant added to every element
+  /// \note In general every tile of the result is nonzero, hence this is an
+  /// O(number of tiles) operation
+  CompressedSparseShape_ add(value_type value) const {
+    TA_ASSERT(!empty());
+    value = std::abs(value);
+    const value_type threshold = this->threshold();
+    auto result = std::make_shared<Data>();
+    const auto volume = range_.volume();
+    size_type i = 0ul;
+    const size_type n = data_->ordinals.size();
+    for (ordinal_type ord = 0ul; ord != volume; ++ord) {
+      value_type norm = value / std::sqrt(tile_volume(range_.idx(ord)));
+      if (i != n && data_->ordinals[i] == ord) norm += data_->norms[i++];
+      if (norm < threshold) continue;
+      result->ordinals.push_back(ord);
+      result->norms.push_back(norm);
+    }
+    return CompressedSparseShape_(range_, std::move(result), size_vectors_);
+  }
+
+  CompressedSparseShape_ add(const value_type value,
+                             const Permutation& perm) const {
+    return add(value).perm(perm);
+  }
+
+  CompressedSparseShape_ subt(const CompressedSparseShape_& other) const {
+    return add(other);
+  }
+
+  CompressedSparseShape_ subt(const CompressedSparseShape_& other,
+                              const Permutation& perm) const {
+    return add(other, perm);
+  }
+
+  template <typename Factor>
+  CompressedSparseShape_ subt(const CompressedSparseShape_& other,
+                              const Factor factor) const {
+    return add(other, factor);
+  }
+
+  template <typename Factor>
+  CompressedSparseShape_ subt(const CompressedSparseShape_& other,
+                              const Factor factor,
+                              const Permutation& perm) const {
+    return add(other, factor, perm);
+  }
+
+  CompressedSparseShape_ subt(const value_type value) const {
+    return add(value);
+  }
+
+  CompressedSparseShape_ subt(const value_type value,
+                              const Permutation& perm) const {
+    return add(value, perm);
+  }
+
+  /// Multiply shapes
+
+  /// The nonzero tiles of the result are the intersection of the nonzero
+  /// tiles of the arguments.
+  /// \param other The shape to be multiplied by this shape
+  /// \return The shape of the elementwise product
+  CompressedSparseShape_ mult(const CompressedSparseShape_& other) const {
+    return mult(other, value_type(1));
+  }
+
+  CompressedSparseShape_ mult(const CompressedSparseShape_& other,
+                              const Permutation& perm) const {
+    return mult(other).perm(perm);
+  }
+
+  template <typename Factor>
+  CompressedSparseShape_ mult(const CompressedSparseShape_& other,
+                              const Factor factor) const {
+    const value_type abs_factor = to_abs_factor(factor);
+    return CompressedSparseShape_(
+        range_,
+        merge<false>(other,
+                     [this, abs_factor](const ordinal_type ord,
+                                        const value_type left,
+                                        const value_type right) {
+                       return left * right * abs_factor *
+                              tile_volume(range_.idx(ord));
+                     }),
+        size_vectors_);
+  }
+
+  template <typename Factor>
+  CompressedSparseShape_ mult(const CompressedSparseShape_& other,
+                              const Factor factor,
+                              const Permutation& perm) const {
+    return mult(other, factor).perm(perm);
+  }
+
+  /// Contract shapes
+
+  /// Sparse-sparse product of the norm matrices (Gustavson's algorithm with
+  /// sort-based accumulation): the cost is proportional to the number of
+  /// nonzero tile products, and no dense intermediates are formed.
+  /// \tparam Factor The scaling factor type
+  /// \param other The right-hand argument
+  /// \param factor The scaling factor
+  /// \param gemm_helper The contraction helper
+  /// \return The shape of the contraction
+  template <typename Factor>
+  CompressedSparseShape_ gemm(const CompressedSparseShape_& other,
+                              const Factor factor,
+                              const math::GemmHelper& gemm_helper) const {
+    TA_ASSERT(!empty());
+    TA_ASSERT(!other.empty());
+
+    const value_type abs_factor = to_abs_factor(factor);
+
+    // Initialize the result size vectors
+    std::shared_ptr<vector_type> result_size_vectors(
+        new vector_type[gemm_helper.result_rank()],
+        std::default_delete<vector_type[]>());
+    unsigned int x = 0ul;
+    for (unsigned int i = gemm_helper.left_outer_begin();
+         i < gemm_helper.left_outer_end(); ++i, ++x)
+      result_size_vectors.get()[x] = size_vectors_.get()[i];
+    for (unsigned int i = gemm_helper.right_outer_begin();
+         i < gemm_helper.right_outer_end(); ++i, ++x)
+      result_size_vectors.get()[x] = other.size_vectors_.get()[i];
+
+    const Range result_range =
+        gemm_helper.make_result_range<Range>(range_, other.range_);
+
+    // Fuses dimensions [first,last) of an index into an ordinal
+    auto fuse = [](const Range& range, const auto& idx,
+                   const unsigned int first, const unsigned int last) {
+      ordinal_type result = 0ul;
+      for (unsigned int d = first; d != last; ++d)
+        result = result * range.extent(d) + (idx[d] - range.lobound(d));
+      return result;
+    };
+    ordinal_type N = 1ul;
+    for (unsigned int d = gemm_helper.right_outer_begin();
+         d != gemm_helper.right_outer_end(); ++d)
+      N *= other.range_.extent(d);
+
+    // Left (m,k) and right (k,n) entries; the scaled norm of a product tile
+    // is weighted by the square of the volume of the contracted tiles
+    typedef std::tuple<ordinal_type, ordinal_type, value_type> entry_type;
+    std::vector<entry_type> left;
+    left.reserve(data_->ordinals.size());
+    for (size_type i = 0ul; i != data_->ordinals.size(); ++i) {
+      const auto idx = range_.idx(data_->ordinals[i]);
+      const value_type k_volume =
+          tile_volume(idx, gemm_helper.left_inner_begin(),
+                      gemm_helper.left_inner_end());
+      left.emplace_back(fuse(range_, idx, gemm_helper.left_outer_begin(),
+                             gemm_helper.left_outer_end()),
+                        fuse(range_, idx, gemm_helper.left_inner_begin(),
+                             gemm_helper.left_inner_end()),
+                        data_->norms[i] * k_volume * k_volume * abs_factor);
+    }
+    std::sort(left.begin(), left.end());
+
+    std::vector<entry_type> right;
+    right.reserve(other.data_->ordinals.size());
+    for (size_type i = 0ul; i != other.data_->ordinals.size(); ++i) {
+      const auto idx = other.range_.idx(other.data_->ordinals[i]);
+      right.emplace_back(
+          fuse(other.range_, idx, gemm_helper.right_inner_begin(),
+               gemm_helper.right_inner_end()),
+          fuse(other.range_, idx, gemm_helper.right_outer_begin(),
+               gemm_helper.right_outer_end()),
+          other.data_->norms[i]);
+    }
+    std::sort(right.begin(), right.end());
+
+    // Compute the result rows
+    const value_type threshold = this->threshold();
+    auto result = std::make_shared<Data>();
+    std::vector<std::pair<ordinal_type, value_type>> row;
+    auto left_it = left.begin();
+    while (left_it != left.end()) {
+      const ordinal_type m = std::get<0>(*left_it);
+      row.clear();
+      for (; left_it != left.end() && std::get<0>(*left_it) == m; ++left_it) {
+        const ordinal_type k = std::get<1>(*left_it);
+        const value_type left_norm = std::get<2>(*left_it);
+        auto right_it = std::lower_bound(
+            right.begin(), right.end(), k,
+            [](const entry_type& entry, const ordinal_type value) {
+              return std::get<0>(entry) < value;
+            });
+        for (; right_it != right.end() && std::get<0>(*right_it) == k;
+             ++right_it)
+          row.emplace_back(std::get<1>(*right_it),
+                           left_norm * std::get<2>(*right_it));
+      }
+
+      // Accumulate the contributions to each result tile of the row
+      std::sort(row.begin(), row.end(),
+                [](const auto& left, const auto& right) {
+                  return left.first < right.first;
+                });
+      for (auto it = row.begin(); it != row.end();) {
+        const ordinal_type n = it->first;
+        value_type norm = 0;
+        for (; it != row.end() && it->first == n; ++it) norm += it->second;
+        if (norm < threshold) continue;
+        result->ordinals.push_back(m * N + n);
+        result->norms.push_back(norm);
+      }
+    }
+
+    return CompressedSparseShape_(result_range, std::move(result),
+                                  result_size_vectors);
+  }
+
+  /// Contract and permute shapes
+
+  /// \tparam Factor The scaling factor type
+  /// \param other The right-hand argument
+  /// \param factor The scaling factor
+  /// \param gemm_helper The contraction helper
+  /// \param perm The permutation that is applied to the result
+  /// \return The permuted shape of the contraction
+  template <typename Factor>
+  CompressedSparseShape_ gemm(const CompressedSparseShape_& other,
+                              const Factor factor,
+                              const math::GemmHelper& gemm_helper,
+                              const Permutation& perm) const {
+    return gemm(other, factor, gemm_helper).perm(perm);
+  }
+
+  template <typename Archive,
+            typename std::enable_if<madness::archive::is_input_archive<
+                Archive>::value>::type* = nullptr>
+  void serialize(const Archive& ar) {
+    ar& range_;
+    auto data = std::make_shared<Data>();
+    ar& data->ordinals& data->norms;
+    data_ = std::move(data);
+    const unsigned int dim = range_.rank();
+    size_vectors_ = std::shared_ptr<vector_type>(
+        new vector_type[dim], std::default_delete<vector_type[]>());
+    for (unsigned d = 0; d != dim; ++d) ar& size_vectors_.get()[d];
+  }
+
+  template <typename Archive,
+            typename std::enable_if<madness::archive::is_output_archive<
+                Archive>::value>::type* = nullptr>
+  void serialize(const Archive& ar) const {
+    TA_ASSERT(!empty());
+    ar& range_& data_->ordinals& data_->norms;
+    const unsigned int dim = range_.rank();
+    for (unsigned d = 0; d != dim; ++d) ar& size_vectors_.get()[d];
+  }
+
+ private:
+  template <typename Factor>
+  static value_type to_abs_factor(const Factor factor) {
+    using std::abs;
+    const auto cast_abs_factor = static_cast<value_type>(abs(factor));
+    TA_ASSERT(std::isfinite(cast_abs_factor));
+    return cast_abs_factor;
+  }
+
+};  // class CompressedSparseShape
+
+/// Add the shape to an output stream
+
+/// \tparam T the numeric type supporting the type of \c shape
+/// \param os The output stream
+/// \param shape the CompressedSparseShape<T> object
+/// \return A reference to the output stream
+template <typename T>
+inline std::ostream& operator<<(std::ostream& os,
+                                const CompressedSparseShape<T>& shape) {
+  os << "CompressedSparseShape<" << typeid(T).name() << ">:" << std::endl;
+  const auto& ordinals = shape.ordinals();
+  const auto& norms = shape.norms();
+  os << "{";
+  for (std::size_t i = 0; i != ordinals.size(); ++i)
+    os << (i == 0 ? " " : ", ") << ordinals[i] << ": " << norms[i];
+  os << " }" << std::endl;
+  return os;
+}
+
+/// collective bitwise-compare-reduce for CompressedSparseShape objects
+
+/// @param world the World object
+/// @param[in] shape the CompressedSparseShape object
+/// @return true if \c shape is bitwise identical across \c world
+/// @note must be invoked on every rank of World
+template <typename T>
+bool is_replicated(World& world, const CompressedSparseShape<T>& shape) {
+  std::size_t nnz = shape.nnz();
+  world.gop.max(&nnz, 1);
+  // pad to the same size on every rank, so that every rank participates in
+  // the same collectives
+  auto ordinals = shape.ordinals();
+  auto norms = shape.norms();
+  ordinals.resize(nnz, 0);
+  norms.resize(nnz, T(0));
+  if (nnz > 0) {
+    world.gop.max(ordinals.data(), nnz);
+    world.gop.max(norms.data(), nnz);
+  }
+  return nnz == shape.nnz() && ordinals == shape.ordinals() &&
+         norms == shape.norms();
+}
+
+#ifndef TILEDARRAY_HEADER_ONLY
+
+extern template class CompressedSparseShape<float>;
+
+#endif  // TILEDARRAY_HEADER_ONLY
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_COMPRESSED_SPARSE_SHAPE_H__INCLUDED
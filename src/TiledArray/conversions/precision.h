@@ -0,0 +1,147 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_CONVERSIONS_PRECISION_H__INCLUDED
+#define TILEDARRAY_CONVERSIONS_PRECISION_H__INCLUDED
+
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+#include <TiledArray/conversions/to_new_tile_type.h>
+#include <TiledArray/dense_shape.h>
+#include <TiledArray/error.h>
+#include <TiledArray/sparse_shape.h>
+#include <TiledArray/tensor/tensor.h>
+
+namespace TiledArray {
+
+/// The precision in which the elements of an array are stored
+enum class Precision { Single, Double };
+
+inline std::ostream& operator<<(std::ostream& os, const Precision precision) {
+  os << (precision == Precision::Single ? "single" : "double");
+  return os;
+}
+
+/// Unit roundoff of a storage precision
+
+/// \param precision The storage precision
+/// \return The maximum relative error of rounding a number to \c precision
+inline double unit_roundoff(const Precision precision) {
+  return (precision == Precision::Single
+              ? double(std::numeric_limits<float>::epsilon())
+              : std::numeric_limits<double>::epsilon()) /
+         2.0;
+}
+
+/// Selects the storage precision of arrays from their shapes
+
+/// Rounding the elements of an array to a precision with unit roundoff \c u
+/// changes the array by at most <tt>u * ||array||</tt> (in the Frobenius
+/// norm). This policy stores an array in single precision if that bound,
+/// computed from the tile norms of a SparseShape, does not exceed the
+/// tolerance; a DenseShape carries no norms, hence dense arrays are kept in
+/// double precision. Single-precision arrays halve the memory footprint and
+/// the volume of the tiles that are communicated; contracting them into a
+/// double-precision result, requested in an expression with
+/// MultExpr::accumulate_as, accumulates the products in double precision
+/// (see ContractReduce).
+class PrecisionPolicy {
+  double tolerance_;  ///< The tolerated rounding error
+
+ public:
+  /// \param tolerance The tolerated rounding error of an array
+  explicit PrecisionPolicy(const double tolerance) : tolerance_(tolerance) {
+    TA_ASSERT(tolerance >= 0.0);
+  }
+
+  /// \return The tolerated rounding error of an array
+  double tolerance() const { return tolerance_; }
+
+  /// Bound on the rounding error of an array
+
+  /// \tparam T The shape value type
+  /// \param shape The shape of the array
+  /// \param precision The storage precision
+  /// \return The bound on the Frobenius norm of the rounding error
+  template <typename T>
+  static double rounding_error(const SparseShape<T>& shape,
+                               const Precision precision) {
+    double norm_squared = 0.0;
+    for (const T norm : shape.tile_norms())
+      norm_squared += double(norm) * double(norm);
+    return unit_roundoff(precision) * std::sqrt(norm_squared);
+  }
+
+  /// Select the precision of an array with a dense shape
+
+  /// \return Precision::Double
+  Precision select(const DenseShape&) const { return Precision::Double; }
+
+  /// Select the precision of an array with a sparse shape
+
+  /// \tparam T The shape value type
+  /// \param shape The shape of the array
+  /// \return The lowest precision whose rounding error is tolerated
+  template <typename T>
+  Precision select(const SparseShape<T>& shape) const {
+    return (rounding_error(shape, Precision::Single) <= tolerance_
+                ? Precision::Single
+                : Precision::Double);
+  }
+
+  /// Select the precision of an array
+
+  /// \tparam Tile The array tile type
+  /// \tparam Policy The array policy type
+  /// \param array The array
+  /// \return The lowest precision whose rounding error is tolerated
+  template <typename Tile, typename Policy>
+  Precision select(const DistArray<Tile, Policy>& array) const {
+    return select(array.shape());
+  }
+};  // class PrecisionPolicy
+
+/// Convert an array to a different element type
+
+/// The shape of \c array is retained; the tiles are converted as they are
+/// copied.
+/// \tparam T The element type of the result
+/// \tparam U The element type of \c array
+/// \tparam A The allocator type of the tiles of \c array
+/// \tparam Policy The array policy type
+/// \param array The array to be converted
+/// \return A copy of \c array with elements of type \c T , or \c array if it
+/// already has elements of type \c T
+template <typename T, typename U, typename A, typename Policy>
+inline DistArray<Tensor<T>, Policy> to_precision(
+    const DistArray<Tensor<U, A>, Policy>& array) {
+  if constexpr (std::is_same_v<Tensor<T>, Tensor<U, A>>) {
+    return array;
+  } else {
+    return to_new_tile_type(
+        array, [](const Tensor<U, A>& tile) { return Tensor<T>(tile); });
+  }
+}
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_CONVERSIONS_PRECISION_H__INCLUDED
@@ -1164,18 +1164,23 @@ class DistArray : public madness::archive::ParallelSerializableObject {
   void swap(DistArray_& other) { std::swap(pimpl_, other.pimpl_); }
 
   /// Convert a distributed array into a replicated array
+
+  /// The tiles of each process are broadcast in chunks along binomial trees
+  /// (see detail::TreeReplicator).
+  /// \param chunk_bytes The target size of the broadcast chunks, in bytes
   /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
   ///                              guarantee.
-  void make_replicated() {
+  void make_replicated(
+      const std::size_t chunk_bytes =
+          detail::TreeReplicator<DistArray_>::default_chunk_bytes) {
     if ((!impl_ref().pmap()->is_replicated()) && (world().size() > 1)) {
       // Construct a replicated array
       auto pmap = std::make_shared<detail::ReplicatedPmap>(world(), size());
       DistArray_ result = DistArray_(world(), trange(), shape(), pmap);
 
-      // Create the replicator object that will do an all-to-all broadcast of
-      // the local tile data.
-      auto replicator =
-          std::make_shared<detail::Replicator<DistArray_>>(*this, result);
+      // Create the replicator object that will broadcast the local tile data
+      auto replicator = std::make_shared<detail::TreeReplicator<DistArray_>>(
+          *this, result, chunk_bytes);
 
       // Put the replicator pointer in the deferred cleanup object so it will
       // be deleted at the end of the next fence.
@@ -28,6 +28,7 @@
 
 #include <TiledArray/block_range.h>
 #include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/remote_tile_cache.h>
 
 namespace TiledArray {
 namespace detail {
@@ -258,11 +259,14 @@ class ArrayEvalImpl
     // index to the correct location.
     if (block_range_.rank()) array_index = block_range_.ordinal(array_index);
 
+    // Remote tiles are copies that may be consumed, unless they are shared
+    // with other consumers through the remote tile cache
+    const bool consumable_tile = !array_.is_local(array_index) &&
+                                 !RemoteTileCache::instance().enabled();
+
     // Get the tile from array_, which may be located on a remote node.
     Future<typename array_type::value_type> tile = array_.find(array_index);
 
-    const bool consumable_tile = !array_.is_local(array_index);
-
     return eval_tile(tile, consumable_tile);
   }
 
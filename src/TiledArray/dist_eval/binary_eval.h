@@ -236,9 +236,10 @@ class BinaryEvalImpl : public DistEvalImpl<typename Op::result_type, Policy>,
       }
     }
 
-    // Wait for child tensors to be evaluated, and process tasks while waiting.
-    left_.wait();
-    right_.wait();
+    // Wait for child tensors to be evaluated, and process tasks while waiting
+    // (deferred in a LazyEvalScope).
+    LazyEvalScope::wait(left_);
+    LazyEvalScope::wait(right_);
 
     return task_count;
   }
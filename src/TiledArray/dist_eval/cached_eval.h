@@ -0,0 +1,141 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_CACHED_EVAL_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_CACHED_EVAL_H__INCLUDED
+
+#include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/tile_interface/clone.h>
+
+namespace TiledArray {
+namespace detail {
+
+/// Distributed evaluator for a cached intermediate
+
+/// This evaluator streams the tiles of an array that holds the (possibly
+/// not yet computed) result of a shared subexpression to one of its
+/// consumers. The tiles are forwarded as they become available; remote
+/// tiles are fetched from their owner in the cache array. Consumers that may
+/// modify their argument tiles in place receive copies, unless they are the
+/// last consumer of the intermediate.
+/// \tparam Array The cache array type
+/// \tparam Policy The evaluator policy type
+template <typename Array, typename Policy>
+class CachedEvalImpl
+    : public DistEvalImpl<typename Array::value_type, Policy>,
+      public std::enable_shared_from_this<CachedEvalImpl<Array, Policy>> {
+ public:
+  typedef CachedEvalImpl<Array, Policy> CachedEvalImpl_;  ///< This object type
+  typedef DistEvalImpl<typename Array::value_type, Policy>
+      DistEvalImpl_;  ///< The base class type
+  typedef typename DistEvalImpl_::TensorImpl_
+      TensorImpl_;          ///< The base, base class type
+  typedef Array array_type;  ///< The cache array type
+  typedef typename DistEvalImpl_::ordinal_type ordinal_type;  ///< Ordinal type
+  typedef typename DistEvalImpl_::range_type range_type;      ///< Range type
+  typedef typename DistEvalImpl_::shape_type shape_type;      ///< Shape type
+  typedef typename DistEvalImpl_::pmap_interface
+      pmap_interface;  ///< Process map interface type
+  typedef
+      typename DistEvalImpl_::trange_type trange_type;    ///< Tiled range type
+  typedef typename DistEvalImpl_::value_type value_type;  ///< Tile type
+
+  /// Constructor
+
+  /// \param array The cache array, its tiled range and shape must match
+  /// \c trange and \c shape
+  /// \param world The world where the tensor lives
+  /// \param trange The tiled range object
+  /// \param shape The tensor shape object
+  /// \param pmap The tile-process map
+  /// \param perm The permutation that is applied to tile indices
+  /// \param clone If \c true, the consumer receives copies of the tiles
+  CachedEvalImpl(const array_type& array, World& world,
+                 const trange_type& trange, const shape_type& shape,
+                 const std::shared_ptr<pmap_interface>& pmap,
+                 const Permutation& perm, const bool clone)
+      : DistEvalImpl_(world, trange, shape, pmap, perm),
+        array_(array),
+        clone_(clone) {}
+
+  /// Virtual destructor
+  virtual ~CachedEvalImpl() {}
+
+  /// Get tile at index \c i
+
+  /// \param i The index of the tile
+  /// \return A \c Future to the tile at index i
+  /// \throw TiledArray::Exception When tile \c i is owned by a remote node.
+  /// \throw TiledArray::Exception When tile \c i a zero tile.
+  virtual Future<value_type> get_tile(ordinal_type i) const {
+    TA_ASSERT(TensorImpl_::is_local(i));
+    TA_ASSERT(!TensorImpl_::is_zero(i));
+    const madness::DistributedID key(DistEvalImpl_::id(), i);
+    return TensorImpl_::world().gop.template recv<value_type>(
+        TensorImpl_::owner(i), key);
+  }
+
+  /// Discard a tile that is not needed
+
+  /// This function handles the cleanup for tiles that are not needed in
+  /// subsequent computation.
+  /// \param i The index of the tile
+  virtual void discard_tile(ordinal_type i) const { get_tile(i); }
+
+ private:
+  /// Task function that copies a tile
+
+  /// \param i The tile index
+  /// \param tile The cached tile
+  void clone_tile(const ordinal_type i, const value_type& tile) {
+    DistEvalImpl_::set_tile(i, TiledArray::clone(tile));
+  }
+
+  /// Forward the local tiles of the cache to the consumer
+
+  /// \return The number of tiles that will be set by this process
+  virtual int internal_eval() {
+    std::shared_ptr<CachedEvalImpl_> self =
+        std::enable_shared_from_this<CachedEvalImpl_>::shared_from_this();
+
+    ordinal_type task_count = 0ul;
+    for (const auto index : *TensorImpl_::pmap()) {
+      if (TensorImpl_::is_zero(index)) continue;
+      if (clone_)
+        TensorImpl_::world().taskq.add(self, &CachedEvalImpl_::clone_tile,
+                                       index, array_.find(index));
+      else
+        DistEvalImpl_::set_tile(index, array_.find(index));
+      ++task_count;
+    }
+
+    // The requested tiles are held by their futures, release the cache
+    array_ = array_type();
+
+    return task_count;
+  }
+
+  array_type array_;  ///< The cache array
+  const bool clone_;  ///< Copy the tiles before forwarding them
+};                    // class CachedEvalImpl
+
+}  // namespace detail
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_DIST_EVAL_CACHED_EVAL_H__INCLUDED
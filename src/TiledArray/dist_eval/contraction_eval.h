@@ -20,6 +20,7 @@
 #ifndef TILEDARRAY_DIST_EVAL_CONTRACTION_EVAL_H__INCLUDED
 #define TILEDARRAY_DIST_EVAL_CONTRACTION_EVAL_H__INCLUDED
 
+#include <cmath>
 #include <vector>
 
 #include <TiledArray/config.h>
@@ -93,8 +94,23 @@ class Summa
   const ordinal_type k_;      ///< Number of tiles in the inner dimension
   const ProcGrid proc_grid_;  ///< Process grid for this contraction
 
+  // Screened argument tiles (empty if no tiles are screened)
+  std::vector<bool> left_screened_;   ///< Screened tiles of \c left_
+  std::vector<bool> right_screened_;  ///< Screened tiles of \c right_
+
   // Contraction results
-  ReducePairTask<op_type>* reduce_tasks_;  ///< A pointer to the reduction tasks
+  /// The reduction task type; the result tiles have a high fan-in, hence
+  /// the contributions are reduced concurrently (except for CUDA tiles,
+  /// whose reductions must be synchronized with the CUDA streams)
+#ifdef TILEDARRAY_HAS_CUDA
+  typedef std::conditional_t<is_cuda_tile_v<value_type>,
+                             ReducePairTask<op_type>,
+                             ConcurrentReducePairTask<op_type>>
+      reduce_task_type;
+#else
+  typedef ConcurrentReducePairTask<op_type> reduce_task_type;
+#endif
+  reduce_task_type* reduce_tasks_;  ///< A pointer to the reduction tasks
 
   // Constants used to iterate over columns and rows of left_ and right_,
   // respectively.
@@ -179,10 +195,10 @@ class Summa
   /// Process group factory function
 
   /// This function generates a sparse process group.
-  /// \tparam Shape The shape type
+  /// \tparam IsZero The zero-tile predicate type
   /// \tparam ProcMap The process map operation type
-  /// \param shape The shape that will be used to select processes that are
-  /// included in the process group
+  /// \param is_zero The zero-tile predicate that will be used to select
+  /// processes that are included in the process group
   /// \param process_mask the process mask, if
   ///        \code process_mask[p] == true \endcode,
   ///        process \c p will not be included in the result (p is row/col index
@@ -199,8 +215,8 @@ class Summa
   /// index into the absolute process index (ProcessID)
   /// \return A sparse process group that includes process in the row or
   /// column of this process as defined by \c proc_grid_.
-  template <typename Shape, typename ProcMap>
-  madness::Group make_group(const Shape& shape,
+  template <typename IsZero, typename ProcMap>
+  madness::Group make_group(const IsZero& is_zero,
                             const std::vector<bool>& process_mask,
                             ordinal_type index, const ordinal_type end,
                             const ordinal_type stride,
@@ -219,7 +235,7 @@ class Summa
     // Flag all processes that have non-zero tiles
     for (p = 0ul; (index < end) && (count < max_group_size);
          index += stride, p = (p + 1u) % max_group_size) {
-      if ((proc_list[p] != -1) || (shape.is_zero(index)) || !process_mask.at(p))
+      if ((proc_list[p] != -1) || (is_zero(index)) || !process_mask.at(p))
         continue;
 
       proc_list[p] = proc_map(p);
@@ -254,11 +270,12 @@ class Summa
 
     // return empty group if I am not in this group, otherwise make a group
     if (result_row_mask_k[proc_grid_.rank_col()])
-      return make_group(right_.shape(), result_row_mask_k, right_begin_k,
-                        right_end_k, right_stride_, proc_grid_.proc_cols(), k,
-                        k_, [&](const ProcGrid::size_type col) {
-                          return proc_grid_.map_col(col);
-                        });
+      return make_group(
+          [this](const ordinal_type index) { return right_is_zero(index); },
+          result_row_mask_k, right_begin_k, right_end_k, right_stride_,
+          proc_grid_.proc_cols(), k, k_, [&](const ProcGrid::size_type col) {
+            return proc_grid_.map_col(col);
+          });
     else
       return madness::Group();
   }
@@ -275,7 +292,8 @@ class Summa
     // return empty group if I am not in this group, otherwise make a group
     if (result_col_mask_k[proc_grid_.rank_row()])
       return make_group(
-          left_.shape(), result_col_mask_k, k, left_end_, left_stride_,
+          [this](const ordinal_type index) { return left_is_zero(index); },
+          result_col_mask_k, k, left_end_, left_stride_,
           proc_grid_.proc_rows(), k, 0ul,
           [&](const ordinal_type row) { return proc_grid_.map_row(row); });
     else
@@ -317,7 +335,7 @@ class Summa
     for (ordinal_type i = i_start, ik = i_start * nk + k; i < i_fence;
          i += i_stride, ik += ik_stride) {
       // ... such that A[i][k] exists ...
-      if (!left_.shape().is_zero(ik)) {
+      if (!left_is_zero(ik)) {
         // ... the owner of А[i][k] is always in the group ...
         const auto k_proc_col = k % nproc_cols;
         mask[k_proc_col] = true;
@@ -382,7 +400,7 @@ class Summa
     for (ordinal_type j = j_start, kj = k * nj + j_start; j < j_fence;
          j += j_stride, kj += kj_stride) {
       // ... such that B[k][j] exists ...
-      if (!right_.shape().is_zero(kj)) {
+      if (!right_is_zero(kj)) {
         // ... the owner of B[k][j] is always in the group ...
         auto k_proc_row = k % nproc_rows;
         mask[k_proc_row] = true;
@@ -440,6 +458,174 @@ class Summa
     return std::make_tuple(start, fence, stride);
   }
 
+  // Screening functions ---------------------------------------------------
+
+  /// Check for a zero or screened tile of \c left_
+
+  /// \param index The tile index of \c left_
+  /// \return \c true if the tile is zero or if it was screened
+  bool left_is_zero(const ordinal_type index) const {
+    return left_.shape().is_zero(index) ||
+           (!left_screened_.empty() && left_screened_[index]);
+  }
+
+  /// Check for a zero or screened tile of \c right_
+
+  /// \param index The tile index of \c right_
+  /// \return \c true if the tile is zero or if it was screened
+  bool right_is_zero(const ordinal_type index) const {
+    return right_.shape().is_zero(index) ||
+           (!right_screened_.empty() && right_screened_[index]);
+  }
+
+  /// Magnitude of the scaling factor of a tile operation
+
+  /// \tparam O The tile operation type
+  /// \param op The tile operation
+  /// \return The absolute value of <tt>op.factor()</tt>
+  template <typename O>
+  static auto abs_factor(const O& op, int)
+      -> decltype(op.factor(), double()) {
+    using std::abs;
+    return static_cast<double>(abs(op.factor()));
+  }
+
+  /// Magnitude of the scaling factor of an unscaled tile operation
+
+  /// \tparam O The tile operation type
+  /// \return 1
+  template <typename O>
+  static double abs_factor(const O&, long) { return 1.0; }
+
+  /// Flag the tiles of an argument that were not selected by the screen
+
+  /// Local tiles that are flagged are discarded, since they will never be
+  /// broadcast.
+  /// \tparam Arg The argument type
+  /// \param arg The argument
+  /// \param contributes The tiles of \c arg that contribute to the result
+  /// \return The screened tiles of \c arg , or an empty vector if no tile
+  /// was screened
+  template <typename Arg>
+  static std::vector<bool> screened_tiles(
+      const Arg& arg, const std::vector<bool>& contributes) {
+    std::vector<bool> screened(arg.size(), false);
+    bool found_screened = false;
+    for (ordinal_type index = 0ul; index < arg.size(); ++index) {
+      if (contributes[index] || arg.shape().is_zero(index)) continue;
+      screened[index] = found_screened = true;
+      if (arg.is_local(index)) arg.discard(index);
+    }
+    if (!found_screened) screened.clear();
+    return screened;
+  }
+
+  /// Screen the argument tiles
+
+  /// Dense contractions are not screened.
+  template <typename Shape>
+  void screen(const Shape&) {}
+
+  /// Screen the argument tiles of a sparse contraction
+
+  /// Flag the non-zero tiles of \c left_ and \c right_ that do not make a
+  /// significant contribution to any non-zero result tile; flagged tiles are
+  /// treated as zero tiles, i.e. they are neither broadcast nor contracted.
+  /// As in SparseShape::gemm, the contribution of <tt>A[i][k]</tt> and
+  /// <tt>B[k][j]</tt> to the (per-element) norm of <tt>C[i][j]</tt> is the
+  /// product of their norms, the size of the inner dimension of tile \c k ,
+  /// and the scaling factor. A contribution is negligible if it is less than
+  /// the zero threshold divided by \c k_ , hence the sum of the negligible
+  /// contributions to a result tile is below the threshold. If all the
+  /// contributions to a non-zero result tile are negligible, its largest
+  /// contribution is kept so that the tile is still computed. The screen only
+  /// depends on the shapes, so it is identical on all processes. Nested
+  /// tensors are not screened, since their scaling factor may be absorbed
+  /// into the element operation.
+  /// \tparam T The shape value type
+  /// \param shape The result shape
+  template <typename T>
+  void screen(const SparseShape<T>& shape) {
+    if constexpr (!TiledArray::detail::is_tensor_of_tensor_v<value_type>) {
+      const ordinal_type ni = proc_grid_.rows();
+      const ordinal_type nj = proc_grid_.cols();
+      const ordinal_type nk = k_;
+      const double factor = abs_factor(op_, 0);
+      if ((nk == 0ul) || !(factor > 0.0)) return;
+      const double threshold_k =
+          double(shape.threshold()) / (double(nk) * factor);
+
+      // Compute the size of the inner dimension of each k tile
+      const auto& left_trange = left_.trange();
+      const unsigned int left_rank = left_trange.tiles_range().rank();
+      const unsigned int num_contract_ranks =
+          (left_rank + right_.trange().tiles_range().rank() -
+           TensorImpl_::trange().tiles_range().rank()) >>
+          1;
+      std::vector<double> k_sizes(nk, 1.0);
+      for (ordinal_type k = 0ul; k < nk; ++k) {
+        const auto range = left_trange.make_tile_range(k);
+        for (unsigned int d = left_rank - num_contract_ranks; d < left_rank;
+             ++d)
+          k_sizes[k] *= range.extent(d);
+      }
+
+      // Cache the non-zero result tiles
+      std::vector<bool> result_non_zero(ni * nj);
+      for (ordinal_type ij = 0ul; ij < ni * nj; ++ij)
+        result_non_zero[ij] =
+            !shape.is_zero(DistEvalImpl_::perm_index_to_target(ij));
+
+      // Select the tiles that make a significant contribution to at least
+      // one non-zero result tile, and record the largest contribution to the
+      // result tiles that have no significant contribution
+      std::vector<bool> left_contributes(left_.size(), false);
+      std::vector<bool> right_contributes(right_.size(), false);
+      std::vector<bool> result_covered(ni * nj, false);
+      std::vector<double> largest(ni * nj, 0.0);
+      std::vector<ordinal_type> largest_k(ni * nj, nk);
+      std::vector<double> right_norms(nj);
+      for (ordinal_type k = 0ul; k < nk; ++k) {
+        for (ordinal_type j = 0ul, kj = k * nj; j < nj; ++j, ++kj)
+          right_norms[j] = (right_.shape().is_zero(kj)
+                                ? 0.0
+                                : double(right_.shape()[kj]) * k_sizes[k]);
+
+        for (ordinal_type i = 0ul, ik = k; i < ni; ++i, ik += nk) {
+          if (left_.shape().is_zero(ik)) continue;
+          const double left_norm = left_.shape()[ik];
+          for (ordinal_type j = 0ul, ij = i * nj; j < nj; ++j, ++ij) {
+            if (!result_non_zero[ij] || (right_norms[j] == 0.0)) continue;
+            const double contribution = left_norm * right_norms[j];
+            if (contribution < threshold_k) {
+              if (!result_covered[ij] && (contribution > largest[ij])) {
+                largest[ij] = contribution;
+                largest_k[ij] = k;
+              }
+              continue;
+            }
+            result_covered[ij] = true;
+            left_contributes[ik] = true;
+            right_contributes[k * nj + j] = true;
+          }
+        }
+      }
+
+      // Keep the largest contribution to the non-zero result tiles that have
+      // no significant contribution
+      for (ordinal_type ij = 0ul; ij < ni * nj; ++ij) {
+        if (result_covered[ij] || (largest_k[ij] == nk)) continue;
+        const ordinal_type i = ij / nj;
+        const ordinal_type j = ij % nj;
+        left_contributes[i * nk + largest_k[ij]] = true;
+        right_contributes[largest_k[ij] * nj + j] = true;
+      }
+
+      left_screened_ = screened_tiles(left_, left_contributes);
+      right_screened_ = screened_tiles(right_, right_contributes);
+    }
+  }
+
   // Broadcast kernels -----------------------------------------------------
 
   /// Tile conversion task function
@@ -515,26 +701,29 @@ class Summa
   /// Collect non-zero tiles from \c arg
 
   /// \tparam Arg The argument type
+  /// \tparam IsZero The zero-tile predicate type
   /// \tparam Datum The vector datum type
   /// \param[in] arg The owner of the input tiles
+  /// \param[in] is_zero The predicate that selects the zero tiles of \c arg
   /// \param[in] index The index of the first tile to be broadcast
   /// \param[in] end The end of the range of tiles to be broadcast
   /// \param[in] stride The stride between tile indices to be broadcast
   /// \param[out] vec The vector that will hold broadcast tiles
-  template <typename Arg, typename Datum>
-  void get_vector(Arg& arg, ordinal_type index, const ordinal_type end,
-                  const ordinal_type stride, std::vector<Datum>& vec) const {
+  template <typename Arg, typename IsZero, typename Datum>
+  void get_vector(Arg& arg, const IsZero& is_zero, ordinal_type index,
+                  const ordinal_type end, const ordinal_type stride,
+                  std::vector<Datum>& vec) const {
     TA_ASSERT(vec.size() == 0ul);
 
     // Iterate over vector of tiles
     if (arg.is_local(index)) {
       for (ordinal_type i = 0ul; index < end; ++i, index += stride) {
-        if (arg.shape().is_zero(index)) continue;
+        if (is_zero(index)) continue;
         vec.emplace_back(i, get_tile(arg, index));
       }
     } else {
       for (ordinal_type i = 0ul; index < end; ++i, index += stride) {
-        if (arg.shape().is_zero(index)) continue;
+        if (is_zero(index)) continue;
         vec.emplace_back(i, Future<typename Arg::eval_type>());
       }
     }
@@ -548,8 +737,9 @@ class Summa
   /// \param[out] col The column vector that will hold the tiles
   void get_col(const ordinal_type k, std::vector<col_datum>& col) const {
     col.reserve(proc_grid_.local_rows());
-    get_vector(left_, left_start_local_ + k, left_end_, left_stride_local_,
-               col);
+    get_vector(
+        left_, [this](const ordinal_type index) { return left_is_zero(index); },
+        left_start_local_ + k, left_end_, left_stride_local_, col);
   }
 
   /// Collect non-zero tiles from row \c k of \c right_
@@ -564,7 +754,10 @@ class Summa
     const ordinal_type end = begin + proc_grid_.cols();
     begin += proc_grid_.rank_col();
 
-    get_vector(right_, begin, end, right_stride_local_, row);
+    get_vector(
+        right_,
+        [this](const ordinal_type index) { return right_is_zero(index); },
+        begin, end, right_stride_local_, row);
   }
 
   /// Broadcast tiles from \c arg
@@ -691,7 +884,7 @@ class Summa
 
       // Search column k of left for non-zero tiles
       for (; index < left_end_; index += left_stride_local_) {
-        if (left_.shape().is_zero(index)) continue;
+        if (left_is_zero(index)) continue;
 
         // Construct broadcast group, if needed
         if (!have_group) {
@@ -734,7 +927,7 @@ class Summa
 
       // Search for and broadcast non-zero row
       for (; index < row_end; index += right_stride_local_) {
-        if (right_.shape().is_zero(index)) continue;
+        if (right_is_zero(index)) continue;
 
         // Construct broadcast group
         if (!have_group) {
@@ -778,7 +971,7 @@ class Summa
       ordinal_type i = end + proc_grid_.rank_col();
       end += proc_grid_.cols();
       for (; i < end; i += right_stride_local_)
-        if (!right_.shape().is_zero(i)) return k;
+        if (!right_is_zero(i)) return k;
     }
 
     return k;
@@ -799,7 +992,7 @@ class Summa
       // Search row k for non-zero tiles
       for (ordinal_type i = left_start_local_ + k; i < left_end_;
            i += left_stride_local_)
-        if (!left_.shape().is_zero(i)) return k;
+        if (!left_is_zero(i)) return k;
 
     return k;
   }
@@ -863,6 +1056,24 @@ class Summa
 
   // Initialization functions ----------------------------------------------
 
+  /// Construct the reduction task of a result tile
+
+  /// The number of contributions that a concurrent reduction task holds
+  /// unreduced is bounded by a small multiple of the number of threads;
+  /// when the bound is reached, the SUMMA step that adds the contribution
+  /// executes other tasks until one has been reduced.
+  /// \param reduce_task The (uninitialized) storage of the reduction task
+  void construct_reduce_task(reduce_task_type* const reduce_task) const {
+    if constexpr (std::is_same_v<reduce_task_type,
+                                 ConcurrentReducePairTask<op_type>>) {
+      const std::size_t max_pending = 4ul * (madness::ThreadPool::size() + 1ul);
+      new (reduce_task)
+          reduce_task_type(TensorImpl_::world(), op_, nullptr, 0u, max_pending);
+    } else {
+      new (reduce_task) reduce_task_type(TensorImpl_::world(), op_);
+    }
+  }
+
   /// Initialize reduce tasks and construct broadcast groups
   ordinal_type initialize(const DenseShape&) {
     // Construct static broadcast groups for dense arguments
@@ -886,16 +1097,16 @@ class Summa
 #endif  // TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE
 
     // Allocate memory for the reduce pair tasks.
-    std::allocator<ReducePairTask<op_type>> alloc;
+    std::allocator<reduce_task_type> alloc;
     reduce_tasks_ = alloc.allocate(proc_grid_.local_size());
 
     // Iterate over all local tiles
     const ordinal_type n = proc_grid_.local_size();
     for (ordinal_type t = 0ul; t < n; ++t) {
       // Initialize the reduction task
-      ReducePairTask<op_type>* MADNESS_RESTRICT const reduce_task =
+      reduce_task_type* MADNESS_RESTRICT const reduce_task =
           reduce_tasks_ + t;
-      new (reduce_task) ReducePairTask<op_type>(TensorImpl_::world(), op_);
+      construct_reduce_task(reduce_task);
     }
 
     return proc_grid_.local_size();
@@ -910,7 +1121,7 @@ class Summa
 #endif  // TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE
 
     // Allocate memory for the reduce pair tasks.
-    std::allocator<ReducePairTask<op_type>> alloc;
+    std::allocator<reduce_task_type> alloc;
     reduce_tasks_ = alloc.allocate(proc_grid_.local_size());
 
     // Initialize iteration variables
@@ -925,7 +1136,7 @@ class Summa
 
     // Iterate over all local tiles
     ordinal_type tile_count = 0ul;
-    ReducePairTask<op_type>* MADNESS_RESTRICT reduce_task = reduce_tasks_;
+    reduce_task_type* MADNESS_RESTRICT reduce_task = reduce_tasks_;
     // this loops over result tiles arranged in block-cyclic order
     // index = tile index (row major)
     for (; row_start < end; row_start += col_stride, row_end += col_stride) {
@@ -939,11 +1150,11 @@ class Summa
           ss << index << " ";
 #endif  // TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE
 
-          new (reduce_task) ReducePairTask<op_type>(TensorImpl_::world(), op_);
+          construct_reduce_task(reduce_task);
           ++tile_count;
         } else {
           // Construct an empty task to represent zero tiles.
-          new (reduce_task) ReducePairTask<op_type>();
+          new (reduce_task) reduce_task_type();
         }
       }
     }
@@ -961,6 +1172,7 @@ class Summa
     printf("init: start rank=%i\n", TensorImpl_::world().rank());
 #endif  // TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE
 
+    screen(TensorImpl_::shape());
     const ordinal_type result = initialize(TensorImpl_::shape());
 
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE
@@ -985,7 +1197,7 @@ class Summa
     const ordinal_type end = TensorImpl_::size();
 
     // Iterate over all local tiles
-    for (ReducePairTask<op_type>* reduce_task = reduce_tasks_; row_start < end;
+    for (reduce_task_type* reduce_task = reduce_tasks_; row_start < end;
          row_start += col_stride, row_end += col_stride) {
       for (ordinal_type index = row_start; index < row_end;
            index += row_stride, ++reduce_task) {
@@ -994,12 +1206,12 @@ class Summa
                                 reduce_task->submit());
 
         // Destroy the reduce task
-        reduce_task->~ReducePairTask<op_type>();
+        reduce_task->~reduce_task_type();
       }
     }
 
     // Deallocate the memory for the reduce pair tasks.
-    std::allocator<ReducePairTask<op_type>>().deallocate(
+    std::allocator<reduce_task_type>().deallocate(
         reduce_tasks_, proc_grid_.local_size());
   }
 
@@ -1022,7 +1234,7 @@ class Summa
     const ordinal_type end = TensorImpl_::size();
 
     // Iterate over all local tiles
-    for (ReducePairTask<op_type>* reduce_task = reduce_tasks_; row_start < end;
+    for (reduce_task_type* reduce_task = reduce_tasks_; row_start < end;
          row_start += col_stride, row_end += col_stride) {
       for (ordinal_type index = row_start; index < row_end;
            index += row_stride, ++reduce_task) {
@@ -1041,11 +1253,11 @@ class Summa
         }
 
         // Destroy the reduce task
-        reduce_task->~ReducePairTask<op_type>();
+        reduce_task->~reduce_task_type();
       }
     }
     // Deallocate the memory for the reduce pair tasks.
-    std::allocator<ReducePairTask<op_type>>().deallocate(
+    std::allocator<reduce_task_type>().deallocate(
         reduce_tasks_, proc_grid_.local_size());
 
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
@@ -1714,9 +1926,10 @@ class Summa
     printf("eval: start wait children rank=%i\n", TensorImpl_::world().rank());
 #endif  // TILEDARRAY_ENABLE_SUMMA_TRACE_EVAL
 
-    // Wait for child tensors to be evaluated, and process tasks while waiting.
-    left_.wait();
-    right_.wait();
+    // Wait for child tensors to be evaluated, and process tasks while waiting
+    // (deferred in a LazyEvalScope).
+    LazyEvalScope::wait(left_);
+    LazyEvalScope::wait(right_);
 
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_EVAL
     printf("eval: finished wait children rank=%i\n",
@@ -21,6 +21,7 @@
 #define TILEDARRAY_DIST_EVAL_DIST_EVAL_BASE_H__INCLUDED
 
 #include <TiledArray/config.h>
+#include <TiledArray/dist_eval/lazy_eval.h>
 #include <TiledArray/perm_index.h>
 #include <TiledArray/permutation.h>
 #include <TiledArray/tensor_impl.h>
@@ -178,6 +179,14 @@ class DistEvalImpl : public TensorImpl<Policy>,
   /// Tile set notification
   virtual void notify() { set_counter_++; }
 
+  /// Test if all tiles have been assigned
+
+  /// \return \c true if all local tiles have been set
+  bool probe() const {
+    const int task_count = task_count_;
+    return task_count >= 0 && set_counter_ == task_count;
+  }
+
   /// Wait for all tiles to be assigned
   void wait() const {
     const int task_count = task_count_;
@@ -370,6 +379,11 @@ class DistEval {
   /// \return The unique id for this object
   madness::uniqueidT id() const { return pimpl_->id(); }
 
+  /// Test if all local tiles have been evaluated
+
+  /// \return \c true if all local tiles have been set
+  bool probe() const { return pimpl_->probe(); }
+
   /// Wait for all local tiles to be evaluated
   void wait() const { pimpl_->wait(); }
 
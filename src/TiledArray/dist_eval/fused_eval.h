@@ -0,0 +1,297 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_FUSED_EVAL_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_FUSED_EVAL_H__INCLUDED
+
+#include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/expressions/fused_kernel.h>
+#include <TiledArray/perm_index.h>
+#include <TiledArray/tensor/kernels.h>
+
+#include <array>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+namespace detail {
+
+/// Statistics of fused expression evaluation
+class FusedEvalStats {
+ public:
+  /// Record the construction of a fused evaluator
+  static void record() { ++evaluators_; }
+
+  /// \return The number of fused evaluators constructed by this process
+  static std::size_t evaluators() { return evaluators_; }
+
+ private:
+  static inline std::atomic<std::size_t> evaluators_{0ul};
+};  // class FusedEvalStats
+
+/// Distributed evaluator for fused element-wise expressions
+
+/// This evaluator computes each result tile of an element-wise expression
+/// in a single pass: one task per tile waits for the tiles of all leaf
+/// arrays and applies the fused element kernel while writing the result,
+/// which is permuted on the fly if needed. Leaves whose index list is a
+/// permutation of that of the expression are read in place: the kernel
+/// walks their tiles with permuted strides. No intermediate tiles or
+/// distributed evaluators are created for the inner nodes of the
+/// expression.
+/// \tparam Array The leaf array type
+/// \tparam Kernel The fused element kernel type
+/// \tparam Policy The evaluator policy type
+template <typename Array, typename Kernel, typename Policy>
+class FusedEvalImpl
+    : public DistEvalImpl<typename Array::value_type, Policy>,
+      public std::enable_shared_from_this<
+          FusedEvalImpl<Array, Kernel, Policy>> {
+ public:
+  typedef FusedEvalImpl<Array, Kernel, Policy>
+      FusedEvalImpl_;  ///< This object type
+  typedef DistEvalImpl<typename Array::value_type, Policy>
+      DistEvalImpl_;  ///< The base class type
+  typedef typename DistEvalImpl_::TensorImpl_
+      TensorImpl_;           ///< The base, base class type
+  typedef Array array_type;  ///< The leaf array type
+  typedef typename DistEvalImpl_::ordinal_type ordinal_type;  ///< Ordinal type
+  typedef typename DistEvalImpl_::range_type range_type;      ///< Range type
+  typedef typename DistEvalImpl_::shape_type shape_type;      ///< Shape type
+  typedef typename DistEvalImpl_::pmap_interface
+      pmap_interface;  ///< Process map interface type
+  typedef
+      typename DistEvalImpl_::trange_type trange_type;    ///< Tiled range type
+  typedef typename DistEvalImpl_::value_type value_type;  ///< Tile type
+  typedef typename value_type::value_type element_type;   ///< Element type
+  typedef expressions::FusedElementOp<Kernel, element_type>
+      op_type;  ///< The element operation type
+
+  static constexpr std::size_t leaves = Kernel::leaves;  ///< Leaf count
+
+  /// Constructor
+
+  /// \param arrays The leaf arrays, in the order of the kernel leaves
+  /// \param leaf_perms The permutations that map the index lists of the
+  /// leaf arrays to that of the expression
+  /// \param kernel The fused element kernel
+  /// \param world The world where the tensor lives
+  /// \param trange The tiled range object
+  /// \param shape The tensor shape object
+  /// \param pmap The tile-process map
+  /// \param perm The permutation that is applied to tile indices
+  /// \param permute_tiles If \c true, \c perm is also applied to the tile
+  /// data
+  FusedEvalImpl(const std::vector<array_type>& arrays,
+                const std::vector<Permutation>& leaf_perms,
+                const Kernel& kernel, World& world, const trange_type& trange,
+                const shape_type& shape,
+                const std::shared_ptr<pmap_interface>& pmap,
+                const Permutation& perm, const bool permute_tiles)
+      : DistEvalImpl_(world, trange, shape, pmap, perm),
+        arrays_(arrays),
+        leaf_perms_(leaf_perms),
+        leaf_indices_(leaves),
+        permuted_leaves_(false),
+        op_{kernel},
+        perm_(permute_tiles ? perm : Permutation()) {
+    TA_ASSERT(arrays_.size() == leaves);
+    TA_ASSERT(leaf_perms_.size() == leaves);
+
+    // Map the tile ordinals of the expression to those of permuted leaves
+    const range_type range =
+        (perm ? -perm * trange.tiles_range() : trange.tiles_range());
+    for (std::size_t k = 0ul; k < leaves; ++k) {
+      if (!leaf_perms_[k]) continue;
+      leaf_indices_[k] = PermIndex(range, -leaf_perms_[k]);
+      permuted_leaves_ = true;
+    }
+
+    FusedEvalStats::record();
+  }
+
+  /// Virtual destructor
+  virtual ~FusedEvalImpl() {}
+
+  /// Get tile at index \c i
+
+  /// \param i The index of the tile
+  /// \return A \c Future to the tile at index i
+  /// \throw TiledArray::Exception When tile \c i is owned by a remote node.
+  /// \throw TiledArray::Exception When tile \c i a zero tile.
+  virtual Future<value_type> get_tile(ordinal_type i) const {
+    TA_ASSERT(TensorImpl_::is_local(i));
+    TA_ASSERT(!TensorImpl_::is_zero(i));
+    const madness::DistributedID key(DistEvalImpl_::id(), i);
+    return TensorImpl_::world().gop.template recv<value_type>(
+        TensorImpl_::owner(i), key);
+  }
+
+  /// Discard a tile that is not needed
+
+  /// This function handles the cleanup for tiles that are not needed in
+  /// subsequent computation.
+  /// \param i The index of the tile
+  virtual void discard_tile(ordinal_type i) const { get_tile(i); }
+
+ private:
+  typedef std::vector<Future<value_type>> tile_list;  ///< Leaf tiles
+
+  /// Evaluate the result tile from the leaf tiles
+
+  /// \param tiles The leaf tiles
+  /// \return The result tile
+  template <std::size_t... Is>
+  value_type eval(const tile_list& tiles, std::index_sequence<Is...>) const {
+    if (permuted_leaves_)
+      return eval_strided(tiles, std::index_sequence<Is...>());
+
+    const range_type& range = tiles.front().get().range();
+    if (perm_) {
+      value_type result(perm_ * range);
+      TiledArray::detail::tensor_init(op_, perm_, result, tiles[Is].get()...);
+      return result;
+    }
+    value_type result(range);
+    TiledArray::detail::tensor_init(op_, result, tiles[Is].get()...);
+    return result;
+  }
+
+  /// Evaluate the result tile from leaf tiles with different index orders
+
+  /// The elements of the expression tile are visited in row-major order;
+  /// each leaf tile and the result tile are addressed with their strides
+  /// permuted to the index order of the expression.
+  /// \param tiles The leaf tiles
+  /// \return The result tile
+  template <std::size_t... Is>
+  value_type eval_strided(const tile_list& tiles,
+                          std::index_sequence<Is...>) const {
+    typedef typename range_type::index1_type index1_type;
+    typedef std::array<index1_type, leaves + 1ul> offset_type;
+
+    const range_type& range0 = tiles.front().get().range();
+    const range_type range =
+        (leaf_perms_.front() ? leaf_perms_.front() * range0 : range0);
+    value_type result(perm_ ? perm_ * range : range);
+    const unsigned int rank = range.rank();
+
+    // Strides of the leaf tiles (and the result tile, last) for each
+    // dimension of the expression tile
+    std::vector<offset_type> strides(rank);
+    for (std::size_t k = 0ul; k <= leaves; ++k) {
+      const range_type& r =
+          (k < leaves ? tiles[k].get().range() : result.range());
+      const Permutation& p = (k < leaves ? leaf_perms_[k] : perm_);
+      for (unsigned int d = 0u; d < rank; ++d) {
+        if (k < leaves)
+          strides[p ? p[d] : d][k] = r.stride(d);
+        else
+          strides[d][k] = r.stride(p ? p[d] : d);
+      }
+    }
+
+    const std::array<const element_type*, leaves> args{
+        {tiles[Is].get().data()...}};
+    element_type* const MADNESS_RESTRICT data = result.data();
+    const offset_type& inner = strides.back();
+    const index1_type n = range.extent(rank - 1u);
+    const index1_type rows = range.volume() / n;
+
+    std::vector<index1_type> index(rank, 0);
+    offset_type offset{};
+    for (index1_type row = 0; row < rows; ++row) {
+      for (index1_type i = 0; i < n; ++i)
+        data[offset[leaves] + i * inner[leaves]] =
+            op_(args[Is][offset[Is] + i * inner[Is]]...);
+
+      // Advance to the next row of the expression tile
+      for (unsigned int d = rank - 1u; d > 0u;) {
+        --d;
+        for (std::size_t k = 0ul; k <= leaves; ++k) offset[k] += strides[d][k];
+        if (++index[d] < range.extent(d)) break;
+        for (std::size_t k = 0ul; k <= leaves; ++k)
+          offset[k] -= range.extent(d) * strides[d][k];
+        index[d] = 0;
+      }
+    }
+
+    return result;
+  }
+
+  /// Task function that evaluates a result tile
+
+  /// \param i The target tile index
+  /// \param tiles The leaf tiles
+  void eval_tile(const ordinal_type i, const tile_list& tiles) {
+    DistEvalImpl_::set_tile(i, eval(tiles, std::make_index_sequence<leaves>()));
+  }
+
+  /// Evaluate the local tiles of the result
+
+  /// \return The number of tiles that will be set by this process
+  virtual int internal_eval() {
+    std::shared_ptr<FusedEvalImpl_> self =
+        std::enable_shared_from_this<FusedEvalImpl_>::shared_from_this();
+
+    ordinal_type task_count = 0ul;
+    for (const auto index : *TensorImpl_::pmap()) {
+      if (TensorImpl_::is_zero(index)) continue;
+
+      // Collect the leaf tiles; zero tiles of sparse leaves are materialized
+      const auto source_index = DistEvalImpl_::perm_index_to_source(index);
+      tile_list tiles;
+      tiles.reserve(leaves);
+      for (std::size_t k = 0ul; k < leaves; ++k) {
+        const array_type& array = arrays_[k];
+        const auto leaf_index =
+            (leaf_indices_[k] ? leaf_indices_[k](source_index) : source_index);
+        if (array.is_zero(leaf_index))
+          tiles.emplace_back(value_type(
+              array.trange().make_tile_range(leaf_index), element_type(0)));
+        else
+          tiles.emplace_back(array.find(leaf_index));
+      }
+
+      TensorImpl_::world().taskq.add(self, &FusedEvalImpl_::eval_tile, index,
+                                     tiles);
+      ++task_count;
+    }
+
+    // The requested tiles are held by their futures, release the arrays
+    arrays_.clear();
+
+    return task_count;
+  }
+
+  std::vector<array_type> arrays_;  ///< The leaf arrays
+  const std::vector<Permutation>
+      leaf_perms_;  ///< The permutations of the leaf index lists
+  std::vector<PermIndex>
+      leaf_indices_;      ///< Maps expression tile ordinals to leaf ordinals
+  bool permuted_leaves_;  ///< \c true if any leaf is permuted
+  const op_type op_;        ///< The element operation
+  const Permutation perm_;  ///< The permutation of the tile data
+};                          // class FusedEvalImpl
+
+}  // namespace detail
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_DIST_EVAL_FUSED_EVAL_H__INCLUDED
@@ -0,0 +1,163 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_LAZY_EVAL_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_LAZY_EVAL_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <TiledArray/external/madness.h>
+
+#include <functional>
+#include <vector>
+
+namespace TiledArray {
+
+/// Scope of lazy expression evaluation
+
+/// By default an expression assignment returns once all local tiles of the
+/// result have been computed, hence the tasks of consecutive statements do
+/// not overlap. While a LazyEvalScope is alive, an assignment returns as
+/// soon as its tasks have been submitted: the assigned array holds futures
+/// to its tiles and acts as the handle of the computation. Subsequent
+/// statements that read the array consume these futures, so the statements
+/// form a single task graph and the tasks of independent statements, e.g.
+/// the SUMMA iterations of independent contractions, run concurrently on the
+/// task queue. The waits for the evaluators are deferred to the barrier,
+/// fence() or the destruction of the scope.
+/// \code
+/// {
+///   LazyEvalScope lazy;
+///   r1("a,b,i,j") = g("a,b,c,d") * t2("c,d,i,j");  // returns immediately
+///   r2("a,b,i,j") = g("k,l,i,j") * t2("a,b,k,l");  // overlaps with r1
+///   r("a,b,i,j") = r1("a,b,i,j") + r2("a,b,i,j");  // consumes r1 and r2
+/// }  // implicit barrier
+/// \endcode
+/// \note Array tiles must only be accessed via futures (e.g. find()) before
+/// the barrier. Scopes may be nested; the barrier of an inner scope only
+/// waits for the evaluators deferred in that scope. The deferred waits may
+/// also be handed to the caller with release(), which closes the scope
+/// without a barrier.
+class LazyEvalScope {
+ public:
+  /// A deferred wait for a distributed evaluator
+
+  /// The evaluator is kept alive until the wait completes.
+  class Deferred {
+   public:
+    Deferred() = default;
+
+    /// Constructor
+
+    /// \tparam DistEval The distributed evaluator type
+    /// \param dist_eval The distributed evaluator
+    template <typename DistEval>
+    explicit Deferred(const DistEval& dist_eval)
+        : probe_([dist_eval]() { return dist_eval.probe(); }),
+          wait_([dist_eval]() { dist_eval.wait(); }) {}
+
+    /// \return \c true if all local tiles of the evaluator are set
+    bool probe() const { return !probe_ || probe_(); }
+
+    /// Wait for the evaluator, then release it
+    void wait() {
+      if (!wait_) return;
+      wait_();
+      probe_ = nullptr;
+      wait_ = nullptr;
+    }
+
+   private:
+    std::function<bool()> probe_;  ///< Tests the evaluator
+    std::function<void()> wait_;   ///< Waits for the evaluator
+  };  // class Deferred
+
+  /// Constructor
+
+  /// \param world The world of the evaluated arrays, it is fenced by the
+  /// barrier
+  explicit LazyEvalScope(World& world = TiledArray::get_default_world())
+      : world_(world), waits_(), parent_(active_), released_(false) {
+    active_ = this;
+  }
+
+  LazyEvalScope(const LazyEvalScope&) = delete;
+  LazyEvalScope& operator=(const LazyEvalScope&) = delete;
+
+  /// Destructor, an implicit barrier unless the scope was released
+  ~LazyEvalScope() {
+    if (!released_) fence();
+    active_ = parent_;
+  }
+
+  /// Barrier
+
+  /// Waits for the evaluation of all statements of this scope and fences
+  /// \c world. This function must be called collectively.
+  void fence() {
+    // The evaluators are released as they complete
+    for (auto& wait : waits_) wait.wait();
+    waits_.clear();
+    world_.gop.fence();
+  }
+
+  /// Release the deferred waits
+
+  /// The scope is closed without a barrier, hence this function does not
+  /// block and need not be called collectively. The caller takes over the
+  /// deferred waits and must complete them, e.g. before the next fence.
+  /// This must be the last call on the scope.
+  /// \return The deferred waits of this scope
+  std::vector<Deferred> release() {
+    released_ = true;
+    return std::move(waits_);
+  }
+
+  /// \return The number of evaluators whose wait has been deferred
+  std::size_t size() const { return waits_.size(); }
+
+  /// \return The innermost active scope, or \c nullptr
+  static LazyEvalScope* active() { return active_; }
+
+  /// Wait for a distributed evaluator
+
+  /// If a scope is active the wait is deferred to its barrier, which also
+  /// keeps the evaluator alive; otherwise this function blocks, processing
+  /// tasks, until all local tiles of \c dist_eval are set.
+  /// \tparam DistEval The distributed evaluator type
+  /// \param dist_eval The distributed evaluator
+  template <typename DistEval>
+  static void wait(const DistEval& dist_eval) {
+    if (active_)
+      active_->waits_.emplace_back(dist_eval);
+    else
+      dist_eval.wait();
+  }
+
+ private:
+  World& world_;  ///< The world of the evaluated arrays
+  std::vector<Deferred> waits_;  ///< The deferred waits
+  LazyEvalScope* parent_;        ///< The enclosing scope
+  bool released_;                ///< The waits were handed to the caller
+
+  static inline LazyEvalScope* active_ = nullptr;  ///< The innermost scope
+};  // class LazyEvalScope
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_DIST_EVAL_LAZY_EVAL_H__INCLUDED
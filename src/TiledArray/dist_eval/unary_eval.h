@@ -180,8 +180,9 @@ class UnaryEvalImpl
       }
     }
 
-    // Wait for local tiles of argument to be evaluated
-    arg_.wait();
+    // Wait for local tiles of argument to be evaluated (deferred in a
+    // LazyEvalScope)
+    LazyEvalScope::wait(arg_);
 
     return task_count;
   }
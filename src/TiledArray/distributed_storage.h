@@ -20,7 +20,15 @@
 #ifndef TILEDARRAY_DISTRIBUTED_STORAGE_H__INCLUDED
 #define TILEDARRAY_DISTRIBUTED_STORAGE_H__INCLUDED
 
+#include <TiledArray/message_aggregation.h>
 #include <TiledArray/pmap/pmap.h>
+#include <TiledArray/remote_tile_cache.h>
+#include <madness/world/buffer_archive.h>
+
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace TiledArray {
 namespace detail {
@@ -67,6 +75,27 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
   mutable container_type data_;     ///< The local data container
   madness::AtomicInt num_live_ds_;  ///< Number of live DelayedSet objects
 
+  typedef std::vector<std::pair<size_type, value_type> >
+      set_list;  ///< Aggregated set requests
+  typedef std::vector<std::pair<size_type, typename future::remote_refT> >
+      get_list;  ///< Aggregated get requests
+
+  /// Buffer of the requests sent to one process
+  struct Batch : public madness::Spinlock {
+    set_list sets;  ///< The buffered set requests
+    get_list gets;  ///< The buffered get requests
+    std::size_t bytes = 0ul;  ///< The size of the buffered tile data
+    std::chrono::steady_clock::time_point first;  ///< Oldest request time
+    bool flush_pending = false;  ///< A flush task has been submitted
+
+    std::size_t size() const { return sets.size() + gets.size(); }
+  };  // struct Batch
+
+  /// The request buffers, one per process; \c nullptr if aggregation was
+  /// disabled when this object was constructed
+  std::unique_ptr<Batch[]> batches_;
+  madness::AtomicInt num_pending_flushes_;  ///< Number of flush tasks
+
   // not allowed
   DistributedStorage(const DistributedStorage_&);
   DistributedStorage_& operator=(const DistributedStorage_&);
@@ -88,10 +117,121 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
   }
 
   void set_remote(const size_type i, const value_type& value) {
+    if (batches_) {
+      madness::archive::BufferOutputArchive count_ar;
+      count_ar& value;
+      aggregate(owner(i), count_ar.size(),
+                [&](Batch& batch) { batch.sets.emplace_back(i, value); });
+      return;
+    }
     WorldObject_::task(owner(i), &DistributedStorage_::set_handler, i, value,
                        madness::TaskAttributes::hipri());
   }
 
+  /// Request element \c i from its owner
+
+  /// \param i The element to get
+  /// \return A future to element \c i
+  future fetch_remote(const size_type i) const {
+    future result;
+    if (batches_) {
+      auto ref = result.remote_ref(get_world());
+      const_cast<DistributedStorage_*>(this)->aggregate(
+          owner(i), sizeof(ref),
+          [&](Batch& batch) { batch.gets.emplace_back(i, ref); });
+      return result;
+    }
+    WorldObject_::task(owner(i), &DistributedStorage_::get_handler, i,
+                       result.remote_ref(get_world()),
+                       madness::TaskAttributes::hipri());
+    return result;
+  }
+
+  /// Handle an aggregated message
+
+  /// \param sets The set requests
+  /// \param gets The get requests
+  void batch_handler(const set_list& sets, const get_list& gets) {
+    for (const auto& request : sets) set_handler(request.first, request.second);
+    for (const auto& request : gets) get_handler(request.first, request.second);
+  }
+
+  /// Buffer a request
+
+  /// The buffer of \c dest is sent if it is full or its oldest request is
+  /// too old; otherwise, a flush task is submitted if there is none yet.
+  /// \tparam Push The type of the function that buffers the request
+  /// \param dest The destination process
+  /// \param bytes The size of the request
+  /// \param push The function that adds the request to a batch
+  template <typename Push>
+  void aggregate(const ProcessID dest, const std::size_t bytes, Push&& push) {
+    Batch& batch = batches_[dest];
+    const auto now = std::chrono::steady_clock::now();
+    set_list sets;
+    get_list gets;
+    bool submit_flush = false;
+    {
+      madness::ScopedMutex<madness::Spinlock> locker(&batch);
+      if (batch.size() == 0ul) batch.first = now;
+      push(batch);
+      batch.bytes += bytes;
+      if (batch.size() >= MessageAggregation::max_count() ||
+          batch.bytes >= MessageAggregation::max_bytes() ||
+          now - batch.first >= MessageAggregation::max_delay()) {
+        take(batch, sets, gets);
+      } else if (!batch.flush_pending) {
+        batch.flush_pending = true;
+        submit_flush = true;
+      }
+    }
+
+    if (submit_flush) {
+      ++num_pending_flushes_;
+      WorldObject_::task(get_world().rank(), &DistributedStorage_::flush,
+                         dest);
+    }
+    send(dest, sets, gets);
+  }
+
+  /// Send the buffered requests of a process
+
+  /// \param dest The destination process
+  void flush(const ProcessID dest) {
+    Batch& batch = batches_[dest];
+    set_list sets;
+    get_list gets;
+    {
+      madness::ScopedMutex<madness::Spinlock> locker(&batch);
+      batch.flush_pending = false;
+      take(batch, sets, gets);
+    }
+    send(dest, sets, gets);
+    --num_pending_flushes_;
+  }
+
+  /// Move the requests out of a batch
+
+  /// \note Assumes \c batch is locked
+  static void take(Batch& batch, set_list& sets, get_list& gets) {
+    std::swap(batch.sets, sets);
+    std::swap(batch.gets, gets);
+    batch.bytes = 0ul;
+  }
+
+  /// Send requests to a process as one message
+
+  /// \param dest The destination process
+  /// \param sets The set requests
+  /// \param gets The get requests
+  void send(const ProcessID dest, const set_list& sets, const get_list& gets) {
+    const std::size_t count = sets.size() + gets.size();
+    if (count == 0ul) return;
+    MessageAggregation::record(count);
+    WorldObject_::task(dest, &DistributedStorage_::batch_handler, sets, gets,
+                       madness::TaskAttributes::hipri());
+  }
+
   struct DelayedSet : public madness::CallbackInterface {
    private:
     DistributedStorage_& ds_;  ///< A reference to the owning object
@@ -121,6 +261,8 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
   /// world.  In order to avoid synchronization when making a container, we
   /// have to assume that all processes execute this constructor in the same
   /// order (does not apply to the non-initializing, default constructor).
+  /// Remote requests are aggregated if MessageAggregation is enabled when the
+  /// container is constructed.
   /// \param world The world where the distributed container lives
   /// \param max_size The maximum capacity of this container
   /// \param pmap The process map for the container (default = null pointer)
@@ -129,24 +271,30 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
       : WorldObject_(world),
         max_size_(max_size),
         pmap_(pmap),
-        data_((max_size / world.size()) + 11) {
+        data_((max_size / world.size()) + 11),
+        batches_(MessageAggregation::enabled() && world.size() > 1
+                     ? new Batch[world.size()]
+                     : nullptr) {
     // Check that the process map is appropriate for this storage object
     TA_ASSERT(pmap_);
     TA_ASSERT(pmap_->size() == max_size);
     TA_ASSERT(pmap_->rank() == pmap_interface::size_type(world.rank()));
     TA_ASSERT(pmap_->procs() == pmap_interface::size_type(world.size()));
     num_live_ds_ = 0;
+    num_pending_flushes_ = 0;
     WorldObject_::process_pending();
   }
 
   virtual ~DistributedStorage() {
-    if (num_live_ds_ != 0) {
+    if (num_live_ds_ != 0 || num_pending_flushes_ != 0) {
       madness::print_error(
           "DistributedStorage (object id=\", id(), \") destroyed while "
           "outstanding tasks exist. Add a fence() to extend the lifetime of "
           "this object.");
       abort();
     }
+    RemoteTileCache& cache = RemoteTileCache::instance();
+    if (cache.enabled()) cache.erase(WorldObject_::id());
   }
 
   using WorldObject_::get_world;
@@ -195,22 +343,26 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
 
   /// Get local or remote element
 
+  /// Remote elements are served by the RemoteTileCache when it is enabled.
   /// \param i The element to get
+  /// \param expected_bytes The expected size of a remote element, which the
+  /// cache reserves while the element is in flight
   /// \return A future to element \c i
   /// \throw TiledArray::Exception If \c i is greater than or equal to \c
   /// max_size() .
-  future get(size_type i) const {
+  future get(size_type i, const std::size_t expected_bytes = 0ul) const {
     TA_ASSERT(i < max_size_);
     if (is_local(i)) {
       return get_local(i);
     } else {
-      // Send a request to the owner of i for the element.
-      future result;
-      WorldObject_::task(owner(i), &DistributedStorage_::get_handler, i,
-                         result.remote_ref(get_world()),
-                         madness::TaskAttributes::hipri());
+      RemoteTileCache& cache = RemoteTileCache::instance();
+      if (cache.enabled())
+        return cache.find_or_fetch<value_type>(
+            get_world(), WorldObject_::id(), i, expected_bytes,
+            [this, i]() { return fetch_remote(i); });
 
-      return result;
+      // Send a request to the owner of i for the element.
+      return fetch_remote(i);
     }
   }
 
@@ -161,6 +161,10 @@ class AddEngine : public BinaryEngine<AddEngine<Left, Right, Result>> {
       typename EngineTrait<AddEngine_>::shape_type shape_type;  ///< Shape type
   typedef typename EngineTrait<AddEngine_>::pmap_interface
       pmap_interface;  ///< Process map interface type
+  typedef detail::fused_array_t<value_type,
+                                typename left_type::fused_array_type,
+                                typename right_type::fused_array_type>
+      fused_array_type;  ///< Leaf array type of fused expressions
 
   /// Constructor
 
@@ -201,6 +205,15 @@ class AddEngine : public BinaryEngine<AddEngine<Left, Right, Result>> {
     return op_type(op_base_type(), perm);
   }
 
+  /// Fused element kernel factory function
+
+  /// \return The element kernel of this expression
+  auto fused_kernel() const {
+    return make_fused_binary<std::plus<>>(
+        BinaryEngine_::left_.fused_kernel(),
+        BinaryEngine_::right_.fused_kernel());
+  }
+
   /// Expression identification tag
 
   /// \return An expression tag used to identify this expression
@@ -255,6 +268,10 @@ class ScalAddEngine
       shape_type;  ///< Shape type
   typedef typename EngineTrait<ScalAddEngine_>::pmap_interface
       pmap_interface;  ///< Process map interface type
+  typedef detail::fused_array_t<value_type,
+                                typename left_type::fused_array_type,
+                                typename right_type::fused_array_type>
+      fused_array_type;  ///< Leaf array type of fused expressions
 
  private:
   scalar_type factor_;  ///< Scaling factor
@@ -302,6 +319,16 @@ class ScalAddEngine
     return op_type(op_base_type(factor_), perm);
   }
 
+  /// Fused element kernel factory function
+
+  /// \return The element kernel of this expression
+  auto fused_kernel() const {
+    const auto kernel = make_fused_binary<std::plus<>>(
+        BinaryEngine_::left_.fused_kernel(),
+        BinaryEngine_::right_.fused_kernel());
+    return make_fused_scal(kernel, factor_);
+  }
+
   /// Scaling factor accessor
 
   /// \return The scaling factor
@@ -316,6 +343,15 @@ class ScalAddEngine
     return ss.str();
   }
 
+  /// Expression tag used for structural hashing
+
+  /// \return The expression tag with the exact scaling factor
+  std::string structural_tag() const {
+    std::stringstream ss;
+    ss << make_tag() << std::hexfloat << factor_;
+    return ss.str();
+  }
+
 };  // class ScalAddEngine
 
 }  // namespace expressions
@@ -95,34 +95,39 @@ class BinaryEngine : public ExprEngine<Derived> {
       PermutationType::general;  ///< Left-hand permutation type
   PermutationType right_inner_permtype_ =
       PermutationType::general;  ///< Right-hand permutation type
+  std::shared_ptr<const CostBasedPermutationOptimizer>
+      permutation_plan_;  ///< The plan of the outer permutations
 
   template <TensorProduct ProductType>
   void init_indices_(const BipartiteIndexList& target_indices = {}) {
     static_assert(ProductType == TensorProduct::Contraction ||
                   ProductType == TensorProduct::Hadamard);
     // prefer to permute the arg with fewest leaves to try to minimize the
-    // number of possible permutations
-    using permopt_type =
-        std::conditional_t<ProductType == TensorProduct::Contraction,
-                           GEMMPermutationOptimizer,
-                           HadamardPermutationOptimizer>;
-
-    std::shared_ptr<BinaryOpPermutationOptimizer> outer_opt, inner_opt;
+    // number of possible permutations; the outer permutations are chosen by
+    // comparing the volumes of the data that the candidate plans permute
+    const bool prefer_to_permute_left = left_type::leaves <= right_type::leaves;
+    const auto left_volume = left_.volume_estimate();
+    const auto right_volume = right_.volume_estimate();
+    const auto result_volume = ExprEngine_::derived().volume_estimate();
+
+    std::shared_ptr<BinaryOpPermutationOptimizer> inner_opt;
     if (!target_indices) {
-      outer_opt = std::make_shared<permopt_type>(
-          outer(left_.indices()), outer(right_.indices()),
-          left_type::leaves <= right_type::leaves);
-      inner_opt = make_permutation_optimizer(
-          inner(left_.indices()), inner(right_.indices()),
-          left_type::leaves <= right_type::leaves);
+      permutation_plan_ = std::make_shared<CostBasedPermutationOptimizer>(
+          ProductType, outer(left_.indices()), outer(right_.indices()),
+          left_volume, right_volume, result_volume, prefer_to_permute_left);
+      inner_opt = make_permutation_optimizer(inner(left_.indices()),
+                                             inner(right_.indices()),
+                                             prefer_to_permute_left);
     } else {
-      outer_opt = std::make_shared<permopt_type>(
-          outer(target_indices), outer(left_.indices()),
-          outer(right_.indices()), left_type::leaves <= right_type::leaves);
+      permutation_plan_ = std::make_shared<CostBasedPermutationOptimizer>(
+          ProductType, outer(target_indices), outer(left_.indices()),
+          outer(right_.indices()), left_volume, right_volume, result_volume,
+          prefer_to_permute_left);
       inner_opt = make_permutation_optimizer(
           inner(target_indices), inner(left_.indices()),
-          inner(right_.indices()), left_type::leaves <= right_type::leaves);
+          inner(right_.indices()), prefer_to_permute_left);
     }
+    const auto& outer_opt = permutation_plan_;
 
     left_indices_ = BipartiteIndexList(outer_opt->target_left_indices(),
                                        inner_opt->target_left_indices());
@@ -278,6 +283,46 @@ class BinaryEngine : public ExprEngine<Derived> {
     return perm * left_.trange();
   }
 
+  /// Size estimate of the result
+
+  /// \return The estimated size of the result, computed from the estimates
+  /// of the arguments
+  VolumeEstimate volume_estimate() const {
+    return VolumeEstimate::elementwise(left_.volume_estimate(),
+                                       right_.volume_estimate(), false);
+  }
+
+  /// Permutation plan accessor
+
+  /// \return The plan of the outer permutations of the arguments, or a null
+  /// pointer if the index lists have not been initialized
+  const std::shared_ptr<const CostBasedPermutationOptimizer>&
+  permutation_plan() const {
+    return permutation_plan_;
+  }
+
+  /// Fusion check
+
+  /// \param root \c true if this engine is the root of the fused expression,
+  /// whose evaluator may permute the result
+  /// \return \c true if this expression can be evaluated by a fused kernel
+  bool fusable(const bool root) const {
+    return !ExprEngine_::override_ptr_ && (root || !perm_) &&
+           left_.fusable(false) && right_.fusable(false);
+  }
+
+  /// Append the leaf arrays of this expression to those of a fused expression
+
+  /// \param arrays The leaf arrays
+  /// \param perms The permutations that map the index lists of the leaf
+  /// arrays to that of the fused expression
+  template <typename A>
+  void fused_arrays(std::vector<A>& arrays,
+                    std::vector<Permutation>& perms) const {
+    left_.fused_arrays(arrays, perms);
+    right_.fused_arrays(arrays, perms);
+  }
+
   /// Construct the distributed evaluator for this expression
 
   /// \return The distributed evaluator that will evaluate this expression
@@ -288,8 +333,10 @@ class BinaryEngine : public ExprEngine<Derived> {
         impl_type;
 
     // Construct left and right distributed evaluators
-    const typename left_type::dist_eval_type left = left_.make_dist_eval();
-    const typename right_type::dist_eval_type right = right_.make_dist_eval();
+    const typename left_type::dist_eval_type left =
+        left_.make_cse_dist_eval();
+    const typename right_type::dist_eval_type right =
+        right_.make_cse_dist_eval();
 
     // Construct the distributed evaluator type
     std::shared_ptr<impl_type> pimpl =
@@ -299,6 +346,27 @@ class BinaryEngine : public ExprEngine<Derived> {
     return dist_eval_type(pimpl);
   }
 
+  /// Structural key of this expression
+
+  /// \return The key of the engine tree rooted at this node
+  std::string structural_key() const {
+    return ExprEngine_::structural_key() + "(" + left_.structural_key() +
+           "," + right_.structural_key() + ")";
+  }
+
+  /// Count the consumers of this expression and of its subexpressions
+
+  /// The subexpressions of a shared expression are counted once, since the
+  /// shared expression is evaluated once.
+  /// \param dag The DAG that is analyzed
+  void count_subexpressions(ExprDAG& dag) const {
+    if (ExprEngine_::override_ptr_ ||
+        dag.count(ExprEngine_::derived().structural_key())) {
+      left_.count_subexpressions(dag);
+      right_.count_subexpressions(dag);
+    }
+  }
+
   /// Expression print
 
   /// \param os The output stream
@@ -306,6 +374,7 @@ class BinaryEngine : public ExprEngine<Derived> {
   void print(ExprOStream os, const BipartiteIndexList& target_indices) const {
     ExprEngine_::print(os, target_indices);
     os.inc();
+    if (permutation_plan_) os << *permutation_plan_ << "\n";
     left_.print(os, indices_);
     right_.print(os, indices_);
     os.dec();
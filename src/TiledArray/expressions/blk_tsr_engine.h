@@ -169,19 +169,99 @@ class BlkTsrEngineBase : public LeafEngine<Derived> {
       lower_bound_;  ///< Lower bound of the tile block
   container::svector<std::size_t>
       upper_bound_;  ///< Upper bound of the tile block
+  std::vector<long> element_lower_bound_;  ///< Lower bound of the elements,
+                                           ///< empty if tile-aligned
+  std::vector<long> element_upper_bound_;  ///< Upper bound of the elements,
+                                           ///< empty if tile-aligned
+
+  /// Lower element bound of the block
+
+  /// \param d The dimension of the array
+  /// \return The first element of the block in dimension \c d
+  long block_base(const unsigned int d) const {
+    return (element_lower_bound_.empty()
+                ? long(array_.trange().dim(d).tile(lower_bound_[d]).first)
+                : element_lower_bound_[d]);
+  }
+
+  /// Shifted tiling of the block
+
+  /// The tiles on the boundary of a block that is not aligned with the tile
+  /// boundaries are cut to the element bounds of the block.
+  /// \param d The dimension of the array
+  /// \return The tiling of the block in dimension \c d , shifted to zero
+  TiledRange1 make_trange1(const unsigned int d) const {
+    const auto& trange1 = array_.trange().dim(d);
+    const long base_d = block_base(d);
+    const long upper_d =
+        (element_upper_bound_.empty()
+             ? long(trange1.tile(upper_bound_[d] - 1ul).second)
+             : element_upper_bound_[d]);
+
+    std::vector<std::size_t> trange1_data;
+    trange1_data.reserve(upper_bound_[d] - lower_bound_[d] + 1ul);
+    trange1_data.emplace_back(0ul);
+    for (auto i = lower_bound_[d]; i < upper_bound_[d]; ++i)
+      trange1_data.emplace_back(
+          std::min(long(trange1.tile(i).second), upper_d) - base_d);
+
+    return TiledRange1(trange1_data.begin(), trange1_data.end());
+  }
+
+  /// \return The element bounds of the tile operation
+  TiledArray::detail::ElementBounds element_bounds() const {
+    if (element_lower_bound_.empty())
+      return TiledArray::detail::ElementBounds();
+    return TiledArray::detail::ElementBounds(element_lower_bound_,
+                                             element_upper_bound_);
+  }
+
+  /// Shape factory function for blocks that are not aligned with the tiles
+
+  /// The norm of a tile on the boundary of the block is bounded by the norm
+  /// of the array tile that contains it, hence a tile of the block is zero
+  /// if and only if the corresponding array tile is zero.
+  /// \param perm The permutation to be applied to the block
+  /// \return The result shape
+  template <typename... Perm>
+  shape_type make_element_block_shape(const Perm&... perm) const {
+    typedef typename shape_type::value_type norm_type;
+    const auto& trange = array_.trange();
+    const BlockRange block_range(trange.tiles_range(), lower_bound_,
+                                 upper_bound_);
+
+    // Collect the (unscaled) norms of the array tiles in the block
+    std::vector<std::size_t> extent(upper_bound_.size());
+    for (unsigned int d = 0u; d < extent.size(); ++d)
+      extent[d] = upper_bound_[d] - lower_bound_[d];
+    Tensor<norm_type> tile_norms{Range(extent)};
+    std::size_t i = 0ul;
+    for (const auto& index : block_range)
+      tile_norms[i++] = array_.shape()[index] *
+                        norm_type(trange.make_tile_range(index).volume());
+
+    if constexpr (sizeof...(Perm) > 0ul)
+      return shape_type(tile_norms.permute(perm...), trange_);
+    else
+      return shape_type(tile_norms, trange_);
+  }
 
  public:
   template <typename Array, bool Alias>
   BlkTsrEngineBase(const BlkTsrExpr<Array, Alias>& expr)
       : LeafEngine_(expr),
         lower_bound_(expr.lower_bound()),
-        upper_bound_(expr.upper_bound()) {}
+        upper_bound_(expr.upper_bound()),
+        element_lower_bound_(expr.element_lower_bound()),
+        element_upper_bound_(expr.element_upper_bound()) {}
 
   template <typename Array, typename Scalar>
   BlkTsrEngineBase(const ScalBlkTsrExpr<Array, Scalar>& expr)
       : LeafEngine_(expr),
         lower_bound_(expr.lower_bound()),
-        upper_bound_(expr.upper_bound()) {}
+        upper_bound_(expr.upper_bound()),
+        element_lower_bound_(expr.element_lower_bound()),
+        element_upper_bound_(expr.element_upper_bound()) {}
 
   /// Non-permuting tiled range factory function
 
@@ -191,29 +271,8 @@ class BlkTsrEngineBase : public LeafEngine<Derived> {
 
     std::vector<TiledRange1> trange_data;
     trange_data.reserve(rank);
-    std::vector<std::size_t> trange1_data;
-
-    // Get temporary data pointers
-    const auto* MADNESS_RESTRICT const trange = array_.trange().data().data();
-    const auto* MADNESS_RESTRICT const lower = lower_bound_.data();
-    const auto* MADNESS_RESTRICT const upper = upper_bound_.data();
-
-    for (unsigned int d = 0u; d < rank; ++d) {
-      // Copy the tiling for the block
-      const auto lower_d = lower[d];
-      const auto upper_d = upper[d];
-
-      // Copy and shift the tiling for the block
-      auto i = lower_d;
-      const auto base_d = trange[d].tile(i).first;
-      trange1_data.emplace_back(0ul);
-      for (; i < upper_d; ++i)
-        trange1_data.emplace_back(trange[d].tile(i).second - base_d);
-
-      // Add the trange1 to the tiled range data
-      trange_data.emplace_back(trange1_data.begin(), trange1_data.end());
-      trange1_data.resize(0ul);
-    }
+    for (unsigned int d = 0u; d < rank; ++d)
+      trange_data.emplace_back(make_trange1(d));
 
     return TiledRange(trange_data.begin(), trange_data.end());
   }
@@ -226,33 +285,11 @@ class BlkTsrEngineBase : public LeafEngine<Derived> {
 
     std::vector<TiledRange1> trange_data;
     trange_data.reserve(rank);
-    std::vector<std::size_t> trange1_data;
-
-    // Get temporary data pointers
-    const auto* MADNESS_RESTRICT const trange = array_.trange().data().data();
-    const auto* MADNESS_RESTRICT const lower = lower_bound_.data();
-    const auto* MADNESS_RESTRICT const upper = upper_bound_.data();
 
     // Construct the inverse permutation
     const auto inv_perm = -perm;
-    for (unsigned int d = 0u; d < rank; ++d) {
-      const auto inv_perm_d = inv_perm[d];
-
-      // Copy the tiling for the block
-      const auto lower_i = lower[inv_perm_d];
-      const auto upper_i = upper[inv_perm_d];
-
-      // Copy, shift, and permute the tiling of the block
-      auto i = lower_i;
-      const auto base_d = trange[inv_perm_d].tile(i).first;
-      trange1_data.emplace_back(0ul);
-      for (; i < upper_i; ++i)
-        trange1_data.emplace_back(trange[inv_perm_d].tile(i).second - base_d);
-
-      // Add the trange1 to the tiled range data
-      trange_data.emplace_back(trange1_data.begin(), trange1_data.end());
-      trange1_data.resize(0ul);
-    }
+    for (unsigned int d = 0u; d < rank; ++d)
+      trange_data.emplace_back(make_trange1(inv_perm[d]));
 
     return TiledRange(trange_data.begin(), trange_data.end());
   }
@@ -288,6 +325,12 @@ class BlkTsrEngineBase : public LeafEngine<Derived> {
     TiledArray::detail::print_array(ss, lower_bound_);
     ss << " - ";
     TiledArray::detail::print_array(ss, upper_bound_);
+    if (!element_lower_bound_.empty()) {
+      ss << " elements ";
+      TiledArray::detail::print_array(ss, element_lower_bound_);
+      ss << " - ";
+      TiledArray::detail::print_array(ss, element_upper_bound_);
+    }
     ss << "] ";
     return ss.str();
   }
@@ -342,6 +385,7 @@ class BlkTsrEngine
 
  protected:
   // Import base class variables to this scope
+  using BlkTsrEngineBase_::element_lower_bound_;
   using BlkTsrEngineBase_::lower_bound_;
   using BlkTsrEngineBase_::upper_bound_;
   using ExprEngine_::indices_;
@@ -361,6 +405,10 @@ class BlkTsrEngine
 
   /// \return The result shape
   shape_type make_shape() {
+    if constexpr (!is_dense_v<shape_type>) {
+      if (!element_lower_bound_.empty())
+        return BlkTsrEngineBase_::make_element_block_shape();
+    }
     return array_.shape().block(lower_bound_, upper_bound_);
   }
 
@@ -369,6 +417,10 @@ class BlkTsrEngine
   /// \param perm The permutation to be applied to the array
   /// \return The result shape
   shape_type make_shape(const Permutation& perm) {
+    if constexpr (!is_dense_v<shape_type>) {
+      if (!element_lower_bound_.empty())
+        return BlkTsrEngineBase_::make_element_block_shape(perm);
+    }
     return array_.shape().block(lower_bound_, upper_bound_, perm);
   }
 
@@ -382,18 +434,12 @@ class BlkTsrEngine
     std::vector<long> range_shift;
     range_shift.reserve(rank);
 
-    // Get temporary data pointers
-    const auto* MADNESS_RESTRICT const trange = array_.trange().data().data();
-    const auto* MADNESS_RESTRICT const lower = lower_bound_.data();
-
     // Initialize the range shift vector
-    for (unsigned int d = 0u; d < rank; ++d) {
-      const auto lower_d = lower[d];
-      const auto base_d = trange[d].tile(lower_d).first;
-      range_shift.emplace_back(-base_d);
-    }
+    for (unsigned int d = 0u; d < rank; ++d)
+      range_shift.emplace_back(-BlkTsrEngineBase_::block_base(d));
 
-    return op_type(op_base_type(range_shift));
+    return op_type(
+        op_base_type(range_shift, BlkTsrEngineBase_::element_bounds()));
   }
 
   /// Permuting tile operation factory function
@@ -408,21 +454,15 @@ class BlkTsrEngine
     // Construct and allocate memory for the shift range
     std::vector<long> range_shift(rank, 0l);
 
-    // Get temporary data pointers
-    const auto* MADNESS_RESTRICT const trange = array_.trange().data().data();
-    const auto* MADNESS_RESTRICT const lower = lower_bound_.data();
-
     // Initialize the permuted range shift vector
     auto outer_perm = outer(perm);
     TA_ASSERT(outer_perm.size() == rank);
-    for (unsigned int d = 0u; d < rank; ++d) {
-      const auto perm_d = outer_perm[d];
-      const auto lower_d = lower[d];
-      const auto base_d = trange[d].tile(lower_d).first;
-      range_shift[perm_d] = -base_d;
-    }
+    for (unsigned int d = 0u; d < rank; ++d)
+      range_shift[outer_perm[d]] = -BlkTsrEngineBase_::block_base(d);
 
-    return op_type(op_base_type(range_shift), perm);
+    return op_type(
+        op_base_type(range_shift, BlkTsrEngineBase_::element_bounds()),
+        perm);
   }
 
   /// Expression identification tag
@@ -485,6 +525,7 @@ class ScalBlkTsrEngine
 
  protected:
   // Import base class variables to this scope
+  using BlkTsrEngineBase_::element_lower_bound_;
   using BlkTsrEngineBase_::lower_bound_;
   using BlkTsrEngineBase_::upper_bound_;
   using ExprEngine_::indices_;
@@ -507,6 +548,10 @@ class ScalBlkTsrEngine
 
   /// \return The result shape
   shape_type make_shape() {
+    if constexpr (!is_dense_v<shape_type>) {
+      if (!element_lower_bound_.empty())
+        return BlkTsrEngineBase_::make_element_block_shape().scale(factor_);
+    }
     return array_.shape().block(lower_bound_, upper_bound_, factor_);
   }
 
@@ -515,6 +560,10 @@ class ScalBlkTsrEngine
   /// \param perm The permutation to be applied to the array
   /// \return The result shape
   shape_type make_shape(const Permutation& perm) {
+    if constexpr (!is_dense_v<shape_type>) {
+      if (!element_lower_bound_.empty())
+        return BlkTsrEngineBase_::make_element_block_shape(perm).scale(factor_);
+    }
     return array_.shape().block(lower_bound_, upper_bound_, factor_, perm);
   }
 
@@ -528,18 +577,12 @@ class ScalBlkTsrEngine
     std::vector<long> range_shift;
     range_shift.reserve(rank);
 
-    // Get temporary data pointers
-    const auto* MADNESS_RESTRICT const trange = array_.trange().data().data();
-    const auto* MADNESS_RESTRICT const lower = lower_bound_.data();
-
-    // Construct the inverse permutation
-    for (unsigned int d = 0u; d < rank; ++d) {
-      const auto lower_d = lower[d];
-      const auto base_d = trange[d].tile(lower_d).first;
-      range_shift.emplace_back(-base_d);
-    }
+    // Initialize the range shift vector
+    for (unsigned int d = 0u; d < rank; ++d)
+      range_shift.emplace_back(-BlkTsrEngineBase_::block_base(d));
 
-    return op_type(op_base_type(range_shift, factor_));
+    return op_type(op_base_type(range_shift, factor_,
+                                 BlkTsrEngineBase_::element_bounds()));
   }
 
   /// Permuting tile operation factory function
@@ -554,21 +597,15 @@ class ScalBlkTsrEngine
     // Construct and allocate memory for the shift range
     std::vector<long> range_shift(rank, 0l);
 
-    // Get temporary data pointers
-    const auto* MADNESS_RESTRICT const trange = array_.trange().data().data();
-    const auto* MADNESS_RESTRICT const lower = lower_bound_.data();
-
     // Initialize the permuted range shift vector
     auto outer_perm = outer(perm);
     TA_ASSERT(outer_perm.size() == rank);
-    for (unsigned int d = 0u; d < rank; ++d) {
-      const auto perm_d = outer_perm[d];
-      const auto lower_d = lower[d];
-      const auto base_d = trange[d].tile(lower_d).first;
-      range_shift[perm_d] = -base_d;
-    }
+    for (unsigned int d = 0u; d < rank; ++d)
+      range_shift[outer_perm[d]] = -BlkTsrEngineBase_::block_base(d);
 
-    return op_type(op_base_type(range_shift, factor_), perm);
+    return op_type(op_base_type(range_shift, factor_,
+                                 BlkTsrEngineBase_::element_bounds()),
+                   perm);
   }
 
   /// Expression identification tag
@@ -580,6 +617,15 @@ class ScalBlkTsrEngine
     return BlkTsrEngineBase_::make_tag() + ss.str();
   }
 
+  /// Expression tag used for structural hashing
+
+  /// \return The expression tag with the exact scaling factor
+  std::string structural_tag() const {
+    std::stringstream ss;
+    ss << make_tag() << std::hexfloat << factor_;
+    return ss.str();
+  }
+
 };  // class ScalBlkTsrEngine
 
 }  // namespace expressions
@@ -122,6 +122,10 @@ class BlkTsrExprBase : public Expr<Derived> {
       lower_bound_;  ///< Lower bound of the tile block
   container::svector<std::size_t>
       upper_bound_;  ///< Upper bound of the tile block
+  std::vector<long> element_lower_bound_;  ///< Lower bound of the elements,
+                                           ///< empty if tile-aligned
+  std::vector<long> element_upper_bound_;  ///< Upper bound of the elements,
+                                           ///< empty if tile-aligned
 
   void check_valid() const {
     const unsigned int rank = array_.trange().tiles_range().rank();
@@ -278,6 +282,87 @@ class BlkTsrExprBase : public Expr<Derived> {
   /// \return The block upper bound
   const auto& upper_bound() const { return upper_bound_; }
 
+  /// Element lower bound accessor
+
+  /// \return The lower bound of the block elements, or an empty vector if the
+  /// block is aligned with the tile boundaries
+  const std::vector<long>& element_lower_bound() const {
+    return element_lower_bound_;
+  }
+
+  /// Element upper bound accessor
+
+  /// \return The upper bound of the block elements, or an empty vector if the
+  /// block is aligned with the tile boundaries
+  const std::vector<long>& element_upper_bound() const {
+    return element_upper_bound_;
+  }
+
+  /// Restrict the block to a range of elements
+
+  /// The tile bounds of the block are set to the tiles that contain the
+  /// elements in <tt>[lower_bound, upper_bound)</tt>. If the element bounds
+  /// do not coincide with tile boundaries, the tiles on the boundary of the
+  /// block are cut to the element bounds when the expression is evaluated.
+  /// \tparam Index1 An integral range type
+  /// \tparam Index2 An integral range type
+  /// \param lower_bound The lower bound of the block elements
+  /// \param upper_bound The upper bound of the block elements
+  /// \return A reference to this expression
+  template <typename Index1, typename Index2,
+            typename = std::enable_if_t<
+                TiledArray::detail::is_integral_range_v<Index1> &&
+                TiledArray::detail::is_integral_range_v<Index2>>>
+  Derived& set_element_bounds(const Index1& lower_bound,
+                              const Index2& upper_bound) {
+    const auto& trange = array_.trange();
+    const unsigned int rank = trange.rank();
+    std::vector<long> lower(std::begin(lower_bound), std::end(lower_bound));
+    std::vector<long> upper(std::begin(upper_bound), std::end(upper_bound));
+    TA_ASSERT(lower.size() == rank);
+    TA_ASSERT(upper.size() == rank);
+
+    bool aligned = true;
+    lower_bound_.resize(rank);
+    upper_bound_.resize(rank);
+    for (unsigned int d = 0u; d < rank; ++d) {
+      const auto& trange1 = trange.dim(d);
+      TA_ASSERT(lower[d] < upper[d]);
+      TA_ASSERT(lower[d] >= long(trange1.elements_range().first));
+      TA_ASSERT(upper[d] <= long(trange1.elements_range().second));
+      lower_bound_[d] = trange1.element_to_tile(lower[d]);
+      upper_bound_[d] = trange1.element_to_tile(upper[d] - 1) + 1;
+      aligned = aligned &&
+                lower[d] == long(trange1.tile(lower_bound_[d]).first) &&
+                upper[d] == long(trange1.tile(upper_bound_[d] - 1).second);
+    }
+
+    if (aligned) {
+      element_lower_bound_.clear();
+      element_upper_bound_.clear();
+    } else {
+      element_lower_bound_ = std::move(lower);
+      element_upper_bound_ = std::move(upper);
+    }
+    return static_cast<Derived&>(*this);
+  }
+
+  /// Copy the block bounds of another block expression
+
+  /// \tparam D The derived type of \c other
+  /// \param other A block expression of the same array
+  /// \return A reference to this expression
+  template <typename D>
+  Derived& copy_bounds(const BlkTsrExprBase<D>& other) {
+    lower_bound_.assign(std::begin(other.lower_bound()),
+                        std::end(other.lower_bound()));
+    upper_bound_.assign(std::begin(other.upper_bound()),
+                        std::end(other.upper_bound()));
+    element_lower_bound_ = other.element_lower_bound();
+    element_upper_bound_ = other.element_upper_bound();
+    return static_cast<Derived&>(*this);
+  }
+
 };  // class BlkTsrExprBase
 
 /// Block expression
@@ -429,7 +514,8 @@ class BlkTsrExpr : public BlkTsrExprBase<BlkTsrExpr<Array, Alias>> {
   ConjBlkTsrExpr<array_type> conj() const {
     return ConjBlkTsrExpr<array_type>(
         BlkTsrExprBase_::array(), BlkTsrExprBase_::annotation(), conj_op(),
-        BlkTsrExprBase_::lower_bound(), BlkTsrExprBase_::upper_bound());
+        BlkTsrExprBase_::lower_bound(), BlkTsrExprBase_::upper_bound())
+        .copy_bounds(*this);
   }
 
 };  // class BlkTsrExpr
@@ -496,7 +582,8 @@ class BlkTsrExpr<const Array, true>
   ConjBlkTsrExpr<array_type> conj() const {
     return ConjBlkTsrExpr<array_type>(
         BlkTsrExprBase_::array(), BlkTsrExprBase_::annotation(), conj_op(),
-        BlkTsrExprBase_::lower_bound(), BlkTsrExprBase_::upper_bound());
+        BlkTsrExprBase_::lower_bound(), BlkTsrExprBase_::upper_bound())
+        .copy_bounds(*this);
   }
 
 };  // class BlkTsrExpr<const Array>
@@ -588,7 +675,8 @@ inline ScalBlkTsrExpr<typename std::remove_const<Array>::type, Scalar>
 operator*(const BlkTsrExpr<Array, Alias>& expr, const Scalar& factor) {
   return ScalBlkTsrExpr<typename std::remove_const<Array>::type, Scalar>(
       expr.array(), expr.annotation(), factor, expr.lower_bound(),
-      expr.upper_bound());
+      expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Scaled-block expression factor
@@ -606,7 +694,8 @@ inline ScalBlkTsrExpr<typename std::remove_const<Array>::type, Scalar>
 operator*(const Scalar& factor, const BlkTsrExpr<Array, Alias>& expr) {
   return ScalBlkTsrExpr<typename std::remove_const<Array>::type, Scalar>(
       expr.array(), expr.annotation(), factor, expr.lower_bound(),
-      expr.upper_bound());
+      expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Scaled-block expression factor
@@ -624,7 +713,8 @@ inline ScalBlkTsrExpr<Array, mult_t<Scalar1, Scalar2>> operator*(
     const ScalBlkTsrExpr<Array, Scalar1>& expr, const Scalar2& factor) {
   return ScalBlkTsrExpr<Array, mult_t<Scalar1, Scalar2>>(
       expr.array(), expr.annotation(), expr.factor() * factor,
-      expr.lower_bound(), expr.upper_bound());
+      expr.lower_bound(), expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Scaled-block expression factor
@@ -642,7 +732,8 @@ inline ScalBlkTsrExpr<Array, mult_t<Scalar2, Scalar1>> operator*(
     const Scalar1& factor, const ScalBlkTsrExpr<Array, Scalar2>& expr) {
   return ScalBlkTsrExpr<Array, mult_t<Scalar2, Scalar1>>(
       expr.array(), expr.annotation(), expr.factor() * factor,
-      expr.lower_bound(), expr.upper_bound());
+      expr.lower_bound(), expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Negated block expression factor
@@ -658,7 +749,8 @@ operator-(const BlkTsrExpr<Array, true>& expr) {
       typename ExprTrait<BlkTsrExpr<Array, true>>::numeric_type numeric_type;
   return ScalBlkTsrExpr<typename std::remove_const<Array>::type, numeric_type>(
       expr.array(), expr.annotation(), -1, expr.lower_bound(),
-      expr.upper_bound());
+      expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Negated scaled-block expression factor
@@ -672,7 +764,8 @@ inline ScalBlkTsrExpr<Array, Scalar> operator-(
     const ScalBlkTsrExpr<Array, Scalar>& expr) {
   return ScalBlkTsrExpr<Array, Scalar>(expr.array(), expr.annotation(),
                                        -expr.factor(), expr.lower_bound(),
-                                       expr.upper_bound());
+                                       expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Conjugated block tensor expression factory
@@ -686,7 +779,8 @@ inline ConjBlkTsrExpr<typename std::remove_const<Array>::type> conj(
     const BlkTsrExpr<Array, Alias>& expr) {
   return ConjBlkTsrExpr<typename std::remove_const<Array>::type>(
       expr.array(), expr.annotation(), conj_op(), expr.lower_bound(),
-      expr.upper_bound());
+      expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Conjugate-conjugate block tensor expression factory
@@ -697,7 +791,8 @@ inline ConjBlkTsrExpr<typename std::remove_const<Array>::type> conj(
 template <typename Array>
 inline BlkTsrExpr<const Array, true> conj(const ConjBlkTsrExpr<Array>& expr) {
   return BlkTsrExpr<const Array, true>(expr.array(), expr.annotation(),
-                                       expr.lower_bound(), expr.upper_bound());
+                                       expr.lower_bound(), expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Conjugated block tensor expression factor
@@ -712,7 +807,8 @@ inline ScalConjBlkTsrExpr<Array, Scalar> conj(
   return ScalConjBlkTsrExpr<Array, Scalar>(
       expr.array(), expr.annotation(),
       conj_op(TiledArray::detail::conj(expr.factor())), expr.lower_bound(),
-      expr.upper_bound());
+      expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Conjugate-conjugate tensor expression factory
@@ -727,7 +823,8 @@ inline ScalBlkTsrExpr<Array, Scalar> conj(
   return ScalBlkTsrExpr<Array, Scalar>(
       expr.array(), expr.annotation(),
       TiledArray::detail::conj(expr.factor().factor()), expr.lower_bound(),
-      expr.upper_bound());
+      expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Scaled block tensor expression factor
@@ -744,7 +841,8 @@ inline ScalConjBlkTsrExpr<Array, Scalar> operator*(
     const ConjBlkTsrExpr<const Array>& expr, const Scalar& factor) {
   return ScalConjBlkTsrExpr<Array, Scalar>(expr.array(), expr.annotation(),
                                            conj_op(factor), expr.lower_bound(),
-                                           expr.upper_bound());
+                                           expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Scaled block tensor expression factor
@@ -761,7 +859,8 @@ inline ScalConjBlkTsrExpr<Array, Scalar> operator*(
     const Scalar& factor, const ConjBlkTsrExpr<Array>& expr) {
   return ScalConjBlkTsrExpr<Array, Scalar>(expr.array(), expr.annotation(),
                                            conj_op(factor), expr.lower_bound(),
-                                           expr.upper_bound());
+                                           expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Scaled block tensor expression factor
@@ -778,7 +877,8 @@ inline ScalConjBlkTsrExpr<Array, mult_t<Scalar1, Scalar2>> operator*(
     const ScalConjBlkTsrExpr<Array, Scalar1>& expr, const Scalar2& factor) {
   return ScalConjBlkTsrExpr<Array, mult_t<Scalar1, Scalar2>>(
       expr.array(), expr.annotation(), conj_op(expr.factor().factor() * factor),
-      expr.lower_bound(), expr.upper_bound());
+      expr.lower_bound(), expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Scaled-tensor expression factor
@@ -795,7 +895,8 @@ inline ScalConjBlkTsrExpr<Array, mult_t<Scalar2, Scalar1>> operator*(
     const Scalar1& factor, const ScalConjBlkTsrExpr<Array, Scalar2>& expr) {
   return ScalConjBlkTsrExpr<Array, mult_t<Scalar2, Scalar1>>(
       expr.array(), expr.annotation(), conj_op(expr.factor().factor() * factor),
-      expr.lower_bound(), expr.upper_bound());
+      expr.lower_bound(), expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Negated-conjugated-tensor expression factor
@@ -810,7 +911,8 @@ operator-(const ConjBlkTsrExpr<Array>& expr) {
   typedef typename ExprTrait<ConjBlkTsrExpr<Array>>::numeric_type numeric_type;
   return ScalConjBlkTsrExpr<Array, numeric_type>(
       expr.array(), expr.annotation(), conj_op<numeric_type>(-1),
-      expr.lower_bound(), expr.upper_bound());
+      expr.lower_bound(), expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 /// Negated-conjugated-tensor expression factor
@@ -824,7 +926,8 @@ inline ScalConjBlkTsrExpr<Array, Scalar> operator-(
     const ScalConjBlkTsrExpr<Array, Scalar>& expr) {
   return ScalConjBlkTsrExpr<Array, Scalar>(
       expr.array(), expr.annotation(), conj_op(-expr.factor().factor()),
-      expr.lower_bound(), expr.upper_bound());
+      expr.lower_bound(), expr.upper_bound())
+      .copy_bounds(expr);
 }
 
 }  // namespace expressions
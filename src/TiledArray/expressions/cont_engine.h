@@ -34,6 +34,8 @@
 #include <TiledArray/tile_op/contract_reduce.h>
 #include <TiledArray/tile_op/mult.h>
 
+#include <optional>
+
 namespace TiledArray {
 namespace expressions {
 
@@ -41,6 +43,8 @@ namespace expressions {
 template <typename, typename>
 class MultExpr;
 template <typename, typename, typename>
+class MixedMultExpr;
+template <typename, typename, typename>
 class ScalMultExpr;
 
 /// Multiplication expression engine
@@ -116,6 +120,10 @@ class ContEngine : public BinaryEngine<Derived> {
                                   const tile_element_type&)>
       inner_tile_return_op_;  ///< Same as inner_tile_nonreturn_op_ but returns
                               ///< the result
+  std::optional<typename op_type::elem_muladd_kernel_type>
+      elem_muladd_kernel_;  ///< Built-in form of inner_tile_nonreturn_op_,
+                            ///< if it has one; it is passed to the GEMM
+                            ///< kernel of the tiles by type
   TiledArray::detail::ProcGrid
       proc_grid_;    ///< Process grid for the contraction
   size_type K_ = 1;  ///< Inner dimension size
@@ -164,6 +172,16 @@ class ContEngine : public BinaryEngine<Derived> {
 
   /// Constructor
 
+  /// \tparam L The left-hand argument expression type
+  /// \tparam R The right-hand argument expression type
+  /// \tparam T The result tile type
+  /// \param expr The parent expression
+  template <typename L, typename R, typename T>
+  ContEngine(const MixedMultExpr<L, R, T>& expr)
+      : BinaryEngine_(expr), factor_(1) {}
+
+  /// Constructor
+
   /// \tparam L The left-hand argument expression type
   /// \tparam R The right-hand argument expression type
   /// \tparam S The expression scalar type
@@ -183,10 +201,8 @@ class ContEngine : public BinaryEngine<Derived> {
   /// to permute left and right args to order their free indices
   /// the order that \p target_indices requires.
   /// \param target_indices The target index list for this expression
-  /// \warning this does not take into account the ranks of the args to decide
-  /// whether it makes sense to permute them or the result
-  /// \todo take into account the ranks of the args to decide
-  /// whether it makes sense to permute them or the result
+  /// The permutations of the arguments and of the result are chosen by
+  /// comparing their estimated volumes (see CostBasedPermutationOptimizer).
   void perm_indices(const BipartiteIndexList& target_indices) {
     // assert that init_indices has been called
     TA_ASSERT(left_.indices() && right_.indices());
@@ -267,11 +283,8 @@ class ContEngine : public BinaryEngine<Derived> {
                       outer_size(left_indices_), outer_size(right_indices_),
                       (permute_tiles_ ? perm_ : BipartitePermutation{}));
       } else {
-        // factor_ is absorbed into inner_tile_nonreturn_op_
-        op_ = op_type(left_op, right_op, scalar_type(1), outer_size(indices_),
-                      outer_size(left_indices_), outer_size(right_indices_),
-                      (permute_tiles_ ? perm_ : BipartitePermutation{}),
-                      this->inner_tile_nonreturn_op_);
+        op_ = make_nested_op(left_op, right_op,
+                             (permute_tiles_ ? perm_ : BipartitePermutation{}));
       }
       trange_ = ContEngine_::make_trange(outer(perm_));
       shape_ = ContEngine_::make_shape(outer(perm_));
@@ -281,18 +294,35 @@ class ContEngine : public BinaryEngine<Derived> {
         op_ = op_type(left_op, right_op, factor_, outer_size(indices_),
                       outer_size(left_indices_), outer_size(right_indices_));
       } else {
-        // factor_ is absorbed into inner_tile_nonreturn_op_
-        op_ = op_type(left_op, right_op, scalar_type(1), outer_size(indices_),
-                      outer_size(left_indices_), outer_size(right_indices_),
-                      BipartitePermutation{}, this->inner_tile_nonreturn_op_);
+        op_ = make_nested_op(left_op, right_op, BipartitePermutation{});
       }
       trange_ = ContEngine_::make_trange();
       shape_ = ContEngine_::make_shape();
     }
 
-    if (ExprEngine_::override_ptr_ && ExprEngine_::override_ptr_->shape) {
-      shape_ = shape_.mask(*ExprEngine_::override_ptr_->shape);
-    }
+    // N.B. SUMMA only broadcasts the argument tiles that contribute to the
+    // nonzero result tiles, hence with a symmetry override only the unique
+    // result blocks are computed
+    ExprEngine_::override_shape();
+  }
+
+  /// Construct the tile operation of a nested tensor contraction
+
+  /// \param left_op The left-hand BLAS matrix operation
+  /// \param right_op The right-hand BLAS matrix operation
+  /// \param perm The permutation that is applied to the result tiles
+  /// \return The tile operation
+  op_type make_nested_op(const math::blas::Op left_op,
+                         const math::blas::Op right_op,
+                         const BipartitePermutation& perm) const {
+    // factor_ is absorbed into inner_tile_nonreturn_op_
+    if (elem_muladd_kernel_)
+      return op_type(left_op, right_op, scalar_type(1), outer_size(indices_),
+                     outer_size(left_indices_), outer_size(right_indices_),
+                     perm, *elem_muladd_kernel_);
+    return op_type(left_op, right_op, scalar_type(1), outer_size(indices_),
+                   outer_size(left_indices_), outer_size(right_indices_), perm,
+                   this->inner_tile_nonreturn_op_);
   }
 
   /// Initialize result tensor distribution
@@ -342,6 +372,15 @@ class ContEngine : public BinaryEngine<Derived> {
     ExprEngine_::init_distribution(world, pmap);
   }
 
+  /// Size estimate of the result
+
+  /// \return The estimated size of the result, computed from the estimates
+  /// of the arguments
+  VolumeEstimate volume_estimate() const {
+    return VolumeEstimate::contraction(left_.volume_estimate(),
+                                       right_.volume_estimate());
+  }
+
   /// Tiled range factory function
 
   /// \param perm The permutation to be applied to the array
@@ -422,8 +461,8 @@ class ContEngine : public BinaryEngine<Derived> {
                                       op_type, typename Derived::policy>
         impl_type;
 
-    typename left_type::dist_eval_type left = left_.make_dist_eval();
-    typename right_type::dist_eval_type right = right_.make_dist_eval();
+    typename left_type::dist_eval_type left = left_.make_cse_dist_eval();
+    typename right_type::dist_eval_type right = right_.make_cse_dist_eval();
 
     std::shared_ptr<impl_type> pimpl =
         std::make_shared<impl_type>(left, right, *world_, trange_, shape_,
@@ -442,6 +481,15 @@ class ContEngine : public BinaryEngine<Derived> {
     return ss.str();
   }
 
+  /// Expression tag used for structural hashing
+
+  /// \return The expression tag with the exact scaling factor
+  std::string structural_tag() const {
+    std::stringstream ss;
+    ss << this->derived().make_tag() << std::hexfloat << factor_;
+    return ss.str();
+  }
+
   /// Expression print
 
   /// \param os The output stream
@@ -562,6 +610,32 @@ class ContEngine : public BinaryEngine<Derived> {
         }
       } else
         abort();  // unsupported TensorProduct type
+
+      // Without an inner permutation the inner products that occur in a
+      // contraction of the outer tiles are built-in ops, which the GEMM
+      // kernel of the tiles calls directly
+      this->elem_muladd_kernel_.reset();
+      if constexpr (TiledArray::detail::is_numeric_v<scalar_type> &&
+                    TiledArray::detail::is_ta_tensor_v<inner_tile_type>) {
+        using kernel_type = typename op_type::elem_muladd_kernel_type;
+        const bool inner_permuted =
+            this->permute_tiles_ &&
+            inner_target_indices != inner(this->indices_);
+        if (!inner_permuted) {
+          if (inner_prod == TensorProduct::Contraction)
+            this->elem_muladd_kernel_ = kernel_type::contraction(
+                math::GemmHelper(to_cblas_op(this->left_inner_permtype_),
+                                 to_cblas_op(this->right_inner_permtype_),
+                                 inner_size(this->indices_),
+                                 inner_size(this->left_indices_),
+                                 inner_size(this->right_indices_)),
+                this->factor_);
+          else if (this->product_type() == TensorProduct::Contraction)
+            this->elem_muladd_kernel_ = kernel_type::hadamard(this->factor_);
+          if (this->elem_muladd_kernel_)
+            this->inner_tile_nonreturn_op_ = *this->elem_muladd_kernel_;
+        }
+      }
       TA_ASSERT(inner_tile_nonreturn_op_);
       this->inner_tile_return_op_ =
           [inner_tile_nonreturn_op = this->inner_tile_nonreturn_op_](
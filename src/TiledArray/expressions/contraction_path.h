@@ -0,0 +1,481 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_CONTRACTION_PATH_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_CONTRACTION_PATH_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <TiledArray/expressions/mult_expr.h>
+#include <TiledArray/expressions/permopt.h>
+#include <TiledArray/expressions/scal_tsr_expr.h>
+#include <TiledArray/expressions/tsr_expr.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+namespace expressions {
+
+/// Optimizer of the order of the contractions of a multi-operand product
+
+/// A product of several tensors, e.g. <tt>a("i,j") * b("j,k") * c("k,l")</tt>,
+/// is evaluated as a sequence of pairwise contractions; the cost of the
+/// sequence depends strongly on the order of the contractions. This object
+/// finds the order (the contraction path) with the lowest estimated cost, in
+/// the style of opt_einsum. The cost of a contraction is the number of
+/// floating-point operations, estimated from the extents of the indices and
+/// the fraction of nonzero tiles of the operands (see VolumeEstimate).
+/// Products of up to \c max_optimal_operands operands are optimized
+/// exhaustively by dynamic programming over the subsets of the operands;
+/// larger products are optimized greedily, by contracting the cheapest pair
+/// of operands first.
+///
+/// Each contraction must be a pure contraction: the indices shared by its
+/// operands must not appear in the result or in the other operands. Outer
+/// products are not considered.
+class ContractionPathOptimizer {
+ public:
+  /// A step of the path: the positions of the left and right operands in the
+  /// list of the current operands. The operands are removed from the list
+  /// and the result of their contraction is appended to it.
+  typedef std::pair<std::size_t, std::size_t> step_type;
+
+  /// The largest product that is optimized exhaustively
+  static constexpr std::size_t max_optimal_operands = 10ul;
+
+  /// \param operands the size estimates of the operands
+  /// \param result_indices the result index list
+  /// \throw TiledArray::Exception if the product cannot be evaluated as a
+  /// sequence of pure contractions that produces \p result_indices
+  ContractionPathOptimizer(const std::vector<VolumeEstimate>& operands,
+                           const IndexList& result_indices)
+      : operands_(operands), result_indices_(result_indices) {
+    TA_ASSERT(!operands_.empty());
+    for (const auto& operand : operands_) TA_ASSERT(!operand.empty());
+
+    optimal_ = operands_.size() <= max_optimal_operands;
+    if (optimal_)
+      optimize_exhaustive();
+    else
+      optimize_greedy();
+
+    const IndexList indices =
+        (steps_.empty() ? operands_.front().indices() : step_indices_.back());
+    if (!indices.is_permutation(result_indices_))
+      TA_EXCEPTION(
+          "The result index list of the product is not a permutation of the "
+          "indices that are not contracted.");
+  }
+
+  /// \return the contraction path
+  const std::vector<step_type>& steps() const { return steps_; }
+
+  /// \return the result index list of each step of the path
+  const std::vector<IndexList>& step_indices() const { return step_indices_; }
+
+  /// \return the estimated cost of each step of the path
+  const std::vector<double>& step_flops() const { return step_flops_; }
+
+  /// \return the estimated cost of the path
+  double flops() const { return flops_; }
+
+  /// \return \c true if the path is optimal, \c false if it was found by the
+  /// greedy search
+  bool optimal() const { return optimal_; }
+
+  /// Print the path
+
+  /// \param os the output stream
+  void print(std::ostream& os) const {
+    os << "[contraction path] " << (optimal_ ? "optimal" : "greedy") << ", "
+       << flops_ << " flops\n";
+    for (std::size_t s = 0ul; s < steps_.size(); ++s)
+      os << "  " << s << ": (" << steps_[s].first << ", " << steps_[s].second
+         << ") -> " << step_indices_[s] << ", " << step_flops_[s]
+         << " flops\n";
+  }
+
+  /// Estimated cost of a contraction
+
+  /// \param left the estimate of the left operand
+  /// \param right the estimate of the right operand
+  /// \return the number of floating-point operations
+  static double contraction_flops(const VolumeEstimate& left,
+                                  const VolumeEstimate& right) {
+    const auto left_indices = left.indices();
+    double result = 2.0 * left.density() * right.density();
+    for (const auto& index : left_indices)
+      result *= left.extent(index).elements;
+    for (const auto& index : right.indices())
+      if (!left_indices.count(index)) result *= right.extent(index).elements;
+    return result;
+  }
+
+ private:
+  std::vector<VolumeEstimate> operands_;  ///< The operands
+  IndexList result_indices_;              ///< The result index list
+  std::vector<step_type> steps_;          ///< The path
+  std::vector<IndexList> step_indices_;   ///< The result indices of the steps
+  std::vector<double> step_flops_;        ///< The cost of the steps
+  double flops_ = 0.0;                    ///< The cost of the path
+  bool optimal_ = true;                   ///< Whether the path is optimal
+
+  /// \param left the left operand index list
+  /// \param right the right operand index list
+  /// \param kept a predicate that is \c true for the indices that are needed
+  /// after the contraction
+  /// \return \c true if the operands can be contracted
+  template <typename Kept>
+  static bool contractible(const IndexList& left, const IndexList& right,
+                           const Kept& kept) {
+    bool contracted = false;
+    for (const auto& index : left) {
+      if (!right.count(index)) continue;
+      if (kept(index)) return false;
+      contracted = true;
+    }
+    return contracted;
+  }
+
+  /// Append a step to the path
+
+  /// \param step the positions of the operands
+  /// \param left the estimate of the left operand
+  /// \param right the estimate of the right operand
+  /// \return the estimate of the result
+  VolumeEstimate append(const step_type& step, const VolumeEstimate& left,
+                        const VolumeEstimate& right) {
+    const auto result = VolumeEstimate::contraction(left, right);
+    steps_.push_back(step);
+    step_indices_.push_back(result.indices());
+    step_flops_.push_back(contraction_flops(left, right));
+    flops_ += step_flops_.back();
+    return result;
+  }
+
+  /// Find the optimal path by dynamic programming over the operand subsets
+  void optimize_exhaustive() {
+    const std::size_t n = operands_.size();
+    const std::uint32_t all = (std::uint32_t(1) << n) - 1u;
+
+    // The operands that carry each index
+    std::map<std::string, std::uint32_t> index_operands;
+    for (std::size_t i = 0ul; i < n; ++i)
+      for (const auto& index : operands_[i].indices())
+        index_operands[index] |= std::uint32_t(1) << i;
+
+    // The cheapest evaluation of each subset of the operands
+    struct Node {
+      double flops = std::numeric_limits<double>::max();
+      std::uint32_t left = 0u;  ///< The operands of the left subproduct
+      VolumeEstimate volume;
+      IndexList indices;
+    };
+    std::vector<Node> nodes(all + 1u);
+    for (std::size_t i = 0ul; i < n; ++i) {
+      auto& node = nodes[std::uint32_t(1) << i];
+      node.flops = 0.0;
+      node.volume = operands_[i];
+      node.indices = operands_[i].indices();
+    }
+
+    for (std::uint32_t set = 1u; set <= all; ++set) {
+      if (!(set & (set - 1u))) continue;
+      auto kept = [&](const std::string& index) {
+        return result_indices_.count(index) ||
+               (index_operands[index] & (all & ~set));
+      };
+
+      // The left subproduct contains the first operand of the subset
+      const std::uint32_t first = set & (~set + 1u);
+      auto& node = nodes[set];
+      for (std::uint32_t left = (set - 1u) & set; left;
+           left = (left - 1u) & set) {
+        if (!(left & first)) continue;
+        const auto& l = nodes[left];
+        const auto& r = nodes[set ^ left];
+        if (l.indices.size() == 0u || r.indices.size() == 0u) continue;
+        if (!contractible(l.indices, r.indices, kept)) continue;
+        const double flops =
+            l.flops + r.flops + contraction_flops(l.volume, r.volume);
+        if (flops < node.flops) {
+          node.flops = flops;
+          node.left = left;
+        }
+      }
+      if (node.left) {
+        node.volume = VolumeEstimate::contraction(
+            nodes[node.left].volume, nodes[set ^ node.left].volume);
+        node.indices = node.volume.indices();
+      }
+    }
+
+    if (!nodes[all].left && n > 1ul)
+      TA_EXCEPTION(
+          "The product cannot be evaluated as a sequence of contractions.");
+
+    // Linearize the tree of the contractions; the current operands are
+    // identified by their subsets
+    std::vector<std::uint32_t> current;
+    for (std::size_t i = 0ul; i < n; ++i)
+      current.push_back(std::uint32_t(1) << i);
+    std::function<void(std::uint32_t)> emit = [&](const std::uint32_t set) {
+      if (!(set & (set - 1u))) return;
+      const std::uint32_t left = nodes[set].left, right = set ^ left;
+      emit(left);
+      emit(right);
+      const auto position = [&current](const std::uint32_t operand) {
+        return std::size_t(std::find(current.begin(), current.end(), operand) -
+                           current.begin());
+      };
+      const step_type step(position(left), position(right));
+      append(step, nodes[left].volume, nodes[right].volume);
+      current.erase(current.begin() + std::max(step.first, step.second));
+      current.erase(current.begin() + std::min(step.first, step.second));
+      current.push_back(set);
+    };
+    emit(all);
+  }
+
+  /// Find a path by contracting the cheapest pair of operands first
+  void optimize_greedy() {
+    std::vector<VolumeEstimate> current = operands_;
+    std::vector<IndexList> indices;
+    for (const auto& operand : operands_) indices.push_back(operand.indices());
+
+    while (current.size() > 1ul) {
+      double best_flops = std::numeric_limits<double>::max(), best_bytes = 0.0;
+      step_type best;
+      for (std::size_t i = 0ul; i < current.size(); ++i) {
+        for (std::size_t j = i + 1ul; j < current.size(); ++j) {
+          auto kept = [&](const std::string& index) {
+            if (result_indices_.count(index)) return true;
+            for (std::size_t k = 0ul; k < current.size(); ++k)
+              if (k != i && k != j && indices[k].count(index)) return true;
+            return false;
+          };
+          if (!contractible(indices[i], indices[j], kept)) continue;
+          const double flops = contraction_flops(current[i], current[j]);
+          const double bytes =
+              VolumeEstimate::contraction(current[i], current[j]).bytes();
+          if (flops < best_flops ||
+              (flops == best_flops && bytes < best_bytes)) {
+            best_flops = flops;
+            best_bytes = bytes;
+            best = step_type(i, j);
+          }
+        }
+      }
+      if (best_flops == std::numeric_limits<double>::max())
+        TA_EXCEPTION(
+            "The product cannot be evaluated as a sequence of contractions.");
+
+      const auto result =
+          append(best, current[best.first], current[best.second]);
+      current.erase(current.begin() + best.second);
+      current.erase(current.begin() + best.first);
+      indices.erase(indices.begin() + best.second);
+      indices.erase(indices.begin() + best.first);
+      current.push_back(result);
+      indices.push_back(result.indices());
+    }
+  }
+};  // class ContractionPathOptimizer
+
+inline std::ostream& operator<<(std::ostream& os,
+                                const ContractionPathOptimizer& path) {
+  path.print(os);
+  return os;
+}
+
+namespace detail {
+
+/// An operand of a product of tensor expressions
+template <typename Array>
+struct ProductOperand {
+  Array array;             ///< The array
+  std::string annotation;  ///< The array annotation
+};
+
+/// Collect the operands of a product of tensor expressions
+
+/// \param expr a tensor expression
+/// \param[out] operands the operands of the product
+/// \param[in,out] factor the scaling factor of the product
+template <typename Array, typename A, typename Scalar>
+void collect_product_operands(const TsrExpr<A, true>& expr,
+                              std::vector<ProductOperand<Array>>& operands,
+                              Scalar&) {
+  static_assert(std::is_same_v<std::remove_const_t<A>, Array>,
+                "The operands of a product must have the same array type");
+  operands.push_back({expr.array(), expr.annotation()});
+}
+
+/// Collect the operands of a product of tensor expressions
+
+/// \param expr a scaled tensor expression
+/// \param[out] operands the operands of the product
+/// \param[in,out] factor the scaling factor of the product
+template <typename Array, typename S, typename Scalar>
+void collect_product_operands(const ScalTsrExpr<Array, S>& expr,
+                              std::vector<ProductOperand<Array>>& operands,
+                              Scalar& factor) {
+  operands.push_back({expr.array(), expr.annotation()});
+  factor *= expr.factor();
+}
+
+/// Collect the operands of a product of tensor expressions
+
+/// \param expr a product expression
+/// \param[out] operands the operands of the product
+/// \param[in,out] factor the scaling factor of the product
+template <typename Array, typename L, typename R, typename Scalar>
+void collect_product_operands(const MultExpr<L, R>& expr,
+                              std::vector<ProductOperand<Array>>& operands,
+                              Scalar& factor) {
+  collect_product_operands(expr.left(), operands, factor);
+  collect_product_operands(expr.right(), operands, factor);
+}
+
+/// Collect the operands of a product of tensor expressions
+
+/// \param expr a scaled product expression
+/// \param[out] operands the operands of the product
+/// \param[in,out] factor the scaling factor of the product
+template <typename Array, typename L, typename R, typename S, typename Scalar>
+void collect_product_operands(const ScalMultExpr<L, R, S>& expr,
+                              std::vector<ProductOperand<Array>>& operands,
+                              Scalar& factor) {
+  collect_product_operands(expr.left(), operands, factor);
+  collect_product_operands(expr.right(), operands, factor);
+  factor *= expr.factor();
+}
+
+/// Evaluate a product in the order given by ContractionPathOptimizer
+
+/// \param result the result tensor expression
+/// \param operands the operands of the product
+/// \param factor the scaling factor of the product
+template <typename Array, typename Scalar>
+void evaluate_product(TsrExpr<Array, true>& result,
+                      std::vector<ProductOperand<Array>> operands,
+                      const Scalar factor) {
+  static_assert(!TiledArray::detail::is_tensor_of_tensor_v<
+                    typename Array::value_type>,
+                "Products of tensors of tensors are not supported");
+
+  std::vector<VolumeEstimate> volumes;
+  volumes.reserve(operands.size());
+  for (const auto& operand : operands)
+    volumes.emplace_back(IndexList(operand.annotation), operand.array.trange(),
+                         1.0 - operand.array.shape().sparsity(),
+                         sizeof(TiledArray::detail::numeric_t<Array>));
+  const ContractionPathOptimizer path(volumes, IndexList(result.annotation()));
+
+  if (path.steps().empty()) {
+    const auto& operand = operands.front();
+    result = factor * operand.array(operand.annotation);
+    return;
+  }
+
+  const std::size_t nsteps = path.steps().size();
+  for (std::size_t s = 0ul; s < nsteps; ++s) {
+    const auto step = path.steps()[s];
+    const auto& left = operands[step.first];
+    const auto& right = operands[step.second];
+    if (s + 1ul == nsteps) {
+      if (factor == Scalar(1))
+        result = left.array(left.annotation) * right.array(right.annotation);
+      else
+        result = factor * (left.array(left.annotation) *
+                           right.array(right.annotation));
+      break;
+    }
+
+    ProductOperand<Array> product{Array(), path.step_indices()[s].string()};
+    product.array(product.annotation) =
+        left.array(left.annotation) * right.array(right.annotation);
+    operands.erase(operands.begin() + std::max(step.first, step.second));
+    operands.erase(operands.begin() + std::min(step.first, step.second));
+    operands.push_back(std::move(product));
+  }
+}
+
+}  // namespace detail
+
+/// Evaluate a product of tensor expressions in the optimal order
+
+/// The product, e.g. <tt>a("i,j") * b("j,k") * c("k,l")</tt>, is evaluated
+/// as the sequence of pairwise contractions chosen by
+/// ContractionPathOptimizer rather than from left to right.
+/// \code
+/// einsum(r("i,l"), a("i,j") * b("j,k") * c("k,l"));
+/// \endcode
+/// \param result the result tensor expression
+/// \param product a product of (scaled) tensor expressions of arrays of the
+/// same type
+template <typename Array, typename E>
+void einsum(TsrExpr<Array, true> result, const Expr<E>& product) {
+  std::vector<detail::ProductOperand<Array>> operands;
+  TiledArray::detail::numeric_t<Array> factor(1);
+  detail::collect_product_operands(product.derived(), operands, factor);
+  detail::evaluate_product(result, std::move(operands), factor);
+}
+
+/// Evaluate a product of three or more tensor expressions in the optimal
+/// order
+
+/// \code
+/// einsum(r("i,m"), a("i,j"), b("j,k"), c("k,l"), d("l,m"));
+/// \endcode
+/// \param result the result tensor expression
+/// \param e1 the first factor
+/// \param e2 the second factor
+/// \param e3 the third factor
+/// \param es the remaining factors
+/// \sa einsum(TsrExpr<Array, true>, const Expr<E>&)
+template <typename Array, typename E1, typename E2, typename E3,
+          typename... Es>
+void einsum(TsrExpr<Array, true> result, const Expr<E1>& e1,
+            const Expr<E2>& e2, const Expr<E3>& e3, const Expr<Es>&... es) {
+  std::vector<detail::ProductOperand<Array>> operands;
+  TiledArray::detail::numeric_t<Array> factor(1);
+  detail::collect_product_operands(e1.derived(), operands, factor);
+  detail::collect_product_operands(e2.derived(), operands, factor);
+  detail::collect_product_operands(e3.derived(), operands, factor);
+  (detail::collect_product_operands(es.derived(), operands, factor), ...);
+  detail::evaluate_product(result, std::move(operands), factor);
+}
+
+}  // namespace expressions
+
+using expressions::ContractionPathOptimizer;
+using expressions::einsum;
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_EXPRESSIONS_CONTRACTION_PATH_H__INCLUDED
@@ -37,6 +37,7 @@
 #include "TiledArray/config.h"
 #include "TiledArray/tile.h"
 #include "TiledArray/tile_interface/trace.h"
+#include "TiledArray/util/logger.h"
 #include "expr_engine.h"
 #ifdef TILEDARRAY_HAS_CUDA
 #include <TiledArray/cuda/cuda_task_fn.h>
@@ -60,7 +61,8 @@ struct is_aliased;
 
 template <typename Engine>
 struct EngineParamOverride {
-  EngineParamOverride() : world(nullptr), pmap(), shape(nullptr) {}
+  EngineParamOverride()
+      : world(nullptr), pmap(), shape(nullptr), symmetry() {}
 
   typedef
       typename EngineTrait<Engine>::policy policy;  ///< The result policy type
@@ -72,6 +74,7 @@ struct EngineParamOverride {
   World* world;
   std::shared_ptr<pmap_interface> pmap;
   const shape_type* shape;
+  std::shared_ptr<const TiledArray::symmetry::TileSymmetry> symmetry;
 };
 
 /// \brief type trait checks if T has array() member
@@ -127,6 +130,17 @@ class Expr {
     }
     return derived();
   }
+  /// \param symmetry the permutational symmetry of the result; only the
+  /// unique tiles of the result will be evaluated, i.e. the result is packed
+  /// (see symmetry::unpack); requires a sparse result shape
+  Expr<Derived>& set_symmetry(
+      const TiledArray::symmetry::TileSymmetry& symmetry) {
+    if (override_ptr_ == nullptr)
+      override_ptr_ = std::make_shared<override_type>();
+    override_ptr_->symmetry =
+        std::make_shared<const TiledArray::symmetry::TileSymmetry>(symmetry);
+    return derived();
+  }
   /// \param world the World object to use for the result
   Expr<Derived>& set_world(World& world) {
     if (override_ptr_ != nullptr) {
@@ -402,12 +416,18 @@ class Expr {
     // Get result index list.
     BipartiteIndexList target_indices(tsr.annotation());
 
+#ifdef TA_ENABLE_TILE_OPS_LOGGING
+    // Count the tiles cloned by the operations of this expression
+    CloneCounter clones;
+#endif  // TA_ENABLE_TILE_OPS_LOGGING
+
     // Construct the expression engine
     engine_type engine(derived());
     engine.init(world, pmap, target_indices);
 
     // Create the distributed evaluator from this expression
-    typename engine_type::dist_eval_type dist_eval = engine.make_dist_eval();
+    typename engine_type::dist_eval_type dist_eval =
+        engine.make_cse_dist_eval();
     dist_eval.eval();
 
     // Create the result array
@@ -422,8 +442,16 @@ class Expr {
       set_tile(result, index, tile_contents);
     }
 
-    // Wait for child expressions of dist_eval
-    dist_eval.wait();
+    // Wait for child expressions of dist_eval, unless the evaluation is lazy
+    LazyEvalScope::wait(dist_eval);
+#ifdef TA_ENABLE_TILE_OPS_LOGGING
+    // The copies of lazily evaluated statements overlap, do not report them
+    auto& logger =
+        TileOpsLogger<typename A::value_type::value_type>::get_instance();
+    if (logger.clone_report && !LazyEvalScope::active())
+      logger << "TA::Expr::eval_to: " << tsr.annotation()
+             << " clones=" << clones.count() << std::endl;
+#endif  // TA_ENABLE_TILE_OPS_LOGGING
     // Swap the new array with the result array object.
     result.swap(tsr.array());
   }
@@ -520,8 +548,8 @@ class Expr {
       }
     }
 
-    // Wait for child expressions of dist_eval
-    dist_eval.wait();
+    // Wait for child expressions of dist_eval, unless the evaluation is lazy
+    LazyEvalScope::wait(dist_eval);
     // Swap the new array with the result array object.
     result.swap(tsr.array());
   }
@@ -557,12 +585,17 @@ class Expr {
     return default_world_helper<Derived>(this->derived()).get();
   }
 
- public:
+ private:
+  /// Evaluates this expression and reduces its local tiles
+
+  /// \tparam Op The reduction operation type
+  /// \param op The reduction operation
+  /// \param world The world where the expression is evaluated
+  /// \return A pair of the future to the local reduction result and the
+  /// distributed evaluator of this expression
   template <typename Op>
-  Future<typename Op::result_type> reduce(const Op& op, World& world) const {
+  auto make_local_reduction(const Op& op, World& world) const {
     // Typedefs
-    typedef madness::TaggedKey<madness::uniqueidT, ExpressionReduceTag>
-        key_type;
     typedef TiledArray::math::UnaryReduceWrapper<
         typename engine_type::value_type, Op>
         reduction_op_type;
@@ -589,29 +622,28 @@ class Expr {
     for (; it != end; ++it)
       if (!dist_eval.is_zero(*it)) reduce_task.add(dist_eval.get(*it));
 
-    // All reduce the result of the expression
-    auto result = world.gop.all_reduce(key_type(dist_eval.id()),
-                                       reduce_task.submit(), op);
-    dist_eval.wait();
-    return result;
+    return std::make_pair(reduce_task.submit(), dist_eval);
   }
 
-  template <typename Op>
-  Future<typename Op::result_type> reduce(const Op& op) const {
-    return reduce(op, default_world());
-  }
+  /// Evaluates this and the right-hand expressions and reduces their local
+  /// tiles pairwise
 
+  /// \tparam D The right-hand expression type
+  /// \tparam Op The reduction operation type
+  /// \param right_expr The right-hand expression
+  /// \param op The reduction operation
+  /// \param world The world where the expressions are evaluated
+  /// \return A tuple of the future to the local reduction result and the
+  /// distributed evaluators of the left- and right-hand expressions
   template <typename D, typename Op>
-  Future<typename Op::result_type> reduce(const Expr<D>& right_expr,
-                                          const Op& op, World& world) const {
+  auto make_local_reduction(const Expr<D>& right_expr, const Op& op,
+                            World& world) const {
     static_assert(
         is_aliased<D>::value,
         "no_alias() expressions are not allowed on the right-hand side of "
         "the assignment operator.");
 
     // Typedefs
-    typedef madness::TaggedKey<madness::uniqueidT, ExpressionReduceTag>
-        key_type;
     typedef TiledArray::math::BinaryReduceWrapper<
         typename engine_type::value_type, typename D::engine_type::value_type,
         Op>
@@ -676,13 +708,104 @@ class Expr {
       }
     }
 
-    auto result = world.gop.all_reduce(key_type(left_dist_eval.id()),
-                                       local_reduce_task.submit(), op);
+    return std::make_tuple(local_reduce_task.submit(), left_dist_eval,
+                           right_dist_eval);
+  }
+
+ public:
+  template <typename Op>
+  Future<typename Op::result_type> reduce(const Op& op, World& world) const {
+    // Typedefs
+    typedef madness::TaggedKey<madness::uniqueidT, ExpressionReduceTag>
+        key_type;
+
+    auto [local_result, dist_eval] = make_local_reduction(op, world);
+
+    // All reduce the result of the expression
+    auto result =
+        world.gop.all_reduce(key_type(dist_eval.id()), local_result, op);
+    dist_eval.wait();
+    return result;
+  }
+
+  template <typename Op>
+  Future<typename Op::result_type> reduce(const Op& op) const {
+    return reduce(op, default_world());
+  }
+
+  template <typename D, typename Op>
+  Future<typename Op::result_type> reduce(const Expr<D>& right_expr,
+                                          const Op& op, World& world) const {
+    // Typedefs
+    typedef madness::TaggedKey<madness::uniqueidT, ExpressionReduceTag>
+        key_type;
+
+    auto [local_result, left_dist_eval, right_dist_eval] =
+        make_local_reduction(right_expr, op, world);
+
+    auto result =
+        world.gop.all_reduce(key_type(left_dist_eval.id()), local_result, op);
     left_dist_eval.wait();
     right_dist_eval.wait();
     return result;
   }
 
+  /// Local part of reduce()
+
+  /// Reduces the tiles of this expression that are owned by this rank. No
+  /// collective is performed and, unlike reduce(), this does not wait for the
+  /// local tiles to be evaluated; the rank-local results of several
+  /// reductions can then be combined with a single collective (see
+  /// ReductionBatch).
+  /// \tparam Op The reduction operation type
+  /// \param op The reduction operation
+  /// \param world The world where the expression is evaluated
+  /// \return A future to the reduction of the local tiles
+  template <typename Op>
+  Future<typename Op::result_type> reduce_local(const Op& op,
+                                                World& world) const {
+    typedef typename Op::result_type result_type;
+    auto local_reduction = make_local_reduction(op, world);
+    auto dist_eval = std::move(local_reduction.second);
+
+    // keep the evaluator alive until its local tiles have been reduced
+    return world.taskq.add(
+        [dist_eval](const result_type& result) -> result_type {
+          dist_eval.wait();
+          return result;
+        },
+        std::move(local_reduction.first));
+  }
+
+  /// Local part of the binary reduce()
+
+  /// \tparam D The right-hand expression type
+  /// \tparam Op The reduction operation type
+  /// \param right_expr The right-hand expression
+  /// \param op The reduction operation
+  /// \param world The world where the expressions are evaluated
+  /// \return A future to the reduction of the local tiles
+  /// \sa reduce_local(const Op&,World&)
+  template <typename D, typename Op>
+  Future<typename Op::result_type> reduce_local(const Expr<D>& right_expr,
+                                                const Op& op,
+                                                World& world) const {
+    typedef typename Op::result_type result_type;
+    auto local_reduction = make_local_reduction(right_expr, op, world);
+    auto left_dist_eval = std::move(std::get<1>(local_reduction));
+    auto right_dist_eval = std::move(std::get<2>(local_reduction));
+
+    // keep the evaluators alive until their local tiles have been reduced
+    return world.taskq.add(
+        [left_dist_eval, right_dist_eval](
+            const result_type& result) -> result_type {
+          left_dist_eval.wait();
+          right_dist_eval.wait();
+          return result;
+        },
+        std::move(std::get<0>(local_reduction)));
+  }
+
   template <typename D, typename Op>
   Future<typename Op::result_type> reduce(const Expr<D>& right_expr,
                                           const Op& op) const {
@@ -0,0 +1,282 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_EXPR_DAG_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_EXPR_DAG_H__INCLUDED
+
+#include <TiledArray/dist_eval/cached_eval.h>
+#include <TiledArray/expressions/index_list.h>
+#include <TiledArray/external/madness.h>
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TiledArray {
+
+// Forward declarations
+template <typename, typename>
+class DistArray;
+
+namespace expressions {
+
+// Forward declarations
+template <typename>
+class Expr;
+template <typename, bool>
+class TsrExpr;
+template <typename>
+struct EngineTrait;
+
+/// Evaluates a sequence of assignments, sharing common subexpressions
+
+/// The assignments added to an ExprDAG are evaluated, in order, by
+/// evaluate(). Before evaluation the engine trees of all assignments are
+/// hashed structurally: two subexpressions are equivalent if they apply the
+/// same operations, with the same scaling factors and index permutations, to
+/// the same (unmodified) arrays. A subexpression shared by several
+/// assignments (or several times by one assignment) is evaluated once, by
+/// its first consumer; all consumers stream its tiles from a cache as they
+/// are computed. The cache is released by the last consumer, hence each tile
+/// of an intermediate is freed once its last consumer is done with it.
+/// \code
+/// ExprDAG dag;
+/// dag.add(r1("a,b,i,j"), (t2("a,b,i,j") + t1("a,i") * t1("b,j")) * ...);
+/// dag.add(r2("a,b,i,j"), (t2("a,b,i,j") + t1("a,i") * t1("b,j")) * ...);
+/// dag.evaluate();  // t2 + t1 * t1 is evaluated once
+/// \endcode
+/// \note The arrays referenced by the assignments must outlive evaluate().
+/// Only TsrExpr assignments may be recorded; subexpressions with a
+/// world, process map, shape, or symmetry override are never shared.
+class ExprDAG {
+ public:
+  ExprDAG() = default;
+  ExprDAG(const ExprDAG&) = delete;
+  ExprDAG& operator=(const ExprDAG&) = delete;
+  ~ExprDAG() = default;
+
+  /// Record an assignment
+
+  /// The assignment <tt>tsr = expr</tt> is evaluated by evaluate()
+  /// \tparam A The array type
+  /// \tparam Alias Tile alias flag
+  /// \tparam D The derived expression type
+  /// \param tsr The tensor that will be assigned
+  /// \param expr The expression that will be assigned to \c tsr
+  template <typename A, bool Alias, typename D>
+  void add(TsrExpr<A, Alias> tsr, const Expr<D>& expr) {
+    typedef typename Expr<D>::engine_type engine_type;
+
+    // Analyze the engine tree of the assignment as it will be evaluated
+    auto analyze = [tsr, expr = expr.derived()](ExprDAG& dag) {
+      const bool initialized = tsr.array().is_initialized();
+      World& world = (initialized ? tsr.array().world()
+                                  : TiledArray::get_default_world());
+      std::shared_ptr<typename A::pmap_interface> pmap;
+      if (initialized) pmap = tsr.array().pmap();
+      engine_type engine(expr);
+      engine.init(world, pmap, BipartiteIndexList(tsr.annotation()));
+      engine.count_subexpressions(dag);
+    };
+    auto evaluate = [tsr, expr = expr.derived()]() mutable {
+      expr.eval_to(tsr);
+    };
+    statements_.push_back(
+        Statement{&tsr.array(), std::move(analyze), std::move(evaluate)});
+  }
+
+  /// \return The number of recorded assignments
+  std::size_t size() const { return statements_.size(); }
+
+  /// \return The number of shared subexpressions found by the last call to
+  /// evaluate()
+  std::size_t nshared() const { return nshared_; }
+
+  /// Evaluate the recorded assignments
+
+  /// The assignments are evaluated in the order they were added; the DAG is
+  /// empty on return. This function must be called collectively.
+  void evaluate() {
+    TA_ASSERT(active_ == nullptr);
+    active_ = this;
+    try {
+      // Count the consumers of each subexpression
+      for (const auto& statement : statements_) {
+        statement.analyze(*this);
+        ++versions_[statement.target];
+      }
+      versions_.clear();
+      for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.uses < 2u)
+          it = entries_.erase(it);
+        else
+          ++it;
+      }
+      nshared_ = entries_.size();
+
+      // Evaluate the statements, the shared subexpressions are evaluated by
+      // their first consumer
+      for (statement_ = 0ul; statement_ < statements_.size(); ++statement_) {
+        statements_[statement_].evaluate();
+        for (auto& entry : entries_) {
+          if (!entry.second.wait) continue;
+          entry.second.wait();
+          entry.second.wait = nullptr;
+        }
+        ++versions_[statements_[statement_].target];
+      }
+    } catch (...) {
+      clear();
+      throw;
+    }
+    clear();
+  }
+
+  /// \return The DAG that is being evaluated, or \c nullptr
+  static ExprDAG* active() { return active_; }
+
+  /// Array version accessor
+
+  /// \param array The address of an array object
+  /// \return The number of preceding assignments to \c array
+  unsigned int version(const void* array) const {
+    const auto it = versions_.find(array);
+    return (it != versions_.end() ? it->second : 0u);
+  }
+
+  /// Record a consumer of a subexpression
+
+  /// \param key The structural key of the subexpression
+  /// \return \c true if this is the first consumer of \c key, i.e. the
+  /// subexpressions of \c key must be counted as well
+  bool count(const std::string& key) { return entries_[key].uses++ == 0u; }
+
+  /// \param key The structural key of a subexpression
+  /// \return \c true if the subexpression is shared and has consumers left
+  bool is_shared(const std::string& key) const {
+    const auto it = entries_.find(key);
+    return (it != entries_.end()) && (it->second.uses != 0u);
+  }
+
+  /// Construct the distributed evaluator for a consumer of a shared
+  /// subexpression
+
+  /// The subexpression is evaluated when it is requested by its first
+  /// consumer.
+  /// \tparam Engine The expression engine type
+  /// \param key The structural key of the subexpression
+  /// \param engine The expression engine of the subexpression
+  /// \return A distributed evaluator that streams the cached tiles
+  template <typename Engine>
+  typename EngineTrait<Engine>::dist_eval_type make_dist_eval(
+      const std::string& key, const Engine& engine) {
+    typedef EngineTrait<Engine> engine_trait;
+    typedef typename engine_trait::policy policy;
+    typedef DistArray<typename engine_trait::value_type, policy> array_type;
+    typedef TiledArray::detail::CachedEvalImpl<array_type, policy> impl_type;
+    typedef typename engine_trait::dist_eval_type dist_eval_type;
+
+    Entry& entry = entries_.at(key);
+    TA_ASSERT(entry.uses != 0u);
+    if (!entry.array) {
+      dist_eval_type dist_eval = engine.make_dist_eval();
+      dist_eval.eval();
+      auto array = std::make_shared<array_type>(
+          dist_eval.world(), dist_eval.trange(), dist_eval.shape(),
+          dist_eval.pmap());
+      for (const auto index : *dist_eval.pmap()) {
+        if (dist_eval.is_zero(index)) continue;
+        array->set(index, dist_eval.get(index));
+      }
+      entry.array = array;
+      entry.wait = [dist_eval]() { LazyEvalScope::wait(dist_eval); };
+    }
+
+    // A consumable tile may be modified by the consumer, hence each consumer
+    // gets a copy except the last one, provided it does not share the
+    // statement with another consumer that may still copy the tile. The
+    // consumers of earlier statements may still be copying the tiles as
+    // well, hence the last consumer waits for them before it gets the tiles.
+    --entry.uses;
+    const bool clone = engine_trait::consumable &&
+                       ((entry.uses != 0u) || (entry.statement == statement_));
+    entry.statement = statement_;
+    if (engine_trait::consumable && !clone) {
+      for (auto& wait : entry.consumers) wait();
+      entry.consumers.clear();
+    }
+
+    std::shared_ptr<impl_type> pimpl = std::make_shared<impl_type>(
+        *std::static_pointer_cast<array_type>(entry.array), *engine.world(),
+        engine.trange(), engine.shape(), engine.pmap(), outer(engine.perm()),
+        clone);
+    dist_eval_type dist_eval(pimpl);
+    if (entry.uses == 0u) {
+      entry.array.reset();
+      entry.consumers.clear();
+    } else if (clone) {
+      entry.consumers.emplace_back([dist_eval]() { dist_eval.wait(); });
+    }
+
+    return dist_eval;
+  }
+
+ private:
+  /// A recorded assignment
+  struct Statement {
+    const void* target;  ///< The address of the assigned array
+    std::function<void(ExprDAG&)> analyze;  ///< Counts the subexpressions
+    std::function<void()> evaluate;         ///< Evaluates the assignment
+  };
+
+  /// A subexpression
+  struct Entry {
+    unsigned int uses = 0u;  ///< The number of remaining consumers
+    /// The statement of the last consumer
+    std::size_t statement = std::numeric_limits<std::size_t>::max();
+    std::shared_ptr<void> array;  ///< The cached result
+    std::function<void()> wait;   ///< Waits for the evaluation of the result
+    /// Wait for the consumers that copy the cached tiles
+    std::vector<std::function<void()>> consumers;
+  };
+
+  void clear() {
+    statements_.clear();
+    entries_.clear();
+    versions_.clear();
+    active_ = nullptr;
+  }
+
+  std::vector<Statement> statements_;  ///< The recorded assignments
+  std::unordered_map<std::string, Entry> entries_;  ///< The subexpressions
+  std::unordered_map<const void*, unsigned int>
+      versions_;              ///< The number of assignments to each array
+  std::size_t statement_ = 0ul;  ///< The statement being evaluated
+  std::size_t nshared_ = 0ul;    ///< The number of shared subexpressions
+
+  static inline ExprDAG* active_ = nullptr;  ///< The DAG being evaluated
+};  // class ExprDAG
+
+}  // namespace expressions
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_EXPRESSIONS_EXPR_DAG_H__INCLUDED
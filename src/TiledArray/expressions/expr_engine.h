@@ -26,8 +26,15 @@
 #ifndef TILEDARRAY_EXPRESSIONS_EXPR_ENGINE_H__INCLUDED
 #define TILEDARRAY_EXPRESSIONS_EXPR_ENGINE_H__INCLUDED
 
+#include <TiledArray/dist_eval/fused_eval.h>
+#include <TiledArray/expressions/expr_dag.h>
 #include <TiledArray/expressions/expr_trace.h>
 #include <TiledArray/external/madness.h>
+#include <TiledArray/shape.h>
+#include <TiledArray/symm/tile_symmetry.h>
+
+#include <sstream>
+#include <typeinfo>
 
 namespace TiledArray {
 namespace expressions {
@@ -66,6 +73,10 @@ class ExprEngine : private NO_DEFAULTS {
   typedef typename EngineTrait<Derived>::pmap_interface
       pmap_interface;  ///< Process map interface type
 
+  /// The leaf array type of a fusable element-wise expression; \c void if
+  /// the expression cannot be fused. Element-wise engines override this.
+  typedef void fused_array_type;
+
  protected:
   // The member variables of this class are protected because derived
   // classes will customize initialization.
@@ -157,8 +168,29 @@ class ExprEngine : private NO_DEFAULTS {
       shape_ = derived().make_shape();
     }
 
-    if (override_ptr_ && override_ptr_->shape)
-      shape_ = shape_.mask(*override_ptr_->shape);
+    override_shape();
+  }
+
+  /// Applies the shape and symmetry overrides to the result shape
+
+  /// The result shape is masked by the shape override and, if a symmetry
+  /// override is given, restricted to the unique tiles of the symmetry, so
+  /// that only these tiles are evaluated.
+  void override_shape() {
+    if (!override_ptr_) return;
+    if (override_ptr_->shape) shape_ = shape_.mask(*override_ptr_->shape);
+    if (override_ptr_->symmetry) {
+      if constexpr (is_dense_v<shape_type>) {
+        TA_EXCEPTION(
+            "symmetric evaluation requires a sparse shape to skip the "
+            "redundant tiles");
+      } else {
+        TA_ASSERT(override_ptr_->symmetry->validate(trange_));
+        shape_ = shape_.mask(
+            override_ptr_->symmetry->template unique_shape<shape_type>(
+                trange_));
+      }
+    }
   }
 
   /// Initialize result tensor distribution
@@ -205,6 +237,84 @@ class ExprEngine : private NO_DEFAULTS {
       return derived().make_tile_op();
   }
 
+  /// Distributed evaluator factory function
+
+  /// While an ExprDAG is evaluated, a subexpression that is shared by its
+  /// statements is evaluated once and its consumers read the tiles from a
+  /// cache; otherwise this is equivalent to \c make_dist_eval().
+  /// Outside of an ExprDAG, an element-wise expression with more than one
+  /// leaf is evaluated by a single fused evaluator (see
+  /// \c make_fused_dist_eval() ). Parent engines construct the evaluators of
+  /// their arguments with this function.
+  /// \return The distributed evaluator for this expression
+  dist_eval_type make_cse_dist_eval() const {
+    ExprDAG* dag = ExprDAG::active();
+    if (dag && !override_ptr_) {
+      const std::string key = derived().structural_key();
+      if (dag->is_shared(key)) return dag->make_dist_eval(key, derived());
+    }
+    if constexpr (!std::is_void_v<typename Derived::fused_array_type> &&
+                  (EngineTrait<Derived>::leaves > 1u)) {
+      if (!dag && derived().fusable(true)) return make_fused_dist_eval();
+    }
+    return derived().make_dist_eval();
+  }
+
+  /// Fused distributed evaluator factory function
+
+  /// The element kernels of the nodes of this expression are composed into
+  /// one kernel that computes each result tile directly from the tiles of
+  /// the leaf arrays, so no intermediate tiles are allocated and the result
+  /// tile is permuted while it is written. The tiles of leaves with a
+  /// different index order are read with permuted strides.
+  /// \return The fused distributed evaluator for this expression
+  dist_eval_type make_fused_dist_eval() const {
+    typedef typename Derived::fused_array_type array_type;
+    const auto kernel = derived().fused_kernel();
+
+    std::vector<array_type> arrays;
+    std::vector<Permutation> perms;
+    arrays.reserve(EngineTrait<Derived>::leaves);
+    perms.reserve(EngineTrait<Derived>::leaves);
+    derived().fused_arrays(arrays, perms);
+
+    typedef TiledArray::detail::FusedEvalImpl<array_type, decltype(kernel),
+                                              policy>
+        impl_type;
+    std::shared_ptr<impl_type> pimpl = std::make_shared<impl_type>(
+        arrays, perms, kernel, *world_, trange_, shape_, pmap_, outer(perm_),
+        permute_tiles_);
+
+    return dist_eval_type(pimpl);
+  }
+
+  /// Structural key of this expression
+
+  /// Two engines with equal keys evaluate to the same tensor. Derived
+  /// classes append the keys of their arguments (or the identity of their
+  /// array) to this key.
+  /// \return The key of this node of the engine tree
+  std::string structural_key() const {
+    std::stringstream ss;
+    ss << typeid(Derived).hash_code() << derived().structural_tag()
+       << indices_;
+    if (perm_)
+      ss << "[P " << outer(perm_) << inner(perm_)
+         << (permute_tiles_ ? "]" : " no permute tiles]");
+    return ss.str();
+  }
+
+  /// Expression tag used for structural hashing
+
+  /// Engines with a scaling factor must include its exact value.
+  /// \return The expression tag
+  std::string structural_tag() const { return derived().make_tag(); }
+
+  /// Count the consumers of the subexpressions of this expression
+
+  /// This function is a noop for leaves, which are never shared.
+  void count_subexpressions(ExprDAG&) const {}
+
   /// Cast this object to its derived type
   derived_type& derived() { return *static_cast<derived_type*>(this); }
 
@@ -0,0 +1,183 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_FUSED_KERNEL_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_FUSED_KERNEL_H__INCLUDED
+
+#include <TiledArray/tensor/type_traits.h>
+
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+
+namespace TiledArray {
+namespace expressions {
+
+// Element kernels of fused element-wise expressions
+//
+// An element-wise subtree of an expression (additions, subtractions,
+// Hadamard products, scaling and conjugation of arrays) is evaluated by a
+// single element kernel, which is composed from the kernels below by the
+// expression engines. A kernel evaluates one element of the
+// result from the corresponding elements of the leaf arrays, which are
+// passed as a tuple; the leaves of a kernel are the consecutive tuple
+// elements starting at offset I.
+
+/// Element kernel of a leaf, i.e. the element of an array
+struct FusedArg {
+  static constexpr std::size_t leaves = 1ul;  ///< The number of leaves
+
+  /// \tparam I The offset of this leaf in \c args
+  /// \tparam Args The tuple type of the leaf elements
+  /// \param args The leaf elements
+  /// \return The element of leaf \c I
+  template <std::size_t I, typename Args>
+  auto eval(const Args& args) const {
+    return std::get<I>(args);
+  }
+};  // struct FusedArg
+
+/// Element kernel of a scaled subexpression
+
+/// A conjugated subexpression is a scaled one whose factor is a
+/// \c TiledArray::detail::ComplexConjugate , which conjugates the element.
+/// \tparam Arg The kernel of the subexpression
+/// \tparam Scalar The scaling factor type
+template <typename Arg, typename Scalar>
+struct FusedScal {
+  static constexpr std::size_t leaves = Arg::leaves;  ///< The number of leaves
+
+  Arg arg;        ///< The kernel of the subexpression
+  Scalar factor;  ///< The scaling factor
+
+  /// \tparam I The offset of the leaves of this kernel in \c args
+  /// \tparam Args The tuple type of the leaf elements
+  /// \param args The leaf elements
+  /// \return The scaled element of the subexpression
+  template <std::size_t I, typename Args>
+  auto eval(const Args& args) const {
+    return arg.template eval<I>(args) * factor;
+  }
+};  // struct FusedScal
+
+/// Element kernel of a binary subexpression
+
+/// \tparam Op The binary element operation type
+/// \tparam Left The kernel of the left-hand subexpression
+/// \tparam Right The kernel of the right-hand subexpression
+template <typename Op, typename Left, typename Right>
+struct FusedBinary {
+  static constexpr std::size_t leaves =
+      Left::leaves + Right::leaves;  ///< The number of leaves
+
+  Left left;    ///< The kernel of the left-hand subexpression
+  Right right;  ///< The kernel of the right-hand subexpression
+
+  /// \tparam I The offset of the leaves of this kernel in \c args
+  /// \tparam Args The tuple type of the leaf elements
+  /// \param args The leaf elements
+  /// \return The element of the subexpression
+  template <std::size_t I, typename Args>
+  auto eval(const Args& args) const {
+    return Op()(left.template eval<I>(args),
+                right.template eval<I + Left::leaves>(args));
+  }
+};  // struct FusedBinary
+
+/// Fused kernel factory functions
+
+/// \param arg The kernel of the subexpression
+/// \param factor The scaling factor
+/// \return The kernel of the scaled subexpression
+template <typename Arg, typename Scalar>
+inline FusedScal<Arg, Scalar> make_fused_scal(const Arg& arg,
+                                              const Scalar factor) {
+  return FusedScal<Arg, Scalar>{arg, factor};
+}
+
+/// \tparam Op The binary element operation type
+/// \param left The kernel of the left-hand subexpression
+/// \param right The kernel of the right-hand subexpression
+/// \return The kernel of the binary subexpression
+template <typename Op, typename Left, typename Right>
+inline FusedBinary<Op, Left, Right> make_fused_binary(const Left& left,
+                                                      const Right& right) {
+  return FusedBinary<Op, Left, Right>{left, right};
+}
+
+/// Element operation of a fused kernel
+
+/// Wraps a kernel into the element-wise operation expected by the tensor
+/// kernels, i.e. a callable that takes one element of each leaf array.
+/// \tparam Kernel The kernel type
+/// \tparam T The element type
+template <typename Kernel, typename T>
+struct FusedElementOp {
+  Kernel kernel;  ///< The kernel
+
+  /// \param values The elements of the leaf arrays
+  /// \return The element of the result
+  template <typename... Ts, typename = std::enable_if_t<
+                                (std::is_same_v<std::decay_t<Ts>, T> && ...)>>
+  T operator()(const Ts&... values) const {
+    static_assert(sizeof...(Ts) == Kernel::leaves);
+    return static_cast<T>(
+        kernel.template eval<0ul>(std::forward_as_tuple(values...)));
+  }
+};  // struct FusedElementOp
+
+namespace detail {
+
+/// The array type of the leaves of a fusable subexpression
+
+/// An element-wise subexpression is fusable if all of its leaves are arrays
+/// of the same type, whose tiles are tensors of scalars of the result tile
+/// type. \c type is \c void if the subexpression is not fusable.
+/// \tparam Result The result tile type of the subexpression
+/// \tparam LeftArray The leaf array type of the left-hand argument, or
+/// \c void
+/// \tparam RightArray The leaf array type of the right-hand argument, or
+/// \c void
+template <typename Result, typename LeftArray, typename RightArray,
+          typename Enabler = void>
+struct fused_array {
+  typedef void type;
+};
+
+template <typename Result, typename Array>
+struct fused_array<
+    Result, Array, Array,
+    std::enable_if_t<std::is_same_v<Result, typename Array::value_type> &&
+                     TiledArray::detail::is_ta_tensor_v<Result> &&
+                     !TiledArray::detail::is_tensor_of_tensor_v<Result>>> {
+  typedef Array type;
+};
+
+/// \c fused_array_t is an alias for \c fused_array<...>::type
+template <typename Result, typename LeftArray,
+          typename RightArray = LeftArray>
+using fused_array_t =
+    typename fused_array<Result, LeftArray, RightArray>::type;
+
+}  // namespace detail
+}  // namespace expressions
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_EXPRESSIONS_FUSED_KERNEL_H__INCLUDED
@@ -28,6 +28,7 @@
 
 #include <TiledArray/dist_eval/array_eval.h>
 #include <TiledArray/expressions/expr_engine.h>
+#include <TiledArray/expressions/permopt.h>
 
 namespace TiledArray {
 namespace expressions {
@@ -79,6 +80,7 @@ class LeafEngine : public ExprEngine<Derived> {
   using ExprEngine_::world_;
 
   array_type array_;  ///< The array object
+  const void* array_id_;  ///< The address of the expression's array object
 
  public:
   /// Engine constructor
@@ -86,7 +88,9 @@ class LeafEngine : public ExprEngine<Derived> {
   /// \param expr The argument expression
   template <typename D>
   LeafEngine(const Expr<D>& expr)
-      : ExprEngine_(expr), array_(expr.derived().array()) {
+      : ExprEngine_(expr),
+        array_(expr.derived().array()),
+        array_id_(&expr.derived().array()) {
     indices_ = BipartiteIndexList(expr.derived().annotation());
   }
 
@@ -144,6 +148,15 @@ class LeafEngine : public ExprEngine<Derived> {
     return perm * array_.trange();
   }
 
+  /// Size estimate of the result
+
+  /// \return The size of the (outer) tensor of this expression
+  VolumeEstimate volume_estimate() const {
+    return VolumeEstimate(outer(indices_), derived().make_trange(),
+                          1.0 - array_.shape().sparsity(),
+                          sizeof(typename array_type::numeric_type));
+  }
+
   /// Non-permuting shape factory function
 
   /// \return The result shape
@@ -157,6 +170,40 @@ class LeafEngine : public ExprEngine<Derived> {
     return array_.shape().perm(perm);
   }
 
+  /// Structural key of this expression
+
+  /// Leaves are identified by their array object and by the number of
+  /// assignments to it that precede the statement of the ExprDAG that is
+  /// analyzed or evaluated.
+  /// \return The key of this leaf
+  std::string structural_key() const {
+    const ExprDAG* dag = ExprDAG::active();
+    std::stringstream ss;
+    ss << ExprEngine_::structural_key() << "{" << array_id_ << "#"
+       << (dag ? dag->version(array_id_) : 0u) << "}";
+    return ss.str();
+  }
+
+  /// Fusion check
+
+  /// A leaf can be fused into the kernel of its parent; if its index list
+  /// differs from that of the parent, the fused kernel reads its tiles with
+  /// permuted strides.
+  /// \return \c true if this leaf can be fused
+  bool fusable(const bool) const { return !ExprEngine_::override_ptr_; }
+
+  /// Append the array of this leaf to the leaf arrays of a fused expression
+
+  /// \param arrays The leaf arrays
+  /// \param perms The permutations that map the index lists of the leaf
+  /// arrays to that of the fused expression
+  template <typename A>
+  void fused_arrays(std::vector<A>& arrays,
+                    std::vector<Permutation>& perms) const {
+    arrays.push_back(array_);
+    perms.push_back(outer(perm_));
+  }
+
   /// Construct the distributed evaluator for array
   dist_eval_type make_dist_eval() const {
     // Define the distributed evaluator implementation type
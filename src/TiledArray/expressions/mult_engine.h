@@ -39,6 +39,8 @@ namespace expressions {
 template <typename, typename>
 class MultExpr;
 template <typename, typename, typename>
+class MixedMultExpr;
+template <typename, typename, typename>
 class ScalMultExpr;
 template <typename, typename, typename>
 class MultEngine;
@@ -238,6 +240,10 @@ class MultEngine : public ContEngine<MultEngine<Left, Right, Result>> {
       typename EngineTrait<MultEngine_>::shape_type shape_type;  ///< Shape type
   typedef typename EngineTrait<MultEngine_>::pmap_interface
       pmap_interface;  ///< Process map interface type
+  typedef detail::fused_array_t<value_type,
+                                typename left_type::fused_array_type,
+                                typename right_type::fused_array_type>
+      fused_array_type;  ///< Leaf array type of fused expressions
 
  public:
   /// Constructor
@@ -248,6 +254,15 @@ class MultEngine : public ContEngine<MultEngine<Left, Right, Result>> {
   template <typename L, typename R>
   MultEngine(const MultExpr<L, R>& expr) : ContEngine_(expr) {}
 
+  /// Constructor
+
+  /// \tparam L The left-hand argument expression type
+  /// \tparam R The right-hand argument expression type
+  /// \tparam T The result tile type
+  /// \param expr The parent expression
+  template <typename L, typename R, typename T>
+  MultEngine(const MixedMultExpr<L, R, T>& expr) : ContEngine_(expr) {}
+
   /// Set the index list for this expression
 
   /// This function will set the index list for this expression and its
@@ -353,6 +368,19 @@ class MultEngine : public ContEngine<MultEngine<Left, Right, Result>> {
       BinaryEngine_::init_distribution(world, pmap);
   }
 
+  /// Size estimate of the result
+
+  /// \return The estimated size of the result, computed from the estimates
+  /// of the arguments
+  VolumeEstimate volume_estimate() const {
+    if (this->product_type() == TensorProduct::Contraction)
+      return ContEngine_::volume_estimate();
+    else
+      return VolumeEstimate::elementwise(
+          BinaryEngine_::left_.volume_estimate(),
+          BinaryEngine_::right_.volume_estimate(), true);
+  }
+
   /// Non-permuting tiled range factory function
 
   /// \return The result tiled range object
@@ -403,6 +431,10 @@ class MultEngine : public ContEngine<MultEngine<Left, Right, Result>> {
                                 // dimensions as well
         return op_type(op_base_type());
       } else if (inner_prod == TensorProduct::Contraction) {
+        // a built-in inner product is passed by type, so that the tiles can
+        // apply it to their inner tensors directly
+        if (this->elem_muladd_kernel_)
+          return op_type(op_base_type(*this->elem_muladd_kernel_));
         return op_type(op_base_type(this->inner_tile_return_op_));
       } else
         abort();
@@ -428,6 +460,8 @@ class MultEngine : public ContEngine<MultEngine<Left, Right, Result>> {
                                 // dimensions as well
         return op_type(op_base_type(), perm);
       } else if (inner_prod == TensorProduct::Contraction) {
+        if (this->elem_muladd_kernel_)
+          return op_type(op_base_type(*this->elem_muladd_kernel_), perm);
         return op_type(op_base_type(this->inner_tile_return_op_), perm);
       } else
         abort();
@@ -437,6 +471,25 @@ class MultEngine : public ContEngine<MultEngine<Left, Right, Result>> {
     abort();  // unreachable
   }
 
+  /// Fusion check
+
+  /// Only Hadamard products are element-wise.
+  /// \param root \c true if this engine is the root of the fused expression
+  /// \return \c true if this expression can be evaluated by a fused kernel
+  bool fusable(const bool root) const {
+    return this->product_type() == TensorProduct::Hadamard &&
+           BinaryEngine_::fusable(root);
+  }
+
+  /// Fused element kernel factory function
+
+  /// \return The element kernel of this expression
+  auto fused_kernel() const {
+    return make_fused_binary<std::multiplies<>>(
+        BinaryEngine_::left_.fused_kernel(),
+        BinaryEngine_::right_.fused_kernel());
+  }
+
   /// Construct the distributed evaluator for this expression
 
   /// \return The distributed evaluator that will evaluate this expression
@@ -513,6 +566,10 @@ class ScalMultEngine
       shape_type;  ///< Shape type
   typedef typename EngineTrait<ScalMultEngine_>::pmap_interface
       pmap_interface;  ///< Process map interface type
+  typedef detail::fused_array_t<value_type,
+                                typename left_type::fused_array_type,
+                                typename right_type::fused_array_type>
+      fused_array_type;  ///< Leaf array type of fused expressions
 
  public:
   /// Constructor
@@ -616,6 +673,19 @@ class ScalMultEngine
       return BinaryEngine_::make_dist_eval();
   }
 
+  /// Size estimate of the result
+
+  /// \return The estimated size of the result, computed from the estimates
+  /// of the arguments
+  VolumeEstimate volume_estimate() const {
+    if (this->product_type() == TensorProduct::Contraction)
+      return ContEngine_::volume_estimate();
+    else
+      return VolumeEstimate::elementwise(
+          BinaryEngine_::left_.volume_estimate(),
+          BinaryEngine_::right_.volume_estimate(), true);
+  }
+
   /// Non-permuting tiled range factory function
 
   /// \return The result tiled range object
@@ -671,6 +741,26 @@ class ScalMultEngine
     return op_type(op_base_type(ContEngine_::factor_), perm);
   }
 
+  /// Fusion check
+
+  /// Only Hadamard products are element-wise.
+  /// \param root \c true if this engine is the root of the fused expression
+  /// \return \c true if this expression can be evaluated by a fused kernel
+  bool fusable(const bool root) const {
+    return this->product_type() == TensorProduct::Hadamard &&
+           BinaryEngine_::fusable(root);
+  }
+
+  /// Fused element kernel factory function
+
+  /// \return The element kernel of this expression
+  auto fused_kernel() const {
+    const auto kernel = make_fused_binary<std::multiplies<>>(
+        BinaryEngine_::left_.fused_kernel(),
+        BinaryEngine_::right_.fused_kernel());
+    return make_fused_scal(kernel, ContEngine_::factor_);
+  }
+
   /// Expression identification tag
 
   /// \return An expression tag used to identify this expression
@@ -62,6 +62,20 @@ struct ExprTrait<MultExpr<Left, Right> > {
       scalar_type;  ///< Multiplication result scalar type
 };
 
+template <typename Left, typename Right, typename Result>
+struct ExprTrait<MixedMultExpr<Left, Right, Result> > {
+  typedef Left left_type;      ///< The left-hand expression type
+  typedef Right right_type;    ///< The right-hand expression type
+  typedef Result result_type;  ///< Result tile type
+  typedef MultEngine<typename ExprTrait<Left>::engine_type,
+                     typename ExprTrait<Right>::engine_type, result_type>
+      engine_type;  ///< Expression engine type
+  typedef numeric_t<typename EngineTrait<engine_type>::eval_type>
+      numeric_type;  ///< Multiplication result numeric type
+  typedef scalar_t<typename EngineTrait<engine_type>::eval_type>
+      scalar_type;  ///< Multiplication result scalar type
+};
+
 template <typename Left, typename Right, typename Scalar>
 struct ExprTrait<ScalMultExpr<Left, Right, Scalar> > {
   typedef Left left_type;      ///< The left-hand expression type
@@ -133,8 +147,61 @@ class MultExpr : public BinaryExpr<MultExpr<Left, Right> > {
     return BinaryExpr_::left().dot(BinaryExpr_::right());
   }
 
+  /// Multiplication with an explicit result tile type
+
+  /// The product of two single-precision arrays is, by default, a
+  /// single-precision array. Requesting a double-precision result tile, e.g.
+  /// \code
+  /// c("i,j") = (a("i,k") * b("k,j")).accumulate_as<TA::Tensor<double>>();
+  /// \endcode
+  /// accumulates the contraction in double precision (see ContractReduce)
+  /// without converting the arguments.
+  /// \tparam Tile The result tile type
+  /// \return A multiplication expression with result tiles of type \c Tile
+  template <typename Tile>
+  MixedMultExpr<Left, Right, Tile> accumulate_as() const {
+    return MixedMultExpr<Left, Right, Tile>(BinaryExpr_::left(),
+                                            BinaryExpr_::right());
+  }
+
 };  // class MultExpr
 
+/// Multiplication expression with an explicit result tile type
+
+/// \tparam Left The left-hand expression type
+/// \tparam Right The right-hand expression type
+/// \tparam Result The result tile type
+/// \sa MultExpr::accumulate_as
+template <typename Left, typename Right, typename Result>
+class MixedMultExpr : public BinaryExpr<MixedMultExpr<Left, Right, Result> > {
+ public:
+  typedef MixedMultExpr<Left, Right, Result>
+      MixedMultExpr_;  ///< This class type
+  typedef BinaryExpr<MixedMultExpr_>
+      BinaryExpr_;  ///< Binary expression base type
+  typedef typename ExprTrait<MixedMultExpr_>::left_type
+      left_type;  ///< The left-hand expression type
+  typedef typename ExprTrait<MixedMultExpr_>::right_type
+      right_type;  ///< The right-hand expression type
+  typedef typename ExprTrait<MixedMultExpr_>::engine_type
+      engine_type;  ///< Expression engine type
+
+  // Compiler generated functions
+  MixedMultExpr(const MixedMultExpr_&) = default;
+  MixedMultExpr(MixedMultExpr_&&) = default;
+  ~MixedMultExpr() = default;
+  MixedMultExpr_& operator=(const MixedMultExpr_&) = delete;
+  MixedMultExpr_& operator=(MixedMultExpr_&&) = delete;
+
+  /// Expression constructor
+
+  /// \param left The left-hand expression
+  /// \param right The right-hand expression
+  MixedMultExpr(const left_type& left, const right_type& right)
+      : BinaryExpr_(left, right) {}
+
+};  // class MixedMultExpr
+
 /// Multiplication expression
 
 /// \tparam Left The left-hand expression type
@@ -29,7 +29,16 @@
 #include <TiledArray/expressions/index_list.h>
 #include <TiledArray/expressions/product.h>
 #include <TiledArray/permutation.h>
+#include <TiledArray/tiled_range.h>
+#include <TiledArray/util/vector.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <ostream>
+#include <vector>
 
 namespace TiledArray {
 namespace expressions {
@@ -43,6 +52,21 @@ namespace expressions {
 // clang-format on
 enum class PermutationType { identity = 1, matrix_transpose = 2, general = 3 };
 
+inline std::ostream& operator<<(std::ostream& os, PermutationType permtype) {
+  switch (permtype) {
+    case PermutationType::identity:
+      os << "identity";
+      break;
+    case PermutationType::matrix_transpose:
+      os << "matrix transpose";
+      break;
+    case PermutationType::general:
+      os << "general";
+      break;
+  }
+  return os;
+}
+
 inline blas::Op to_cblas_op(PermutationType permtype) {
   TA_ASSERT(permtype == PermutationType::matrix_transpose ||
             permtype == PermutationType::identity);
@@ -134,27 +158,36 @@ class GEMMPermutationOptimizer : public BinaryOpPermutationOptimizer {
       default;
   virtual ~GEMMPermutationOptimizer() = default;
 
+  /// \param left_indices the initial left argument index list
+  /// \param right_indices the initial right argument index list
+  /// \param prefer_to_permute_left whether to prefer permuting left argument
+  /// \param strict_preference if \c false , the argument with the lower rank
+  /// is permuted regardless of \p prefer_to_permute_left
   GEMMPermutationOptimizer(const IndexList& left_indices,
                            const IndexList& right_indices,
-                           const bool prefer_to_permute_left = true)
+                           const bool prefer_to_permute_left = true,
+                           const bool strict_preference = false)
       : BinaryOpPermutationOptimizer(left_indices, right_indices,
                                      prefer_to_permute_left) {
     std::tie(target_left_indices_, target_right_indices_,
              target_result_indices_, left_permtype_, right_permtype_) =
         compute_index_list_contraction(left_indices, right_indices,
-                                       prefer_to_permute_left);
+                                       prefer_to_permute_left,
+                                       strict_preference);
   }
 
   GEMMPermutationOptimizer(const IndexList& result_indices,
                            const IndexList& left_indices,
                            const IndexList& right_indices,
-                           const bool prefer_to_permute_left = true)
+                           const bool prefer_to_permute_left = true,
+                           const bool strict_preference = false)
       : BinaryOpPermutationOptimizer(left_indices, right_indices,
                                      prefer_to_permute_left) {
     std::tie(target_left_indices_, target_right_indices_,
              target_result_indices_, left_permtype_, right_permtype_) =
         compute_index_list_contraction(left_indices, right_indices,
-                                       prefer_to_permute_left);
+                                       prefer_to_permute_left,
+                                       strict_preference);
   }
 
   const IndexList& target_left_indices() const override final {
@@ -201,7 +234,8 @@ class GEMMPermutationOptimizer : public BinaryOpPermutationOptimizer {
                     PermutationType>
   compute_index_list_contraction(const IndexList& left_indices,
                                  const IndexList& right_indices,
-                                 const bool prefer_to_permute_left = true) {
+                                 const bool prefer_to_permute_left = true,
+                                 const bool strict_preference = false) {
     const auto left_rank = left_indices.size();
     const auto right_rank = right_indices.size();
 
@@ -259,11 +293,14 @@ class GEMMPermutationOptimizer : public BinaryOpPermutationOptimizer {
     // If the inner index lists of the arguments are not in the same
     // order, one of them will need to be permuted. Here, we determine which
     // argument, left or right, will be permuted if a permutation is
-    // required. The argument with the lowest rank is preferred since it is
-    // likely to have the smaller memory footprint.
+    // required. Unless the preference is strict, the argument with the lowest
+    // rank is preferred since it is likely to have the smaller memory
+    // footprint.
     const bool perm_left =
-        (left_rank < right_rank) ||
-        ((left_rank == right_rank) && prefer_to_permute_left);
+        strict_preference
+            ? prefer_to_permute_left
+            : (left_rank < right_rank) ||
+                  ((left_rank == right_rank) && prefer_to_permute_left);
 
     // Extract variables from the right-hand argument, collect information
     // about the layout of the index lists, and ensure the inner variable
@@ -527,6 +564,416 @@ class NullBinaryOpPermutationOptimizer : public BinaryOpPermutationOptimizer {
   }
 };
 
+/// Estimated size of the tensor produced by an expression
+
+/// The cost of permuting a tensor is proportional to the amount of data it
+/// holds. This object records the number of elements and tiles along each
+/// (outer) index of a tensor, the fraction of its tiles that are nonzero, and
+/// the size of its elements. The estimates of expressions are computed
+/// bottom-up from the tiled ranges and the shapes of the leaf arrays.
+class VolumeEstimate {
+ public:
+  /// The number of elements and tiles along an index
+  struct Extent {
+    double elements;
+    double tiles;
+  };
+
+  /// Constructs an unknown estimate
+  VolumeEstimate() = default;
+
+  /// Constructs the estimate of an array
+
+  /// \param indices the index list of the array
+  /// \param trange the tiled range of the array
+  /// \param density the fraction of nonzero tiles
+  /// \param element_size the size of the elements, in bytes
+  VolumeEstimate(const IndexList& indices, const TiledRange& trange,
+                 const double density, const std::size_t element_size)
+      : density_(density), element_size_(element_size) {
+    TA_ASSERT(indices.size() == trange.rank());
+    extents_.reserve(indices.size());
+    for (unsigned int d = 0u; d < indices.size(); ++d) {
+      const auto& trange1 = trange.dim(d);
+      extents_.emplace_back(
+          indices[d],
+          Extent{double(trange1.extent()), double(trange1.tile_extent())});
+    }
+  }
+
+  /// \return \c true if the size of the tensor is not known
+  bool empty() const { return element_size_ == 0ul; }
+
+  /// \return the fraction of nonzero tiles
+  double density() const { return density_; }
+
+  /// \return the size of the elements, in bytes
+  std::size_t element_size() const { return element_size_; }
+
+  /// \return the indices of the tensor
+  IndexList indices() const {
+    IndexList::container_type result;
+    result.reserve(extents_.size());
+    for (const auto& extent : extents_) result.push_back(extent.first);
+    return IndexList(result);
+  }
+
+  /// \param index an index of the tensor
+  /// \return the extent of the tensor along \p index
+  const Extent& extent(const std::string& index) const {
+    const auto it = find(index);
+    TA_ASSERT(it != extents_.end());
+    return it->second;
+  }
+
+  /// \return the estimated number of nonzero elements
+  double elements() const {
+    double result = density_;
+    for (const auto& extent : extents_) result *= extent.second.elements;
+    return result;
+  }
+
+  /// \return the estimated amount of data, in bytes
+  double bytes() const { return elements() * element_size_; }
+
+  /// Estimate of an element-wise operation
+
+  /// \param left the estimate of the left argument
+  /// \param right the estimate of the right argument
+  /// \param intersection if \c true, a tile of the result is nonzero only if
+  /// the tiles of both arguments are (e.g. for a Hadamard product); otherwise
+  /// it is nonzero if either tile is (e.g. for a sum)
+  /// \return the estimate of the result
+  static VolumeEstimate elementwise(const VolumeEstimate& left,
+                                    const VolumeEstimate& right,
+                                    const bool intersection) {
+    if (left.empty() || right.empty()) return VolumeEstimate();
+    VolumeEstimate result = left;
+    result.density_ =
+        (intersection ? left.density_ * right.density_
+                      : std::min(1.0, left.density_ + right.density_));
+    result.element_size_ = std::max(left.element_size_, right.element_size_);
+    return result;
+  }
+
+  /// Estimate of a contraction
+
+  /// The indices that appear in both arguments are contracted. A tile of the
+  /// result is nonzero if any of the products of the argument tiles that
+  /// contribute to it is nonzero.
+  /// \param left the estimate of the left argument
+  /// \param right the estimate of the right argument
+  /// \return the estimate of the result
+  static VolumeEstimate contraction(const VolumeEstimate& left,
+                                    const VolumeEstimate& right) {
+    if (left.empty() || right.empty()) return VolumeEstimate();
+    VolumeEstimate result;
+    result.element_size_ = std::max(left.element_size_, right.element_size_);
+    double inner_tiles = 1.0;
+    for (const auto& extent : left.extents_) {
+      if (right.find(extent.first) == right.extents_.end())
+        result.extents_.push_back(extent);
+      else
+        inner_tiles *= extent.second.tiles;
+    }
+    for (const auto& extent : right.extents_)
+      if (left.find(extent.first) == left.extents_.end())
+        result.extents_.push_back(extent);
+    result.density_ =
+        1.0 - std::pow(1.0 - left.density_ * right.density_, inner_tiles);
+    return result;
+  }
+
+ private:
+  container::svector<std::pair<std::string, Extent>> extents_;
+  double density_ = 1.0;           ///< fraction of nonzero tiles
+  std::size_t element_size_ = 0ul;  ///< element size; 0 if unknown
+
+  auto find(const std::string& index) const {
+    return std::find_if(
+        extents_.begin(), extents_.end(),
+        [&index](const auto& extent) { return extent.first == index; });
+  }
+};
+
+// clang-format off
+/// Cost-based optimizer of the permutations of a binary operation
+
+/// The optimizers above choose the argument to permute from the structure of
+/// the index lists and a static preference. This optimizer compares the
+/// candidate plans, i.e. the layouts into which the arguments and the result
+/// can be permuted, and picks the plan that moves the least data:
+/// - permuting an argument costs its volume, unless the permutation is the
+///   identity or is folded into GEMM as a matrix transpose;
+/// - permuting the result into the desired result layout costs the volume of
+///   the result.
+///
+/// The volumes are estimated from the tiled ranges and the shapes of the
+/// arguments (see VolumeEstimate); since the estimates of the arguments
+/// account for their own subexpressions, the plans of a chain of products
+/// are chosen using the sizes of the intermediates. Ties are broken by the
+/// static preference. If a volume is unknown, this reduces to the index-based
+/// optimizers.
+// clang-format on
+class CostBasedPermutationOptimizer : public BinaryOpPermutationOptimizer {
+ public:
+  CostBasedPermutationOptimizer(const CostBasedPermutationOptimizer&) =
+      default;
+  CostBasedPermutationOptimizer& operator=(
+      const CostBasedPermutationOptimizer&) = default;
+  ~CostBasedPermutationOptimizer() = default;
+
+  /// \param product_type the type of the binary operation
+  /// \param left_indices the initial left argument index list
+  /// \param right_indices the initial right argument index list
+  /// \param left_volume the size estimate of the left argument
+  /// \param right_volume the size estimate of the right argument
+  /// \param result_volume the size estimate of the result
+  /// \param prefer_to_permute_left whether to prefer permuting left argument
+  CostBasedPermutationOptimizer(TensorProduct product_type,
+                                const IndexList& left_indices,
+                                const IndexList& right_indices,
+                                const VolumeEstimate& left_volume,
+                                const VolumeEstimate& right_volume,
+                                const VolumeEstimate& result_volume,
+                                const bool prefer_to_permute_left = true)
+      : BinaryOpPermutationOptimizer(left_indices, right_indices,
+                                     prefer_to_permute_left),
+        op_type_(product_type),
+        left_volume_(left_volume),
+        right_volume_(right_volume),
+        result_volume_(result_volume) {
+    optimize(IndexList());
+  }
+
+  /// \param product_type the type of the binary operation
+  /// \param result_indices the desired result index list
+  /// \param left_indices the initial left argument index list
+  /// \param right_indices the initial right argument index list
+  /// \param left_volume the size estimate of the left argument
+  /// \param right_volume the size estimate of the right argument
+  /// \param result_volume the size estimate of the result
+  /// \param prefer_to_permute_left whether to prefer permuting left argument
+  CostBasedPermutationOptimizer(TensorProduct product_type,
+                                const IndexList& result_indices,
+                                const IndexList& left_indices,
+                                const IndexList& right_indices,
+                                const VolumeEstimate& left_volume,
+                                const VolumeEstimate& right_volume,
+                                const VolumeEstimate& result_volume,
+                                const bool prefer_to_permute_left = true)
+      : BinaryOpPermutationOptimizer(result_indices, left_indices,
+                                     right_indices, prefer_to_permute_left),
+        op_type_(product_type),
+        left_volume_(left_volume),
+        right_volume_(right_volume),
+        result_volume_(result_volume) {
+    optimize(result_indices);
+  }
+
+  const IndexList& target_left_indices() const override final {
+    return target_left_indices_;
+  }
+  const IndexList& target_right_indices() const override final {
+    return target_right_indices_;
+  }
+  const IndexList& target_result_indices() const override final {
+    return target_result_indices_;
+  }
+  PermutationType left_permtype() const override final {
+    return left_permtype_;
+  }
+  PermutationType right_permtype() const override final {
+    return right_permtype_;
+  }
+  TensorProduct op_type() const override final { return op_type_; }
+
+  /// \return \c true if the plan was chosen by comparing costs, \c false if
+  /// a volume was unknown
+  bool costed() const { return costed_; }
+
+  /// \return the estimated amount of data moved by the chosen plan, in bytes
+  double cost() const { return cost_; }
+
+  /// Print the chosen plan
+
+  /// \param os the output stream
+  void print(std::ostream& os) const {
+    os << "[permutation plan] "
+       << (op_type_ == TensorProduct::Contraction ? "contraction" : "hadamard")
+       << ": left " << left_indices() << " -> " << target_left_indices_ << " ("
+       << left_permtype_ << "), right " << right_indices() << " -> "
+       << target_right_indices_ << " (" << right_permtype_ << "), result "
+       << target_result_indices_;
+    if (desired_result_indices_ &&
+        desired_result_indices_ != target_result_indices_)
+      os << " -> " << desired_result_indices_;
+    if (costed_)
+      os << "; moves " << cost_ << " bytes";
+    else
+      os << "; volumes unknown";
+  }
+
+ private:
+  TensorProduct op_type_;
+  VolumeEstimate left_volume_, right_volume_, result_volume_;
+  IndexList desired_result_indices_;
+  IndexList target_left_indices_, target_right_indices_, target_result_indices_;
+  PermutationType left_permtype_ = PermutationType::general;
+  PermutationType right_permtype_ = PermutationType::general;
+  bool costed_ = false;
+  double cost_ = 0.0;
+
+  /// A candidate plan
+  struct Plan {
+    IndexList left, right, result;
+    PermutationType left_permtype, right_permtype;
+
+    Plan(const BinaryOpPermutationOptimizer& opt)
+        : left(opt.target_left_indices()),
+          right(opt.target_right_indices()),
+          result(opt.target_result_indices()),
+          left_permtype(opt.left_permtype()),
+          right_permtype(opt.right_permtype()) {}
+
+    Plan(const IndexList& left, const IndexList& right, const IndexList& result,
+         const PermutationType left_permtype,
+         const PermutationType right_permtype)
+        : left(left),
+          right(right),
+          result(result),
+          left_permtype(left_permtype),
+          right_permtype(right_permtype) {}
+  };
+
+  /// \return the estimated amount of data moved by \p plan , in bytes
+  double cost(const Plan& plan) const {
+    auto arg_cost = [](const IndexList& indices, const IndexList& target,
+                       const PermutationType permtype,
+                       const VolumeEstimate& volume) {
+      return (indices == target || permtype != PermutationType::general)
+                 ? 0.0
+                 : volume.bytes();
+    };
+    double result = arg_cost(left_indices(), plan.left, plan.left_permtype,
+                             left_volume_) +
+                    arg_cost(right_indices(), plan.right, plan.right_permtype,
+                             right_volume_);
+    if (desired_result_indices_ && desired_result_indices_ != plan.result)
+      result += result_volume_.bytes();
+    return result;
+  }
+
+  /// Adopt \p plan
+  void adopt(const Plan& plan) {
+    target_left_indices_ = plan.left;
+    target_right_indices_ = plan.right;
+    target_result_indices_ = plan.result;
+    left_permtype_ = plan.left_permtype;
+    right_permtype_ = plan.right_permtype;
+  }
+
+  /// The plan of a contraction that produces the result in the layout of
+  /// \p result_indices by permuting both arguments
+
+  /// \param result_indices the desired result index list
+  /// \return the plan, or an empty optional if the free indices of the left
+  /// argument do not precede those of the right argument in \p result_indices
+  std::optional<Plan> make_result_layout_plan(
+      const IndexList& result_indices) const {
+    // the contracted indices, in the order of the left argument
+    container::svector<std::string> inner_indices;
+    for (const auto& index : left_indices())
+      if (right_indices().count(index)) inner_indices.push_back(index);
+
+    const unsigned int left_outer_rank =
+        left_indices().size() - inner_indices.size();
+    container::svector<std::string> left, right(inner_indices);
+    for (unsigned int i = 0u; i < result_indices.size(); ++i) {
+      const bool in_left = left_indices().count(result_indices[i]);
+      if (in_left != (i < left_outer_rank)) return {};
+      (in_left ? left : right).push_back(result_indices[i]);
+    }
+    left.insert(left.end(), inner_indices.begin(), inner_indices.end());
+
+    auto permtype = [](const IndexList& indices, const IndexList& target) {
+      return indices == target ? PermutationType::identity
+                               : PermutationType::general;
+    };
+    const IndexList left_target(left), right_target(right);
+    return Plan(left_target, right_target, result_indices,
+                permtype(left_indices(), left_target),
+                permtype(right_indices(), right_target));
+  }
+
+  void optimize(const IndexList& result_indices) {
+    desired_result_indices_ = result_indices;
+    const bool prefer_left = prefer_to_permute_left();
+    costed_ = !(left_volume_.empty() || right_volume_.empty() ||
+                (result_indices && result_volume_.empty()));
+
+    // The candidate plans, in the order of preference
+    std::vector<Plan> candidates;
+    if (op_type_ == TensorProduct::Contraction) {
+      if (!costed_) {
+        adopt(GEMMPermutationOptimizer(left_indices(), right_indices(),
+                                       prefer_left));
+        return;
+      }
+      // GEMM with either argument permuted to match the other ...
+      candidates.emplace_back(GEMMPermutationOptimizer(
+          left_indices(), right_indices(), prefer_left, true));
+      candidates.emplace_back(GEMMPermutationOptimizer(
+          left_indices(), right_indices(), !prefer_left, true));
+      // ... or with both arguments permuted so that the result is produced
+      // in the desired layout
+      if (result_indices) {
+        if (auto plan = make_result_layout_plan(result_indices))
+          candidates.push_back(*plan);
+      }
+    } else {
+      TA_ASSERT(op_type_ == TensorProduct::Hadamard);
+      TA_ASSERT(left_indices().is_permutation(right_indices()));
+      TA_ASSERT(!result_indices ||
+                left_indices().is_permutation(result_indices));
+      if (!costed_) {
+        if (result_indices)
+          adopt(HadamardPermutationOptimizer(result_indices, left_indices(),
+                                             right_indices(), prefer_left));
+        else
+          adopt(HadamardPermutationOptimizer(left_indices(), right_indices(),
+                                             prefer_left));
+        return;
+      }
+      // A Hadamard product may be computed in the layout of either argument
+      // or in the layout of the result
+      const auto general = PermutationType::general;
+      for (const auto& layout :
+           {prefer_left ? right_indices() : left_indices(),
+            prefer_left ? left_indices() : right_indices()})
+        candidates.emplace_back(layout, layout, layout, general, general);
+      if (result_indices)
+        candidates.emplace_back(result_indices, result_indices, result_indices,
+                                general, general);
+    }
+
+    cost_ = std::numeric_limits<double>::max();
+    for (const auto& candidate : candidates) {
+      const double candidate_cost = cost(candidate);
+      if (candidate_cost < cost_) {
+        cost_ = candidate_cost;
+        adopt(candidate);
+      }
+    }
+  }
+};
+
+inline std::ostream& operator<<(std::ostream& os,
+                                const CostBasedPermutationOptimizer& opt) {
+  opt.print(os);
+  return os;
+}
+
 inline std::shared_ptr<BinaryOpPermutationOptimizer> make_permutation_optimizer(
     TensorProduct product_type, const IndexList& left_indices,
     const IndexList& right_indices, bool prefer_to_permute_left) {
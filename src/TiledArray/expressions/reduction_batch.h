@@ -0,0 +1,320 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_REDUCTION_BATCH_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_REDUCTION_BATCH_H__INCLUDED
+
+#include <TiledArray/expressions/expr.h>
+#include <TiledArray/reduce_task.h>
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace TiledArray {
+namespace expressions {
+
+namespace detail {
+
+/// Collective reduction operation for a batch of type-erased reductions
+
+/// The rank-local results of all reductions in a batch are packed
+/// (bitwise) into a single buffer; this operation combines two such buffers
+/// entry by entry using the reduction operation of each entry.
+class BatchReduction {
+ public:
+  typedef std::vector<unsigned char> result_type;
+  typedef result_type argument_type;
+  /// Combines the packed result of a single reduction, \c result += \c arg
+  typedef std::function<void(unsigned char* result, const unsigned char* arg)>
+      combine_type;
+  /// An entry of the batch: offset in the packed buffer and combine op
+  typedef std::pair<std::size_t, combine_type> entry_type;
+
+  BatchReduction() = default;
+  explicit BatchReduction(
+      std::shared_ptr<const std::vector<entry_type>> entries)
+      : entries_(std::move(entries)) {}
+
+  // Make an empty result object
+  result_type operator()() const { return result_type(); }
+
+  // Post process the result
+  const result_type& operator()(const result_type& result) const {
+    return result;
+  }
+
+  // Reduce two result objects
+  void operator()(result_type& result, const argument_type& arg) const {
+    if (arg.empty()) return;
+    if (result.empty()) {
+      result = arg;
+      return;
+    }
+    TA_ASSERT(result.size() == arg.size());
+    for (const auto& entry : *entries_)
+      entry.second(result.data() + entry.first, arg.data() + entry.first);
+  }
+
+ private:
+  std::shared_ptr<const std::vector<entry_type>> entries_;
+};  // class BatchReduction
+
+}  // namespace detail
+
+/// A batch of reductions that are combined with a single collective
+
+/// Every reduction added to the batch evaluates its expression(s) and
+/// reduces the local tiles immediately (see Expr::reduce_local), without
+/// communication; the rank-local results of all reductions are then combined
+/// with a single all-reduce when the batch is submitted. Every member that
+/// adds a reduction returns a future to its result, so that the caller can
+/// continue with other work and wait for the results later:
+/// \code
+/// ReductionBatch batch(world);
+/// auto r_norm = batch.norm(r("i,j"));
+/// auto rz = batch.dot(r("i,j"), z("i,j"));
+/// auto r_max = batch.abs_max(r("i,j"));
+/// batch.submit();
+/// // ... other work ...
+/// const double alpha = rz.get() / r_norm.get();
+/// \endcode
+/// The result types of the reductions must be trivially copyable (all
+/// reductions provided by TiledArray produce scalars).
+/// \note Like all collectives, reductions must be added to batches, and
+/// batches submitted, in the same order on every rank of the World.
+class ReductionBatch {
+ public:
+  /// Constructor
+
+  /// \param world The world where the reductions are evaluated
+  explicit ReductionBatch(World& world)
+      : world_(world),
+        entries_(std::make_shared<
+                 std::vector<detail::BatchReduction::entry_type>>()) {}
+
+  ReductionBatch(const ReductionBatch&) = delete;
+  ReductionBatch& operator=(const ReductionBatch&) = delete;
+
+  /// Destructor
+
+  /// The batch is not submitted by the destructor, since the destructor may
+  /// run on some ranks only, e.g. while an exception unwinds the stack, and
+  /// the other ranks would then wait for the collective forever. A warning is
+  /// printed if reductions were added but the batch was not submitted; the
+  /// futures to their results are never set.
+  ~ReductionBatch() {
+    if (!submitted_ && !local_results_.empty())
+      TA_USER_ERROR_MESSAGE(
+          "ReductionBatch destroyed before submit(), the results of its "
+          << size() << " reductions will never be set");
+  }
+
+  /// Adds a unary reduction to the batch
+
+  /// \tparam D The expression type
+  /// \tparam Op The reduction operation type (see e.g. SumReduction)
+  /// \param expr The expression to be reduced
+  /// \param op The reduction operation
+  /// \return A future to the result of the reduction, set after submit()
+  template <typename D, typename Op>
+  Future<typename Op::result_type> reduce(const Expr<D>& expr, const Op& op) {
+    TA_ASSERT(!submitted_);
+    return add(expr.reduce_local(op, world_), op);
+  }
+
+  /// Adds a binary reduction to the batch
+
+  /// \tparam Left The left-hand expression type
+  /// \tparam Right The right-hand expression type
+  /// \tparam Op The reduction operation type (see e.g. DotReduction)
+  /// \param left The left-hand expression
+  /// \param right The right-hand expression
+  /// \param op The reduction operation
+  /// \return A future to the result of the reduction, set after submit()
+  template <typename Left, typename Right, typename Op>
+  Future<typename Op::result_type> reduce(const Expr<Left>& left,
+                                          const Expr<Right>& right,
+                                          const Op& op) {
+    TA_ASSERT(!submitted_);
+    return add(left.reduce_local(right, op, world_), op);
+  }
+
+  template <typename D>
+  auto sum(const Expr<D>& expr) {
+    return reduce(expr, TiledArray::SumReduction<eval_t<D>>());
+  }
+
+  template <typename D>
+  auto product(const Expr<D>& expr) {
+    return reduce(expr, TiledArray::ProductReduction<eval_t<D>>());
+  }
+
+  template <typename D>
+  auto squared_norm(const Expr<D>& expr) {
+    return reduce(expr, TiledArray::SquaredNormReduction<eval_t<D>>());
+  }
+
+  template <typename D>
+  auto norm(const Expr<D>& expr) {
+    typedef typename TiledArray::SquaredNormReduction<
+        eval_t<D>>::result_type result_type;
+    return world_.taskq.add(
+        [](const result_type& squared_norm) -> result_type {
+          using std::sqrt;
+          return sqrt(squared_norm);
+        },
+        squared_norm(expr));
+  }
+
+  template <typename D>
+  auto min(const Expr<D>& expr) {
+    return reduce(expr, TiledArray::MinReduction<eval_t<D>>());
+  }
+
+  template <typename D>
+  auto max(const Expr<D>& expr) {
+    return reduce(expr, TiledArray::MaxReduction<eval_t<D>>());
+  }
+
+  template <typename D>
+  auto abs_min(const Expr<D>& expr) {
+    return reduce(expr, TiledArray::AbsMinReduction<eval_t<D>>());
+  }
+
+  template <typename D>
+  auto abs_max(const Expr<D>& expr) {
+    return reduce(expr, TiledArray::AbsMaxReduction<eval_t<D>>());
+  }
+
+  template <typename Left, typename Right>
+  auto dot(const Expr<Left>& left, const Expr<Right>& right) {
+    return reduce(left, right,
+                  TiledArray::DotReduction<eval_t<Left>, eval_t<Right>>());
+  }
+
+  template <typename Left, typename Right>
+  auto inner_product(const Expr<Left>& left, const Expr<Right>& right) {
+    return reduce(
+        left, right,
+        TiledArray::InnerProductReduction<eval_t<Left>, eval_t<Right>>());
+  }
+
+  /// Launches the collective that combines the rank-local results
+
+  /// This must be called explicitly, on every rank of the World, once all
+  /// reductions have been added. This does not block; the futures returned by
+  /// the reduction members are set once the collective completes.
+  void submit() {
+    TA_ASSERT(!submitted_);
+    submitted_ = true;
+    if (local_results_.empty()) return;
+
+    // Pack the local results into a single buffer
+    const std::size_t size = size_;
+    auto local_result = world_.taskq.add(
+        [size](const std::vector<Future<packed_type>>& local_results) {
+          packed_type result(size);
+          unsigned char* it = result.data();
+          for (const auto& local_result : local_results) {
+            const auto& packed = local_result.get();
+            std::memcpy(it, packed.data(), packed.size());
+            it += packed.size();
+          }
+          return result;
+        },
+        std::move(local_results_));
+
+    // Combine the local results
+    auto result = world_.gop.all_reduce(
+        TiledArray::detail::next_reduction_key(world_), local_result,
+        detail::BatchReduction(entries_));
+
+    // Unpack the results
+    world_.taskq.add(
+        [setters = std::move(setters_)](const packed_type& result) {
+          for (const auto& setter : setters) setter(result);
+        },
+        result);
+  }
+
+  /// \return the number of reductions in this batch
+  std::size_t size() const { return entries_->size(); }
+
+ private:
+  typedef std::vector<unsigned char> packed_type;
+
+  template <typename D>
+  using eval_t =
+      typename EngineTrait<typename ExprTrait<D>::engine_type>::eval_type;
+
+  template <typename Op>
+  Future<typename Op::result_type> add(
+      const Future<typename Op::result_type>& local_result, const Op& op) {
+    typedef typename Op::result_type result_type;
+    static_assert(std::is_trivially_copyable_v<result_type>,
+                  "ReductionBatch: reduction results must be trivially "
+                  "copyable");
+    const std::size_t offset = size_;
+    size_ += sizeof(result_type);
+
+    local_results_.push_back(world_.taskq.add(
+        [](const result_type& value) {
+          packed_type result(sizeof(result_type));
+          std::memcpy(result.data(), &value, sizeof(result_type));
+          return result;
+        },
+        local_result));
+
+    entries_->emplace_back(
+        offset, [op](unsigned char* result, const unsigned char* arg) {
+          result_type result_value, arg_value;
+          std::memcpy(&result_value, result, sizeof(result_type));
+          std::memcpy(&arg_value, arg, sizeof(result_type));
+          op(result_value, arg_value);
+          std::memcpy(result, &result_value, sizeof(result_type));
+        });
+
+    Future<result_type> result;
+    setters_.emplace_back([offset, result](const packed_type& packed) mutable {
+      result_type value;
+      std::memcpy(&value, packed.data() + offset, sizeof(result_type));
+      result.set(value);
+    });
+    return result;
+  }
+
+  World& world_;
+  bool submitted_ = false;
+  std::size_t size_ = 0;  ///< size of the packed buffer
+  std::shared_ptr<std::vector<detail::BatchReduction::entry_type>> entries_;
+  std::vector<Future<packed_type>> local_results_;
+  std::vector<std::function<void(const packed_type&)>> setters_;
+};  // class ReductionBatch
+
+}  // namespace expressions
+
+using expressions::ReductionBatch;
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_EXPRESSIONS_REDUCTION_BATCH_H__INCLUDED
@@ -108,6 +108,9 @@ class ScalEngine : public UnaryEngine<ScalEngine<Arg, Scalar, Result>> {
       typename EngineTrait<ScalEngine_>::shape_type shape_type;  ///< Shape type
   typedef typename EngineTrait<ScalEngine_>::pmap_interface
       pmap_interface;  ///< Process map interface type
+  typedef detail::fused_array_t<value_type,
+                                typename argument_type::fused_array_type>
+      fused_array_type;  ///< Leaf array type of fused expressions
 
  private:
   scalar_type factor_;  ///< Scaling factor
@@ -152,6 +155,13 @@ class ScalEngine : public UnaryEngine<ScalEngine<Arg, Scalar, Result>> {
     return op_type(perm, factor_);
   }
 
+  /// Fused element kernel factory function
+
+  /// \return The element kernel of this expression
+  auto fused_kernel() const {
+    return make_fused_scal(UnaryEngine_::arg_.fused_kernel(), factor_);
+  }
+
   /// Expression identification tag
 
   /// \return An expression tag used to identify this expression
@@ -161,6 +171,15 @@ class ScalEngine : public UnaryEngine<ScalEngine<Arg, Scalar, Result>> {
     return ss.str();
   }
 
+  /// Expression tag used for structural hashing
+
+  /// \return The expression tag with the exact scaling factor
+  std::string structural_tag() const {
+    std::stringstream ss;
+    ss << make_tag() << std::hexfloat << factor_;
+    return ss.str();
+  }
+
 };  // class ScalEngine
 
 }  // namespace expressions
@@ -112,6 +112,9 @@ class ScalTsrEngine : public LeafEngine<ScalTsrEngine<Array, Scalar, Result>> {
       shape_type;  ///< Tensor shape type
   typedef typename EngineTrait<ScalTsrEngine_>::pmap_interface
       pmap_interface;  ///< Process map interface type
+  typedef detail::fused_array_t<
+      typename EngineTrait<ScalTsrEngine_>::eval_type, array_type>
+      fused_array_type;  ///< Leaf array type of fused expressions
 
  private:
   scalar_type factor_;  ///< The scaling factor
@@ -149,6 +152,13 @@ class ScalTsrEngine : public LeafEngine<ScalTsrEngine<Array, Scalar, Result>> {
     return op_type(op_base_type(factor_), perm);
   }
 
+  /// Fused element kernel factory function
+
+  /// \return The element kernel of this leaf
+  FusedScal<FusedArg, scalar_type> fused_kernel() const {
+    return make_fused_scal(FusedArg(), factor_);
+  }
+
   /// Expression identification tag
 
   /// \return An expression tag used to identify this expression
@@ -158,6 +168,15 @@ class ScalTsrEngine : public LeafEngine<ScalTsrEngine<Array, Scalar, Result>> {
     return ss.str();
   }
 
+  /// Expression tag used for structural hashing
+
+  /// \return The expression tag with the exact scaling factor
+  std::string structural_tag() const {
+    std::stringstream ss;
+    ss << make_tag() << std::hexfloat << factor_;
+    return ss.str();
+  }
+
 };  // class ScalTsrEngine
 
 }  // namespace expressions
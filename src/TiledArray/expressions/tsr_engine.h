@@ -119,6 +119,9 @@ class TsrEngine : public LeafEngine<TsrEngine<Array, Result, Alias>> {
       shape_type;  ///< Tensor shape type
   typedef typename EngineTrait<TsrEngine_>::pmap_interface
       pmap_interface;  ///< Process map interface type
+  typedef detail::fused_array_t<typename EngineTrait<TsrEngine_>::eval_type,
+                                array_type>
+      fused_array_type;  ///< Leaf array type of fused expressions
 
   template <typename A>
   TsrEngine(const TsrExpr<A, Alias>& expr) : LeafEngine_(expr) {}
@@ -138,6 +141,11 @@ class TsrEngine : public LeafEngine<TsrEngine<Array, Result, Alias>> {
     return op_type(op_base_type(), perm);
   }
 
+  /// Fused element kernel factory function
+
+  /// \return The element kernel of this leaf
+  static FusedArg fused_kernel() { return FusedArg(); }
+
 };  // class TsrEngine
 
 }  // namespace expressions
@@ -236,6 +236,54 @@ class TsrExpr : public Expr<TsrExpr<Array, Alias>> {
     return BlkTsrExpr<const Array, Alias>(array_, annotation_, bounds);
   }
 
+  /// Element block expression factory
+
+  /// Unlike block(), the bounds of the block are given in element
+  /// coordinates and need not coincide with the tile boundaries. Tiles that
+  /// are inside the block are used as in block(); only the part of a tile
+  /// on the boundary of the block that lies inside the bounds is copied.
+  /// \tparam Index1 An integral range type
+  /// \tparam Index2 An integral range type
+  /// \param lower_bound The lower bound of the block elements
+  /// \param upper_bound The upper bound of the block elements
+  /// \note Tiles on the boundary of the block must be TiledArray::Tensor
+  /// objects with numeric elements
+  template <typename Index1, typename Index2,
+            typename = std::enable_if_t<
+                TiledArray::detail::is_integral_range_v<Index1> &&
+                TiledArray::detail::is_integral_range_v<Index2>>>
+  BlkTsrExpr<const Array, Alias> element_block(
+      const Index1& lower_bound, const Index2& upper_bound) const {
+    // The tile bounds of the block are set by set_element_bounds()
+    const auto& tiles_range = array_.trange().tiles_range();
+    const auto rank = tiles_range.rank();
+    const std::vector<std::size_t> lobound(tiles_range.lobound_data(),
+                                           tiles_range.lobound_data() + rank);
+    const std::vector<std::size_t> upbound(tiles_range.upbound_data(),
+                                           tiles_range.upbound_data() + rank);
+    return BlkTsrExpr<const Array, Alias>(array_, annotation_, lobound,
+                                          upbound)
+        .set_element_bounds(lower_bound, upper_bound);
+  }
+
+  /// Element block expression factory
+
+  /// \tparam Index1 An integral type
+  /// \tparam Index2 An integral type
+  /// \param lower_bound The lower bound of the block elements
+  /// \param upper_bound The upper bound of the block elements
+  /// \sa element_block(const Index1&, const Index2&)
+  template <typename Index1, typename Index2,
+            typename = std::enable_if_t<std::is_integral_v<Index1> &&
+                                        std::is_integral_v<Index2>>>
+  BlkTsrExpr<const Array, Alias> element_block(
+      const std::initializer_list<Index1>& lower_bound,
+      const std::initializer_list<Index2>& upper_bound) const {
+    return element_block<std::initializer_list<Index1>,
+                         std::initializer_list<Index2>>(lower_bound,
+                                                        upper_bound);
+  }
+
   /// mutable Block expression factory
 
   /// \tparam Index1 An integral range type
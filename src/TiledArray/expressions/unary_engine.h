@@ -28,6 +28,7 @@
 
 #include <TiledArray/dist_eval/unary_eval.h>
 #include <TiledArray/expressions/expr_engine.h>
+#include <TiledArray/expressions/permopt.h>
 
 namespace TiledArray {
 namespace expressions {
@@ -154,6 +155,32 @@ class UnaryEngine : ExprEngine<Derived> {
     return perm ^ arg_.trange();
   }
 
+  /// Size estimate of the result
+
+  /// \return The estimated size of the result, which is that of the argument
+  VolumeEstimate volume_estimate() const { return arg_.volume_estimate(); }
+
+  /// Fusion check
+
+  /// \param root \c true if this engine is the root of the fused expression,
+  /// whose evaluator may permute the result
+  /// \return \c true if this expression can be evaluated by a fused kernel
+  bool fusable(const bool root) const {
+    return !ExprEngine_::override_ptr_ && (root || !perm_) &&
+           arg_.fusable(false);
+  }
+
+  /// Append the leaf arrays of this expression to those of a fused expression
+
+  /// \param arrays The leaf arrays
+  /// \param perms The permutations that map the index lists of the leaf
+  /// arrays to that of the fused expression
+  template <typename A>
+  void fused_arrays(std::vector<A>& arrays,
+                    std::vector<Permutation>& perms) const {
+    arg_.fused_arrays(arrays, perms);
+  }
+
   /// Construct the distributed evaluator for this expression
 
   /// \return The distributed evaluator that will evaluate this expression
@@ -164,7 +191,8 @@ class UnaryEngine : ExprEngine<Derived> {
         impl_type;
 
     // Construct left and right distributed evaluators
-    const typename argument_type::dist_eval_type arg = arg_.make_dist_eval();
+    const typename argument_type::dist_eval_type arg =
+        arg_.make_cse_dist_eval();
 
     // Construct the distributed evaluator type
     std::shared_ptr<impl_type> pimpl = std::make_shared<impl_type>(
@@ -173,6 +201,22 @@ class UnaryEngine : ExprEngine<Derived> {
     return dist_eval_type(pimpl);
   }
 
+  /// Structural key of this expression
+
+  /// \return The key of the engine tree rooted at this node
+  std::string structural_key() const {
+    return ExprEngine_::structural_key() + "(" + arg_.structural_key() + ")";
+  }
+
+  /// Count the consumers of this expression and of its subexpressions
+
+  /// \param dag The DAG that is analyzed
+  void count_subexpressions(ExprDAG& dag) const {
+    if (ExprEngine_::override_ptr_ ||
+        dag.count(ExprEngine_::derived().structural_key()))
+      arg_.count_subexpressions(dag);
+  }
+
   /// Expression print
 
   /// \param os The output stream
@@ -35,7 +35,12 @@
 #include <blas/util.hh>
 #include <blas/wrappers.hh>
 
+#include <algorithm>
+#include <complex>
 #include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 namespace TiledArray::math::blas {
 
@@ -65,9 +70,32 @@ using Matrix = ::Eigen::Matrix<T, ::Eigen::Dynamic, ::Eigen::Dynamic, Options>;
 template <typename T>
 using Vector = ::Eigen::Matrix<T, ::Eigen::Dynamic, 1, ::Eigen::ColMajor>;
 
+namespace detail {
+
+/// \c true if \c T is widened to \c U without loss of precision, e.g. a
+/// single-precision argument of a double-precision GEMM
+template <typename T, typename U>
+constexpr bool is_widenable_v =
+    std::is_same_v<T, U> ||
+    (std::is_same_v<T, float> && std::is_same_v<U, double>) ||
+    (std::is_same_v<T, std::complex<float>> &&
+     std::is_same_v<U, std::complex<double>>);
+
+/// \c true if a GEMM with arguments of types \c T1 and \c T2 and a result of
+/// type \c T3 is evaluated in the precision of the result
+template <typename T1, typename T2, typename T3>
+constexpr bool is_mixed_precision_gemm_v =
+    (std::is_same_v<T3, double> || std::is_same_v<T3, std::complex<double>>) &&
+    !(std::is_same_v<T1, T3> && std::is_same_v<T2, T3>) &&
+    is_widenable_v<T1, T3> && is_widenable_v<T2, T3>;
+
+}  // namespace detail
+
 // BLAS _GEMM wrapper functions
 
-template <typename S1, typename T1, typename T2, typename S2, typename T3>
+template <typename S1, typename T1, typename T2, typename S2, typename T3,
+          typename std::enable_if_t<
+              !detail::is_mixed_precision_gemm_v<T1, T2, T3>>* = nullptr>
 inline void gemm(Op op_a, Op op_b, const integer m, const integer n,
                  const integer k, const S1 alpha, const T1* a,
                  const integer lda, const T2* b, const integer ldb,
@@ -196,6 +224,102 @@ inline void gemm(Op op_a, Op op_b, const integer m, const integer n,
                lda, beta, c, ldc);
 }
 
+namespace detail {
+
+/// Copy a row-major block, converting the elements to the destination type
+
+/// \param rows The number of rows of the block
+/// \param cols The number of columns of the block
+/// \param src The first element of the block
+/// \param ld_src The leading dimension of \c src
+/// \param dst The destination of the block, with leading dimension \c cols
+template <typename T, typename U>
+inline void widen_block(const integer rows, const integer cols, const T* src,
+                        const integer ld_src, U* dst) {
+  for (integer r = 0; r < rows; ++r, src += ld_src, dst += cols)
+    std::copy(src, src + cols, dst);
+}
+
+/// Panel of a GEMM argument in the precision of the result
+
+/// The panel spans \c kb elements of the inner dimension of a matrix with
+/// \c mn elements in the outer dimension; the matrix is \c mn x \c k if
+/// \c outer_rows is \c true , otherwise it is \c k x \c mn .
+template <typename T, typename U>
+class WidenedPanel {
+  std::unique_ptr<U[]> buffer_;  ///< Widened panel (empty if \c T is \c U )
+
+ public:
+  explicit WidenedPanel(const integer size)
+      : buffer_(std::is_same_v<T, U> ? nullptr : new U[size]) {}
+
+  /// Pack a panel
+
+  /// \param outer_rows \c true if the outer dimension indexes the rows
+  /// \param mn The size of the outer dimension
+  /// \param p0 The first element of the panel in the inner dimension
+  /// \param kb The size of the panel in the inner dimension
+  /// \param data The matrix data
+  /// \param ld The leading dimension of \c data
+  /// \return The panel data and its leading dimension
+  std::pair<const U*, integer> pack(const bool outer_rows, const integer mn,
+                                    const integer p0, const integer kb,
+                                    const T* data, const integer ld) {
+    const T* first = (outer_rows ? data + p0 : data + p0 * ld);
+    if constexpr (std::is_same_v<T, U>) {
+      return {first, ld};
+    } else {
+      if (outer_rows) {
+        widen_block(mn, kb, first, ld, buffer_.get());
+        return {buffer_.get(), kb};
+      }
+      widen_block(kb, mn, first, ld, buffer_.get());
+      return {buffer_.get(), mn};
+    }
+  }
+};  // class WidenedPanel
+
+}  // namespace detail
+
+/// Mixed-precision GEMM
+
+/// Computes <tt>c = alpha * op(a) * op(b) + beta * c</tt> in the precision of
+/// \c c when \c a and/or \c b are stored in a lower precision, e.g.
+/// single-precision arguments with a double-precision result. The arguments
+/// are widened panel by panel along the inner dimension, and each panel is
+/// passed to the BLAS kernel of the result type; hence the products are
+/// accumulated in the higher precision without widened copies of the whole
+/// arguments.
+template <typename S1, typename T1, typename T2, typename S2, typename T3,
+          typename std::enable_if_t<
+              detail::is_mixed_precision_gemm_v<T1, T2, T3>>* = nullptr>
+inline void gemm(Op op_a, Op op_b, const integer m, const integer n,
+                 const integer k, const S1 alpha, const T1* a,
+                 const integer lda, const T2* b, const integer ldb,
+                 const S2 beta, T3* c, const integer ldc) {
+  // The number of inner-dimension elements widened per panel
+  constexpr integer max_panel_size = 256;
+
+  if (k == 0) {
+    for (integer i = 0; i < m; ++i)
+      for (integer j = 0; j < n; ++j)
+        c[i * ldc + j] = (beta == S2(0) ? T3(0) : T3(beta) * c[i * ldc + j]);
+    return;
+  }
+
+  const integer panel_size = std::min(k, max_panel_size);
+  detail::WidenedPanel<T1, T3> a_panel(m * panel_size);
+  detail::WidenedPanel<T2, T3> b_panel(n * panel_size);
+  for (integer p0 = 0; p0 < k; p0 += panel_size) {
+    const integer kb = std::min(panel_size, k - p0);
+    // a is m x k when it is not transposed, and b is n x k when it is
+    const auto a_kb = a_panel.pack(op_a == NoTranspose, m, p0, kb, a, lda);
+    const auto b_kb = b_panel.pack(op_b != NoTranspose, n, p0, kb, b, ldb);
+    gemm(op_a, op_b, m, n, kb, T3(alpha), a_kb.first, a_kb.second, b_kb.first,
+         b_kb.second, (p0 == 0 ? T3(beta) : T3(1)), c, ldc);
+  }
+}
+
 // BLAS _SCAL wrapper functions
 
 template <typename T, typename U>
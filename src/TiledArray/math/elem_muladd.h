@@ -0,0 +1,189 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_MATH_ELEM_MULADD_H__INCLUDED
+#define TILEDARRAY_MATH_ELEM_MULADD_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <TiledArray/math/blas.h>
+#include <TiledArray/math/gemm_helper.h>
+#include <TiledArray/math/vector_op.h>
+
+namespace TiledArray {
+namespace math {
+
+/// Element multiply-add operation of a nested tensor contraction
+
+/// The GEMM of tensors of tensors calls a ternary multiply-add operation,
+/// <tt>result += left * right</tt>, for each triple of inner tensors. The
+/// operations that are generated for the common inner products are
+/// represented by this class rather than by an opaque callable, so that the
+/// GEMM kernel of the outer tensors can call them directly, and so that
+/// tiles with packed inner tensors can apply them to their storage without
+/// materializing the inner tensors. The inner
+/// contraction is dispatched to BLAS and accumulates into \c result ; the
+/// inner Hadamard product is a single fused pass over the inner tensors that
+/// does not create a temporary.
+/// \tparam T The numeric type of the inner tensors
+template <typename T>
+class ElemMulAdd {
+ public:
+  typedef T numeric_type;  ///< The numeric type of the inner tensors
+
+  /// The product of the inner tensors
+  enum class Kind { Hadamard, Contraction };
+
+ private:
+  Kind kind_;               ///< The product of the inner tensors
+  numeric_type factor_;     ///< The scaling factor of the product
+  GemmHelper gemm_helper_;  ///< The GEMM meta data of an inner contraction
+
+  ElemMulAdd(const Kind kind, const numeric_type factor,
+             const GemmHelper& gemm_helper)
+      : kind_(kind), factor_(factor), gemm_helper_(gemm_helper) {}
+
+ public:
+  ElemMulAdd(const ElemMulAdd&) = default;
+  ElemMulAdd(ElemMulAdd&&) = default;
+  ElemMulAdd& operator=(const ElemMulAdd&) = default;
+  ElemMulAdd& operator=(ElemMulAdd&&) = default;
+
+  /// Construct an inner Hadamard product
+
+  /// \param factor The scaling factor of the product
+  /// \return <tt>result += factor * left * right</tt> , element-wise
+  static ElemMulAdd hadamard(const numeric_type factor) {
+    return ElemMulAdd(Kind::Hadamard, factor,
+                      GemmHelper(blas::NoTranspose, blas::NoTranspose, 0u, 0u,
+                                 0u));
+  }
+
+  /// Construct an inner contraction
+
+  /// \param gemm_helper The GEMM meta data of the inner tensors
+  /// \param factor The scaling factor of the product
+  /// \return <tt>result += factor * gemm(left, right)</tt>
+  static ElemMulAdd contraction(const GemmHelper& gemm_helper,
+                                const numeric_type factor) {
+    return ElemMulAdd(Kind::Contraction, factor, gemm_helper);
+  }
+
+  /// \return The product of the inner tensors
+  Kind kind() const { return kind_; }
+
+  /// \return The scaling factor of the product
+  numeric_type factor() const { return factor_; }
+
+  /// \return The GEMM meta data of an inner contraction
+  const GemmHelper& gemm_helper() const { return gemm_helper_; }
+
+  /// Multiply-add a pair of inner tensors
+
+  /// If \c result is empty it is initialized with the product.
+  /// \param[in,out] result The inner tensor that accumulates the product
+  /// \param[in] left The left-hand inner tensor
+  /// \param[in] right The right-hand inner tensor
+  template <typename Result, typename Left, typename Right>
+  void operator()(Result& result, const Left& left, const Right& right) const {
+    TA_ASSERT(!left.empty());
+    TA_ASSERT(!right.empty());
+    if (kind_ == Kind::Hadamard)
+      hadamard_muladd(result, left, right);
+    else
+      contract_muladd(result, left, right);
+  }
+
+  /// Multiply a pair of inner tensors
+
+  /// \param[in] left The left-hand inner tensor
+  /// \param[in] right The right-hand inner tensor
+  /// \return The product of \c left and \c right
+  template <typename Left, typename Right>
+  auto operator()(const Left& left, const Right& right) const {
+    std::decay_t<decltype(left.mult(right))> result;
+    (*this)(result, left, right);
+    return result;
+  }
+
+ private:
+  template <typename Result, typename Left, typename Right>
+  void hadamard_muladd(Result& result, const Left& left,
+                       const Right& right) const {
+    if (result.empty()) {
+      result = (factor_ == numeric_type(1) ? left.mult(right)
+                                           : left.mult(right, factor_));
+      return;
+    }
+
+    TA_ASSERT(left.size() == right.size());
+    TA_ASSERT(result.size() == left.size());
+    typedef typename Result::value_type result_value_type;
+    typedef typename Left::value_type left_value_type;
+    typedef typename Right::value_type right_value_type;
+    if (factor_ == numeric_type(1)) {
+      inplace_vector_op(
+          [](result_value_type& MADNESS_RESTRICT r, const left_value_type l,
+             const right_value_type x) { r += l * x; },
+          result.size(), result.data(), left.data(), right.data());
+    } else {
+      const numeric_type factor = factor_;
+      inplace_vector_op(
+          [factor](result_value_type& MADNESS_RESTRICT r,
+                   const left_value_type l,
+                   const right_value_type x) { r += (l * x) * factor; },
+          result.size(), result.data(), left.data(), right.data());
+    }
+  }
+
+  template <typename Result, typename Left, typename Right>
+  void contract_muladd(Result& result, const Left& left,
+                       const Right& right) const {
+    TA_ASSERT(left.range().rank() == gemm_helper_.left_rank());
+    TA_ASSERT(right.range().rank() == gemm_helper_.right_rank());
+    TA_ASSERT(gemm_helper_.left_right_congruent(left.range().extent_data(),
+                                                right.range().extent_data()));
+
+    blas::integer m = 1, n = 1, k = 1;
+    gemm_helper_.compute_matrix_sizes(m, n, k, left.range(), right.range());
+    const blas::integer lda =
+        (gemm_helper_.left_op() == blas::NoTranspose ? k : m);
+    const blas::integer ldb =
+        (gemm_helper_.right_op() == blas::NoTranspose ? n : k);
+
+    // An empty result is allocated and overwritten by the product
+    typedef typename Result::numeric_type result_numeric_type;
+    result_numeric_type beta(1);
+    if (result.empty()) {
+      result = Result(
+          gemm_helper_.template make_result_range<typename Result::range_type>(
+              left.range(), right.range()));
+      beta = result_numeric_type(0);
+    }
+    TA_ASSERT(result.size() == std::size_t(m) * std::size_t(n));
+
+    blas::gemm(gemm_helper_.left_op(), gemm_helper_.right_op(), m, n, k,
+               factor_, left.data(), lda, right.data(), ldb, beta,
+               result.data(), n);
+  }
+};  // class ElemMulAdd
+
+}  // namespace math
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_MATH_ELEM_MULADD_H__INCLUDED
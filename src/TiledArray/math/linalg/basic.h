@@ -27,6 +27,9 @@
 #define TILEDARRAY_MATH_LINALG_BASIC_H__INCLUDED
 
 #include "TiledArray/dist_array.h"
+#include "TiledArray/expressions/reduction_batch.h"
+
+#include <vector>
 
 namespace TiledArray::math::linalg {
 
@@ -57,6 +60,155 @@ inline void axpy(DistArray<Tile, Policy>& y, S alpha,
   y(vars) = y(vars) + numeric_type(alpha) * x(vars);
 }
 
+/// computes a batch of dot products \f$ \{ x_k \cdot y_k \} \f$
+
+/// This is the generic version, it evaluates the dot products eagerly by
+/// calling \c dot(*x[k],*y[k]) for each \c k .
+/// \param x the left-hand arguments
+/// \param y the right-hand arguments
+/// \return a future to the vector of dot products
+template <typename D>
+inline auto dot_async(const std::vector<const D*>& x,
+                      const std::vector<const D*>& y) {
+  TA_ASSERT(x.size() == y.size());
+  using result_type =
+      decltype(dot(std::declval<const D&>(), std::declval<const D&>()));
+  std::vector<result_type> result;
+  result.reserve(x.size());
+  for (std::size_t k = 0; k != x.size(); ++k)
+    result.push_back(dot(*x[k], *y[k]));
+  return Future<std::vector<result_type>>(std::move(result));
+}
+
+/// computes a batch of dot products \f$ \{ x_k \cdot y_k \} \f$
+
+/// The dot products are added to a ReductionBatch, which reduces the local
+/// tiles of each pair without communication and combines the local results
+/// of all pairs with a single all-reduce, hence the number of collectives
+/// does not depend on the batch size. This function does not block; the
+/// result can be awaited after launching other work that does not depend on
+/// it.
+/// \param x the left-hand arguments
+/// \param y the right-hand arguments; all arrays in \p x and \p y must
+///        have identical TiledRange objects
+/// \return a future to the vector of dot products
+template <typename Tile, typename Policy>
+inline auto dot_async(const std::vector<const DistArray<Tile, Policy>*>& x,
+                      const std::vector<const DistArray<Tile, Policy>*>& y) {
+  using value_type = typename DistArray<Tile, Policy>::value_type;
+  using result_type =
+      decltype(dot(std::declval<value_type>(), std::declval<value_type>()));
+  TA_ASSERT(!x.empty() && x.size() == y.size());
+  const auto& x0 = *x[0];
+  World& world = x0.world();
+  const auto vars = TiledArray::detail::dummy_annotation(rank(x0));
+
+  ReductionBatch batch(world);
+  std::vector<Future<result_type>> dots;
+  dots.reserve(x.size());
+  for (std::size_t k = 0; k != x.size(); ++k) {
+    TA_ASSERT(x[k]->trange() == x0.trange());
+    TA_ASSERT(y[k]->trange() == x0.trange());
+    dots.push_back(batch.dot((*x[k])(vars), (*y[k])(vars)));
+  }
+  batch.submit();
+
+  return world.taskq.add(
+      [](const std::vector<Future<result_type>>& dots) {
+        std::vector<result_type> result;
+        result.reserve(dots.size());
+        for (const auto& dot_k : dots) result.push_back(dot_k.get());
+        return result;
+      },
+      std::move(dots));
+}
+
+/// computes dot products of \p x with each of \p y
+
+/// \param x the left-hand argument
+/// \param y the right-hand arguments
+/// \return the vector of dot products, \c {dot(x,*y[0]),dot(x,*y[1]),...}
+/// \sa dot_async()
+template <typename D>
+inline auto dot(const D& x, const std::vector<const D*>& y) {
+  using result_type =
+      decltype(dot(std::declval<const D&>(), std::declval<const D&>()));
+  if (y.empty()) return std::vector<result_type>{};
+  return dot_async(std::vector<const D*>(y.size(), &x), y).get();
+}
+
+/// computes linear combination \f$ y = \sum_k a_k x_k \f$
+
+/// This is the generic version, it is implemented in terms of \c clone ,
+/// \c scale , and \c axpy
+/// \param[out] y the result
+/// \param a the coefficients
+/// \param x the vectors; \p y may alias any of these
+template <typename D, typename S>
+inline void linear_combination(D& y, const std::vector<S>& a,
+                               const std::vector<const D*>& x) {
+  TA_ASSERT(!x.empty() && a.size() == x.size());
+  D result = clone(*x[0]);
+  scale(result, a[0]);
+  for (std::size_t k = 1; k != x.size(); ++k) axpy(result, a[k], *x[k]);
+  y = std::move(result);
+}
+
+/// computes linear combination \f$ y = \sum_k a_k x_k \f$
+
+/// Every tile of \p y is computed by a single task that reads the
+/// corresponding tiles of all \p x , i.e. the data is swept once, rather than
+/// once per term as would be the case with a sequence of \c axpy calls.
+/// \param[out] y the result
+/// \param a the coefficients
+/// \param x the vectors; must have identical TiledRange objects; \p y
+///        may alias any of these
+template <typename Tile, typename Policy, typename S>
+inline void linear_combination(
+    DistArray<Tile, Policy>& y, const std::vector<S>& a,
+    const std::vector<const DistArray<Tile, Policy>*>& x) {
+  using array_type = DistArray<Tile, Policy>;
+  using value_type = typename array_type::value_type;
+  using numeric_type = typename array_type::numeric_type;
+  TA_ASSERT(!x.empty() && a.size() == x.size());
+  const std::size_t n = x.size();
+  const array_type& x0 = *x[0];
+  World& world = x0.world();
+
+  // the result shape is the sum of scaled argument shapes
+  auto shape = x0.shape().scale(numeric_type(a[0]));
+  for (std::size_t k = 1; k != n; ++k) {
+    TA_ASSERT(x[k]->trange() == x0.trange());
+    shape = shape.add(x[k]->shape().scale(numeric_type(a[k])));
+  }
+
+  array_type result(world, x0.trange(), shape, x0.pmap());
+  for (const auto index : *result.pmap()) {
+    if (result.is_zero(index)) continue;
+    std::vector<numeric_type> factors;
+    std::vector<Future<value_type>> tiles;
+    for (std::size_t k = 0; k != n; ++k) {
+      if (x[k]->is_zero(index)) continue;
+      factors.push_back(numeric_type(a[k]));
+      tiles.push_back(x[k]->find(index));
+    }
+    TA_ASSERT(!tiles.empty());
+    result.set(index, world.taskq.add(
+                          [](const std::vector<numeric_type>& factors,
+                             const std::vector<Future<value_type>>& tiles) {
+                            using TiledArray::add_to;
+                            using TiledArray::scale;
+                            value_type tile = scale(tiles[0].get(), factors[0]);
+                            for (std::size_t k = 1; k != tiles.size(); ++k)
+                              add_to(tile, tiles[k].get(), factors[k]);
+                            return tile;
+                          },
+                          std::move(factors), std::move(tiles)));
+  }
+
+  y = result;
+}
+
 }  // namespace TiledArray::math::linalg
 
 #endif  // TILEDARRAY_MATH_LINALG_BASIC_H__INCLUDED
@@ -183,10 +183,161 @@ struct ConjugateGradientSolver {
   }
 };
 
+// clang-format off
+/// Solves real linear system <tt> a(x) = b </tt>, with \c a is a linear
+/// function of \c x , using the pipelined (communication-hiding) conjugate
+/// gradient solver with a diagonal preconditioner.
+
+/// This is the pipelined preconditioned CG method of P. Ghysels and
+/// W. Vanroose, Parallel Computing 40, 224 (2014). It is mathematically
+/// equivalent to ConjugateGradientSolver, but every iteration performs a
+/// single global reduction that computes all inner products at once; the
+/// reduction is launched before, and awaited after, the application of the
+/// preconditioner and of \c a , hence its latency is overlapped with
+/// computation. The vector updates are evaluated as fused linear
+/// combinations that do not synchronize.
+///
+/// \tparam D type of \c x and \c b, as well as the preconditioner;
+/// \tparam F type that evaluates the LHS, will call \c F::operator()(x,result)
+/// , \c D must implement <tt> operator()(const D&, D&) const </tt> \c
+/// D::element_type must be defined and \c D must provide the stand-alone
+/// functions required by ConjugateGradientSolver, as well as:
+///   \li <tt> Future<std::vector<value_type>> dot_async(const std::vector<const D*>& x, const std::vector<const D*>& y) </tt>
+///   \li <tt> void linear_combination(D& y, const std::vector<value_type>& a, const std::vector<const D*>& x) </tt>
+///
+/// Generic versions of the latter are provided in the
+/// TiledArray::math::linalg namespace.
+// clang-format on
+template <typename D, typename F>
+struct PipelinedConjugateGradientSolver {
+  typedef typename D::element_type value_type;
+
+  /// \param a object of type F
+  /// \param b RHS
+  /// \param x unknown
+  /// \param preconditioner
+  /// \param convergence_target The convergence target [default = -1.0]
+  /// \return The 2-norm of the residual, a(x) - b, divided by the number of
+  /// elements in the residual.
+  value_type operator()(F& a, const D& b, D& x, const D& preconditioner,
+                        value_type convergence_target = -1.0) {
+    std::size_t n = volume(preconditioner);
+
+    // see ConjugateGradientSolver for the convergence target estimate
+    const value_type precond_min = abs_min(preconditioner);
+    const value_type precond_max = abs_max(preconditioner);
+    const value_type cond_number = precond_max / precond_min;
+    if (convergence_target < 0.0) {
+      convergence_target = 1e-15 * cond_number;
+    } else {
+      if (convergence_target < 1e-15 * cond_number)
+        std::cout << "WARNING: PipelinedConjugateGradient convergence target ("
+                  << convergence_target
+                  << ") may be too low for 64-bit precision" << std::endl;
+    }
+
+    const unsigned int max_niter = n;
+    const std::size_t rhs_size = volume(b);
+
+    // starting guess: x_0 = D^-1 . b
+    D XX_i = b;
+    vec_multiply(XX_i, preconditioner);
+
+    // r_0 = b - a(x)
+    D RR_i = clone(b);
+    a(XX_i, RR_i);
+    linear_combination(RR_i, std::vector<value_type>{1.0, -1.0},
+                       std::vector<const D*>{&b, &RR_i});
+
+    // u_0 = D^-1 . r_0
+    D UU_i = RR_i;
+    vec_multiply(UU_i, preconditioner);
+
+    // w_0 = a(u_0)
+    D WW_i = clone(b);
+    a(UU_i, WW_i);
+
+    // m_i = D^-1 . w_i, n_i = a(m_i)
+    D MM_i;
+    D NN_i = clone(b);
+    // auxiliary vectors: z_i = A q_i, q_i = D^-1 s_i, s_i = A p_i
+    D ZZ_i, QQ_i, SS_i;
+    // direction vector
+    D PP_i;
+
+    value_type alpha = 0.0, gamma_prev = 0.0;
+    value_type rnorm2 = 0.0;
+    unsigned int iter = 0;
+    while (true) {
+      // gamma_i = (r_i . u_i), delta_i = (w_i . u_i), and (r_i . r_i)
+      auto dots = dot_async(std::vector<const D*>{&RR_i, &WW_i, &RR_i},
+                            std::vector<const D*>{&UU_i, &UU_i, &RR_i});
+
+      // overlap the reduction with m_i = D^-1 . w_i and n_i = a(m_i)
+      MM_i = WW_i;
+      vec_multiply(MM_i, preconditioner);
+      a(MM_i, NN_i);
+
+      const auto& dot_values = dots.get();
+      const value_type gamma = dot_values[0];
+      const value_type delta = dot_values[1];
+
+      using std::sqrt;
+      rnorm2 = sqrt(dot_values[2]) / rhs_size;
+      if (rnorm2 < convergence_target) break;
+      if (iter >= max_niter)
+        throw std::domain_error(
+            "PipelinedConjugateGradient: max # of iterations exceeded");
+
+      value_type beta = 0.0;
+      if (iter > 0) {
+        beta = gamma / gamma_prev;
+        alpha = gamma / (delta - beta * gamma / alpha);
+      } else {
+        alpha = gamma / delta;
+      }
+      gamma_prev = gamma;
+
+      if (iter > 0) {
+        // z_i = n_i + beta_i z_i-1, etc.
+        const std::vector<value_type> one_beta{1.0, beta};
+        linear_combination(ZZ_i, one_beta, std::vector<const D*>{&NN_i, &ZZ_i});
+        linear_combination(QQ_i, one_beta, std::vector<const D*>{&MM_i, &QQ_i});
+        linear_combination(SS_i, one_beta, std::vector<const D*>{&WW_i, &SS_i});
+        linear_combination(PP_i, one_beta, std::vector<const D*>{&UU_i, &PP_i});
+      } else {
+        // NN_i is reused as the output of a, hence must be deep-copied
+        ZZ_i = clone(NN_i);
+        QQ_i = MM_i;
+        SS_i = WW_i;
+        PP_i = UU_i;
+      }
+
+      // x_i+1 = x_i + alpha_i p_i, r_i+1 = r_i - alpha_i s_i, etc.
+      const std::vector<value_type> one_alpha{1.0, alpha};
+      const std::vector<value_type> one_minus_alpha{1.0, -alpha};
+      linear_combination(XX_i, one_alpha, std::vector<const D*>{&XX_i, &PP_i});
+      linear_combination(RR_i, one_minus_alpha,
+                         std::vector<const D*>{&RR_i, &SS_i});
+      linear_combination(UU_i, one_minus_alpha,
+                         std::vector<const D*>{&UU_i, &QQ_i});
+      linear_combination(WW_i, one_minus_alpha,
+                         std::vector<const D*>{&WW_i, &ZZ_i});
+
+      ++iter;
+    }  // solver loop
+
+    x = XX_i;
+
+    return rnorm2;
+  }
+};
+
 }  // namespace TiledArray::math::linalg
 
 namespace TiledArray {
   using TiledArray::math::linalg::ConjugateGradientSolver;
+  using TiledArray::math::linalg::PipelinedConjugateGradientSolver;
 }
 
 #endif  // TILEDARRAY_MATH_LINALG_CONJGRAD_H__INCLUDED
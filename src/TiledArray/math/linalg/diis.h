@@ -32,6 +32,7 @@
 
 #include <Eigen/QR>
 #include <deque>
+#include <vector>
 
 namespace TiledArray::math::linalg {
 
@@ -78,6 +79,14 @@ namespace TiledArray::math::linalg {
 ///
 /// The original DIIS reference: P. Pulay, Chem. Phys. Lett. 73, 393 (1980).
 ///
+/// In the fused mode (see the \c fused constructor parameter) the new row of
+/// the B matrix is computed with a single batched reduction (see
+/// \c dot(const D&,const std::vector<const D*>&) ) and the extrapolated
+/// vectors are computed by a single sweep over the stored subspace (see
+/// \c linear_combination() ). For distributed arrays this reduces the number
+/// of global synchronizations per iteration from \f$ O(n) \f$ to
+/// \f$ O(1) \f$, where \f$ n \f$ is the subspace size.
+///
 /// \tparam D type of \c x
 template <typename D>
 class DIIS {
@@ -113,9 +122,12 @@ class DIIS {
   ///            if nonzero, once the 2-norm of the error is below this
   ///            attenuate the damping factor by the ratio of the current
   ///            2-norm of the error to this value.
+  /// \param fused if true, compute the B matrix elements with a single
+  ///   batched reduction and form the extrapolated vectors with a single
+  ///   (fused) linear combination (default = false).
   DIIS(unsigned int strt = 1, unsigned int ndi = 5, scalar_type dmp = 0,
        unsigned int ngr = 1, unsigned int ngrdiis = 1, scalar_type mf = 0,
-       scalar_type adt = 0)
+       scalar_type adt = 0, bool fused = false)
       : error_(0),
         errorset_(false),
         start(strt),
@@ -125,7 +137,8 @@ class DIIS {
         ngroupdiis(ngrdiis),
         damping_factor(dmp),
         mixing_fraction(mf),
-        attenuated_damping_threshold(adt) {
+        attenuated_damping_threshold(adt),
+        fused_(fused) {
     init();
   }
   ~DIIS() {
@@ -160,8 +173,18 @@ class DIIS {
 
     // extrapolate the error if needed
     if (extrapolate_error && (mixing_fraction == 0.0 || x_extrap_.empty())) {
-      for (unsigned int k = nskip_, kk = 1; k < nvec; ++k, ++kk) {
-        axpy(error, C_[kk], errors_[k]);
+      if (fused_) {
+        std::vector<value_type> coeffs(1, value_type(1));
+        std::vector<const D*> vecs(1, &error);
+        for (unsigned int k = nskip_, kk = 1; k < nvec; ++k, ++kk) {
+          coeffs.push_back(C_[kk]);
+          vecs.push_back(&errors_[k]);
+        }
+        linear_combination(error, coeffs, vecs);
+      } else {
+        for (unsigned int k = nskip_, kk = 1; k < nvec; ++k, ++kk) {
+          axpy(error, C_[kk], errors_[k]);
+        }
       }
     }
   }
@@ -193,7 +216,13 @@ class DIIS {
     x_.push_back(x);
 
     if (iter == 1) {  // the first iteration
-      if (not x_extrap_.empty() && do_mixing) {
+      if (not x_extrap_.empty() && do_mixing && fused_) {
+        linear_combination(
+            x,
+            std::vector<value_type>{value_type(1.0 - mixing_fraction),
+                                    value_type(mixing_fraction)},
+            std::vector<const D*>{&x_[0], &x_extrap_[0]});
+      } else if (not x_extrap_.empty() && do_mixing) {
         zero(x);
         axpy(x, (1.0 - mixing_fraction), x_[0]);
         axpy(x, mixing_fraction, x_extrap_[0]);
@@ -207,15 +236,32 @@ class DIIS {
 
       TA_ASSERT(c.size() == rank &&
                 "DIIS: numbers of coefficients and x's do not match");
-      zero(x);
-      for (unsigned int k = nskip, kk = 1; k < nvec; ++k, ++kk) {
-        if (not do_mixing || x_extrap_.empty()) {
-          // std::cout << "contrib " << k << " c=" << c[kk] << ":" << std::endl
-          // << x_[k] << std::endl;
-          axpy(x, c[kk], x_[k]);
-        } else {
-          axpy(x, c[kk] * (1.0 - mixing_fraction), x_[k]);
-          axpy(x, c[kk] * mixing_fraction, x_extrap_[k]);
+      if (fused_) {
+        std::vector<value_type> coeffs;
+        std::vector<const D*> vecs;
+        for (unsigned int k = nskip, kk = 1; k < nvec; ++k, ++kk) {
+          if (not do_mixing || x_extrap_.empty()) {
+            coeffs.push_back(c[kk]);
+            vecs.push_back(&x_[k]);
+          } else {
+            coeffs.push_back(c[kk] * (1.0 - mixing_fraction));
+            vecs.push_back(&x_[k]);
+            coeffs.push_back(c[kk] * mixing_fraction);
+            vecs.push_back(&x_extrap_[k]);
+          }
+        }
+        linear_combination(x, coeffs, vecs);
+      } else {
+        zero(x);
+        for (unsigned int k = nskip, kk = 1; k < nvec; ++k, ++kk) {
+          if (not do_mixing || x_extrap_.empty()) {
+            // std::cout << "contrib " << k << " c=" << c[kk] << ":" << std::endl
+            // << x_[k] << std::endl;
+            axpy(x, c[kk], x_[k]);
+          } else {
+            axpy(x, c[kk] * (1.0 - mixing_fraction), x_[k]);
+            axpy(x, c[kk] * mixing_fraction, x_extrap_[k]);
+          }
         }
       }
 
@@ -250,9 +296,19 @@ class DIIS {
     const unsigned int nvec = errors_.size();
 
     // and compute the most recent elements of B, B(i,j) = <ei|ej>
-    for (unsigned int i = 0; i < nvec - 1; i++)
-      B_(i, nvec - 1) = B_(nvec - 1, i) = dot(errors_[i], errors_[nvec - 1]);
-    B_(nvec - 1, nvec - 1) = dot(errors_[nvec - 1], errors_[nvec - 1]);
+    if (fused_) {  // all elements of the new row at once
+      std::vector<const D*> errors;
+      errors.reserve(nvec);
+      for (const auto& e : errors_) errors.push_back(&e);
+      const auto B_row = dot(errors_[nvec - 1], errors);
+      for (unsigned int i = 0; i < nvec; i++)
+        B_(i, nvec - 1) = B_(nvec - 1, i) = B_row[i];
+    } else {
+      for (unsigned int i = 0; i < nvec - 1; i++)
+        B_(i, nvec - 1) = B_(nvec - 1, i) =
+            dot(errors_[i], errors_[nvec - 1]);
+      B_(nvec - 1, nvec - 1) = dot(errors_[nvec - 1], errors_[nvec - 1]);
+    }
     using std::abs;
     using std::sqrt;
     const auto current_error_2norm = sqrt(abs(B_(nvec - 1, nvec - 1)));
@@ -378,6 +434,7 @@ class DIIS {
   scalar_type attenuated_damping_threshold;  //!< if nonzero, will start
                                              //!< decreasing damping factor once
                                              //!< error 2-norm falls below this
+  bool fused_;  //!< if true, use batched dot products and fused extrapolation
 
   Matrix B_;                  //!< B(i,j) = <ei|ej>
   Vector C_;                  //! DIIS coefficients
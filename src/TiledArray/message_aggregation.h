@@ -0,0 +1,115 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_MESSAGE_AGGREGATION_H__INCLUDED
+#define TILEDARRAY_MESSAGE_AGGREGATION_H__INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace TiledArray {
+
+/// Settings and statistics of remote message aggregation
+
+/// By default each remote tile set and get of an array is sent as a separate
+/// active message. Arrays with many small tiles, e.g. those filled by
+/// make_array() or init_tiles() on processes that do not own the tiles, then
+/// flood the network with tiny messages. When aggregation is enabled, the
+/// storage of each array constructed afterwards buffers its outgoing tile sets
+/// and gets per destination process and sends each buffer as one message
+/// once it holds \c max_count() requests or \c max_bytes() bytes of tile data,
+/// once its oldest request is older than \c max_delay(), or, at the latest,
+/// when the task queue gets to the flush task that is submitted with the
+/// first buffered request. Tile futures behave exactly as without
+/// aggregation.
+/// \code
+/// TiledArray::MessageAggregation::set_max_count(256);  // enable
+/// \endcode
+class MessageAggregation {
+ public:
+  typedef std::chrono::microseconds duration;  ///< Delay type
+
+  /// Set the number of requests per message
+
+  /// \param count The maximum number of requests per aggregated message;
+  /// aggregation is disabled if \c count is less than 2
+  static void set_max_count(const std::size_t count) { max_count_ = count; }
+
+  /// \return The maximum number of requests per aggregated message
+  static std::size_t max_count() { return max_count_; }
+
+  /// Set the data size that triggers a flush
+
+  /// \param bytes The maximum size of the tile data of an aggregated message
+  static void set_max_bytes(const std::size_t bytes) { max_bytes_ = bytes; }
+
+  /// \return The maximum size of the tile data of an aggregated message
+  static std::size_t max_bytes() { return max_bytes_; }
+
+  /// Set the delay that triggers a flush
+
+  /// \param delay The maximum time a request is buffered while requests are
+  /// added to the same buffer
+  static void set_max_delay(const duration delay) {
+    max_delay_ = delay.count();
+  }
+
+  /// \return The maximum time a request is buffered while requests are added
+  /// to the same buffer
+  static duration max_delay() { return duration(max_delay_); }
+
+  /// \return \c true if aggregation is enabled
+  static bool enabled() { return max_count_ > 1ul; }
+
+  /// Record an aggregated message
+
+  /// \param count The number of requests in the message
+  static void record(const std::size_t count) {
+    ++messages_;
+    requests_ += count;
+  }
+
+  /// \return The number of aggregated messages sent by this process
+  static std::size_t messages() { return messages_; }
+
+  /// \return The number of requests sent by this process in aggregated
+  /// messages
+  static std::size_t requests() { return requests_; }
+
+  /// \return The number of messages saved by aggregation on this process
+  static std::size_t messages_saved() { return requests_ - messages_; }
+
+  /// Reset the statistics
+  static void reset_statistics() {
+    messages_ = 0ul;
+    requests_ = 0ul;
+  }
+
+ private:
+  static inline std::atomic<std::size_t> max_count_{0ul};
+  static inline std::atomic<std::size_t> max_bytes_{1ul << 16};
+  static inline std::atomic<duration::rep> max_delay_{100};
+  static inline std::atomic<std::size_t> messages_{0ul};
+  static inline std::atomic<std::size_t> requests_{0ul};
+};  // class MessageAggregation
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_MESSAGE_AGGREGATION_H__INCLUDED
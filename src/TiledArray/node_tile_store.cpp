@@ -0,0 +1,372 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "node_tile_store.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <thread>
+
+#ifdef TILEDARRAY_HAS_POSIX_SHM
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // TILEDARRAY_HAS_POSIX_SHM
+
+namespace TiledArray {
+namespace detail {
+
+/// The control object of a node, zero-initialized by its creator
+struct NodeTileStore::Control {
+  std::atomic<std::size_t> bytes;  ///< The size of the stored tiles
+};  // struct NodeTileStore::Control
+
+namespace {
+
+/// The header of the shared-memory object of a tile
+
+/// A claimed object holds only the header, with \c state zero; the
+/// serialized tile follows the header once it is published.
+struct TileHeader {
+  std::atomic<std::uint32_t> state;  ///< \c ready_state once published
+  std::uint32_t padding;             ///< Unused
+  std::uint64_t world_id;  ///< The world id of the array storage
+  std::uint64_t obj_id;    ///< The object id of the array storage
+  std::uint64_t ordinal;   ///< The tile ordinal
+  std::uint64_t bytes;     ///< The size of the serialized tile
+};  // struct TileHeader
+
+constexpr std::uint32_t ready_state = 1u;
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free &&
+                  std::atomic<std::size_t>::is_always_lock_free,
+              "the atomics in shared memory must be lock-free");
+
+/// \return The 64-bit mix of \c x (the finalizer of SplitMix64)
+inline std::uint64_t mix(std::uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x;
+}
+
+}  // namespace
+
+bool NodeTileStore::supported() {
+#ifdef TILEDARRAY_HAS_POSIX_SHM
+  return true;
+#else
+  return false;
+#endif  // TILEDARRAY_HAS_POSIX_SHM
+}
+
+std::string NodeTileStore::unique_prefix() {
+  std::uint64_t seed = static_cast<std::uint64_t>(
+      std::chrono::system_clock::now().time_since_epoch().count());
+#ifdef TILEDARRAY_HAS_POSIX_SHM
+  seed ^= mix(static_cast<std::uint64_t>(getpid()));
+#endif  // TILEDARRAY_HAS_POSIX_SHM
+  char prefix[12];
+  std::snprintf(prefix, sizeof(prefix), "/ta%08x",
+                static_cast<unsigned int>(mix(seed)));
+  return prefix;
+}
+
+std::string NodeTileStore::name(const Key& key) const {
+  const std::uint64_t hash =
+      mix(mix(mix(key.world_id) ^ key.obj_id) ^ key.ordinal);
+  char suffix[18];
+  std::snprintf(suffix, sizeof(suffix), ".%016llx",
+                static_cast<unsigned long long>(hash));
+  return prefix_ + suffix;
+}
+
+std::size_t NodeTileStore::size_bytes() const {
+  return (control_ ? control_->bytes.load() : 0ul);
+}
+
+#ifdef TILEDARRAY_HAS_POSIX_SHM
+
+bool NodeTileStore::attach(const std::string& prefix,
+                           const std::size_t budget) {
+  detach();
+
+  // The first process of the node creates the control object, the others
+  // wait until it has been sized
+  const std::string control_name = prefix + ".ctl";
+  bool creator = true;
+  int fd = shm_open(control_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0 && errno == EEXIST) {
+    creator = false;
+    fd = shm_open(control_name.c_str(), O_RDWR, 0600);
+  }
+  if (fd < 0) return false;
+  if (creator) {
+    if (posix_fallocate(fd, 0, sizeof(Control)) != 0) {
+      close(fd);
+      shm_unlink(control_name.c_str());
+      return false;
+    }
+  } else {
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    struct stat st;
+    while (fstat(fd, &st) == 0 &&
+           static_cast<std::size_t>(st.st_size) < sizeof(Control)) {
+      if (std::chrono::steady_clock::now() > deadline) break;
+      std::this_thread::yield();
+    }
+    if (fstat(fd, &st) != 0 ||
+        static_cast<std::size_t>(st.st_size) < sizeof(Control)) {
+      close(fd);
+      return false;
+    }
+  }
+
+  void* const ptr = mmap(nullptr, sizeof(Control), PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  prefix_ = prefix;
+  budget_ = budget;
+  control_ = static_cast<Control*>(ptr);
+  return true;
+}
+
+void NodeTileStore::detach() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!control_) return;
+  for (auto it = tiles_.begin(); it != tiles_.end();) it = unlink_tile(it);
+  munmap(control_, sizeof(Control));
+  control_ = nullptr;
+  budget_ = 0ul;
+}
+
+void NodeTileStore::remove(const std::string& prefix) {
+  shm_unlink((prefix + ".ctl").c_str());
+}
+
+NodeTileStore::Status NodeTileStore::read(
+    const Key& key,
+    function_ref<void(const unsigned char*, std::size_t)> reader) const {
+  if (!control_) return Status::Absent;
+
+  const int fd = shm_open(name(key).c_str(), O_RDONLY, 0);
+  if (fd < 0) return Status::Absent;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return Status::Absent;
+  }
+  const std::size_t size = st.st_size;
+  if (size < sizeof(TileHeader)) {  // not sized by its claimer yet
+    close(fd);
+    return Status::Pending;
+  }
+  void* const ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) return Status::Absent;
+
+  const TileHeader* const header = static_cast<const TileHeader*>(ptr);
+  Status status = Status::Pending;
+  if (header->state.load(std::memory_order_acquire) == ready_state) {
+    if (header->world_id != key.world_id || header->obj_id != key.obj_id ||
+        header->ordinal != key.ordinal) {
+      status = Status::Absent;  // another tile with the same name
+    } else if (sizeof(TileHeader) + header->bytes <= size) {
+      try {
+        reader(static_cast<const unsigned char*>(ptr) + sizeof(TileHeader),
+               header->bytes);
+      } catch (...) {
+        munmap(ptr, size);
+        throw;
+      }
+      status = Status::Ready;
+    }
+  }
+  munmap(ptr, size);
+  return status;
+}
+
+NodeTileStore::Claim NodeTileStore::claim(const Key& key,
+                                          const std::size_t expected_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!control_) return Claim::Rejected;
+  const std::string tile_name = name(key);
+  if (index_.count(tile_name)) return Claim::Exists;
+  if (!reserve(expected_bytes)) return Claim::Rejected;
+
+  const int fd = shm_open(tile_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    const bool exists = (errno == EEXIST);
+    control_->bytes -= expected_bytes;
+    return (exists ? Claim::Exists : Claim::Rejected);
+  }
+  void* ptr = MAP_FAILED;
+  if (posix_fallocate(fd, 0, sizeof(TileHeader)) == 0)
+    ptr = mmap(nullptr, sizeof(TileHeader), PROT_READ | PROT_WRITE,
+               MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    shm_unlink(tile_name.c_str());
+    control_->bytes -= expected_bytes;
+    return Claim::Rejected;
+  }
+
+  // The tile stays pending until the state is set by publish()
+  TileHeader* const header = static_cast<TileHeader*>(ptr);
+  header->world_id = key.world_id;
+  header->obj_id = key.obj_id;
+  header->ordinal = key.ordinal;
+  munmap(ptr, sizeof(TileHeader));
+
+  tiles_.push_back(Tile{tile_name, key, expected_bytes, false});
+  index_.emplace(tile_name, std::prev(tiles_.end()));
+  return Claim::Claimed;
+}
+
+void NodeTileStore::publish(
+    const Key& key, const std::size_t bytes,
+    function_ref<void(unsigned char*, std::size_t)> writer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!control_) return;
+  const auto found = index_.find(name(key));
+  if (found == index_.end() || found->second->published)
+    return;  // the tile was erased while it was pending
+  const auto it = found->second;
+
+  // Account for the actual size of the tile
+  if (bytes > it->bytes) {
+    if (!reserve(bytes - it->bytes)) {
+      unlink_tile(it);
+      return;
+    }
+  } else {
+    control_->bytes -= it->bytes - bytes;
+  }
+  it->bytes = bytes;
+
+  const std::size_t size = sizeof(TileHeader) + bytes;
+  void* ptr = MAP_FAILED;
+  const int fd = shm_open(it->name.c_str(), O_RDWR, 0600);
+  if (fd >= 0) {
+    if (posix_fallocate(fd, 0, size) == 0)
+      ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+  }
+  if (ptr == MAP_FAILED) {
+    unlink_tile(it);
+    return;
+  }
+
+  TileHeader* const header = static_cast<TileHeader*>(ptr);
+  try {
+    writer(static_cast<unsigned char*>(ptr) + sizeof(TileHeader), bytes);
+  } catch (...) {
+    munmap(ptr, size);
+    unlink_tile(it);
+    throw;
+  }
+  header->bytes = bytes;
+  header->state.store(ready_state, std::memory_order_release);
+  munmap(ptr, size);
+
+  // Published tiles are evicted oldest first
+  it->published = true;
+  tiles_.splice(tiles_.end(), tiles_, it);
+}
+
+void NodeTileStore::erase(const unsigned long world_id,
+                          const unsigned long obj_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = tiles_.begin(); it != tiles_.end();) {
+    if (it->key.world_id == world_id && it->key.obj_id == obj_id)
+      it = unlink_tile(it);
+    else
+      ++it;
+  }
+}
+
+bool NodeTileStore::reserve(const std::size_t bytes) {
+  std::size_t total = control_->bytes.fetch_add(bytes) + bytes;
+  auto it = tiles_.begin();
+  while (total > budget_) {
+    while (it != tiles_.end() && !it->published) ++it;
+    if (it == tiles_.end()) {
+      control_->bytes -= bytes;
+      return false;
+    }
+    it = unlink_tile(it);
+    ++evictions_;
+    total = control_->bytes.load();
+  }
+  return true;
+}
+
+std::list<NodeTileStore::Tile>::iterator NodeTileStore::unlink_tile(
+    std::list<Tile>::iterator it) {
+  shm_unlink(it->name.c_str());
+  control_->bytes -= it->bytes;
+  index_.erase(it->name);
+  return tiles_.erase(it);
+}
+
+#else  // TILEDARRAY_HAS_POSIX_SHM
+
+bool NodeTileStore::attach(const std::string&, const std::size_t) {
+  return false;
+}
+
+void NodeTileStore::detach() {}
+
+void NodeTileStore::remove(const std::string&) {}
+
+NodeTileStore::Status NodeTileStore::read(
+    const Key&, function_ref<void(const unsigned char*, std::size_t)>) const {
+  return Status::Absent;
+}
+
+NodeTileStore::Claim NodeTileStore::claim(const Key&, const std::size_t) {
+  return Claim::Rejected;
+}
+
+void NodeTileStore::publish(const Key&, const std::size_t,
+                            function_ref<void(unsigned char*, std::size_t)>) {
+}
+
+void NodeTileStore::erase(const unsigned long, const unsigned long) {}
+
+bool NodeTileStore::reserve(const std::size_t) { return false; }
+
+std::list<NodeTileStore::Tile>::iterator NodeTileStore::unlink_tile(
+    std::list<Tile>::iterator it) {
+  return tiles_.erase(it);
+}
+
+#endif  // TILEDARRAY_HAS_POSIX_SHM
+
+}  // namespace detail
+}  // namespace TiledArray
@@ -0,0 +1,192 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_NODE_TILE_STORE_H__INCLUDED
+#define TILEDARRAY_NODE_TILE_STORE_H__INCLUDED
+
+#include <TiledArray/config.h>
+#include <TiledArray/util/function.h>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace TiledArray {
+namespace detail {
+
+/// Serialized tiles shared by the processes of a node
+
+/// Each tile is held in a POSIX shared-memory object whose name is derived
+/// from a job-wide prefix and the key of the tile (the id of the array
+/// storage and the tile ordinal), hence the processes of a node find the
+/// tiles stored by each other without communication. The process that
+/// first requests a tile claims its object and publishes the serialized
+/// tile when it arrives; the other processes read it from there (or wait
+/// for it while it is pending) instead of fetching it from its owner.
+/// The size of the tiles stored on the node is accounted for in a control
+/// object shared by the processes; a process that exceeds the budget
+/// evicts the oldest tiles it has stored itself. Readers copy a tile out of
+/// its object, hence an evicted object is released as soon as it is
+/// unlinked.
+/// \note The store is available if the platform provides \c shm_open and
+/// \c posix_fallocate (see supported()); otherwise no tiles are ever
+/// stored. All processes of a node must use the same budget.
+class NodeTileStore {
+ public:
+  /// The state of a tile in the store
+  enum class Status { Absent, Pending, Ready };
+
+  /// The outcome of a claim
+  enum class Claim {
+    Claimed,  ///< This process must publish the tile
+    Exists,   ///< Another process has claimed the tile
+    Rejected  ///< The tile does not fit in the budget
+  };
+
+  /// The key of a tile
+  struct Key {
+    unsigned long world_id;  ///< The world id of the array storage
+    unsigned long obj_id;    ///< The object id of the array storage
+    std::size_t ordinal;     ///< The tile ordinal
+  };  // struct Key
+
+  NodeTileStore() = default;
+  NodeTileStore(const NodeTileStore&) = delete;
+  NodeTileStore& operator=(const NodeTileStore&) = delete;
+
+  /// Destructor, removes the tiles stored by this process
+  ~NodeTileStore() { detach(); }
+
+  /// \return \c true if the platform provides POSIX shared memory
+  static bool supported();
+
+  /// \return A name prefix that is unlikely to be used by another job
+  static std::string unique_prefix();
+
+  /// Attach this process to the store of its node
+
+  /// All processes of a job that share tiles must use the same \c prefix.
+  /// \param prefix The name prefix of the shared-memory objects of the job;
+  /// it must begin with '/' and hold no other '/'
+  /// \param budget The maximum size of the tiles stored on the node, in
+  /// bytes
+  /// \return \c true if the store could be attached
+  bool attach(const std::string& prefix, const std::size_t budget);
+
+  /// Detach this process from the store and remove the tiles it stored
+  void detach();
+
+  /// Remove the control object of the store
+
+  /// This must be called once all processes of the node have detached.
+  /// \param prefix The name prefix of the shared-memory objects of the job
+  static void remove(const std::string& prefix);
+
+  /// \return \c true if this process is attached to the store
+  bool attached() const { return control_ != nullptr; }
+
+  /// \return The size of the tiles stored on this node, in bytes
+  std::size_t size_bytes() const;
+
+  /// \return The number of tiles evicted by this process
+  std::size_t evictions() const { return evictions_; }
+
+  /// Reset the eviction counter
+  void reset_evictions() { evictions_ = 0ul; }
+
+  /// Read a tile
+
+  /// \param key The key of the tile
+  /// \param reader The function that deserializes the tile from its
+  /// buffer, it is only called if the tile is ready
+  /// \return The state of the tile
+  Status read(const Key& key,
+              function_ref<void(const unsigned char*, std::size_t)> reader)
+      const;
+
+  /// Claim a tile that is absent from the store
+
+  /// On success the expected size of the tile is reserved in the budget and
+  /// the tile is pending until it is published (or abandoned) by this
+  /// process.
+  /// \param key The key of the tile
+  /// \param expected_bytes The expected size of the serialized tile
+  /// \return The outcome of the claim
+  Claim claim(const Key& key, const std::size_t expected_bytes);
+
+  /// Publish a claimed tile
+
+  /// \param key The key of the tile
+  /// \param bytes The size of the serialized tile
+  /// \param writer The function that serializes the tile into its buffer
+  void publish(const Key& key, const std::size_t bytes,
+               function_ref<void(unsigned char*, std::size_t)> writer);
+
+  /// Remove the tiles of an array that were stored by this process
+
+  /// \param world_id The world id of the array storage
+  /// \param obj_id The object id of the array storage
+  void erase(const unsigned long world_id, const unsigned long obj_id);
+
+ private:
+  /// A tile stored (or claimed) by this process
+  struct Tile {
+    std::string name;   ///< The name of the shared-memory object
+    Key key;            ///< The key of the tile
+    std::size_t bytes;  ///< The size accounted for in the budget
+    bool published;     ///< \c false while the tile is pending
+  };  // struct Tile
+
+  struct Control;
+
+  /// \param key The key of a tile
+  /// \return The name of the shared-memory object of the tile
+  std::string name(const Key& key) const;
+
+  /// Reserve room in the budget, evicting tiles stored by this process
+
+  /// \note Assumes \c mutex_ is locked
+  /// \param bytes The size to reserve
+  /// \return \c true if the size could be reserved
+  bool reserve(const std::size_t bytes);
+
+  /// Unlink a tile stored by this process and release its size
+
+  /// \note Assumes \c mutex_ is locked
+  /// \param it The tile
+  /// \return The next tile
+  std::list<Tile>::iterator unlink_tile(std::list<Tile>::iterator it);
+
+  std::string prefix_;          ///< The name prefix of the job
+  Control* control_ = nullptr;  ///< The control object of the node
+  std::size_t budget_ = 0ul;    ///< The budget of the node, in bytes
+  std::atomic<std::size_t> evictions_{0ul};  ///< The number of evictions
+  mutable std::mutex mutex_;  ///< Protects the tiles of this process
+  std::list<Tile> tiles_;     ///< The tiles of this process, oldest first
+  std::unordered_map<std::string, std::list<Tile>::iterator>
+      index_;  ///< The tiles of this process, by name
+};  // class NodeTileStore
+
+}  // namespace detail
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_NODE_TILE_STORE_H__INCLUDED
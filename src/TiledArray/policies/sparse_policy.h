@@ -26,6 +26,7 @@
 #ifndef TILEDARRAY_SPARSE_ARRAY_H__INCLUDED
 #define TILEDARRAY_SPARSE_ARRAY_H__INCLUDED
 
+#include <TiledArray/compressed_sparse_shape.h>
 #include <TiledArray/pmap/blocked_pmap.h>
 #include <TiledArray/sparse_shape.h>
 #include <TiledArray/tiled_range.h>
@@ -54,6 +55,16 @@ class SparsePolicy {
 
 };  // class SparsePolicy
 
+/// Sparse policy with compressed shape storage
+
+/// Same as SparsePolicy, but the shape only stores the norms of the nonzero
+/// tiles (see CompressedSparseShape); use for arrays with very many tiles
+/// of which very few are nonzero.
+class CompressedSparsePolicy : public SparsePolicy {
+ public:
+  typedef TiledArray::CompressedSparseShape<float> shape_type;
+};  // class CompressedSparsePolicy
+
 }  // namespace TiledArray
 
 #endif  // TILEDARRAY_SPARSE_ARRAY_H__INCLUDED
@@ -24,6 +24,14 @@
 #include <TiledArray/error.h>
 #include <TiledArray/external/madness.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #ifdef TILEDARRAY_HAS_CUDA
 #include <TiledArray/cuda/cuda_task_fn.h>
 #include <TiledArray/external/cuda.h>
@@ -972,6 +980,544 @@ class ReducePairTask : public ReduceTask<ReducePairOpWrapper<opT> > {
 
 };  // class ReducePairTask
 
+/// Concurrent reduce task
+
+/// This task has the same interface and semantics as ReduceTask, but is
+/// designed for reductions with a large number of arguments (a high fan-in),
+/// e.g. the reduction of all contributions to a result tile of a
+/// contraction. ReduceTask hands each argument that becomes ready to a new
+/// task that combines it with another ready argument or partial result;
+/// with a high fan-in many such tasks, and the temporary results they
+/// create, are in flight at the same time. Instead, here the arguments that
+/// become ready are pushed onto a lock-free stack, which is drained by at
+/// most \c max_partials concurrent reducer tasks. Each reducer task owns a
+/// partial result that it accumulates the arguments into, and arguments are
+/// released as soon as they have been reduced. When all arguments have been
+/// reduced, the partial results are merged into the final result. Hence,
+/// the number of partial result objects is bounded, independently of the
+/// number of arguments, and threads never wait for each other.
+/// The number of arguments that have been added but not yet reduced can
+/// also be bounded (see \c max_pending ); add() then applies backpressure
+/// to the producer of the arguments by executing other tasks until an
+/// argument has been reduced.
+/// The reduction operation must have the same form as that of ReduceTask.
+/// \note Unlike ReduceTask, this task does not synchronize the reductions
+/// with CUDA streams, hence it must not be used to reduce CUDA tiles.
+/// \tparam opT The reduction operation type
+template <typename opT>
+class ConcurrentReduceTask {
+ private:
+  typedef typename opT::result_type result_type;
+  typedef typename std::remove_const<
+      typename std::remove_reference<typename opT::argument_type>::type>::type
+      argument_type;
+
+  /// Concurrent reduction task implementation
+
+  /// This object is the task that merges the partial results, which is
+  /// submitted to the task queue; it depends on every argument and on every
+  /// running reducer task. It also holds the data shared by the reducer
+  /// tasks.
+  class ConcurrentReduceTaskImpl : public madness::TaskInterface {
+   public:
+    /// Reduction argument container
+
+    /// This object holds the reduction argument. When the arguments to
+    /// this object are ready, it is pushed onto the stack of ready objects.
+    class ReduceObject : public madness::CallbackInterface {
+     private:
+      ConcurrentReduceTaskImpl* parent_;  ///< The parent task
+      typename ArgumentHelper<argument_type>::type
+          arg_;                               ///< The reduction argument
+      madness::CallbackInterface* callback_;  ///< Reduction callback
+      madness::AtomicInt count_;              ///< Dependency counter
+
+      /// Register a future as a dependency
+
+      /// \tparam T The type of the future
+      /// \param f The future that this object depends on
+      template <typename T>
+      void register_callbacks(Future<T>& f) {
+        if (f.probe()) {
+          parent_->ready(this);
+        } else {
+          count_ = 1;
+          f.register_callback(this);
+        }
+      }
+
+      /// Register a pair of futures as dependencies
+
+      /// \tparam T The type of the first future
+      /// \tparam U The type of the second future
+      /// \param p The pair of futures that this object depends on
+      template <typename T, typename U>
+      void register_callbacks(std::pair<Future<T>, Future<U> >& p) {
+        if (p.first.probe() && p.second.probe()) {
+          parent_->ready(this);
+        } else {
+          count_ = 2;
+          p.first.register_callback(this);
+          p.second.register_callback(this);
+        }
+      }
+
+     public:
+      ReduceObject* next = nullptr;  ///< The next object in the ready stack
+
+      /// Constructor
+
+      /// \tparam Arg The argument type
+      /// \param parent The owner of this object
+      /// \param arg The reduction argument
+      /// \param callback The callback to invoke when this argument has been
+      /// reduced
+      template <typename Arg>
+      ReduceObject(ConcurrentReduceTaskImpl* parent, const Arg& arg,
+                   madness::CallbackInterface* callback)
+          : parent_(parent), arg_(arg), callback_(callback) {
+        TA_ASSERT(parent_);
+        register_callbacks(arg_);
+      }
+
+      virtual ~ReduceObject() {}
+
+      /// Callback function that is invoked when the argument is ready
+      virtual void notify() {
+        if ((--count_) == 0) parent_->ready(this);
+      }
+
+      /// Argument accessor
+
+      /// \return A const reference to the reduction argument
+      const argument_type& arg() const { return arg_; }
+
+      /// Destroy the \c object
+
+      /// This function will invoke the callback and delete object.
+      /// \param object The reduce object to be destroyed
+      static void destroy(const ReduceObject* object) {
+        ConcurrentReduceTaskImpl* const parent = object->parent_;
+        if (object->callback_) object->callback_->notify();
+        delete object;
+        --(parent->pending_);
+      }
+
+    };  // class ReduceObject
+
+    /// The maximum number of partial results
+    static constexpr const unsigned int max_partials_limit = 64u;
+
+    World& world_;  ///< The world that owns this task
+    opT op_;        ///< The reduction operation
+    /// The top of the (lock-free) stack of ready reduction arguments
+    std::atomic<ReduceObject*> ready_;
+    /// Bit mask of the partial results that are not in use by a reducer task
+    std::atomic<std::uint64_t> free_partials_;
+    /// The partial results, each is used by at most one reducer task at a time
+    std::vector<std::unique_ptr<result_type> > partials_;
+    Future<result_type> result_;            ///< The result of the reduction
+    madness::CallbackInterface* callback_;  ///< The completion callback
+    /// The number of arguments that have been added but not yet reduced
+    std::atomic<std::size_t> pending_;
+    /// The maximum number of unreduced arguments (0 means no limit)
+    std::size_t max_pending_;
+
+    /// Claim an unused partial result
+
+    /// \return The index of the partial result, or \c partials_.size() if
+    /// all partial results are in use
+    unsigned int acquire_partial() {
+      std::uint64_t free_partials = free_partials_.load();
+      while (free_partials) {
+        // Try to claim the lowest unused partial result
+        const std::uint64_t bit = free_partials & (~free_partials + 1u);
+        if (free_partials_.compare_exchange_weak(free_partials,
+                                                 free_partials & ~bit)) {
+          unsigned int p = 0u;
+          while (!((bit >> p) & 1u)) ++p;
+          return p;
+        }
+      }
+      return partials_.size();
+    }
+
+    /// Release a partial result
+
+    /// \param p The index of the partial result
+    void release_partial(const unsigned int p) {
+      free_partials_.fetch_or(std::uint64_t(1) << p);
+    }
+
+    /// Reducer task function
+
+    /// Reduces the ready arguments into partial result \c p until there are
+    /// no more ready arguments.
+    /// \param p The index of the partial result claimed for this task
+    void reduce(unsigned int p) {
+      // The dependencies of this task are released only at the very end,
+      // since this task may be run, and deleted, as soon as they are.
+      int reduced = 0;
+      while (true) {
+        // Take all ready arguments at once, which is free of the ABA problem
+        ReduceObject* object = ready_.exchange(nullptr);
+        if (object && !partials_[p])
+          partials_[p] = std::make_unique<result_type>(op_());
+        while (object) {
+          ReduceObject* const next = object->next;
+          op_(*partials_[p], object->arg());
+          ReduceObject::destroy(object);
+          ++reduced;
+          object = next;
+        }
+
+        // Release the partial result, unless an argument became ready after
+        // the stack was emptied and no other reducer task is available to
+        // reduce it.
+        release_partial(p);
+        if (ready_.load() == nullptr) break;
+        p = acquire_partial();
+        if (p == partials_.size()) break;
+      }
+
+      for (; reduced > 0; --reduced) this->dec();
+      this->dec();  // the dependency of this reducer task
+    }
+
+   public:
+    /// Constructor
+
+    /// \param world The world that owns this task
+    /// \param op The reduction operation
+    /// \param callback The callback that will be invoked when this task is
+    /// complete
+    /// \param max_partials The maximum number of partial results, i.e. the
+    /// maximum number of concurrent reducer tasks; if zero, the number of
+    /// threads is used
+    /// \param max_pending The maximum number of unreduced arguments; if
+    /// zero, the number is not limited
+    ConcurrentReduceTaskImpl(World& world, opT op,
+                             madness::CallbackInterface* callback,
+                             unsigned int max_partials,
+                             std::size_t max_pending)
+        : madness::TaskInterface(1, TaskAttributes::hipri()),
+          world_(world),
+          op_(op),
+          ready_(nullptr),
+          free_partials_(),
+          partials_(),
+          result_(),
+          callback_(callback),
+          pending_(0ul),
+          max_pending_(max_pending) {
+      if (max_partials == 0u)
+        max_partials =
+            static_cast<unsigned int>(madness::ThreadPool::size()) + 1u;
+      max_partials = std::min(max_partials, max_partials_limit);
+      partials_.resize(max_partials);
+      free_partials_ = (max_partials == max_partials_limit
+                            ? ~std::uint64_t(0)
+                            : (std::uint64_t(1) << max_partials) - 1u);
+    }
+
+    virtual ~ConcurrentReduceTaskImpl() {}
+
+    virtual void get_id(std::pair<void*, unsigned short>& id) const {
+      return PoolTaskInterface::make_id(id, *this);
+    }
+
+    /// Task function that merges the partial results
+    virtual void run(const madness::TaskThreadEnv&) {
+      TA_ASSERT(ready_.load() == nullptr);
+      std::unique_ptr<result_type> result;
+      for (auto& partial : partials_) {
+        if (!partial) continue;
+        if (result)
+          op_(*result, *partial);
+        else
+          result = std::move(partial);
+        partial.reset();
+      }
+      if (!result) result = std::make_unique<result_type>(op_());
+      result_.set(op_(*result));
+
+      if (callback_) callback_->notify();
+    }
+
+    /// Reduce argument ready callback
+
+    /// The object is pushed onto the stack of ready objects and, if a partial
+    /// result is available, a new reducer task is spawned; otherwise the
+    /// object will be reduced by one of the running reducer tasks.
+    /// \param object The reduction argument that is ready to be reduced
+    void ready(ReduceObject* object) {
+      TA_ASSERT(object);
+      // Add the dependency of a reducer task first; once object is on the
+      // stack it may be reduced, and this task run, at any time.
+      this->inc();
+      object->next = ready_.load();
+      while (!ready_.compare_exchange_weak(object->next, object))
+        ;
+
+      const unsigned int p = acquire_partial();
+      if (p != partials_.size())
+        world_.taskq.add(this, &ConcurrentReduceTaskImpl::reduce, p,
+                         TaskAttributes::hipri());
+      else
+        this->dec();  // a running reducer task will reduce object
+    }
+
+    /// Reserve room for another argument
+
+    /// If the number of unreduced arguments has reached the limit, the
+    /// calling thread executes other tasks, including the reducer tasks of
+    /// this object, until an argument has been reduced. The slot is claimed
+    /// atomically, hence concurrent producers cannot exceed the limit.
+    void reserve() {
+      std::size_t pending = pending_.load();
+      while (true) {
+        if (max_pending_ != 0ul && pending >= max_pending_) {
+          world_.await([this]() { return pending_.load() < max_pending_; });
+          pending = pending_.load();
+        } else if (pending_.compare_exchange_weak(pending, pending + 1ul)) {
+          return;
+        }
+      }
+    }
+
+    /// \return The number of arguments that have not been reduced yet
+    std::size_t pending() const { return pending_.load(); }
+
+    /// Task result accessor
+
+    /// \return A future that will hold the result of the reduction task
+    const Future<result_type>& result() const { return result_; }
+
+    /// World accessor
+
+    /// \return The world that owns this task.
+    World& world() const { return world_; }
+
+  };  // class ConcurrentReduceTaskImpl
+
+  ConcurrentReduceTaskImpl* pimpl_;  ///< The reduction task object.
+  std::atomic<std::size_t> count_;   ///< Reduction argument counter
+
+ public:
+  /// Default constructor
+  ConcurrentReduceTask() : pimpl_(nullptr), count_(0ul) {}
+
+  /// Constructor
+
+  /// \param world The world that owns this task
+  /// \param op The reduction operation [ default = opT() ]
+  /// \param callback The callback that will be invoked when this task is
+  /// complete
+  /// \param max_partials The maximum number of partial results, i.e. of
+  /// concurrent reducer tasks, at most 64 [ default = 0, i.e. the number of
+  /// threads ]
+  /// \param max_pending The maximum number of arguments that have been
+  /// added but not yet reduced [ default = 0, i.e. no limit ]
+  /// \warning With a limit, add() waits until an argument has been reduced,
+  /// hence the pending arguments must not depend on work that the caller of
+  /// add() does after it returns.
+  ConcurrentReduceTask(World& world, const opT& op = opT(),
+                       madness::CallbackInterface* callback = nullptr,
+                       unsigned int max_partials = 0u,
+                       std::size_t max_pending = 0ul)
+      : pimpl_(new ConcurrentReduceTaskImpl(world, op, callback, max_partials,
+                                            max_pending)),
+        count_(0ul) {}
+
+  /// Move constructor
+
+  /// \param other The object to be moved
+  ConcurrentReduceTask(ConcurrentReduceTask<opT>&& other) noexcept
+      : pimpl_(other.pimpl_), count_(other.count_.load()) {
+    other.pimpl_ = nullptr;
+    other.count_ = 0ul;
+  }
+
+  /// Destructor
+  ~ConcurrentReduceTask() { delete pimpl_; }
+
+  /// Move assignment operator
+
+  /// \param other The object to be moved
+  ConcurrentReduceTask<opT>& operator=(
+      ConcurrentReduceTask<opT>&& other) noexcept {
+    pimpl_ = other.pimpl_;
+    count_ = other.count_.load();
+    other.pimpl_ = nullptr;
+    other.count_ = 0;
+    return *this;
+  }
+
+  // Non-copyable
+  ConcurrentReduceTask(const ConcurrentReduceTask<opT>&) = delete;
+  ConcurrentReduceTask<opT>& operator=(const ConcurrentReduceTask<opT>&) =
+      delete;
+
+  /// Add an argument to the reduction task
+
+  /// \c arg may be of the argument type of \c opT, a \c Future to the
+  /// argument type, or \c RemoteReference<FutureImpl> to the argument
+  /// type. If the maximum number of unreduced arguments has been reached,
+  /// this waits (executing other tasks) until an argument has been reduced.
+  /// \tparam Arg The argument type
+  /// \param arg The argument that will be reduced
+  /// \param callback The callback that will be invoked when this argument
+  /// pair has been reduced [ default = nullptr ]
+  template <typename Arg>
+  int add(const Arg& arg, madness::CallbackInterface* callback = nullptr) {
+    TA_ASSERT(pimpl_);
+    pimpl_->reserve();
+    pimpl_->inc();
+    new typename ConcurrentReduceTaskImpl::ReduceObject(pimpl_, arg, callback);
+    return ++count_;
+  }
+
+  /// Argument count
+
+  /// \return The total number of arguments added to this task
+  int count() const { return count_; }
+
+  /// Unreduced argument count
+
+  /// \return The number of arguments that have been added to this task but
+  /// not yet reduced
+  std::size_t pending() const {
+    TA_ASSERT(pimpl_);
+    return pimpl_->pending();
+  }
+
+  /// Submit the reduction task to the task queue
+
+  /// \return The result of the reduction
+  /// \note Arguments can no longer be added to the reduction after calling
+  /// \c submit().
+  Future<result_type> submit() {
+    TA_ASSERT(pimpl_);
+
+    Future<result_type> result = pimpl_->result();
+
+    pimpl_->dec();
+    World& world = pimpl_->world();
+    world.taskq.add(pimpl_);
+
+    pimpl_ = nullptr;
+    return result;
+  }
+
+  /// Implicit conversion to bool
+
+  /// \return \c true if the task has been initialized and not yet submitted
+  operator bool() const { return pimpl_ != nullptr; }
+
+};  // class ConcurrentReduceTask
+
+/// Concurrent reduce pair task
+
+/// This task has the same interface and semantics as ReducePairTask, but
+/// reduces the argument pairs with a ConcurrentReduceTask.
+/// \tparam opT The pair reduction operation type
+template <typename opT>
+class ConcurrentReducePairTask
+    : public ConcurrentReduceTask<ReducePairOpWrapper<opT> > {
+ private:
+  typedef ReducePairOpWrapper<opT> op_type;  ///< The reduction operation type
+  typedef typename op_type::first_argument_type
+      first_argument_type;  ///< The left-hand reduction argument type
+  typedef typename op_type::second_argument_type
+      second_argument_type;  /// The right-hand reduction argument type
+  typedef typename op_type::argument_type
+      argument_type;  ///< The pair reduction argument type
+  typedef ConcurrentReduceTask<op_type>
+      ConcurrentReduceTask_;  ///< The base class
+
+ public:
+  /// Default constructor
+  ConcurrentReducePairTask() : ConcurrentReduceTask_() {}
+
+  /// Constructor
+
+  /// \param world The world that owns this task
+  /// \param op The pair reduction operation [ default = opT() ]
+  /// \param callback The callback that will be invoked when this task is
+  /// complete
+  /// \param max_partials The maximum number of partial results
+  /// [ default = 0, i.e. the number of threads ]
+  /// \param max_pending The maximum number of unreduced argument pairs
+  /// [ default = 0, i.e. no limit ]
+  ConcurrentReducePairTask(World& world, const opT& op = opT(),
+                           madness::CallbackInterface* callback = nullptr,
+                           unsigned int max_partials = 0u,
+                           std::size_t max_pending = 0ul)
+      : ConcurrentReduceTask_(world, op_type(op), callback, max_partials,
+                              max_pending) {}
+
+  /// Move constructor
+
+  /// \param other The object to be moved
+  ConcurrentReducePairTask(ConcurrentReducePairTask<opT>&& other) noexcept
+      : ConcurrentReduceTask_(std::move(other)) {}
+
+  /// Move assignment operator
+
+  /// \param other The object to be moved
+  ConcurrentReducePairTask<opT>& operator=(
+      ConcurrentReducePairTask<opT>&& other) noexcept {
+    ConcurrentReduceTask_::operator=(std::move(other));
+    return *this;
+  }
+
+  /// Non-copyable
+  ConcurrentReducePairTask(const ConcurrentReducePairTask<opT>&) = delete;
+  ConcurrentReducePairTask<opT> operator=(
+      const ConcurrentReducePairTask<opT>&) = delete;
+
+  /// Add a pair of arguments to the reduction task
+
+  /// \tparam L The left-hand object type
+  /// \tparam R The right-hand object type
+  /// \param left The left-hand argument that will be reduced
+  /// \param right The right-hand argument that will be reduced
+  /// \param callback The callback that will be invoked when this argument
+  /// pair has been reduced [ default = nullptr ]
+  /// \sa ReducePairTask::add
+  template <typename L, typename R>
+  void add(const L& left, const R& right,
+           madness::CallbackInterface* callback = nullptr) {
+    ConcurrentReduceTask_::add(
+        argument_type(Future<first_argument_type>(left),
+                      Future<second_argument_type>(right)),
+        callback);
+  }
+
+};  // class ConcurrentReducePairTask
+
+/// Tag of the keys of collective reductions
+struct ReductionKeyTag {};
+
+/// The key type of collective reductions
+typedef madness::TaggedKey<std::size_t, ReductionKeyTag> reduction_key_type;
+
+/// Provides a unique key for a collective reduction
+
+/// The keys of a World are drawn from a counter that persists for the
+/// lifetime of the program, hence a key is never reused while a reduction
+/// may still be in flight, and drawing a key requires no communication.
+/// Like the collectives themselves, keys must be drawn in the same order on
+/// every rank of the World.
+/// \param world The world of the reduction
+/// \return A key that is unique in \c world
+inline reduction_key_type next_reduction_key(World& world) {
+  static std::mutex mutex;
+  static std::unordered_map<std::uint64_t, std::size_t> counters;
+  std::lock_guard<std::mutex> lock(mutex);
+  return reduction_key_type(counters[world.id()]++);
+}
+
 }  // namespace detail
 }  // namespace TiledArray
 
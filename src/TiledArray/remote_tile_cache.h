@@ -0,0 +1,530 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_REMOTE_TILE_CACHE_H__INCLUDED
+#define TILEDARRAY_REMOTE_TILE_CACHE_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <TiledArray/external/madness.h>
+#include <TiledArray/node_tile_store.h>
+#include <madness/world/buffer_archive.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace TiledArray {
+
+/// Cache of remote tiles
+
+/// Arrays are read-only once their tiles are set, hence a remote tile that
+/// is requested repeatedly (e.g. by several expressions that read the same
+/// block of an array) needs to cross the network only once. The cache works
+/// at two levels:
+/// - Each process holds the futures of the remote tiles it requested
+///   through DistributedStorage::get(), keyed by the id of the array and the
+///   tile ordinal. A repeated request is served with the cached future,
+///   hence the tile is shared with the cache (see below). The tiles are
+///   evicted in least-recently-used order when the size of the cached
+///   tiles exceeds the budget of the process (see set_budget()); the
+///   expected size of a tile is reserved while it is in flight.
+/// - With share_within_node(), the processes of a node also share the
+///   serialized tiles through POSIX shared memory (see
+///   detail::NodeTileStore): a tile that is not cached by a process is read
+///   from the node store if another process of the node has stored it, or
+///   is waited for if it is being fetched, and is only requested from its
+///   owner otherwise. Hence each tile crosses the network at most once per
+///   node while it is held by the node store.
+///
+/// The entries of an array are removed when the array is destroyed. The
+/// cache is disabled by default.
+/// \code
+/// auto& cache = TiledArray::RemoteTileCache::instance();
+/// cache.set_budget(1ul << 28);                // 256 MiB per process
+/// cache.share_within_node(world, 1ul << 32);  // 4 GiB per node
+/// \endcode
+/// \note Like the local tiles of an array, the remote tiles served through
+/// the cache are shared with other readers and must not be modified; use
+/// TiledArray::clone() to obtain a private copy. Array evaluators copy a
+/// remote tile only if the operation applied to it would modify it.
+class RemoteTileCache : private madness::Spinlock {
+ public:
+  /// Cache statistics
+  struct Statistics {
+    std::size_t hits = 0ul;       ///< The number of requests served
+    std::size_t node_hits = 0ul;  ///< The requests served by the node store
+    std::size_t misses = 0ul;     ///< The number of remote requests
+    std::size_t evictions = 0ul;  ///< The number of evicted tiles
+    std::size_t node_evictions = 0ul;  ///< The tiles evicted from the node
+
+    /// \return The fraction of the requests served without a remote request
+    double hit_rate() const {
+      const std::size_t requests = hits + node_hits + misses;
+      return (requests ? double(hits + node_hits) / double(requests) : 0.0);
+    }
+  };  // struct Statistics
+
+  RemoteTileCache(const RemoteTileCache&) = delete;
+  RemoteTileCache& operator=(const RemoteTileCache&) = delete;
+
+  /// Destructor, removes the tiles this process stored on its node
+  ~RemoteTileCache() {
+    if (node_shared_) {
+      store_.detach();
+      detail::NodeTileStore::remove(prefix_);
+    }
+  }
+
+  /// \return The cache of this process
+  static RemoteTileCache& instance() {
+    static RemoteTileCache cache;
+    return cache;
+  }
+
+  /// Set the memory budget of this process
+
+  /// \param bytes The maximum size of the tiles cached by this process, in
+  /// bytes; zero disables the cache of this process and releases all its
+  /// cached tiles
+  void set_budget(const std::size_t bytes) {
+    madness::ScopedMutex<madness::Spinlock> locker(this);
+    budget_ = bytes;
+    if (bytes == 0ul) {
+      entries_.clear();
+      lru_.clear();
+      bytes_ = 0ul;
+    } else {
+      evict();
+    }
+  }
+
+  /// \return The memory budget of this process, in bytes
+  std::size_t budget() const { return budget_; }
+
+  /// Share the cached tiles with the other processes of the node
+
+  /// This function must be called collectively by all processes of
+  /// \c world, with the same budget.
+  /// \param world The world of the processes that share tiles
+  /// \param bytes The maximum size of the tiles stored on each node, in
+  /// bytes; zero stops sharing and removes the stored tiles
+  /// \return \c true if the tiles are shared, which requires POSIX shared
+  /// memory (see detail::NodeTileStore::supported())
+  bool share_within_node(World& world, const std::size_t bytes) {
+    if (node_shared_) {
+      node_shared_ = false;
+      store_.detach();
+      world.gop.fence();
+      detail::NodeTileStore::remove(prefix_);
+    }
+    if (bytes == 0ul || !detail::NodeTileStore::supported()) return false;
+
+    // The processes of the job agree on the names of the shared tiles
+    char prefix[16] = {};
+    if (world.rank() == 0) {
+      const std::string unique = detail::NodeTileStore::unique_prefix();
+      TA_ASSERT(unique.size() < sizeof(prefix));
+      unique.copy(prefix, unique.size());
+    }
+    world.gop.broadcast(prefix, sizeof(prefix), 0);
+    prefix_ = prefix;
+    node_shared_ = store_.attach(prefix_, bytes);
+    return node_shared_;
+  }
+
+  /// \return \c true if the tiles are shared with the processes of the node
+  bool node_shared() const { return node_shared_; }
+
+  /// \return \c true if the cache is enabled
+  bool enabled() const { return budget_ != 0ul || node_shared_; }
+
+  /// \return The size of the tiles cached by this process, in bytes
+  std::size_t size_bytes() const {
+    madness::ScopedMutex<madness::Spinlock> locker(this);
+    return bytes_;
+  }
+
+  /// \return The size of the tiles stored on the node, in bytes
+  std::size_t node_size_bytes() const { return store_.size_bytes(); }
+
+  /// \return The number of tiles cached by this process
+  std::size_t size() const {
+    madness::ScopedMutex<madness::Spinlock> locker(this);
+    return entries_.size();
+  }
+
+  /// \return The cache statistics
+  Statistics statistics() const {
+    madness::ScopedMutex<madness::Spinlock> locker(this);
+    Statistics result = statistics_;
+    result.node_evictions = store_.evictions();
+    return result;
+  }
+
+  /// Reset the cache statistics
+  void reset_statistics() {
+    madness::ScopedMutex<madness::Spinlock> locker(this);
+    statistics_ = Statistics();
+    store_.reset_evictions();
+  }
+
+  /// Remove the tiles of an array
+
+  /// \param id The id of the array storage
+  void erase(const madness::uniqueidT& id) {
+    if (node_shared_) store_.erase(id.get_world_id(), id.get_obj_id());
+    madness::ScopedMutex<madness::Spinlock> locker(this);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->first.world_id == id.get_world_id() &&
+          it->first.obj_id == id.get_obj_id()) {
+        bytes_ -= it->second.bytes;
+        lru_.erase(it->second.lru);
+        it = entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  /// Get a remote tile
+
+  /// \tparam T The tile type
+  /// \tparam Fetch A nullary function type that returns a \c Future<T>
+  /// \param world The world of the array
+  /// \param id The id of the array storage
+  /// \param ordinal The ordinal of the tile
+  /// \param expected_bytes The expected size of the tile, which is reserved
+  /// in the budget until the tile arrives
+  /// \param fetch The function that requests the tile from its owner
+  /// \return A future to the tile, which may be shared with the cache
+  template <typename T, typename Fetch>
+  Future<T> find_or_fetch(World& world, const madness::uniqueidT& id,
+                          const std::size_t ordinal,
+                          const std::size_t expected_bytes, Fetch&& fetch) {
+    const Key key{id.get_world_id(), id.get_obj_id(), ordinal};
+    {
+      madness::ScopedMutex<madness::Spinlock> locker(this);
+      auto it = entries_.find(key);
+      if (it != entries_.end()) {
+        ++statistics_.hits;
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        return *std::static_pointer_cast<Future<T>>(it->second.tile);
+      }
+    }
+
+    // Read the tile from the node store, or request it from its owner
+    bool publish = false;
+    Future<T> result = node_find_or_fetch<T>(world, key, expected_bytes,
+                                             fetch, publish);
+
+    std::uint64_t generation = 0ul;
+    {
+      madness::ScopedMutex<madness::Spinlock> locker(this);
+      if (budget_ != 0ul && !entries_.count(key)) {
+        generation = ++generation_;
+        lru_.push_front(key);
+        entries_.emplace(key, Entry{std::make_shared<Future<T>>(result),
+                                    expected_bytes, lru_.begin(), generation});
+        bytes_ += expected_bytes;
+        evict();
+      }
+    }
+
+    // The size of the tile is known once it arrives, a tile claimed in the
+    // node store is then published
+    if (generation != 0ul || publish)
+      result.register_callback(new ArrivalCallback<T>(
+          world, *this, key, generation, publish, result));
+
+    return result;
+  }
+
+ private:
+  /// Cache key
+  struct Key {
+    unsigned long world_id;  ///< The world id of the array storage
+    unsigned long obj_id;    ///< The object id of the array storage
+    std::size_t ordinal;     ///< The tile ordinal
+
+    bool operator==(const Key& other) const {
+      return world_id == other.world_id && obj_id == other.obj_id &&
+             ordinal == other.ordinal;
+    }
+
+    /// \return The key of the tile in the node store
+    detail::NodeTileStore::Key node_key() const {
+      return detail::NodeTileStore::Key{world_id, obj_id, ordinal};
+    }
+  };  // struct Key
+
+  /// Cache key hash function
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const {
+      std::size_t seed = std::hash<unsigned long>()(key.world_id);
+      madness::hash_combine(seed, key.obj_id);
+      madness::hash_combine(seed, key.ordinal);
+      return seed;
+    }
+  };  // struct KeyHash
+
+  /// Cache entry
+  struct Entry {
+    std::shared_ptr<void> tile;  ///< The future to the tile
+    /// The size of the tile, or the expected size while it is in flight
+    std::size_t bytes;
+    std::list<Key>::iterator lru;  ///< The position in the LRU list
+    std::uint64_t generation;      ///< Distinguishes reinserted entries
+  };  // struct Entry
+
+  /// Records the size of a tile when it arrives, and publishes it
+  template <typename T>
+  class ArrivalCallback : public madness::CallbackInterface {
+   public:
+    ArrivalCallback(World& world, RemoteTileCache& cache, const Key& key,
+                    const std::uint64_t generation, const bool publish,
+                    const Future<T>& tile)
+        : world_(world),
+          cache_(cache),
+          key_(key),
+          generation_(generation),
+          publish_(publish),
+          tile_(tile) {}
+
+    virtual void notify() {
+      if (generation_ != 0ul) {
+        madness::archive::BufferOutputArchive count_ar;
+        count_ar& tile_.get();
+        cache_.set_bytes(key_, generation_, count_ar.size());
+      }
+      // The tile may arrive in the communication thread, hence it is
+      // serialized into the node store by a task
+      if (publish_)
+        world_.taskq.add(
+            [cache = &cache_, key = key_, tile = tile_]() {
+              cache->publish(key, tile.get());
+            },
+            madness::TaskAttributes::hipri());
+      delete this;
+    }
+
+   private:
+    World& world_;
+    RemoteTileCache& cache_;
+    const Key key_;
+    const std::uint64_t generation_;
+    const bool publish_;
+    Future<T> tile_;
+  };  // class ArrivalCallback
+
+  /// The time a process waits for a tile that another process of the node
+  /// is fetching, before it requests the tile itself
+  static constexpr std::chrono::seconds node_wait_timeout{5};
+
+  RemoteTileCache()
+      : madness::Spinlock(),
+        budget_(0ul),
+        node_shared_(false),
+        bytes_(0ul),
+        generation_(0ul),
+        entries_(),
+        lru_(),
+        statistics_(),
+        store_(),
+        prefix_() {}
+
+  /// Count a request
+
+  /// \param counter The statistics counter of the request
+  void count(std::size_t Statistics::*counter) {
+    madness::ScopedMutex<madness::Spinlock> locker(this);
+    ++(statistics_.*counter);
+  }
+
+  /// Read a tile from the node store
+
+  /// \tparam T The tile type
+  /// \param key The key of the tile
+  /// \param tile The tile, which is set if the tile is ready
+  /// \return The state of the tile in the node store
+  template <typename T>
+  detail::NodeTileStore::Status read_node(const Key& key, T& tile) const {
+    return store_.read(key.node_key(),
+                       [&tile](const unsigned char* data, std::size_t bytes) {
+                         madness::archive::BufferInputArchive ar(data, bytes);
+                         ar& tile;
+                       });
+  }
+
+  /// Get a tile that is not cached by this process
+
+  /// \tparam T The tile type
+  /// \tparam Fetch A nullary function type that returns a \c Future<T>
+  /// \param world The world of the array
+  /// \param key The key of the tile
+  /// \param expected_bytes The expected size of the tile
+  /// \param fetch The function that requests the tile from its owner
+  /// \param[out] publish Set to \c true if this process must publish the
+  /// tile in the node store
+  /// \return A future to the tile
+  template <typename T, typename Fetch>
+  Future<T> node_find_or_fetch(World& world, const Key& key,
+                               const std::size_t expected_bytes,
+                               Fetch& fetch, bool& publish) {
+    typedef detail::NodeTileStore::Status Status;
+    typedef detail::NodeTileStore::Claim Claim;
+    if (node_shared_) {
+      T tile;
+      switch (read_node(key, tile)) {
+        case Status::Ready:
+          count(&Statistics::node_hits);
+          return Future<T>(std::move(tile));
+        case Status::Pending:
+          return wait_node<T>(world, key, fetch);
+        case Status::Absent:
+          break;
+      }
+      switch (store_.claim(key.node_key(), expected_bytes)) {
+        case Claim::Claimed:
+          publish = true;
+          break;
+        case Claim::Exists:
+          return wait_node<T>(world, key, fetch);
+        case Claim::Rejected:
+          break;
+      }
+    }
+
+    count(&Statistics::misses);
+    return fetch();
+  }
+
+  /// Wait for a tile that another process of the node is fetching
+
+  /// \tparam T The tile type
+  /// \tparam Fetch A nullary function type that returns a \c Future<T>
+  /// \param world The world of the array
+  /// \param key The key of the tile
+  /// \param fetch The function that requests the tile from its owner
+  /// \return A future to the tile
+  template <typename T, typename Fetch>
+  Future<T> wait_node(World& world, const Key& key, const Fetch& fetch) {
+    Future<T> result;
+    poll_node(world, key, result, std::decay_t<Fetch>(fetch),
+              std::chrono::steady_clock::now() + node_wait_timeout);
+    return result;
+  }
+
+  /// Task function that polls the node store for a pending tile
+
+  /// The tile is requested from its owner if it is abandoned by the process
+  /// that claimed it, or if it is still pending at \c deadline.
+  /// \tparam T The tile type
+  /// \tparam Fetch A nullary function type that returns a \c Future<T>
+  /// \param world The world of the array
+  /// \param key The key of the tile
+  /// \param result The future to the tile
+  /// \param fetch The function that requests the tile from its owner
+  /// \param deadline The time when the tile is requested from its owner
+  template <typename T, typename Fetch>
+  void poll_node(World& world, const Key& key, Future<T> result, Fetch fetch,
+                 const std::chrono::steady_clock::time_point deadline) {
+    typedef detail::NodeTileStore::Status Status;
+    T tile;
+    const Status status = read_node(key, tile);
+    if (status == Status::Ready) {
+      count(&Statistics::node_hits);
+      result.set(std::move(tile));
+    } else if (status == Status::Pending &&
+               std::chrono::steady_clock::now() < deadline) {
+      world.taskq.add([this, &world, key, result, fetch, deadline]() {
+        poll_node(world, key, result, fetch, deadline);
+      });
+    } else {
+      count(&Statistics::misses);
+      result.set(fetch());
+    }
+  }
+
+  /// Publish a tile in the node store
+
+  /// \tparam T The tile type
+  /// \param key The key of the tile
+  /// \param tile The tile
+  template <typename T>
+  void publish(const Key& key, const T& tile) {
+    madness::archive::BufferOutputArchive count_ar;
+    count_ar& tile;
+    store_.publish(key.node_key(), count_ar.size(),
+                   [&tile](unsigned char* data, std::size_t bytes) {
+                     madness::archive::BufferOutputArchive ar(data, bytes);
+                     ar& tile;
+                   });
+  }
+
+  /// Record the size of a tile and enforce the budget
+
+  /// \param key The key of the tile
+  /// \param generation The generation of the entry
+  /// \param bytes The size of the tile
+  void set_bytes(const Key& key, const std::uint64_t generation,
+                 const std::size_t bytes) {
+    madness::ScopedMutex<madness::Spinlock> locker(this);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.generation != generation) return;
+    bytes_ = bytes_ - it->second.bytes + bytes;
+    it->second.bytes = bytes;
+    evict();
+  }
+
+  /// Evict the least-recently-used tiles until the size of the cached tiles
+  /// is within budget
+
+  /// Tiles in flight are accounted for with their expected size and may be
+  /// evicted as well; they are then not cached when they arrive.
+  /// \note Assumes the object is locked
+  void evict() {
+    for (auto it = lru_.end(); bytes_ > budget_ && it != lru_.begin();) {
+      --it;
+      auto entry = entries_.find(*it);
+      TA_ASSERT(entry != entries_.end());
+      bytes_ -= entry->second.bytes;
+      entries_.erase(entry);
+      it = lru_.erase(it);
+      ++statistics_.evictions;
+    }
+  }
+
+  std::atomic<std::size_t> budget_;  ///< The memory budget, in bytes
+  std::atomic<bool> node_shared_;    ///< Tiles are shared within the node
+  std::size_t bytes_;                ///< The size of the cached tiles
+  std::uint64_t generation_;         ///< The number of insertions
+  std::unordered_map<Key, Entry, KeyHash> entries_;  ///< The cached tiles
+  std::list<Key> lru_;              ///< The keys, most recently used first
+  Statistics statistics_;           ///< The cache statistics
+  detail::NodeTileStore store_;     ///< The tiles shared within the node
+  std::string prefix_;  ///< The name prefix of the tiles shared by the job
+};  // class RemoteTileCache
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_REMOTE_TILE_CACHE_H__INCLUDED
@@ -21,200 +21,139 @@
 #define TILEDARRAY_REPLICATOR_H__INCLUDED
 
 #include <TiledArray/external/madness.h>
+#include <madness/world/buffer_archive.h>
+
+#include <utility>
+#include <vector>
 
 namespace TiledArray {
 namespace detail {
 
-/// Replicate a \c Array object
+/// Replicate a \c Array object with tree broadcasts of tile chunks
 
 /// This object will create a replicated \c Array from a distributed
-/// \c Array.
+/// \c Array. Each process packs its local tiles, as they become ready, into
+/// chunks of (serialized) size \c chunk_bytes and broadcasts each chunk along
+/// a binomial tree rooted at the process. Hence the owner of a tile sends
+/// \f$ O(\log P) \f$ messages per chunk, rather than \f$ P - 1 \f$
+/// messages, and the chunks of each process are pipelined through the tree.
+/// The object must be kept alive until the next fence.
 /// \tparam A The array type
-/// Homeworld = M7R-227
 template <typename A>
-class Replicator : public madness::WorldObject<Replicator<A> >,
-                   private madness::Spinlock {
- private:
-  typedef Replicator<A> Replicator_;  ///< This object type
-  typedef madness::WorldObject<Replicator_>
-      wobj_type;  ///< The base object type
-  typedef std::stack<madness::CallbackInterface*,
-                     std::vector<madness::CallbackInterface*> >
-      callback_type;  ///< Callback interface
+class TreeReplicator : public madness::WorldObject<TreeReplicator<A> >,
+                       private madness::Spinlock {
+ public:
+  typedef TreeReplicator<A> TreeReplicator_;  ///< This object type
+  typedef madness::WorldObject<TreeReplicator_>
+      wobj_type;                                    ///< The base object type
+  typedef typename A::ordinal_type ordinal_type;    ///< Tile ordinal type
+  typedef typename A::value_type value_type;        ///< Tile type
+  typedef std::vector<std::pair<ordinal_type, value_type> >
+      chunk_type;  ///< A chunk of tiles
+
+  /// The default chunk size, in bytes
+  static constexpr std::size_t default_chunk_bytes = 1ul << 22;
 
+ private:
   A destination_;  ///< The replicated array
-  std::vector<typename A::ordinal_type>
-      indices_;  ///< List of local tile indices
-  std::vector<Future<typename A::value_type> > data_;  ///< List of local tiles
-  madness::AtomicInt sent_;  ///< The number of nodes the data has been sent to
   World& world_;
-  volatile callback_type callbacks_;  ///< A callback stack
-  volatile mutable bool probe_;       ///< Cache for local data probe
-
-  /// \note Assume object is already locked
-  void do_callbacks() {
-    callback_type& callbacks = const_cast<callback_type&>(callbacks_);
-    while (!callbacks.empty()) {
-      callbacks.top()->notify();
-      callbacks.pop();
-    }
-  }
-
-  /// Task that will call send when all local tiles are ready to be sent
-  class DelaySend : public madness::TaskInterface {
-   private:
-    Replicator_& parent_;  ///< The parent replicator operation
-
-   public:
-    /// Constructor
-    DelaySend(Replicator_& parent)
-        : madness::TaskInterface(madness::TaskAttributes::hipri()),
-          parent_(parent) {
-      typename std::vector<Future<typename A::value_type> >::iterator it =
-          parent_.data_.begin();
-      typename std::vector<Future<typename A::value_type> >::iterator end =
-          parent_.data_.end();
-      for (; it != end; ++it) {
-        if (!it->probe()) {
-          madness::DependencyInterface::inc();
-          it->register_callback(this);
-        }
+  const std::size_t chunk_bytes_;  ///< The target chunk size
+  chunk_type chunk_;               ///< The chunk that is being packed
+  std::size_t bytes_;              ///< The size of \c chunk_
+  std::size_t remaining_;  ///< The number of local tiles left to pack
+
+  /// Add a local tile to the current chunk, and broadcast the chunk when it
+  /// is full or when it holds the last local tile
+
+  /// \param index The tile ordinal
+  /// \param tile The tile
+  void pack(const ordinal_type index, const value_type& tile) {
+    madness::archive::BufferOutputArchive count_ar;
+    count_ar& tile;
+
+    chunk_type chunk;
+    {
+      madness::ScopedMutex<madness::Spinlock> locker(this);
+      chunk_.emplace_back(index, tile);
+      bytes_ += count_ar.size();
+      --remaining_;
+      if (bytes_ >= chunk_bytes_ || remaining_ == 0ul) {
+        chunk.swap(chunk_);
+        bytes_ = 0ul;
       }
     }
 
-    /// Virtual destructor
-    virtual ~DelaySend() {}
-
-    /// Task send task function
-    virtual void run(const madness::TaskThreadEnv&) { parent_.send(); }
-
-  };  // class DelaySend
-
-  /// Probe all local data has been set
-
-  /// \return \c true when all local tiles have been set
-  bool probe() const {
-    madness::ScopedMutex<madness::Spinlock> locker(this);
-
-    if (!probe_) {
-      typename std::vector<Future<typename A::value_type> >::const_iterator it =
-          data_.begin();
-      typename std::vector<Future<typename A::value_type> >::const_iterator
-          end = data_.end();
-      for (; it != end; ++it)
-        if (!it->probe()) break;
-
-      probe_ = (it == end);
-    }
-
-    return probe_;
+    if (!chunk.empty()) forward(world_.rank(), chunk);
   }
 
-  /// Send data to the next node when it is ready
-  void delay_send() {
-    if (probe()) {
-      // The data is ready so send it now.
-      send();  // Replication is done
-    } else {
-      // The local data is not ready to be sent, so create a task that will
-      // send it when it is ready.
-      DelaySend* delay_send_task = new DelaySend(*this);
-      world_.taskq.add(delay_send_task);
+  /// Send a chunk to the children of this process in the broadcast tree
+
+  /// The children of relative rank \c r in the binomial tree rooted at
+  /// \c root are <tt>r + m</tt> for every power of two \c m less than the
+  /// lowest set bit of \c r (any power of two for the root).
+  /// \param root The process that owns the tiles of \c chunk
+  /// \param chunk The chunk
+  void forward(const ProcessID root, const chunk_type& chunk) {
+    const ProcessID size = world_.size();
+    const ProcessID rel_rank = (world_.rank() - root + size) % size;
+    ProcessID mask = 1;
+    while (mask < size && !(rel_rank & mask)) mask <<= 1;
+    // Send to the largest subtree first
+    for (mask >>= 1; mask > 0; mask >>= 1) {
+      if (rel_rank + mask < size)
+        wobj_type::task((rel_rank + mask + root) % size,
+                        &TreeReplicator_::receive, root, chunk,
+                        madness::TaskAttributes::hipri());
     }
   }
 
-  /// Send all local data to the next node
-  void send() {
-    const long sent = ++sent_;
-    const ProcessID dest = (world_.rank() + sent) % world_.size();
-
-    if (dest != world_.rank()) {
-      wobj_type::task(dest, &Replicator_::send_handler, indices_, data_,
-                      madness::TaskAttributes::hipri());
-    } else
-      do_callbacks();  // Replication is done
-  }
-
-  void send_handler(const std::vector<typename A::ordinal_type>& indices,
-                    const std::vector<Future<typename A::value_type> >& data) {
-    typename std::vector<typename A::ordinal_type>::const_iterator index_it =
-        indices.begin();
-    typename std::vector<Future<typename A::value_type> >::const_iterator
-        data_it = data.begin();
-    typename std::vector<Future<typename A::value_type> >::const_iterator
-        data_end = data.end();
-
-    for (; data_it != data_end; ++data_it, ++index_it)
-      destination_.set(*index_it, data_it->get());
+  /// Forward a received chunk and store its tiles
 
-    delay_send();
+  /// \param root The process that owns the tiles of \c chunk
+  /// \param chunk The chunk
+  void receive(const ProcessID root, const chunk_type& chunk) {
+    forward(root, chunk);
+    for (const auto& tile : chunk) destination_.set(tile.first, tile.second);
   }
 
  public:
-  Replicator(const A& source, const A destination)
+  /// Constructor
+
+  /// This function must be called collectively.
+  /// \param source The distributed array
+  /// \param destination The replicated array, with the same tiled range
+  /// and shape as \c source
+  /// \param chunk_bytes The target size of the broadcast chunks, in bytes
+  TreeReplicator(const A& source, const A& destination,
+                 const std::size_t chunk_bytes = default_chunk_bytes)
       : wobj_type(source.world()),
         madness::Spinlock(),
         destination_(destination),
-        indices_(),
-        data_(),
-        sent_(),
         world_(source.world()),
-        callbacks_(),
-        probe_(false) {
-    sent_ = 0;
-
-    // Generate a list of local tiles from other.
-    typename A::pmap_interface::const_iterator end = source.pmap()->end();
-    typename A::pmap_interface::const_iterator it = source.pmap()->begin();
-    indices_.reserve(source.pmap()->local_size());
-    data_.reserve(source.pmap()->local_size());
-    if (source.is_dense()) {
-      // When dense, all tiles are present
-      for (; it != end; ++it) {
-        indices_.push_back(*it);
-        data_.push_back(source.find(*it));
-        destination_.set(*it, data_.back());
-      }
-    } else {
-      // When sparse, we need to generate a list
-      for (; it != end; ++it)
-        if (!source.is_zero(*it)) {
-          indices_.push_back(*it);
-          data_.push_back(source.find(*it));
-          destination_.set(*it, data_.back());
-        }
+        chunk_bytes_(chunk_bytes),
+        chunk_(),
+        bytes_(0ul),
+        remaining_(0ul) {
+    // Generate a list of local non-zero tiles from source
+    std::vector<std::pair<ordinal_type, Future<value_type> > > local_tiles;
+    local_tiles.reserve(source.pmap()->local_size());
+    for (const auto index : *source.pmap()) {
+      if (source.is_zero(index)) continue;
+      local_tiles.emplace_back(index, source.find(index));
+      destination_.set(index, local_tiles.back().second);
     }
 
-    /// Send the data to the first node
-    delay_send();
+    // Pack the tiles as they become ready
+    remaining_ = local_tiles.size();
+    for (const auto& tile : local_tiles)
+      world_.taskq.add(*this, &TreeReplicator_::pack, tile.first, tile.second,
+                       madness::TaskAttributes::hipri());
 
     // Process any pending messages
     wobj_type::process_pending();
   }
 
-  /// Check that the replication is complete
-
-  /// \return \c true when all data has been transfered.
-  bool done() {
-    madness::ScopedMutex<madness::Spinlock> locker(this);
-    return sent_ == world_.size();
-  }
-
-  /// Add a callback
-
-  /// The callback is called when the local data has been sent to all
-  /// nodes. If the data has already been sent to all nodes, the callback
-  /// is notified immediately.
-  /// \param callback The callback object
-  void register_callback(madness::CallbackInterface* callback) {
-    madness::ScopedMutex<madness::Spinlock> locker(this);
-    if (sent_ == world_.size())
-      callback->notify();
-    else
-      const_cast<callback_type&>(callbacks_).push(callback);
-  }
-
-};  // class Replicator
+};  // class TreeReplicator
 
 }  // namespace detail
 }  // namespace TiledArray
@@ -31,6 +31,8 @@
 #include <TiledArray/tensor/tensor_interface.h>
 #include <TiledArray/tiled_range.h>
 #include <TiledArray/val_array.h>
+#include <algorithm>
+#include <numeric>
 #include <typeinfo>
 
 namespace TiledArray {
@@ -89,8 +91,8 @@ class SparseShape {
   typedef detail::ValArray<value_type> vector_type;
 
   Tensor<value_type> tile_norms_;  ///< scaled Tile norms
-  mutable std::unique_ptr<Tensor<value_type>> tile_norms_unscaled_ =
-      nullptr;  ///< unscaled Tile norms (memoized)
+  mutable std::shared_ptr<const Tensor<value_type>> tile_norms_unscaled_ =
+      nullptr;  ///< unscaled Tile norms (memoized, shared by shallow copies)
   std::shared_ptr<vector_type>
       size_vectors_;  ///< Tile size information; size_vectors_.get()[d][i]
                       ///< reports the size of i-th tile in dimension d
@@ -260,6 +262,33 @@ class SparseShape {
     return zero_tile_count;
   }
 
+  /// \param ord the ordinal of a tile
+  /// \return the volume of tile \p ord
+  value_type tile_volume(const size_type ord) const {
+    const auto& range = tile_norms_.range();
+    const auto idx = range.idx(ord);
+    const auto* MADNESS_RESTRICT const lobound = range.lobound_data();
+    value_type volume = 1;
+    for (unsigned int d = 0u; d != range.rank(); ++d)
+      volume *= size_vectors_.get()[d][idx[d] - lobound[d]];
+    return volume;
+  }
+
+  /// Sets the scaled norm of a tile and updates the zero tile count
+
+  /// \param ord the ordinal of a tile
+  /// \param norm the new scaled norm of tile \p ord
+  void set_scaled_norm(const size_type ord, value_type norm) {
+    const value_type threshold = threshold_;
+    value_type& result = tile_norms_[ord];
+    if (norm < threshold) norm = value_type(0);
+    if ((result < threshold) && (norm >= threshold))
+      --zero_tile_count_;
+    else if ((result >= threshold) && (norm < threshold))
+      ++zero_tile_count_;
+    result = norm;
+  }
+
   SparseShape(const Tensor<T>& tile_norms,
               const std::shared_ptr<vector_type>& size_vectors,
               const size_type zero_tile_count)
@@ -411,33 +440,29 @@ class SparseShape {
 
   /// Copy constructor
 
-  /// Shallow copy of \c other.
+  /// Shallow copy of \c other; the norm data is copied on write (see
+  /// update()).
   /// \param other The other shape object to be copied
-  SparseShape(const SparseShape<T>& other)
-      : tile_norms_(other.tile_norms_),
-        tile_norms_unscaled_(
-            other.tile_norms_unscaled_
-                ? std::make_unique<decltype(tile_norms_)>(
-                      other.tile_norms_unscaled_.get()->clone())
-                : nullptr),
-        size_vectors_(other.size_vectors_),
-        zero_tile_count_(other.zero_tile_count_) {}
+  SparseShape(const SparseShape<T>& other) = default;
+
+  /// Move constructor
+
+  /// \param other The other shape object to be moved
+  SparseShape(SparseShape<T>&& other) = default;
 
   /// Copy assignment operator
 
-  /// Shallow copy of \c other.
+  /// Shallow copy of \c other; the norm data is copied on write (see
+  /// update()).
   /// \param other The other shape object to be copied
   /// \return A reference to this object.
-  SparseShape<T>& operator=(const SparseShape<T>& other) {
-    tile_norms_ = other.tile_norms_;
-    tile_norms_unscaled_ = other.tile_norms_unscaled_
-                               ? std::make_unique<decltype(tile_norms_)>(
-                                     other.tile_norms_unscaled_.get()->clone())
-                               : nullptr;
-    size_vectors_ = other.size_vectors_;
-    zero_tile_count_ = other.zero_tile_count_;
-    return *this;
-  }
+  SparseShape<T>& operator=(const SparseShape<T>& other) = default;
+
+  /// Move assignment operator
+
+  /// \param other The other shape object to be moved
+  /// \return A reference to this object.
+  SparseShape<T>& operator=(SparseShape<T>&& other) = default;
 
   /// Validate shape range
 
@@ -531,14 +556,17 @@ class SparseShape {
 
   /// \return A const reference to the \c Tensor object that stores the
   /// Frobenius norms of tiles
+  /// \note The unscaled norms are computed on first use, and recomputed
+  /// lazily after the norms are modified by update()
   const Tensor<value_type>& tile_norms() const {
     if (tile_norms_unscaled_ == nullptr) {
-      tile_norms_unscaled_ =
-          std::make_unique<decltype(tile_norms_)>(tile_norms_.clone());
+      auto tile_norms_unscaled =
+          std::make_shared<decltype(tile_norms_)>(tile_norms_.clone());
       [[maybe_unused]] auto should_be_zero =
-          scale_tile_norms<ScaleBy::Volume, false>(*tile_norms_unscaled_,
+          scale_tile_norms<ScaleBy::Volume, false>(*tile_norms_unscaled,
                                                    size_vectors_.get());
       TA_ASSERT(should_be_zero == 0);
+      tile_norms_unscaled_ = std::move(tile_norms_unscaled);
     }
     return *(tile_norms_unscaled_.get());
   }
@@ -690,6 +718,157 @@ class SparseShape {
         bounds, other);
   }
 
+  // clang-format off
+  /// Creates a copy of this with the norms of some tiles updated
+
+  /// Only the updated tiles are touched: the zero tile count is updated
+  /// incrementally, the tile size data is shared with this shape, and the
+  /// unscaled norms (see tile_norms()) are recomputed lazily. No communication
+  /// is performed, hence \p updates must be identical on every rank (see
+  /// update(World&,const SparseNormSequence&,bool) for the collective
+  /// version).
+  /// \tparam SparseNormSequence the sequence of \c std::pair<index,value_type>
+  ///         objects, where \c index is either a tile ordinal or a
+  ///         directly-addressable sequence of tile indices.
+  /// \param updates The new Frobenius norms of the updated tiles; if a tile
+  ///        appears more than once the last norm is used
+  /// \param do_not_scale if true, assume that the norms in \p updates are
+  ///        already scaled
+  /// \return A new sparse shape object with the updated norms
+  /// \note The norm data of this shape is copied; use the rvalue overload
+  ///       to update the data in place when it is not shared with other
+  ///       shapes (copy-on-write).
+  // clang-format on
+  template <typename SparseNormSequence,
+            typename = std::enable_if_t<
+                TiledArray::detail::has_member_function_begin_anyreturn<
+                    std::decay_t<SparseNormSequence>>::value &&
+                TiledArray::detail::has_member_function_end_anyreturn<
+                    std::decay_t<SparseNormSequence>>::value>>
+  SparseShape update(const SparseNormSequence& updates,
+                     bool do_not_scale = false) const& {
+    return SparseShape(*this).update(updates, do_not_scale);
+  }
+
+  // clang-format off
+  /// Updates the norms of some tiles of this shape
+
+  /// Same as the const overload, but the norm data is reused, and only copied
+  /// if it is shared with other shapes (copy-on-write).
+  /// \tparam SparseNormSequence the sequence of \c std::pair<index,value_type>
+  ///         objects, where \c index is either a tile ordinal or a
+  ///         directly-addressable sequence of tile indices.
+  /// \param updates The new Frobenius norms of the updated tiles; if a tile
+  ///        appears more than once the last norm is used
+  /// \param do_not_scale if true, assume that the norms in \p updates are
+  ///        already scaled
+  /// \return A sparse shape object with the updated norms
+  // clang-format on
+  template <typename SparseNormSequence,
+            typename = std::enable_if_t<
+                TiledArray::detail::has_member_function_begin_anyreturn<
+                    std::decay_t<SparseNormSequence>>::value &&
+                TiledArray::detail::has_member_function_end_anyreturn<
+                    std::decay_t<SparseNormSequence>>::value>>
+  SparseShape update(const SparseNormSequence& updates,
+                     bool do_not_scale = false) && {
+    TA_ASSERT(!tile_norms_.empty());
+    if (updates.begin() == updates.end()) return std::move(*this);
+
+    // Copy on write
+    if (tile_norms_.is_shared()) tile_norms_ = tile_norms_.clone();
+    tile_norms_unscaled_.reset();
+
+    const auto& range = tile_norms_.range();
+    for (const auto& pair_idx_norm : updates) {
+      const auto ord = range.ordinal(pair_idx_norm.first);
+      TA_ASSERT(range.includes(ord));
+      set_scaled_norm(ord, do_not_scale ? pair_idx_norm.second
+                                        : pair_idx_norm.second /
+                                              tile_volume(ord));
+    }
+
+    return std::move(*this);
+  }
+
+  // clang-format off
+  /// Collective update of the norms of some tiles
+
+  /// Each rank provides the norms of the tiles that it updated, e.g. its local
+  /// tiles; only these deltas are exchanged between the ranks, hence the
+  /// communication volume is proportional to the number of updated tiles
+  /// rather than the number of tiles of the shape. Norms of a tile provided by
+  /// more than one rank are max-reduced, as in the collective "sparse"
+  /// constructor. If no rank provides any updates this is returned.
+  /// \tparam SparseNormSequence the sequence of \c std::pair<index,value_type>
+  ///         objects, where \c index is either a tile ordinal or a
+  ///         directly-addressable sequence of tile indices.
+  /// \param world The world where the shape lives
+  /// \param local_updates The new Frobenius norms of the tiles updated by
+  ///        this rank
+  /// \param do_not_scale if true, assume that the norms in \p local_updates
+  ///        are already scaled
+  /// \return A new sparse shape object with the updated norms
+  /// \note must be invoked on every rank of \p world
+  // clang-format on
+  template <typename SparseNormSequence,
+            typename = std::enable_if_t<
+                TiledArray::detail::has_member_function_begin_anyreturn<
+                    std::decay_t<SparseNormSequence>>::value &&
+                TiledArray::detail::has_member_function_end_anyreturn<
+                    std::decay_t<SparseNormSequence>>::value>>
+  SparseShape update(World& world, const SparseNormSequence& local_updates,
+                     bool do_not_scale = false) const {
+    TA_ASSERT(!tile_norms_.empty());
+    const auto& range = tile_norms_.range();
+
+    // Gather the number of updates of every rank
+    const auto nproc = world.size();
+    const auto rank = world.rank();
+    std::vector<size_type> counts(nproc, 0);
+    for (auto it = local_updates.begin(); it != local_updates.end(); ++it)
+      ++counts[rank];
+    world.gop.sum(counts.data(), nproc);
+    const size_type offset =
+        std::accumulate(counts.begin(), counts.begin() + rank, size_type(0));
+    const size_type count =
+        std::accumulate(counts.begin() + rank, counts.end(), offset);
+    if (count == 0) return *this;
+
+    // Exchange the (scaled) deltas; each rank fills its own segment
+    std::vector<size_type> ordinals(count, 0);
+    std::vector<value_type> norms(count, value_type(0));
+    size_type i = offset;
+    for (const auto& pair_idx_norm : local_updates) {
+      const auto ord = range.ordinal(pair_idx_norm.first);
+      TA_ASSERT(range.includes(ord));
+      ordinals[i] = ord;
+      norms[i] = do_not_scale ? pair_idx_norm.second
+                              : pair_idx_norm.second / tile_volume(ord);
+      ++i;
+    }
+    world.gop.sum(ordinals.data(), count);
+    world.gop.sum(norms.data(), count);
+
+    // Max-reduce the norms of tiles updated by more than one rank
+    std::vector<std::pair<size_type, value_type>> updates;
+    updates.reserve(count);
+    for (i = 0; i != count; ++i) updates.emplace_back(ordinals[i], norms[i]);
+    std::sort(updates.begin(), updates.end(),
+              [](const auto& left, const auto& right) {
+                return left.first < right.first ||
+                       (left.first == right.first &&
+                        left.second > right.second);
+              });
+    updates.erase(std::unique(updates.begin(), updates.end(),
+                              [](const auto& left, const auto& right) {
+                                return left.first == right.first;
+                              }),
+                  updates.end());
+
+    return update(updates, true);
+  }
+
   /// Bitwise comparison
 
   /// \param other a SparseShape object
@@ -1565,6 +1744,7 @@ class SparseShape {
                 Archive>::value>::type* = nullptr>
   void serialize(const Archive& ar) {
     ar& tile_norms_;
+    tile_norms_unscaled_.reset();
     const unsigned int dim = tile_norms_.range().rank();
     // allocate size_vectors_
     size_vectors_ = std::move(std::shared_ptr<vector_type>(
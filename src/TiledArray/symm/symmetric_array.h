@@ -0,0 +1,152 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_SYMM_SYMMETRIC_ARRAY_H__INCLUDED
+#define TILEDARRAY_SYMM_SYMMETRIC_ARRAY_H__INCLUDED
+
+#include <TiledArray/external/madness.h>
+#include <TiledArray/shape.h>
+#include <TiledArray/symm/tile_symmetry.h>
+#include <TiledArray/tile_interface/permute.h>
+#include <TiledArray/tile_interface/scale.h>
+
+namespace TiledArray {
+
+/// Forward declarations
+template <typename, typename>
+class DistArray;
+
+namespace symmetry {
+
+/**
+ * \addtogroup symmetry
+ * @{
+ */
+
+// A packed array is an array with a sparse shape that holds only the unique
+// tiles of a TileSymmetry; the shape of all other tiles is zero. Packed arrays
+// are produced by pack() or by evaluating an expression with
+// Expr::set_symmetry(), e.g.
+// \code
+// t2_new("i,j,a,b") = (g("i,j,k,l") * t2("k,l,a,b")).set_symmetry(sym);
+// \endcode
+// evaluates only the unique blocks of the contraction.
+
+/// Packs an array, keeping only its unique tiles
+
+/// \tparam Tile The tile type of the array
+/// \tparam Policy The (sparse) policy of the array
+/// \param arg An array with the symmetry \c symmetry
+/// \param symmetry The permutational symmetry of \c arg
+/// \return A shallow copy of the unique tiles of \c arg
+template <typename Tile, typename Policy>
+inline DistArray<Tile, Policy> pack(const DistArray<Tile, Policy>& arg,
+                                    const TileSymmetry& symmetry) {
+  static_assert(!is_dense_v<Policy>,
+                "TiledArray::symmetry::pack(): packed arrays require a "
+                "sparse policy");
+  typedef typename DistArray<Tile, Policy>::shape_type shape_type;
+  TA_ASSERT(symmetry.validate(arg.trange()));
+
+  DistArray<Tile, Policy> result(
+      arg.world(), arg.trange(),
+      arg.shape().mask(symmetry.unique_shape<shape_type>(arg.trange())),
+      arg.pmap());
+  for (auto index : *result.pmap()) {
+    if (result.is_zero(index)) continue;
+    result.set(index, arg.find(index));
+  }
+
+  return result;
+}
+
+/// Generates a tile of a packed array
+
+/// The tile is generated by permuting (and, for antisymmetric arrays,
+/// possibly negating) the unique tile of its orbit, which may be remote.
+/// \tparam Tile The tile type of the array
+/// \tparam Policy The (sparse) policy of the array
+/// \tparam Index A coordinate index type
+/// \param packed A packed array
+/// \param index The coordinate index of the tile
+/// \param symmetry The permutational symmetry of \c packed
+/// \return A future to tile \c index
+/// \throw TiledArray::Exception if tile \c index is zero
+template <typename Tile, typename Policy, typename Index>
+inline Future<Tile> find(const DistArray<Tile, Policy>& packed,
+                         const Index& index, const TileSymmetry& symmetry) {
+  auto orbit = symmetry.orbit(index);
+  auto unique_tile = packed.find(orbit.index);
+  if (orbit.sign == 1 && !orbit.perm) return unique_tile;
+
+  return packed.world().taskq.add(
+      [perm = std::move(orbit.perm), sign = orbit.sign](const Tile& tile) {
+        using TiledArray::permute;
+        using TiledArray::scale;
+        return Tile(sign == 1 ? permute(tile, perm) : scale(tile, -1, perm));
+      },
+      unique_tile);
+}
+
+/// Unpacks a packed array
+
+/// \tparam Tile The tile type of the array
+/// \tparam Policy The (sparse) policy of the array
+/// \param packed A packed array
+/// \param symmetry The permutational symmetry of \c packed
+/// \return An array that holds every tile of \c packed, the redundant tiles
+/// are generated from the unique ones
+template <typename Tile, typename Policy>
+inline DistArray<Tile, Policy> unpack(const DistArray<Tile, Policy>& packed,
+                                      const TileSymmetry& symmetry) {
+  static_assert(!is_dense_v<Policy>,
+                "TiledArray::symmetry::unpack(): packed arrays require a "
+                "sparse policy");
+  typedef typename DistArray<Tile, Policy>::shape_type shape_type;
+  typedef typename shape_type::value_type value_type;
+  const auto& trange = packed.trange();
+  TA_ASSERT(symmetry.validate(trange));
+
+  // The norm of each tile is that of the unique tile of its orbit
+  const auto& tiles_range = trange.tiles_range();
+  const auto volume = tiles_range.volume();
+  Tensor<value_type> norms(tiles_range, value_type(0));
+  for (std::size_t ord = 0ul; ord < volume; ++ord) {
+    const auto orbit = symmetry.orbit(tiles_range.idx(ord));
+    norms[ord] = packed.shape()[tiles_range.ordinal(orbit.index)];
+  }
+
+  DistArray<Tile, Policy> result(packed.world(), trange,
+                                 shape_type(norms, trange, true),
+                                 packed.pmap());
+  for (auto index : *result.pmap()) {
+    if (result.is_zero(index)) continue;
+    result.set(index, TiledArray::symmetry::find(
+                          packed, tiles_range.idx(index), symmetry));
+  }
+
+  return result;
+}
+
+/** @}*/
+
+}  // namespace symmetry
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_SYMM_SYMMETRIC_ARRAY_H__INCLUDED
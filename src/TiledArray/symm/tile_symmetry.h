@@ -0,0 +1,208 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_SYMM_TILE_SYMMETRY_H__INCLUDED
+#define TILEDARRAY_SYMM_TILE_SYMMETRY_H__INCLUDED
+
+#include <TiledArray/permutation.h>
+#include <TiledArray/symm/permutation_group.h>
+#include <TiledArray/tensor.h>
+#include <TiledArray/tiled_range.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace TiledArray {
+namespace symmetry {
+
+/**
+ * \addtogroup symmetry
+ * @{
+ */
+
+/// Permutational symmetry of the tiles of an array
+
+/// TileSymmetry describes a tensor \f$ A \f$ that is invariant (up to a sign)
+/// under the permutations of its modes that form a PermutationGroup \f$ G \f$:
+/// \f$ A_{i_0 i_1 \dots} = \sigma(p) A_{i_{p(0)} i_{p(1)} \dots} \f$ for all
+/// \f$ p \in G \f$, where \f$ \sigma(p) = 1 \f$ for symmetric tensors and
+/// \f$ \sigma(p) \f$ is the parity of \f$ p \f$ for antisymmetric tensors.
+/// Modes related by \f$ G \f$ must have identical tilings, hence the tiles
+/// of \f$ A \f$ are related by the same symmetry: only the tiles whose
+/// indices are lexicographically smallest in their orbit under \f$ G \f$
+/// (the \em unique tiles) need to be stored, all others are obtained by
+/// permuting (and, possibly, negating) a unique tile.
+/// E.g. the symmetry of the antisymmetric amplitudes \f$ t^{ab}_{ij} \f$,
+/// stored as \c t("i,j,a,b"), is
+/// \code
+/// TileSymmetry sym(PermutationGroup{{Permutation{1, 0, 2, 3},
+///                                    Permutation{0, 1, 3, 2}}},
+///                  TileSymmetry::antisymmetric);
+/// \endcode
+class TileSymmetry {
+ public:
+  typedef TiledArray::symmetry::Permutation element_type;  ///< Group element
+  typedef Range::index_type index_type;  ///< Tile coordinate index type
+
+  /// The behavior of tensor elements under the permutations of the group
+  enum Kind {
+    symmetric,     ///< the tensor is invariant under the group
+    antisymmetric  ///< the tensor changes sign under odd permutations
+  };
+
+  /// Maps a tile onto the unique tile of its orbit
+  struct Orbit {
+    index_type index;  ///< The coordinate index of the unique tile
+    /// Permutation that maps the unique tile onto the tile; empty if the tile
+    /// is unique
+    TiledArray::Permutation perm;
+    int sign;  ///< The factor applied to the permuted unique tile
+  };
+
+  // Compiler generated functions
+  TileSymmetry() = delete;
+  TileSymmetry(const TileSymmetry&) = default;
+  TileSymmetry(TileSymmetry&&) = default;
+  TileSymmetry& operator=(const TileSymmetry&) = default;
+  TileSymmetry& operator=(TileSymmetry&&) = default;
+
+  /// Constructor
+
+  /// \param group The group of mode permutations
+  /// \param kind The behavior of the tensor under the group
+  explicit TileSymmetry(PermutationGroup group, Kind kind = symmetric)
+      : group_(std::move(group)), kind_(kind), signs_(), rank_(0u) {
+    signs_.reserve(group_.order());
+    for (const auto& p : group_) {
+      // the parity of a cycle of length n is that of n - 1 transpositions
+      unsigned int transpositions = 0u;
+      for (const auto& cycle : p.cycles()) transpositions += cycle.size() - 1u;
+      const bool odd = transpositions & 1u;
+      signs_.push_back(kind_ == antisymmetric && odd ? -1 : 1);
+      for (const auto& e : p) rank_ = std::max(rank_, e.first + 1u);
+    }
+  }
+
+  /// \return The group of mode permutations
+  const PermutationGroup& group() const { return group_; }
+
+  /// \return The behavior of the tensor under the group
+  Kind kind() const { return kind_; }
+
+  /// \return The minimum rank of the tensors described by this symmetry
+  unsigned int rank() const { return rank_; }
+
+  /// Checks that this symmetry is compatible with a tiled range
+
+  /// \param trange A tiled range
+  /// \return \c true if \c trange has the required rank and all modes related
+  /// by the group have identical tilings, otherwise \c false
+  bool validate(const TiledRange& trange) const {
+    if (trange.rank() < rank_) return false;
+    for (const auto& p : group_.generators())
+      for (const auto& e : p)
+        if (trange.dim(e.first) != trange.dim(e.second)) return false;
+    return true;
+  }
+
+  /// Tests if a tile is unique
+
+  /// \tparam Index A coordinate index type
+  /// \param index The coordinate index of a tile
+  /// \return \c true if \c index is lexicographically smallest in its orbit
+  template <typename Index>
+  bool is_unique(const Index& index) const {
+    TA_ASSERT(std::size(index) >= rank_);
+    return is_lexicographically_smallest(index, group_);
+  }
+
+  /// Locates the unique tile from which a tile is generated
+
+  /// Tile \c index is equal to
+  /// <tt>orbit.sign * permute(tile(orbit.index), orbit.perm)</tt>
+  /// \tparam Index A coordinate index type
+  /// \param index The coordinate index of a tile
+  /// \return The orbit of \c index
+  template <typename Index>
+  Orbit orbit(const Index& index) const {
+    const unsigned int n = std::size(index);
+    TA_ASSERT(n >= rank_);
+    Orbit result{index_type(std::begin(index), std::end(index)),
+                 TiledArray::Permutation(), 1};
+    index_type image(n);
+    const unsigned int order = group_.order();
+    unsigned int best = order;  // the identity
+    for (unsigned int g = 0u; g < order; ++g) {
+      const auto& p = group_[g];
+      for (unsigned int d = 0u; d < n; ++d) image[d] = index[p[d]];
+      if (std::lexicographical_compare(image.begin(), image.end(),
+                                       result.index.begin(),
+                                       result.index.end())) {
+        std::swap(result.index, image);
+        best = g;
+      }
+    }
+
+    if (best != order) {
+      // image[d] = index[p[d]] maps element f of tile index onto element
+      // g[d] = f[p[d]] of the unique tile, i.e. the tile is obtained by
+      // moving mode d of the unique tile to mode p[d]
+      const auto& p = group_[best];
+      TiledArray::Permutation::vector<TiledArray::Permutation::index_type>
+          perm(n);
+      for (unsigned int d = 0u; d < n; ++d) perm[d] = p[d];
+      result.perm = TiledArray::Permutation(std::move(perm));
+      result.sign = signs_[best];
+    }
+    return result;
+  }
+
+  /// Constructs a shape that selects the unique tiles
+
+  /// \tparam Shape A (sparse) shape type that can be constructed from a
+  /// tensor of (scaled) tile norms and a TiledRange
+  /// \param trange The tiled range of the array
+  /// \return A shape with unit norms for unique tiles and zero norms for
+  /// all others, for use as a mask
+  template <typename Shape>
+  Shape unique_shape(const TiledRange& trange) const {
+    TA_ASSERT(validate(trange));
+    typedef typename Shape::value_type value_type;
+    const auto& tiles_range = trange.tiles_range();
+    Tensor<value_type> norms(tiles_range, value_type(0));
+    const auto volume = tiles_range.volume();
+    for (std::size_t ord = 0ul; ord < volume; ++ord)
+      if (is_unique(tiles_range.idx(ord))) norms[ord] = value_type(1);
+    return Shape(norms, trange, true);
+  }
+
+ private:
+  PermutationGroup group_;  ///< The group of mode permutations
+  Kind kind_;               ///< The behavior of the tensor under the group
+  std::vector<int> signs_;  ///< The sign of each element of \c group_
+  unsigned int rank_;       ///< 1 + the largest mode permuted by \c group_
+};  // class TileSymmetry
+
+/** @}*/
+
+}  // namespace symmetry
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_SYMM_TILE_SYMMETRY_H__INCLUDED
@@ -28,6 +28,7 @@
 
 #include <TiledArray/block_range.h>
 #include <TiledArray/tensor/operators.h>
+#include <TiledArray/tensor/packed_tensor_of_tensors.h>
 #include <TiledArray/tensor/shift_wrapper.h>
 #include <TiledArray/tensor/tensor.h>
 #include <TiledArray/tensor/tensor_interface.h>
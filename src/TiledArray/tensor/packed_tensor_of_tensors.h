@@ -0,0 +1,1061 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_TENSOR_PACKED_TENSOR_OF_TENSORS_H__INCLUDED
+#define TILEDARRAY_TENSOR_PACKED_TENSOR_OF_TENSORS_H__INCLUDED
+
+#include <TiledArray/math/elem_muladd.h>
+#include <TiledArray/perm_index.h>
+#include <TiledArray/tensor/permute.h>
+#include <TiledArray/tensor/tensor.h>
+#include <TiledArray/tensor/tensor_map.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+namespace TiledArray {
+
+/// A tensor of tensors with packed storage
+
+/// \c Tensor<Tensor<T>> allocates every inner tensor separately. This tile
+/// stores the ranges of all inner tensors and their elements in two
+/// contiguous buffers instead: the inner tensors are laid out one after the
+/// other, in the order of the outer range, in a single \c Tensor<T>. An
+/// inner tensor is accessed as a \c TensorMap view in O(1) time. The layout
+/// (outer range, inner ranges and offsets) is immutable and is shared by
+/// all tiles computed from this one, so element-wise operations reduce to a
+/// single vectorized pass over the packed elements, and the tile is
+/// serialized as one block of inner range bounds followed by one block of
+/// elements.
+///
+/// The tile is a tensor-of-tensors type (see
+/// \c detail::is_tensor_of_tensor ), hence arrays of packed tiles are
+/// annotated with outer and inner indices, e.g. \c "i,j;k,l" , and take
+/// part in the same expressions as arrays of \c Tensor<Tensor<T>> .
+/// Element-wise operations keep the packed layout; the arguments of binary
+/// operations must have the same layout, otherwise an exception is thrown.
+/// The inner products of nested expressions (\c math::ElemMulAdd ) are
+/// applied directly to the packed elements, with one allocation for the
+/// result; only custom inner operations are evaluated on the unpacked
+/// tensor of tensors, and their result is packed.
+/// \tparam T The element type of the inner tensors
+template <typename T>
+class PackedTensorOfTensors {
+ public:
+  typedef PackedTensorOfTensors<T> PackedTensorOfTensors_;  ///< This type
+  typedef Range range_type;  ///< Outer and inner range type
+  typedef typename range_type::index1_type index1_type;  ///< 1-index type
+  typedef typename range_type::ordinal_type ordinal_type;  ///< Ordinal type
+  typedef ordinal_type size_type;                          ///< Size type
+  typedef Tensor<T> value_type;  ///< The (unpacked) inner tensor type
+  typedef T element_type;        ///< The element type of the inner tensors
+  typedef TensorMap<T> reference;  ///< Inner tensor view type
+  typedef TensorConstMap<T> const_reference;  ///< Inner tensor view type
+  typedef typename TiledArray::detail::numeric_type<T>::type
+      numeric_type;  ///< The numeric type of the elements
+  typedef typename TiledArray::detail::scalar_type<T>::type
+      scalar_type;  ///< The scalar type of the elements
+  typedef math::ElemMulAdd<numeric_type>
+      elem_muladd_kernel_type;  ///< The built-in inner product type
+
+ private:
+  /// The outer range, the inner ranges and the positions of the inner
+  /// tensors in the packed data
+  struct Layout {
+    range_type range_;                      ///< The outer range
+    std::vector<range_type> inner_ranges_;  ///< The inner ranges
+    std::vector<ordinal_type> offsets_;     ///< Inner tensor offsets
+
+    /// Compute the offsets from the inner ranges
+
+    /// \return The number of packed elements
+    ordinal_type init_offsets() {
+      offsets_.resize(inner_ranges_.size() + 1ul);
+      offsets_[0] = 0ul;
+      for (ordinal_type i = 0ul; i < inner_ranges_.size(); ++i)
+        offsets_[i + 1ul] = offsets_[i] + inner_ranges_[i].volume();
+      return offsets_.back();
+    }
+
+    /// Flatten the inner ranges
+
+    /// \return The rank, lower bounds and upper bounds of each inner range
+    std::vector<index1_type> bounds() const {
+      std::vector<index1_type> result;
+      for (const auto& range : inner_ranges_) {
+        result.push_back(range.rank());
+        result.insert(result.end(), range.lobound_data(),
+                      range.lobound_data() + range.rank());
+        result.insert(result.end(), range.upbound_data(),
+                      range.upbound_data() + range.rank());
+      }
+      return result;
+    }
+
+    /// Construct the inner ranges from flattened bounds
+
+    /// \param bounds The bounds of the inner ranges (see \c bounds() )
+    /// \throw TiledArray::Exception if \c bounds does not describe one
+    /// range for each element of the outer range
+    void init_inner_ranges(const std::vector<index1_type>& bounds) {
+      const ordinal_type n = range_.volume();
+      inner_ranges_.clear();
+      inner_ranges_.reserve(n);
+      auto it = bounds.cbegin();
+      for (ordinal_type i = 0ul; i < n; ++i) {
+        if (it == bounds.cend())
+          TA_EXCEPTION("PackedTensorOfTensors: truncated inner ranges");
+        const auto rank = std::ptrdiff_t(*it++);
+        if (rank < 0 || bounds.cend() - it < 2 * rank)
+          TA_EXCEPTION("PackedTensorOfTensors: truncated inner ranges");
+        if (rank == 0) {
+          inner_ranges_.emplace_back();
+          continue;
+        }
+        const std::vector<index1_type> lobound(it, it + rank);
+        const std::vector<index1_type> upbound(it + rank, it + 2 * rank);
+        inner_ranges_.emplace_back(lobound, upbound);
+        it += 2 * rank;
+      }
+      if (it != bounds.cend())
+        TA_EXCEPTION("PackedTensorOfTensors: too many inner ranges");
+    }
+  };  // struct Layout
+
+  std::shared_ptr<const Layout> layout_;  ///< The layout of the tile
+  Tensor<T> data_;                        ///< The packed inner tensors
+
+  PackedTensorOfTensors(const std::shared_ptr<const Layout>& layout,
+                        Tensor<T>&& data)
+      : layout_(layout), data_(std::move(data)) {}
+
+  /// Construct a layout and allocate the packed data for it
+  void init(const range_type& range, std::vector<range_type>&& inner_ranges) {
+    TA_ASSERT(inner_ranges.size() == range.volume());
+    auto layout = std::make_shared<Layout>();
+    layout->range_ = range;
+    layout->inner_ranges_ = std::move(inner_ranges);
+    data_ = Tensor<T>(range_type(layout->init_offsets()));
+    layout_ = std::move(layout);
+  }
+
+  /// Check that \c other has the layout of this tile
+
+  /// \throw TiledArray::Exception if either tile is empty or the layouts
+  /// differ
+  void check_layout(const PackedTensorOfTensors_& other) const {
+    if (!layout_ || !other.layout_)
+      TA_EXCEPTION("PackedTensorOfTensors: empty argument tile");
+    if (layout_ != other.layout_ &&
+        (layout_->range_ != other.layout_->range_ ||
+         layout_->inner_ranges_ != other.layout_->inner_ranges_))
+      TA_EXCEPTION("PackedTensorOfTensors: the tiles have different layouts");
+  }
+
+  /// \return The unpacked tensor of tensors
+  Tensor<Tensor<T>> unpack() const {
+    return static_cast<Tensor<Tensor<T>>>(*this);
+  }
+
+  /// Apply \c op to the packed data
+
+  /// \return A tile with the layout of this tile and the data computed by
+  /// \c op
+  template <typename Op>
+  PackedTensorOfTensors_ transform(Op&& op) const {
+    TA_ASSERT(layout_);
+    return PackedTensorOfTensors_(layout_, op(data_));
+  }
+
+  /// \param kernel An inner product
+  /// \param left The range of a left-hand inner tensor
+  /// \param right The range of a right-hand inner tensor
+  /// \return The range of the product of the inner tensors
+  static range_type inner_product_range(const elem_muladd_kernel_type& kernel,
+                                        const range_type& left,
+                                        const range_type& right) {
+    if (kernel.kind() == elem_muladd_kernel_type::Kind::Hadamard) {
+      TA_ASSERT(left.volume() == right.volume());
+      return left;
+    }
+    return kernel.gemm_helper().template make_result_range<range_type>(left,
+                                                                       right);
+  }
+
+  /// Compute the product of a pair of packed inner tensors
+
+  /// \param kernel The inner product
+  /// \param left_range The range of the left-hand inner tensor
+  /// \param left The elements of the left-hand inner tensor
+  /// \param right_range The range of the right-hand inner tensor
+  /// \param right The elements of the right-hand inner tensor
+  /// \param[in,out] result The elements of the result inner tensor
+  /// \param accumulate If \c true the product is added to \c result ,
+  /// otherwise \c result is overwritten
+  static void inner_product(const elem_muladd_kernel_type& kernel,
+                            const range_type& left_range,
+                            const T* MADNESS_RESTRICT const left,
+                            const range_type& right_range,
+                            const T* MADNESS_RESTRICT const right,
+                            T* MADNESS_RESTRICT const result,
+                            const bool accumulate) {
+    const numeric_type factor = kernel.factor();
+    if (kernel.kind() == elem_muladd_kernel_type::Kind::Hadamard) {
+      TA_ASSERT(left_range.volume() == right_range.volume());
+      if (accumulate)
+        math::inplace_vector_op(
+            [factor](T& MADNESS_RESTRICT r, const T l, const T x) {
+              r += (l * x) * factor;
+            },
+            left_range.volume(), result, left, right);
+      else
+        math::inplace_vector_op(
+            [factor](T& MADNESS_RESTRICT r, const T l, const T x) {
+              r = (l * x) * factor;
+            },
+            left_range.volume(), result, left, right);
+      return;
+    }
+
+    const math::GemmHelper& gemm_helper = kernel.gemm_helper();
+    TA_ASSERT(left_range.rank() == gemm_helper.left_rank());
+    TA_ASSERT(right_range.rank() == gemm_helper.right_rank());
+    math::blas::integer m = 1, n = 1, k = 1;
+    gemm_helper.compute_matrix_sizes(m, n, k, left_range, right_range);
+    const math::blas::integer lda =
+        (gemm_helper.left_op() == math::blas::NoTranspose ? k : m);
+    const math::blas::integer ldb =
+        (gemm_helper.right_op() == math::blas::NoTranspose ? n : k);
+    math::blas::gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, k,
+                     factor, left, lda, right, ldb,
+                     numeric_type(accumulate ? 1 : 0), result, n);
+  }
+
+  /// Apply a built-in inner product to each pair of inner tensors
+
+  /// \param right The right-hand argument
+  /// \param kernel The inner product
+  /// \return A tile whose inner tensor \c i is the product of
+  /// <tt>(*this)[i]</tt> and <tt>right[i]</tt>
+  PackedTensorOfTensors_ binary_kernel(
+      const PackedTensorOfTensors_& right,
+      const elem_muladd_kernel_type& kernel) const {
+    // An inner Hadamard product is a single pass over the packed elements
+    if (kernel.kind() == elem_muladd_kernel_type::Kind::Hadamard)
+      return (kernel.factor() == numeric_type(1)
+                  ? mult(right)
+                  : mult(right, kernel.factor()));
+
+    const Layout& left_layout = *layout_;
+    const Layout& right_layout = *right.layout_;
+    const ordinal_type n = left_layout.range_.volume();
+    std::vector<range_type> inner_ranges(n);
+    for (ordinal_type i = 0ul; i < n; ++i)
+      if (left_layout.inner_ranges_[i].volume() &&
+          right_layout.inner_ranges_[i].volume())
+        inner_ranges[i] =
+            inner_product_range(kernel, left_layout.inner_ranges_[i],
+                                right_layout.inner_ranges_[i]);
+
+    PackedTensorOfTensors_ result(left_layout.range_, std::move(inner_ranges));
+    const Layout& result_layout = *result.layout_;
+    for (ordinal_type i = 0ul; i < n; ++i)
+      if (result_layout.inner_ranges_[i].volume())
+        inner_product(kernel, left_layout.inner_ranges_[i],
+                      data_.data() + left_layout.offsets_[i],
+                      right_layout.inner_ranges_[i],
+                      right.data_.data() + right_layout.offsets_[i],
+                      result.data_.data() + result_layout.offsets_[i], false);
+    return result;
+  }
+
+  /// Contract two tiles with a built-in inner product and accumulate into
+  /// this tile
+
+  /// The inner products accumulate directly into the packed elements of
+  /// this tile; it is repacked only if it is empty or if a product falls on
+  /// an empty inner tensor.
+  /// \param left The left-hand argument
+  /// \param right The right-hand argument
+  /// \param gemm_helper The GEMM helper of the outer contraction
+  /// \param kernel The inner product
+  void gemm_kernel(const PackedTensorOfTensors_& left,
+                   const PackedTensorOfTensors_& right,
+                   const math::GemmHelper& gemm_helper,
+                   const elem_muladd_kernel_type& kernel) {
+    const Layout& left_layout = *left.layout_;
+    const Layout& right_layout = *right.layout_;
+    TA_ASSERT(left_layout.range_.rank() == gemm_helper.left_rank());
+    TA_ASSERT(right_layout.range_.rank() == gemm_helper.right_rank());
+    TA_ASSERT(gemm_helper.left_right_congruent(
+        left_layout.range_.extent_data(), right_layout.range_.extent_data()));
+
+    // Compute the outer gemm dimensions and the strides of the rows and
+    // columns of the outer left and right matrices
+    using integer = math::blas::integer;
+    integer M = 1, N = 1, K = 1;
+    gemm_helper.compute_matrix_sizes(M, N, K, left_layout.range_,
+                                     right_layout.range_);
+    const bool left_notrans = gemm_helper.left_op() == math::blas::NoTranspose;
+    const bool right_notrans =
+        gemm_helper.right_op() == math::blas::NoTranspose;
+    const integer a_ms = (left_notrans ? K : 1);
+    const integer a_ks = (left_notrans ? 1 : M);
+    const integer b_ks = (right_notrans ? N : 1);
+    const integer b_ns = (right_notrans ? 1 : K);
+
+    // The first contribution to a result inner tensor determines its range
+    auto find_inner_range = [&](const integer m, const integer n,
+                                range_type* inner_range) {
+      for (integer k = 0; k < K; ++k) {
+        const range_type& a = left_layout.inner_ranges_[m * a_ms + k * a_ks];
+        const range_type& b = right_layout.inner_ranges_[k * b_ks + n * b_ns];
+        if (a.volume() && b.volume()) {
+          if (inner_range) *inner_range = inner_product_range(kernel, a, b);
+          return true;
+        }
+      }
+      return false;
+    };
+
+    // Repack this tile if it is empty or if a result inner tensor that
+    // receives a contribution is empty
+    bool repack = !layout_;
+    if (layout_) {
+      TA_ASSERT(layout_->range_.volume() == ordinal_type(M * N));
+      for (integer m = 0; m < M && !repack; ++m)
+        for (integer n = 0; n < N && !repack; ++n)
+          repack = (layout_->inner_ranges_[m * N + n].volume() == 0ul &&
+                    find_inner_range(m, n, nullptr));
+    }
+    if (repack) {
+      const range_type result_range =
+          (layout_ ? layout_->range_
+                   : gemm_helper.make_result_range<range_type>(
+                         left_layout.range_, right_layout.range_));
+      std::vector<range_type> inner_ranges =
+          (layout_ ? layout_->inner_ranges_
+                   : std::vector<range_type>(result_range.volume()));
+      for (integer m = 0; m < M; ++m)
+        for (integer n = 0; n < N; ++n)
+          if (inner_ranges[m * N + n].volume() == 0ul)
+            find_inner_range(m, n, &inner_ranges[m * N + n]);
+      PackedTensorOfTensors_ result(result_range, std::move(inner_ranges),
+                                    T(0));
+      if (layout_) {
+        for (ordinal_type i = 0ul; i < result.size(); ++i)
+          std::copy_n(data_.data() + layout_->offsets_[i],
+                      layout_->inner_ranges_[i].volume(),
+                      result.data_.data() + result.layout_->offsets_[i]);
+      }
+      *this = std::move(result);
+    }
+
+    // Accumulate the inner products in order of increasing k
+    const Layout& result_layout = *layout_;
+    for (integer m = 0; m < M; ++m) {
+      for (integer k = 0; k < K; ++k) {
+        const ordinal_type a = m * a_ms + k * a_ks;
+        const range_type& a_range = left_layout.inner_ranges_[a];
+        if (a_range.volume() == 0ul) continue;
+        const T* const a_data = left.data_.data() + left_layout.offsets_[a];
+        for (integer n = 0; n < N; ++n) {
+          const ordinal_type b = k * b_ks + n * b_ns;
+          const range_type& b_range = right_layout.inner_ranges_[b];
+          if (b_range.volume() == 0ul) continue;
+          const ordinal_type c = m * N + n;
+          TA_ASSERT(result_layout.inner_ranges_[c].volume() ==
+                    inner_product_range(kernel, a_range, b_range).volume());
+          inner_product(kernel, a_range, a_data, b_range,
+                        right.data_.data() + right_layout.offsets_[b],
+                        data_.data() + result_layout.offsets_[c], true);
+        }
+      }
+    }
+  }
+
+ public:
+  PackedTensorOfTensors() = default;
+  PackedTensorOfTensors(const PackedTensorOfTensors_&) = default;
+  PackedTensorOfTensors(PackedTensorOfTensors_&&) = default;
+  PackedTensorOfTensors_& operator=(const PackedTensorOfTensors_&) = default;
+  PackedTensorOfTensors_& operator=(PackedTensorOfTensors_&&) = default;
+
+  /// Construct a tile with uninitialized elements
+
+  /// \param range The outer range
+  /// \param inner_ranges The ranges of the inner tensors, in the order of
+  /// \c range ; an inner tensor with an empty range has no elements
+  PackedTensorOfTensors(const range_type& range,
+                        std::vector<range_type> inner_ranges) {
+    init(range, std::move(inner_ranges));
+  }
+
+  /// Construct a tile with all elements set to \c value
+
+  /// \param range The outer range
+  /// \param inner_ranges The ranges of the inner tensors
+  /// \param value The value of the elements
+  PackedTensorOfTensors(const range_type& range,
+                        std::vector<range_type> inner_ranges, const T& value) {
+    init(range, std::move(inner_ranges));
+    std::fill_n(data_.data(), data_.size(), value);
+  }
+
+  /// Pack a tensor of tensors
+
+  /// \param tot The tensor of tensors
+  explicit PackedTensorOfTensors(const Tensor<Tensor<T>>& tot) {
+    if (tot.empty()) return;
+    std::vector<range_type> inner_ranges;
+    inner_ranges.reserve(tot.size());
+    for (const auto& inner : tot)
+      inner_ranges.emplace_back(inner.empty() ? range_type() : inner.range());
+    init(tot.range(), std::move(inner_ranges));
+    for (ordinal_type i = 0ul; i < tot.size(); ++i)
+      if (!tot[i].empty())
+        std::copy_n(tot[i].data(), tot[i].size(),
+                    data_.data() + layout_->offsets_[i]);
+  }
+
+  /// Unpack this tile
+
+  /// \return A tensor of tensors with the elements of this tile
+  explicit operator Tensor<Tensor<T>>() const {
+    if (!layout_) return Tensor<Tensor<T>>();
+    Tensor<Tensor<T>> result(layout_->range_);
+    for (ordinal_type i = 0ul; i < result.size(); ++i)
+      if (layout_->inner_ranges_[i].volume())
+        result[i] = Tensor<T>(layout_->inner_ranges_[i],
+                              data_.data() + layout_->offsets_[i]);
+    return result;
+  }
+
+  /// Deep copy
+
+  /// The layout is immutable and is shared with the copy.
+  /// \return A copy of this tile that does not share its data
+  PackedTensorOfTensors_ clone() const {
+    if (!layout_) return PackedTensorOfTensors_();
+    return transform([](const Tensor<T>& data) { return data.clone(); });
+  }
+
+  /// \return \c true if this tile has no layout
+  bool empty() const { return !layout_; }
+
+  /// \return \c true if the data of this tile is shared with another tile
+  bool is_shared() const { return data_.is_shared(); }
+
+  /// \return The outer range
+  const range_type& range() const {
+    TA_ASSERT(layout_);
+    return layout_->range_;
+  }
+
+  /// \return The number of inner tensors
+  ordinal_type size() const { return layout_ ? layout_->range_.volume() : 0ul; }
+
+  /// \return The packed elements of all inner tensors
+  const Tensor<T>& packed_data() const { return data_; }
+
+  /// \return The packed elements of all inner tensors
+  Tensor<T>& packed_data() { return data_; }
+
+  /// \param ord The ordinal index of an inner tensor
+  /// \return The range of inner tensor \c ord
+  const range_type& inner_range(const ordinal_type ord) const {
+    TA_ASSERT(layout_);
+    TA_ASSERT(layout_->range_.includes(ord));
+    return layout_->inner_ranges_[ord];
+  }
+
+  /// Inner tensor accessor
+
+  /// \param ord The ordinal index of an inner tensor
+  /// \return A view of inner tensor \c ord
+  const_reference operator[](const ordinal_type ord) const {
+    return const_reference(inner_range(ord),
+                           data_.data() + layout_->offsets_[ord]);
+  }
+
+  /// Inner tensor accessor
+
+  /// \param ord The ordinal index of an inner tensor
+  /// \return A mutable view of inner tensor \c ord
+  reference operator[](const ordinal_type ord) {
+    return reference(inner_range(ord), data_.data() + layout_->offsets_[ord]);
+  }
+
+  /// Inner tensor accessor
+
+  /// \tparam Index An integral range type
+  /// \param i The coordinate index of an inner tensor
+  /// \return A view of inner tensor \c i
+  template <typename Index, std::enable_if_t<
+                                detail::is_integral_range_v<Index>>* = nullptr>
+  const_reference operator[](const Index& i) const {
+    return operator[](range().ordinal(i));
+  }
+
+  /// Inner tensor accessor
+
+  /// \tparam Index An integral range type
+  /// \param i The coordinate index of an inner tensor
+  /// \return A mutable view of inner tensor \c i
+  template <typename Index, std::enable_if_t<
+                                detail::is_integral_range_v<Index>>* = nullptr>
+  reference operator[](const Index& i) {
+    return operator[](range().ordinal(i));
+  }
+
+  // Permutation -------------------------------------------------------------
+
+  /// Create a permuted copy of this tile
+
+  /// The outer modes are permuted by \c outer(perm) and, for a bipartite
+  /// permutation, the inner modes by \c inner(perm) .
+  /// \tparam Perm A permutation type
+  /// \param perm The permutation
+  /// \return A permuted copy of this tile
+  template <typename Perm,
+            typename = std::enable_if_t<detail::is_permutation_v<Perm>>>
+  PackedTensorOfTensors_ permute(const Perm& perm) const {
+    TA_ASSERT(layout_);
+    const Permutation outer_perm = outer(perm);
+    Permutation inner_perm;
+    if constexpr (detail::is_bipartite_permutation_v<Perm>) {
+      if (inner_size(perm) != 0) inner_perm = inner(perm);
+    }
+    if (!outer_perm && !inner_perm) return clone();
+
+    // Permute the layout
+    const Layout& arg = *layout_;
+    const ordinal_type n = arg.range_.volume();
+    auto layout = std::make_shared<Layout>();
+    layout->range_ = outer_perm ? outer_perm * arg.range_ : arg.range_;
+    layout->inner_ranges_.resize(n);
+    std::vector<ordinal_type> target(n);
+    const detail::PermIndex perm_index(arg.range_, outer_perm);
+    for (ordinal_type i = 0ul; i < n; ++i) {
+      target[i] = (outer_perm ? perm_index(i) : i);
+      layout->inner_ranges_[target[i]] =
+          (inner_perm && arg.inner_ranges_[i].volume()
+               ? inner_perm * arg.inner_ranges_[i]
+               : arg.inner_ranges_[i]);
+    }
+    layout->init_offsets();
+
+    // Move the inner tensors to their new positions
+    Tensor<T> data(data_.range());
+    auto input_op = [](const T& value) -> T { return value; };
+    auto output_op = [](T* MADNESS_RESTRICT const result, const T value) {
+      *result = value;
+    };
+    for (ordinal_type i = 0ul; i < n; ++i) {
+      const auto volume = arg.inner_ranges_[i].volume();
+      if (volume == 0ul) continue;
+      const T* const source = data_.data() + arg.offsets_[i];
+      T* const result = data.data() + layout->offsets_[target[i]];
+      if (inner_perm) {
+        const_reference source_map(arg.inner_ranges_[i], source);
+        reference result_map(layout->inner_ranges_[target[i]], result);
+        detail::permute(input_op, output_op, result_map, inner_perm,
+                        source_map);
+      } else {
+        std::copy_n(source, volume, result);
+      }
+    }
+
+    return PackedTensorOfTensors_(std::move(layout), std::move(data));
+  }
+
+  // Addition ----------------------------------------------------------------
+
+  /// \param right The right-hand argument
+  /// \return The sum of this tile and \c right
+  PackedTensorOfTensors_ add(const PackedTensorOfTensors_& right) const {
+    check_layout(right);
+    return transform(
+        [&right](const Tensor<T>& data) { return data.add(right.data_); });
+  }
+
+  /// \param right The right-hand argument
+  /// \param factor The scaling factor
+  /// \return The sum of this tile and \c right, scaled by \c factor
+  template <typename Scalar, typename std::enable_if<
+                                 detail::is_numeric_v<Scalar>>::type* = nullptr>
+  PackedTensorOfTensors_ add(const PackedTensorOfTensors_& right,
+                             const Scalar factor) const {
+    check_layout(right);
+    return transform([&right, factor](const Tensor<T>& data) {
+      return data.add(right.data_, factor);
+    });
+  }
+
+  /// \param right The right-hand argument
+  /// \param perm The permutation to be applied to the result
+  /// \return The permuted sum of this tile and \c right
+  template <typename Perm,
+            typename = std::enable_if_t<detail::is_permutation_v<Perm>>>
+  PackedTensorOfTensors_ add(const PackedTensorOfTensors_& right,
+                             const Perm& perm) const {
+    return add(right).permute(perm);
+  }
+
+  /// \param right The right-hand argument
+  /// \param factor The scaling factor
+  /// \param perm The permutation to be applied to the result
+  /// \return The permuted, scaled sum of this tile and \c right
+  template <typename Scalar, typename Perm,
+            typename std::enable_if<detail::is_numeric_v<Scalar> &&
+                                    detail::is_permutation_v<Perm>>::type* =
+                nullptr>
+  PackedTensorOfTensors_ add(const PackedTensorOfTensors_& right,
+                             const Scalar factor, const Perm& perm) const {
+    return add(right, factor).permute(perm);
+  }
+
+  /// \param value The constant to be added to the elements
+  /// \return A copy of this tile with \c value added to its elements
+  PackedTensorOfTensors_ add(const numeric_type value) const {
+    return transform(
+        [value](const Tensor<T>& data) { return data.add(value); });
+  }
+
+  /// \param right The tile to be added to this tile
+  /// \return A reference to this tile
+  PackedTensorOfTensors_& add_to(const PackedTensorOfTensors_& right) {
+    check_layout(right);
+    data_.add_to(right.data_);
+    return *this;
+  }
+
+  /// \param right The tile to be added to this tile
+  /// \param factor The scaling factor
+  /// \return A reference to this tile, which is scaled by \c factor
+  template <typename Scalar, typename std::enable_if<
+                                 detail::is_numeric_v<Scalar>>::type* = nullptr>
+  PackedTensorOfTensors_& add_to(const PackedTensorOfTensors_& right,
+                                 const Scalar factor) {
+    check_layout(right);
+    data_.add_to(right.data_, factor);
+    return *this;
+  }
+
+  /// \param value The constant to be added to the elements
+  /// \return A reference to this tile
+  PackedTensorOfTensors_& add_to(const numeric_type value) {
+    data_.add_to(value);
+    return *this;
+  }
+
+  // Subtraction -------------------------------------------------------------
+
+  /// \param right The right-hand argument
+  /// \return The difference of this tile and \c right
+  PackedTensorOfTensors_ subt(const PackedTensorOfTensors_& right) const {
+    check_layout(right);
+    return transform(
+        [&right](const Tensor<T>& data) { return data.subt(right.data_); });
+  }
+
+  /// \param right The right-hand argument
+  /// \param factor The scaling factor
+  /// \return The difference of this tile and \c right, scaled by \c factor
+  template <typename Scalar, typename std::enable_if<
+                                 detail::is_numeric_v<Scalar>>::type* = nullptr>
+  PackedTensorOfTensors_ subt(const PackedTensorOfTensors_& right,
+                              const Scalar factor) const {
+    check_layout(right);
+    return transform([&right, factor](const Tensor<T>& data) {
+      return data.subt(right.data_, factor);
+    });
+  }
+
+  /// \param right The right-hand argument
+  /// \param perm The permutation to be applied to the result
+  /// \return The permuted difference of this tile and \c right
+  template <typename Perm,
+            typename = std::enable_if_t<detail::is_permutation_v<Perm>>>
+  PackedTensorOfTensors_ subt(const PackedTensorOfTensors_& right,
+                              const Perm& perm) const {
+    return subt(right).permute(perm);
+  }
+
+  /// \param right The right-hand argument
+  /// \param factor The scaling factor
+  /// \param perm The permutation to be applied to the result
+  /// \return The permuted, scaled difference of this tile and \c right
+  template <typename Scalar, typename Perm,
+            typename std::enable_if<detail::is_numeric_v<Scalar> &&
+                                    detail::is_permutation_v<Perm>>::type* =
+                nullptr>
+  PackedTensorOfTensors_ subt(const PackedTensorOfTensors_& right,
+                              const Scalar factor, const Perm& perm) const {
+    return subt(right, factor).permute(perm);
+  }
+
+  /// \param value The constant to be subtracted from the elements
+  /// \return A copy of this tile with \c value subtracted from its elements
+  PackedTensorOfTensors_ subt(const numeric_type value) const {
+    return add(-value);
+  }
+
+  /// \param right The tile to be subtracted from this tile
+  /// \return A reference to this tile
+  PackedTensorOfTensors_& subt_to(const PackedTensorOfTensors_& right) {
+    check_layout(right);
+    data_.subt_to(right.data_);
+    return *this;
+  }
+
+  /// \param right The tile to be subtracted from this tile
+  /// \param factor The scaling factor
+  /// \return A reference to this tile, which is scaled by \c factor
+  template <typename Scalar, typename std::enable_if<
+                                 detail::is_numeric_v<Scalar>>::type* = nullptr>
+  PackedTensorOfTensors_& subt_to(const PackedTensorOfTensors_& right,
+                                  const Scalar factor) {
+    check_layout(right);
+    data_.subt_to(right.data_, factor);
+    return *this;
+  }
+
+  /// \param value The constant to be subtracted from the elements
+  /// \return A reference to this tile
+  PackedTensorOfTensors_& subt_to(const numeric_type value) {
+    return add_to(-value);
+  }
+
+  // Element-wise product ----------------------------------------------------
+
+  /// \param right The right-hand argument
+  /// \return The element-wise product of this tile and \c right
+  PackedTensorOfTensors_ mult(const PackedTensorOfTensors_& right) const {
+    check_layout(right);
+    return transform(
+        [&right](const Tensor<T>& data) { return data.mult(right.data_); });
+  }
+
+  /// \param right The right-hand argument
+  /// \param factor The scaling factor
+  /// \return The element-wise product of this tile and \c right, scaled by
+  /// \c factor
+  template <typename Scalar, typename std::enable_if<
+                                 detail::is_numeric_v<Scalar>>::type* = nullptr>
+  PackedTensorOfTensors_ mult(const PackedTensorOfTensors_& right,
+                              const Scalar factor) const {
+    check_layout(right);
+    return transform([&right, factor](const Tensor<T>& data) {
+      return data.mult(right.data_, factor);
+    });
+  }
+
+  /// \param right The right-hand argument
+  /// \param perm The permutation to be applied to the result
+  /// \return The permuted element-wise product of this tile and \c right
+  template <typename Perm,
+            typename = std::enable_if_t<detail::is_permutation_v<Perm>>>
+  PackedTensorOfTensors_ mult(const PackedTensorOfTensors_& right,
+                              const Perm& perm) const {
+    return mult(right).permute(perm);
+  }
+
+  /// \param right The right-hand argument
+  /// \param factor The scaling factor
+  /// \param perm The permutation to be applied to the result
+  /// \return The permuted, scaled element-wise product of this tile and
+  /// \c right
+  template <typename Scalar, typename Perm,
+            typename std::enable_if<detail::is_numeric_v<Scalar> &&
+                                    detail::is_permutation_v<Perm>>::type* =
+                nullptr>
+  PackedTensorOfTensors_ mult(const PackedTensorOfTensors_& right,
+                              const Scalar factor, const Perm& perm) const {
+    return mult(right, factor).permute(perm);
+  }
+
+  /// \param right The tile to be multiplied by this tile
+  /// \return A reference to this tile
+  PackedTensorOfTensors_& mult_to(const PackedTensorOfTensors_& right) {
+    check_layout(right);
+    data_.mult_to(right.data_);
+    return *this;
+  }
+
+  /// \param right The tile to be multiplied by this tile
+  /// \param factor The scaling factor
+  /// \return A reference to this tile, which is scaled by \c factor
+  template <typename Scalar, typename std::enable_if<
+                                 detail::is_numeric_v<Scalar>>::type* = nullptr>
+  PackedTensorOfTensors_& mult_to(const PackedTensorOfTensors_& right,
+                                  const Scalar factor) {
+    check_layout(right);
+    data_.mult_to(right.data_, factor);
+    return *this;
+  }
+
+  // Scaling and negation ----------------------------------------------------
+
+  /// \param factor The scaling factor
+  /// \return A copy of this tile scaled by \c factor
+  template <typename Scalar, typename std::enable_if<
+                                 detail::is_numeric_v<Scalar>>::type* = nullptr>
+  PackedTensorOfTensors_ scale(const Scalar factor) const {
+    return transform(
+        [factor](const Tensor<T>& data) { return data.scale(factor); });
+  }
+
+  /// \param factor The scaling factor
+  /// \param perm The permutation to be applied to the result
+  /// \return A permuted copy of this tile scaled by \c factor
+  template <typename Scalar, typename Perm,
+            typename std::enable_if<detail::is_numeric_v<Scalar> &&
+                                    detail::is_permutation_v<Perm>>::type* =
+                nullptr>
+  PackedTensorOfTensors_ scale(const Scalar factor, const Perm& perm) const {
+    return scale(factor).permute(perm);
+  }
+
+  /// \param factor The scaling factor
+  /// \return A reference to this tile
+  template <typename Scalar, typename std::enable_if<
+                                 detail::is_numeric_v<Scalar>>::type* = nullptr>
+  PackedTensorOfTensors_& scale_to(const Scalar factor) {
+    data_.scale_to(factor);
+    return *this;
+  }
+
+  /// \return A negated copy of this tile
+  PackedTensorOfTensors_ neg() const {
+    return transform([](const Tensor<T>& data) { return data.neg(); });
+  }
+
+  /// \param perm The permutation to be applied to the result
+  /// \return A permuted, negated copy of this tile
+  template <typename Perm,
+            typename = std::enable_if_t<detail::is_permutation_v<Perm>>>
+  PackedTensorOfTensors_ neg(const Perm& perm) const {
+    return neg().permute(perm);
+  }
+
+  /// \return A reference to this tile
+  PackedTensorOfTensors_& neg_to() {
+    data_.neg_to();
+    return *this;
+  }
+
+  // Reductions --------------------------------------------------------------
+
+  /// \return The sum of the elements of all inner tensors
+  numeric_type sum() const { return data_.sum(); }
+
+  /// \return The product of the elements of all inner tensors
+  numeric_type product() const { return data_.product(); }
+
+  /// \return The squared Frobenius norm of this tile
+  scalar_type squared_norm() const { return data_.squared_norm(); }
+
+  /// \return The Frobenius norm of this tile
+  scalar_type norm() const { return data_.norm(); }
+
+  /// \return The minimum element of all inner tensors
+  numeric_type min() const { return data_.min(); }
+
+  /// \return The maximum element of all inner tensors
+  numeric_type max() const { return data_.max(); }
+
+  /// \return The minimum absolute value of the elements
+  scalar_type abs_min() const { return data_.abs_min(); }
+
+  /// \return The maximum absolute value of the elements
+  scalar_type abs_max() const { return data_.abs_max(); }
+
+  /// \param other A tile with the layout of this tile
+  /// \return The dot product of this tile and \c other
+  numeric_type dot(const PackedTensorOfTensors_& other) const {
+    check_layout(other);
+    return data_.dot(other.data_);
+  }
+
+  // Nested operations -------------------------------------------------------
+
+  /// Use a binary operation on the inner tensors to construct a new tile
+
+  /// A built-in inner product (\c elem_muladd_kernel_type ) is applied
+  /// directly to the packed elements. The layout of the result of any other
+  /// operation is not known before \c op is applied, so the inner tensors
+  /// are unpacked and the result is packed.
+  /// \tparam Op The inner tensor operation type, a callable with signature
+  /// <tt>Tensor<T>(const Tensor<T>&, const Tensor<T>&)</tt>
+  /// \param right The right-hand argument
+  /// \param op The inner tensor operation
+  /// \return A tile whose inner tensor \c i is <tt>op((*this)[i],
+  /// right[i])</tt>
+  template <typename Op,
+            typename = std::enable_if_t<std::is_invocable_r_v<
+                Tensor<T>, Op, const Tensor<T>&, const Tensor<T>&>>>
+  PackedTensorOfTensors_ binary(const PackedTensorOfTensors_& right,
+                                Op&& op) const {
+    if (!layout_ || !right.layout_)
+      TA_EXCEPTION("PackedTensorOfTensors: empty argument tile");
+    if (layout_->range_ != right.layout_->range_)
+      TA_EXCEPTION("PackedTensorOfTensors: the tiles have different ranges");
+    if constexpr (std::is_same_v<std::decay_t<Op>, elem_muladd_kernel_type>)
+      return binary_kernel(right, op);
+    const Tensor<Tensor<T>> left_tot = unpack(), right_tot = right.unpack();
+    Tensor<Tensor<T>> result(left_tot.range());
+    for (ordinal_type i = 0ul; i < result.size(); ++i)
+      result[i] = op(left_tot[i], right_tot[i]);
+    return PackedTensorOfTensors_(result);
+  }
+
+  /// Use a binary operation on the inner tensors to construct a new,
+  /// permuted tile
+
+  /// \tparam Op The inner tensor operation type
+  /// \tparam Perm A permutation type
+  /// \param right The right-hand argument
+  /// \param op The inner tensor operation
+  /// \param perm The permutation to be applied to the result
+  /// \return The permuted result of \c binary(right,op)
+  template <typename Op, typename Perm,
+            typename = std::enable_if_t<detail::is_permutation_v<Perm>>>
+  PackedTensorOfTensors_ binary(const PackedTensorOfTensors_& right, Op&& op,
+                                const Perm& perm) const {
+    return binary(right, std::forward<Op>(op)).permute(perm);
+  }
+
+  /// Contract two tiles and accumulate into this tile with an inner tensor
+  /// multiply-add operation
+
+  /// The tiles are contracted as tensors of tensors (see
+  /// \c Tensor::gemm ). A built-in inner product
+  /// (\c elem_muladd_kernel_type ) accumulates directly into the packed
+  /// elements of this tile. The layout of the result of any other operation
+  /// depends on \c elem_muladd_op , so the arguments are unpacked and the
+  /// result is packed.
+  /// \tparam ElementMultiplyAddOp A callable with signature
+  /// <tt>void(Tensor<T>&, const Tensor<T>&, const Tensor<T>&)</tt>
+  /// \param left The left-hand argument
+  /// \param right The right-hand argument
+  /// \param gemm_helper The GEMM helper of the outer contraction
+  /// \param elem_muladd_op The inner tensor multiply-add operation
+  /// \return A reference to this tile
+  template <typename ElementMultiplyAddOp,
+            typename = std::enable_if_t<std::is_invocable_r_v<
+                void, std::remove_reference_t<ElementMultiplyAddOp>,
+                Tensor<T>&, const Tensor<T>&, const Tensor<T>&>>>
+  PackedTensorOfTensors_& gemm(const PackedTensorOfTensors_& left,
+                               const PackedTensorOfTensors_& right,
+                               const math::GemmHelper& gemm_helper,
+                               ElementMultiplyAddOp&& elem_muladd_op) {
+    if (left.empty() || right.empty())
+      TA_EXCEPTION("PackedTensorOfTensors: empty argument tile");
+    if constexpr (std::is_same_v<std::decay_t<ElementMultiplyAddOp>,
+                                 elem_muladd_kernel_type>) {
+      gemm_kernel(left, right, gemm_helper, elem_muladd_op);
+      return *this;
+    }
+    Tensor<Tensor<T>> result = unpack();
+    result.gemm(left.unpack(), right.unpack(), gemm_helper,
+                std::forward<ElementMultiplyAddOp>(elem_muladd_op));
+    *this = PackedTensorOfTensors_(result);
+    return *this;
+  }
+
+  // Serialization -----------------------------------------------------------
+
+  /// Output serialization function
+
+  /// The bounds of all inner ranges are written as one block, followed by
+  /// the elements of all inner tensors as one block.
+  /// \tparam Archive The output archive type
+  /// \param[out] ar The output archive
+  template <typename Archive,
+            typename std::enable_if<madness::archive::is_output_archive<
+                Archive>::value>::type* = nullptr>
+  void serialize(Archive& ar) {
+    const bool empty = !layout_;
+    ar& empty;
+    if (!empty) {
+      const std::vector<index1_type> bounds = layout_->bounds();
+      const std::size_t nbounds = bounds.size();
+      const std::size_t volume = data_.size();
+      ar & layout_->range_ & nbounds & volume;
+      ar& madness::archive::wrap(bounds.data(), nbounds);
+      ar& madness::archive::wrap(data_.data(), volume);
+    }
+  }
+
+  /// Input serialization function
+
+  /// \tparam Archive The input archive type
+  /// \param[out] ar The input archive
+  template <typename Archive,
+            typename std::enable_if<madness::archive::is_input_archive<
+                Archive>::value>::type* = nullptr>
+  void serialize(Archive& ar) {
+    bool empty = true;
+    ar& empty;
+    if (empty) {
+      layout_.reset();
+      data_ = Tensor<T>();
+    } else {
+      auto layout = std::make_shared<Layout>();
+      std::size_t nbounds = 0ul, volume = 0ul;
+      ar & layout->range_ & nbounds & volume;
+      std::vector<index1_type> bounds(nbounds);
+      ar& madness::archive::wrap(bounds.data(), nbounds);
+      layout->init_inner_ranges(bounds);
+      if (layout->init_offsets() != volume)
+        TA_EXCEPTION(
+            "PackedTensorOfTensors: the element count does not match the "
+            "inner ranges");
+      data_ = Tensor<T>(range_type(volume));
+      ar& madness::archive::wrap(data_.data(), volume);
+      layout_ = std::move(layout);
+    }
+  }
+
+};  // class PackedTensorOfTensors
+
+/// Packed tensor of tensors output operator
+
+/// \tparam T The element type of the inner tensors
+/// \param os The output stream
+/// \param t The tile to be output
+/// \return A reference to the output stream
+template <typename T>
+inline std::ostream& operator<<(std::ostream& os,
+                                const PackedTensorOfTensors<T>& t) {
+  if (t.empty()) return os << "{ }";
+  os << t.range() << " { ";
+  for (std::size_t i = 0ul; i < t.size(); ++i) os << t[i] << " ";
+  os << "}";
+  return os;
+}
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_TENSOR_PACKED_TENSOR_OF_TENSORS_H__INCLUDED
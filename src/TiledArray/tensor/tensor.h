@@ -619,6 +619,14 @@ class Tensor {
   /// data), otherwise \c false.
   bool empty() const { return !pimpl_; }
 
+  /// Test if the data of this tensor is shared
+
+  /// Copies of Tensor objects are shallow, i.e. share data; this can be used
+  /// to implement copy-on-write semantics.
+  /// \return \c true if other Tensor objects refer to the data of this
+  /// tensor, otherwise \c false.
+  bool is_shared() const { return pimpl_ && pimpl_.use_count() > 1; }
+
   /// Output serialization function
 
   /// This function enables serialization within MADNESS
@@ -1737,6 +1745,9 @@ class Tensor {
   /// \code
   ///   return (*this = left.gemm(right, factor, gemm_helper));
   /// \endcode
+  /// unless \c left and/or \c right have a lower precision than \c this
+  /// (e.g. \c float arguments and a \c double result), in which case the
+  /// contraction is evaluated in the precision of \c this .
   template <typename U, typename AU, typename V, typename AV, typename W>
   Tensor_& gemm(const Tensor<U, AU>& left, const Tensor<V, AV>& right,
                 const W factor, const math::GemmHelper& gemm_helper) {
@@ -1744,6 +1755,13 @@ class Tensor {
         !detail::is_tensor_of_tensor_v<Tensor_, Tensor<U, AU>, Tensor<V, AV>>,
         "TA::Tensor<T>::gemm without custom element op is only applicable to "
         "plain tensors");
+    // Arguments of a lower precision are accumulated in the precision of this
+    if constexpr (math::blas::detail::is_mixed_precision_gemm_v<U, V, T>) {
+      if (this->empty())
+        *this = Tensor_(gemm_helper.make_result_range<range_type>(
+                            left.range(), right.range()),
+                        numeric_type(0));
+    }
     if (this->empty()) {
       *this = left.gemm(right, factor, gemm_helper);
     } else {
@@ -1941,20 +1959,50 @@ class Tensor {
     const integer ldb =
         (gemm_helper.right_op() == TiledArray::math::blas::NoTranspose ? N : K);
 
-    for (integer m = 0; m != M; ++m) {
-      for (integer n = 0; n != N; ++n) {
-        auto c_offset = m * N + n;
-        for (integer k = 0; k != K; ++k) {
-          auto a_offset =
-              gemm_helper.left_op() == TiledArray::math::blas::NoTranspose
-                  ? m * lda + k
-                  : k * lda + m;
-          auto b_offset =
-              gemm_helper.right_op() == TiledArray::math::blas::NoTranspose
-                  ? k * ldb + n
-                  : n * ldb + k;
-          elem_muladd_op(*(pimpl_->data_ + c_offset), *(left.data() + a_offset),
-                         *(right.data() + b_offset));
+    // Strides of the rows and columns of the left and right matrices
+    const bool left_notrans =
+        gemm_helper.left_op() == TiledArray::math::blas::NoTranspose;
+    const bool right_notrans =
+        gemm_helper.right_op() == TiledArray::math::blas::NoTranspose;
+    const integer a_ms = (left_notrans ? lda : 1);
+    const integer a_ks = (left_notrans ? 1 : lda);
+    const integer b_ks = (right_notrans ? ldb : 1);
+    const integer b_ns = (right_notrans ? 1 : ldb);
+
+    // The loops are blocked so that the elements of a block of left and
+    // right, e.g. inner tensors, stay in cache while they are reused. The
+    // elements of each right-hand block are packed into a contiguous panel
+    // of pointers, which is shared by all rows of the left-hand block. Each
+    // result element accumulates its contributions in order of increasing k,
+    // as in the unblocked algorithm.
+    constexpr integer block_size = 32;
+    const U* MADNESS_RESTRICT const a = left.data();
+    const V* MADNESS_RESTRICT const b = right.data();
+    value_type* MADNESS_RESTRICT const c = pimpl_->data_;
+    std::vector<const V*> panel(std::min(K, block_size) *
+                                std::min(N, block_size));
+    for (integer mb = 0; mb < M; mb += block_size) {
+      const integer me = std::min(mb + block_size, M);
+      for (integer nb = 0; nb < N; nb += block_size) {
+        const integer ne = std::min(nb + block_size, N);
+        const integer nn = ne - nb;
+        for (integer kb = 0; kb < K; kb += block_size) {
+          const integer ke = std::min(kb + block_size, K);
+
+          // Pack the right-hand block
+          for (integer k = kb; k != ke; ++k)
+            for (integer n = nb; n != ne; ++n)
+              panel[(k - kb) * nn + (n - nb)] = b + k * b_ks + n * b_ns;
+
+          for (integer m = mb; m != me; ++m) {
+            value_type* const c_m = c + m * N + nb;
+            for (integer k = kb; k != ke; ++k) {
+              const U& a_mk = a[m * a_ms + k * a_ks];
+              const V* const* const b_k = panel.data() + (k - kb) * nn;
+              for (integer n = 0; n != nn; ++n)
+                elem_muladd_op(c_m[n], a_mk, *b_k[n]);
+            }
+          }
         }
       }
     }
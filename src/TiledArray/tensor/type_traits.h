@@ -48,6 +48,8 @@ template <typename T, typename A = Eigen::aligned_allocator<T>>
 class Tensor;
 template <typename>
 class Tile;
+template <typename>
+class PackedTensorOfTensors;
 
 class Permutation;
 class BipartitePermutation;
@@ -114,6 +116,10 @@ template <typename T>
 struct is_tensor_of_tensor_helper<Tile<T>>
     : public is_tensor_of_tensor_helper<T> {};
 
+template <typename T>
+struct is_tensor_of_tensor_helper<PackedTensorOfTensors<T>>
+    : public std::true_type {};
+
 template <>
 struct is_tensor<> : public std::false_type {};
 
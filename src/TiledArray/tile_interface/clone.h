@@ -26,9 +26,13 @@
 #ifndef TILEDARRAY_TILE_INTERFACE_CLONE_H__INCLUDED
 #define TILEDARRAY_TILE_INTERFACE_CLONE_H__INCLUDED
 
+#include "../tensor/type_traits.h"
 #include "../tile_interface/cast.h"
 #include "../type_traits.h"
 
+#include <atomic>
+#include <memory>
+
 namespace TiledArray {
 
 /// Create a copy of \c arg
@@ -127,6 +131,103 @@ struct clone_trait : public TiledArray::tile_interface::clone_trait<Arg> {};
 template <typename Result, typename Arg>
 class Clone : public TiledArray::tile_interface::Clone<Result, Arg> {};
 
+/// Counter of the tiles cloned by expressions
+
+/// The tile operations of the expressions that are evaluated while a
+/// CloneCounter is alive count the tiles they clone (deep copy) in it. The
+/// operations keep counting after the counter goes out of scope, hence the
+/// count of an expression is complete once its evaluation has finished,
+/// e.g. after the barrier of a LazyEvalScope.
+/// \code
+/// CloneCounter clones;
+/// c("i,j") = a("i,j").block({0, 0}, {2, 2});  // clones the array tiles
+/// std::cout << clones.count();
+/// \endcode
+/// \note Counters may be nested; a tile cloned in the scope of an inner
+/// counter is also counted by the enclosing counters.
+class CloneCounter {
+ public:
+  /// The clone count of a counter and its enclosing counters
+  struct Count {
+    std::atomic<std::size_t> value{0ul};  ///< The number of cloned tiles
+    std::shared_ptr<Count> parent;        ///< The enclosing count
+
+    /// Count a cloned tile
+    void increment() {
+      for (Count* count = this; count; count = count->parent.get())
+        ++(count->value);
+    }
+  };  // struct Count
+
+  /// Constructor, the counter becomes the innermost active counter
+  CloneCounter() : count_(std::make_shared<Count>()), parent_(active_) {
+    if (parent_) count_->parent = parent_->count_;
+    active_ = this;
+  }
+
+  CloneCounter(const CloneCounter&) = delete;
+  CloneCounter& operator=(const CloneCounter&) = delete;
+
+  ~CloneCounter() { active_ = parent_; }
+
+  /// \return The number of tiles cloned by the tile operations created in
+  /// the scope of this counter
+  std::size_t count() const { return count_->value; }
+
+  /// \return The count of the innermost active counter, or \c nullptr
+  static std::shared_ptr<Count> active_count() {
+    return (active_ ? active_->count_ : nullptr);
+  }
+
+ private:
+  std::shared_ptr<Count> count_;  ///< The clone count
+  CloneCounter* parent_;          ///< The enclosing counter
+
+  static inline CloneCounter* active_ = nullptr;  ///< The innermost counter
+};  // class CloneCounter
+
+namespace detail {
+
+/// Clone count of a tile operation
+
+/// A tile operation captures the innermost active CloneCounter when it is
+/// constructed, i.e. when its expression is evaluated.
+class CloneCount {
+ public:
+  CloneCount() : count_(CloneCounter::active_count()) {}
+
+  /// Count a cloned tile
+  void increment() const {
+    if (count_) count_->increment();
+  }
+
+ private:
+  std::shared_ptr<CloneCounter::Count> count_;  ///< The captured count
+};  // class CloneCount
+
+/// Test if a tile is the only owner of its data
+
+/// Tile copies are shallow, hence a tile may only be modified in place if no
+/// other tile object refers to its data. A tile that is not flagged as
+/// consumable, e.g. the result of converting an array tile, can still be
+/// consumed if this function returns \c true .
+/// \tparam Tile The tile type
+/// \param tile The tile to be tested
+/// \return \c true if \c tile reports that its data is not shared;
+/// \c false if the data is shared, the tile type does not report sharing,
+/// or \c tile is a tensor of tensors (whose elements may be shared even if
+/// the outer tensor is not)
+template <typename Tile>
+inline bool is_exclusive_tile(const Tile& tile) {
+  if constexpr (has_member_function_is_shared_v<const Tile, bool> &&
+                !is_tensor_of_tensor_v<Tile>)
+    return !tile.is_shared();
+  else
+    return false;
+}
+
+}  // namespace detail
+
 }  // namespace TiledArray
 
 #endif  // TILEDARRAY_TILE_INTERFACE_CLONE_H__INCLUDED
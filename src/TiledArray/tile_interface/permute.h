@@ -105,7 +105,14 @@ class Permute<Result, Arg,
             typename = std::enable_if_t<detail::is_permutation_v<Perm>>>
   result_type operator()(const argument_type& arg, const Perm& perm) const {
     using TiledArray::permute;
-    if constexpr (detail::is_bipartite_permutable_v<argument_type>) {
+    if constexpr (detail::is_ta_tensor_v<result_type> &&
+                  detail::is_ta_tensor_v<argument_type> &&
+                  !detail::is_tensor_of_tensor_v<result_type> &&
+                  !detail::is_tensor_of_tensor_v<argument_type>) {
+      // Convert the elements as they are permuted, e.g. to change the
+      // precision of a tensor, without an intermediate permuted tensor
+      return result_type(arg, perm);
+    } else if constexpr (detail::is_bipartite_permutable_v<argument_type>) {
       return Cast_::operator()(permute(arg, perm));
     } else {
       TA_ASSERT(inner_size(perm));
@@ -300,10 +300,13 @@ class BinaryWrapper {
     auto op_right = [=](eval_t<L>& _left, eval_t<R>& _right) {
       return op_.consume_right(_left, _right);
     };
-    // Override consumable
-    if (is_consumable_tile<eval_t<L>>::value && left.is_consumable())
+    // Override consumable; evaluated tiles that do not share data with the
+    // array tiles may be consumed as well
+    if (is_consumable_tile<eval_t<L>>::value &&
+        (left.is_consumable() || is_exclusive_tile(eval_left)))
       return meta::invoke(op_left, eval_left, eval_right);
-    if (is_consumable_tile<eval_t<R>>::value && right.is_consumable())
+    if (is_consumable_tile<eval_t<R>>::value &&
+        (right.is_consumable() || is_exclusive_tile(eval_right)))
       return meta::invoke(op_right, eval_left, eval_right);
 
     return meta::invoke(op_, eval_left, eval_right);
@@ -319,8 +322,10 @@ class BinaryWrapper {
 
     if (perm_) return op_(eval_left, std::forward<R>(right), perm_);
 
-    // Override consumable
-    if (is_consumable_tile<eval_t<L>>::value && left.is_consumable())
+    // Override consumable; evaluated tiles that do not share data with the
+    // array tiles may be consumed as well
+    if (is_consumable_tile<eval_t<L>>::value &&
+        (left.is_consumable() || is_exclusive_tile(eval_left)))
       return op_.consume_left(eval_left, std::forward<R>(right));
 
     return op_(eval_left, std::forward<R>(right));
@@ -336,8 +341,10 @@ class BinaryWrapper {
 
     if (perm_) return op_(eval_left, eval_right, perm_);
 
-    // Override consumable
-    if (is_consumable_tile<eval_t<L>>::value && left.is_consumable())
+    // Override consumable; evaluated tiles that do not share data with the
+    // array tiles may be consumed as well
+    if (is_consumable_tile<eval_t<L>>::value &&
+        (left.is_consumable() || is_exclusive_tile(eval_left)))
       return op_.consume_left(eval_left, eval_right);
 
     return op_(eval_left, eval_right);
@@ -352,8 +359,10 @@ class BinaryWrapper {
 
     if (perm_) return op_(std::forward<L>(left), eval_right, perm_);
 
-    // Override consumable
-    if (is_consumable_tile<eval_t<R>>::value && right.is_consumable())
+    // Override consumable; evaluated tiles that do not share data with the
+    // array tiles may be consumed as well
+    if (is_consumable_tile<eval_t<R>>::value &&
+        (right.is_consumable() || is_exclusive_tile(eval_right)))
       return op_.consume_right(std::forward<L>(left), eval_right);
 
     return op_(std::forward<L>(left), eval_right);
@@ -369,8 +378,10 @@ class BinaryWrapper {
 
     if (perm_) return op_(eval_left, eval_right, perm_);
 
-    // Override consumable
-    if (is_consumable_tile<eval_t<R>>::value && right.is_consumable())
+    // Override consumable; evaluated tiles that do not share data with the
+    // array tiles may be consumed as well
+    if (is_consumable_tile<eval_t<R>>::value &&
+        (right.is_consumable() || is_exclusive_tile(eval_right)))
       return op_.consume_right(eval_left, eval_right);
 
     return op_(eval_left, eval_right);
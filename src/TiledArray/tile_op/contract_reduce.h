@@ -26,6 +26,7 @@
 #ifndef TILEDARRAY_TILE_OP_CONTRACT_REDUCE_H__INCLUDED
 #define TILEDARRAY_TILE_OP_CONTRACT_REDUCE_H__INCLUDED
 
+#include <TiledArray/math/elem_muladd.h>
 #include <TiledArray/math/gemm_helper.h>
 #include <TiledArray/permutation.h>
 #include <TiledArray/tensor/complex.h>
@@ -34,6 +35,8 @@
 #include "../tile_interface/add.h"
 #include "../tile_interface/permute.h"
 
+#include <optional>
+
 namespace TiledArray {
 namespace detail {
 
@@ -63,6 +66,8 @@ class ContractReduceBase {
   using result_value_type = typename Result::value_type;
   using elem_muladd_op_type = void(result_value_type&, const left_value_type&,
                                    const right_value_type&);
+  using elem_muladd_kernel_type =
+      math::ElemMulAdd<TiledArray::detail::numeric_t<result_value_type>>;
 
   static_assert(
       TiledArray::detail::is_tensor_v<left_value_type> ==
@@ -75,6 +80,15 @@ class ContractReduceBase {
       !(TiledArray::detail::is_tensor_v<left_value_type> &&
         TiledArray::detail::is_tensor_v<right_value_type> &&
         TiledArray::detail::is_tensor_v<result_value_type>);
+  /// \c true if the arguments have a lower precision than the result, e.g.
+  /// single-precision arguments of a double-precision result; the products
+  /// are then accumulated in the precision of the result
+  static constexpr bool mixed_precision =
+      plain_tensors &&
+      math::blas::detail::is_mixed_precision_gemm_v<
+          TiledArray::detail::numeric_t<Left>,
+          TiledArray::detail::numeric_t<Right>,
+          TiledArray::detail::numeric_t<Result>>;
 
  private:
   struct Impl {
@@ -96,6 +110,12 @@ class ContractReduceBase {
           elem_muladd_op_(std::forward<ElemMultAddOp>(elem_muladd_op)) {
       // non-unit alpha must be absorbed into elem_muladd_op
       if (elem_muladd_op_) TA_ASSERT(alpha == scalar_type(1));
+      // keep a copy of a built-in op, so that gemm can call it directly
+      if constexpr (std::is_same_v<std::decay_t<ElemMultAddOp>,
+                                   elem_muladd_kernel_type>) {
+        elem_muladd_kernel_ = elem_muladd_op;
+        elem_muladd_op_ = *elem_muladd_kernel_;
+      }
     }
 
     math::GemmHelper gemm_helper_;  ///< Gemm helper object
@@ -107,6 +127,9 @@ class ContractReduceBase {
     /// type-erased reference to custom element multiply-add op
     /// \note the lifetime is managed by the callee!
     TiledArray::function_ref<elem_muladd_op_type> elem_muladd_op_;
+
+    /// the element multiply-add op, if it is a built-in op
+    std::optional<elem_muladd_kernel_type> elem_muladd_kernel_;
   };
 
   std::shared_ptr<Impl> pimpl_;
@@ -184,6 +207,16 @@ class ContractReduceBase {
     return pimpl_->elem_muladd_op_;
   }
 
+  /// Built-in element multiply-add op accessor
+
+  /// \return A pointer to the element multiply-add op, if it is a built-in
+  /// op, or \c nullptr otherwise
+  const elem_muladd_kernel_type* elem_muladd_kernel() const {
+    TA_ASSERT(pimpl_);
+    return pimpl_->elem_muladd_kernel_ ? &*pimpl_->elem_muladd_kernel_
+                                       : nullptr;
+  }
+
   //-------------- these are only used for unit tests -----------------
 
   /// Compute the number of contracted ranks
@@ -323,16 +356,19 @@ class ContractReduce : public ContractReduceBase<Result, Left, Right, Scalar> {
                   const second_argument_type& right) const {
     if constexpr (!ContractReduceBase_::plain_tensors) {
       TA_ASSERT(this->elem_muladd_op());
-      // not yet implemented
       using TiledArray::empty;
       using TiledArray::gemm;
-      gemm(result, left, right, ContractReduceBase_::gemm_helper(),
-           this->elem_muladd_op());
+      // built-in ops are passed by type, so that gemm can inline them
+      if (const auto* kernel = this->elem_muladd_kernel())
+        gemm(result, left, right, ContractReduceBase_::gemm_helper(), *kernel);
+      else
+        gemm(result, left, right, ContractReduceBase_::gemm_helper(),
+             this->elem_muladd_op());
     } else {  // plain tensors
       TA_ASSERT(!this->elem_muladd_op());
       using TiledArray::empty;
       using TiledArray::gemm;
-      if (empty(result))
+      if (empty(result) && !ContractReduceBase_::mixed_precision)
         result = gemm(left, right, ContractReduceBase_::factor(),
                       ContractReduceBase_::gemm_helper());
       else
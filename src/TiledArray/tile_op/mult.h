@@ -27,10 +27,13 @@
 #define TILEDARRAY_TILE_OP_MULT_H__INCLUDED
 
 #include <TiledArray/error.h>
+#include <TiledArray/math/elem_muladd.h>
 #include <TiledArray/tile_op/tile_interface.h>
 #include <TiledArray/util/function.h>
 #include <TiledArray/zero_tensor.h>
 
+#include <optional>
+
 namespace TiledArray {
 namespace detail {
 
@@ -66,6 +69,8 @@ class Mult {
   using result_value_type = typename result_type::value_type;
   using element_op_type = result_value_type(const left_value_type&,
                                             const right_value_type&);
+  using elem_muladd_kernel_type =
+      math::ElemMulAdd<TiledArray::detail::numeric_t<result_value_type>>;
 
   /// Indicates whether it is *possible* to consume the left tile
   static constexpr bool left_is_consumable =
@@ -79,6 +84,26 @@ class Mult {
   /// \note the lifetime is managed by the callee!
   TiledArray::function_ref<element_op_type> element_op_;
 
+  /// the element op, if it is a built-in inner product of nested tensors
+  std::optional<elem_muladd_kernel_type> elem_muladd_kernel_;
+
+  /// Apply the built-in element op
+
+  /// Built-in ops are passed to the tiles by type, so that tiles can apply
+  /// them to their inner tensors directly.
+  template <typename... Perm>
+  result_type eval_kernel(const left_type& first, const right_type& second,
+                          const Perm&... perm) const {
+    TA_ASSERT(elem_muladd_kernel_);
+    if constexpr (TiledArray::detail::is_tensor_of_tensor_v<result_type>) {
+      using TiledArray::binary;
+      return binary(first, second, *elem_muladd_kernel_, perm...);
+    } else {
+      TA_ASSERT(false);  // only nested tensors have built-in element ops
+      return result_type();
+    }
+  }
+
   // Permuting tile evaluation function
   // These operations cannot consume the argument tile since this operation
   // requires temporary storage space.
@@ -86,9 +111,10 @@ class Mult {
                                TiledArray::detail::is_permutation_v<Perm>>>
   result_type eval(const left_type& first, const right_type& second,
                    const Perm& perm) const {
+    if (elem_muladd_kernel_) return eval_kernel(first, second, perm);
     if (!element_op_) {
       using TiledArray::mult;
-      return mult(first, second, perm);
+      return result_type(mult(first, second, perm));
     } else {
       using TiledArray::binary;
       return binary(first, second, element_op_, perm);
@@ -117,9 +143,10 @@ class Mult {
   template <bool LC, bool RC,
             typename std::enable_if<!(LC || RC)>::type* = nullptr>
   result_type eval(const left_type& first, const right_type& second) const {
+    if (elem_muladd_kernel_) return eval_kernel(first, second);
     if (!element_op_) {
       using TiledArray::mult;
-      return mult(first, second);
+      return result_type(mult(first, second));
     } else {
       using TiledArray::binary;
       return binary(first, second, element_op_);
@@ -128,6 +155,7 @@ class Mult {
 
   template <bool LC, bool RC, typename std::enable_if<LC>::type* = nullptr>
   result_type eval(left_type& first, const right_type& second) const {
+    if (elem_muladd_kernel_) return eval_kernel(first, second);
     TA_ASSERT(!element_op_);
     using TiledArray::mult_to;
     return mult_to(first, second);
@@ -136,6 +164,7 @@ class Mult {
   template <bool LC, bool RC,
             typename std::enable_if<!LC && RC>::type* = nullptr>
   result_type eval(const left_type& first, right_type& second) const {
+    if (elem_muladd_kernel_) return eval_kernel(first, second);
     TA_ASSERT(!element_op_);
     using TiledArray::mult_to;
     return mult_to(second, first);
@@ -176,10 +205,16 @@ class Mult {
   template <typename ElementOp,
             typename = std::enable_if_t<
                 !std::is_same_v<std::remove_reference_t<ElementOp>, Mult_> &&
+                !std::is_same_v<std::decay_t<ElementOp>,
+                                elem_muladd_kernel_type> &&
                 std::is_invocable_r_v<
                     result_value_type, std::remove_reference_t<ElementOp>,
                     const left_value_type&, const right_value_type&>>>
   explicit Mult(ElementOp&& op) : element_op_(std::forward<ElementOp>(op)) {}
+  /// Construct using a built-in element-wise op of nested tensors
+  /// \param kernel the inner product of the nested tensors
+  explicit Mult(const elem_muladd_kernel_type& kernel)
+      : elem_muladd_kernel_(kernel) {}
 
   /// Multiply-and-permute operator
 
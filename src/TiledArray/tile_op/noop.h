@@ -50,6 +50,8 @@ class Noop {
   static constexpr bool is_consumable = Consumable;
 
  private:
+  CloneCount clones_;  ///< Counts the cloned tiles
+
   // Permuting tile evaluation function
   // These operations cannot consume the argument tile since this operation
   // requires temporary storage space.
@@ -67,6 +69,7 @@ class Noop {
   template <bool C, typename std::enable_if<!C>::type* = nullptr>
   result_type eval(const Arg& arg) const {
     TiledArray::Clone<Result, Arg> clone;
+    clones_.increment();
     return clone(arg);
   }
 
@@ -26,12 +26,83 @@
 #ifndef TILEDARRAY_TILE_OP_SHIFT_H__INCLUDED
 #define TILEDARRAY_TILE_OP_SHIFT_H__INCLUDED
 
+#include "../tensor/type_traits.h"
 #include "../tile_interface/permute.h"
 #include "../tile_interface/shift.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace TiledArray {
 namespace detail {
 
+/// Element bounds of a tensor block
+
+/// A block whose bounds are not aligned with the tile boundaries cuts
+/// through the tiles on the boundary of the block. This object holds the
+/// element bounds of such a block and extracts the part of a boundary tile
+/// that lies inside them, as a strided view of the tile data. An empty object
+/// represents a block that is aligned with the tile boundaries.
+class ElementBounds {
+  std::vector<long> lobound_;  ///< Lower element bound of the block
+  std::vector<long> upbound_;  ///< Upper element bound of the block
+
+ public:
+  ElementBounds() = default;
+  ElementBounds(const ElementBounds&) = default;
+  ElementBounds(ElementBounds&&) = default;
+  ~ElementBounds() = default;
+  ElementBounds& operator=(const ElementBounds&) = default;
+  ElementBounds& operator=(ElementBounds&&) = default;
+
+  /// Constructor
+
+  /// \param lobound The lower element bound of the block
+  /// \param upbound The upper element bound of the block
+  ElementBounds(const std::vector<long>& lobound,
+                const std::vector<long>& upbound)
+      : lobound_(lobound), upbound_(upbound) {
+    TA_ASSERT(lobound_.size() == upbound_.size());
+  }
+
+  /// \return \c true if the block is aligned with the tile boundaries
+  bool empty() const { return lobound_.empty(); }
+
+  /// Test if a tile lies inside the block
+
+  /// \tparam Range The tile range type
+  /// \param range The range of the tile
+  /// \return \c true if every element of \c range is inside the block
+  template <typename Range>
+  bool includes(const Range& range) const {
+    if (lobound_.empty()) return true;
+    const auto* MADNESS_RESTRICT const lower = range.lobound_data();
+    const auto* MADNESS_RESTRICT const upper = range.upbound_data();
+    for (unsigned int d = 0u; d < lobound_.size(); ++d)
+      if (long(lower[d]) < lobound_[d] || long(upper[d]) > upbound_[d])
+        return false;
+    return true;
+  }
+
+  /// Strided view of the part of a tile that is inside the block
+
+  /// \tparam Tile The tile type
+  /// \param tile The tile
+  /// \return A view of the elements of \c tile that are inside the block
+  template <typename Tile>
+  auto block(const Tile& tile) const {
+    const unsigned int rank = lobound_.size();
+    const auto& range = tile.range();
+    TA_ASSERT(range.rank() == rank);
+    std::vector<long> lower(rank), upper(rank);
+    for (unsigned int d = 0u; d < rank; ++d) {
+      lower[d] = std::max<long>(range.lobound(d), lobound_[d]);
+      upper[d] = std::min<long>(range.upbound(d), upbound_[d]);
+    }
+    return tile.block(lower, upper);
+  }
+};  // class ElementBounds
+
 /// Tile shift operation
 
 /// This tile operation will shift the range of the tile and/or apply a
@@ -42,6 +113,9 @@ namespace detail {
 /// consumed
 /// \note Input tiles can be consumed only if their type matches the result
 /// type.
+/// \note A TiledArray::Tensor stores its range with its data, so a tile that
+/// cannot be consumed is copied even when only its range is shifted. This
+/// includes the tiles inside the bounds of an element block.
 template <typename Result, typename Arg, bool Consumable>
 class Shift {
  public:
@@ -55,6 +129,28 @@ class Shift {
 
  private:
   std::vector<long> range_shift_;
+  ElementBounds bounds_;  ///< Element bounds of an unaligned block
+  CloneCount clones_;     ///< Counts the cloned tiles
+
+  // Boundary tile evaluation function
+  // Only the part of the tile that is inside the block is copied, the copy
+  // is permuted and shifted.
+  template <typename... Perm>
+  result_type eval_block(const argument_type& arg, const Perm&... perm) const {
+    if constexpr (is_ta_tensor_v<argument_type> &&
+                  !is_tensor_of_tensor_v<argument_type> &&
+                  std::is_same<result_type, argument_type>::value) {
+      TiledArray::ShiftTo<result_type, result_type> shift_to;
+      result_type result(bounds_.block(arg), perm...);
+      shift_to(result, range_shift_);
+      return result;
+    } else {
+      TA_EXCEPTION(
+          "Blocks that are not aligned with the tile boundaries require "
+          "TiledArray::Tensor tiles of numbers");
+      return result_type{};
+    }
+  }
 
   // Permuting tile evaluation function
   // These operations cannot consume the argument tile since this operation
@@ -76,6 +172,7 @@ class Shift {
   template <bool C, typename = void>
   auto eval(const argument_type& arg) const {
     TiledArray::Shift<result_type, argument_type> shift;
+    clones_.increment();
     return shift(arg, range_shift_);
   }
 
@@ -107,6 +204,15 @@ class Shift {
   /// Construct a no operation that does not permute the result tile
   Shift(const std::vector<long>& range_shift) : range_shift_(range_shift) {}
 
+  /// Block constructor
+
+  /// Tiles that are not inside \c bounds are cut to the bounds before they
+  /// are shifted.
+  /// \param range_shift The shift applied to the tile ranges
+  /// \param bounds The element bounds of the block
+  Shift(const std::vector<long>& range_shift, const ElementBounds& bounds)
+      : range_shift_(range_shift), bounds_(bounds) {}
+
   /// Shift and permute operator
 
   /// \param arg The tile argument
@@ -115,6 +221,7 @@ class Shift {
   template <typename Perm, typename = std::enable_if_t<
                                TiledArray::detail::is_permutation_v<Perm>>>
   result_type operator()(const argument_type& arg, const Perm& perm) const {
+    if (!bounds_.includes(arg.range())) return eval_block(arg, perm);
     return eval(arg, perm);
   }
 
@@ -125,6 +232,7 @@ class Shift {
   /// \return A shifted copy of `arg`
   template <typename A>
   result_type operator()(A&& arg) const {
+    if (!bounds_.includes(arg.range())) return eval_block(arg);
     return Shift_::template eval<is_consumable>(std::forward<A>(arg));
   }
 
@@ -138,6 +246,7 @@ class Shift {
     constexpr bool can_consume =
         is_consumable_tile<argument_type>::value &&
         std::is_same<result_type, argument_type>::value;
+    if (!bounds_.includes(arg.range())) return eval_block(arg);
     return Shift_::template eval<can_consume>(arg);
   }
 
@@ -166,6 +275,30 @@ class ScalShift {
  private:
   std::vector<long> range_shift_;  ///< Range shift array
   scalar_type factor_;             ///< Scaling factor
+  ElementBounds bounds_;           ///< Element bounds of an unaligned block
+
+  // Boundary tile evaluation function
+  // Only the part of the tile that is inside the block is copied, the copy
+  // is scaled, permuted, and shifted in a single pass.
+  template <typename... Perm>
+  result_type eval_block(const argument_type& arg, const Perm&... perm) const {
+    if constexpr (is_ta_tensor_v<argument_type> &&
+                  !is_tensor_of_tensor_v<argument_type> &&
+                  std::is_same<result_type, argument_type>::value) {
+      using TiledArray::shift_to;
+      const scalar_type factor = factor_;
+      result_type result(
+          bounds_.block(arg),
+          [factor](const numeric_t<argument_type> x) { return x * factor; },
+          perm...);
+      return shift_to(result, range_shift_);
+    } else {
+      TA_EXCEPTION(
+          "Blocks that are not aligned with the tile boundaries require "
+          "TiledArray::Tensor tiles of numbers");
+      return result_type{};
+    }
+  }
 
  public:
   // Permuting tile evaluation function
@@ -217,6 +350,17 @@ class ScalShift {
   ScalShift(const std::vector<long>& range_shift, const scalar_type factor)
       : range_shift_(range_shift), factor_(factor) {}
 
+  /// Block constructor
+
+  /// Tiles that are not inside \c bounds are cut to the bounds before they
+  /// are scaled and shifted.
+  /// \param range_shift The shift applied to the tile ranges
+  /// \param factor The scaling factor
+  /// \param bounds The element bounds of the block
+  ScalShift(const std::vector<long>& range_shift, const scalar_type factor,
+            const ElementBounds& bounds)
+      : range_shift_(range_shift), factor_(factor), bounds_(bounds) {}
+
   /// Shift and permute operator
 
   /// \param arg The tile argument
@@ -225,6 +369,7 @@ class ScalShift {
   template <typename Perm, typename = std::enable_if_t<
                                TiledArray::detail::is_permutation_v<Perm>>>
   result_type operator()(const argument_type& arg, const Perm& perm) const {
+    if (!bounds_.includes(arg.range())) return eval_block(arg, perm);
     return eval(arg, perm);
   }
 
@@ -235,6 +380,7 @@ class ScalShift {
   /// \return A shifted copy of `arg`
   template <typename A>
   result_type operator()(A&& arg) const {
+    if (!bounds_.includes(arg.range())) return eval_block(arg);
     return ScalShift_::template eval<is_consumable>(std::forward<A>(arg));
   }
 
@@ -246,6 +392,7 @@ class ScalShift {
     constexpr bool can_consume =
         is_consumable_tile<argument_type>::value &&
         std::is_same<result_type, argument_type>::value;
+    if (!bounds_.includes(arg.range())) return eval_block(arg);
     return ScalShift_::template eval<can_consume>(arg);
   }
 
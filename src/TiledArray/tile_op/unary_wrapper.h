@@ -176,8 +176,10 @@ class UnaryWrapper {
     //          return op_.consume(std::forward<decltype(arg)>(arg));
     //        };
     auto op_consume = [this](eval_t<A>& arg) { return op_.consume(arg); };
+    // The evaluated tile may also be consumed if it is a temporary that does
+    // not share data with the array tile
     return (perm_ ? meta::invoke(op_, std::move(cast_arg), perm_)
-                  : (arg.is_consumable()
+                  : (arg.is_consumable() || is_exclusive_tile(cast_arg)
                          ? meta::invoke(op_consume, cast_arg)
                          : meta::invoke(op_, std::move(cast_arg))));
   }
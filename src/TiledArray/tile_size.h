@@ -0,0 +1,426 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_TILE_SIZE_H__INCLUDED
+#define TILEDARRAY_TILE_SIZE_H__INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include <TiledArray/error.h>
+#include <TiledArray/external/madness.h>
+#include <TiledArray/math/blas.h>
+#include <TiledArray/permutation.h>
+#include <TiledArray/tensor/tensor.h>
+#include <TiledArray/tiled_range1.h>
+#include <TiledArray/util/time.h>
+
+namespace TiledArray {
+
+/// Measured performance of the kernels of a tensor contraction
+
+/// The profile holds the rates of the GEMM and permute kernels of square
+/// double-precision tiles, measured for a set of tile sizes, the overhead of
+/// a task, and the latency and bandwidth of messages. Rates of tile sizes
+/// that were not measured are interpolated. A profile is measured with
+/// measure() , which is collective; get() measures the profile of a world
+/// once and caches it.
+class KernelProfile {
+ public:
+  typedef std::size_t size_type;  ///< Tile size type
+
+ private:
+  std::vector<size_type> sizes_;       ///< The measured tile sizes
+  std::vector<double> gemm_rates_;     ///< GEMM rates, in flops/s
+  std::vector<double> permute_rates_;  ///< Permute rates, in bytes/s
+
+  double task_overhead_;  ///< The time to submit and run a task, in s
+  double latency_;        ///< The latency of a message, in s
+  double bandwidth_;      ///< The bandwidth of messages, in bytes/s
+
+  /// Interpolate a rate, linearly in the logarithm of the tile size
+  double interpolate(const std::vector<double>& rates,
+                     const double size) const {
+    if (size <= double(sizes_.front())) return rates.front();
+    if (size >= double(sizes_.back())) return rates.back();
+    const auto upper =
+        std::upper_bound(sizes_.begin(), sizes_.end(), size,
+                         [](const double x, const size_type y) {
+                           return x < double(y);
+                         }) -
+        sizes_.begin();
+    const double x0 = std::log(double(sizes_[upper - 1]));
+    const double x1 = std::log(double(sizes_[upper]));
+    const double w = (std::log(size) - x0) / (x1 - x0);
+    return rates[upper - 1] + w * (rates[upper] - rates[upper - 1]);
+  }
+
+  /// Time a kernel
+
+  /// The kernel is repeated until the elapsed time reaches a minimum.
+  /// \return The time of one call, in s
+  template <typename Op>
+  static double time_kernel(Op&& op) {
+    constexpr double min_time = 1.0e-3;
+    const auto t0 = TiledArray::now();
+    std::size_t count = 0ul;
+    double elapsed = 0.0;
+    do {
+      op();
+      ++count;
+      elapsed = TiledArray::duration_in_s(t0, TiledArray::now());
+    } while (elapsed < min_time);
+    return elapsed / double(count);
+  }
+
+ public:
+  /// Construct a profile from measured or modeled kernel performance
+
+  /// \param sizes The tile sizes, in increasing order
+  /// \param gemm_rates The GEMM rates of the square tiles of \c sizes , in
+  /// flops/s
+  /// \param permute_rates The permute rates of the square tiles of \c sizes ,
+  /// in bytes/s
+  /// \param task_overhead The time to submit and run a task, in s
+  /// \param latency The latency of a message, in s
+  /// \param bandwidth The bandwidth of messages, in bytes/s
+  KernelProfile(std::vector<size_type> sizes, std::vector<double> gemm_rates,
+                std::vector<double> permute_rates, const double task_overhead,
+                const double latency, const double bandwidth)
+      : sizes_(std::move(sizes)),
+        gemm_rates_(std::move(gemm_rates)),
+        permute_rates_(std::move(permute_rates)),
+        task_overhead_(task_overhead),
+        latency_(latency),
+        bandwidth_(bandwidth) {
+    TA_ASSERT(!sizes_.empty());
+    TA_ASSERT(std::is_sorted(sizes_.begin(), sizes_.end()));
+    TA_ASSERT(sizes_.front() > 0ul);
+    TA_ASSERT(gemm_rates_.size() == sizes_.size());
+    TA_ASSERT(permute_rates_.size() == sizes_.size());
+    TA_ASSERT(task_overhead_ >= 0.0);
+    TA_ASSERT(latency_ >= 0.0);
+    TA_ASSERT(bandwidth_ > 0.0);
+  }
+
+  /// \return The tile sizes that are benchmarked by default
+  static std::vector<size_type> default_sizes() {
+    return {8ul, 16ul, 32ul, 64ul, 128ul, 256ul, 512ul};
+  }
+
+  /// Benchmark the kernels
+
+  /// This function is collective. The rates are reduced to the slowest
+  /// process, so that every process holds the same profile.
+  /// \param world The world whose processes are benchmarked
+  /// \param sizes The tile sizes to benchmark, in increasing order
+  /// \return The profile of \c world
+  static KernelProfile measure(World& world,
+                               std::vector<size_type> sizes = default_sizes()) {
+    TA_ASSERT(!sizes.empty());
+    const Permutation transpose{1, 0};
+    std::vector<double> gemm_rates, permute_rates;
+    for (const size_type size : sizes) {
+      const Tensor<double> a(Range(size, size), 1.0);
+      Tensor<double> c(Range(size, size));
+      const math::blas::integer n = size;
+      const double gemm_time = time_kernel([&]() {
+        math::blas::gemm(math::blas::NoTranspose, math::blas::NoTranspose, n,
+                         n, n, 1.0, a.data(), n, a.data(), n, 0.0, c.data(),
+                         n);
+      });
+      const double permute_time =
+          time_kernel([&]() { c = a.permute(transpose); });
+      const double volume = double(size) * double(size);
+      gemm_rates.push_back(2.0 * volume * double(size) / gemm_time);
+      permute_rates.push_back(volume * sizeof(double) / permute_time);
+    }
+
+    // The overhead of tasks that do no work
+    constexpr std::size_t ntasks = 1024ul;
+    std::vector<madness::Future<int>> tasks;
+    tasks.reserve(ntasks);
+    const auto t0 = TiledArray::now();
+    for (std::size_t i = 0ul; i < ntasks; ++i)
+      tasks.push_back(world.taskq.add([]() { return 0; }));
+    for (auto& task : tasks) task.get();
+    const double task_overhead =
+        TiledArray::duration_in_s(t0, TiledArray::now()) / double(ntasks);
+
+    // The latency and bandwidth of broadcasts, which are repeated the same
+    // number of times by every process
+    double latency = 0.0, bandwidth = std::numeric_limits<double>::max();
+    if (world.size() > 1) {
+      constexpr std::size_t nbytes = 1ul << 20, nrepeats = 16ul;
+      std::vector<char> buffer(nbytes, 0);
+      auto time_broadcast = [&](const std::size_t bytes) {
+        world.gop.fence();
+        const auto start = TiledArray::now();
+        for (std::size_t i = 0ul; i < nrepeats; ++i)
+          world.gop.broadcast(buffer.data(), bytes, 0);
+        return TiledArray::duration_in_s(start, TiledArray::now()) /
+               double(nrepeats);
+      };
+      latency = time_broadcast(1ul);
+      const double message_time = time_broadcast(nbytes);
+      bandwidth = double(nbytes) /
+                  std::max(message_time - latency, message_time * 1.0e-3);
+    }
+
+    world.gop.min(gemm_rates.data(), gemm_rates.size());
+    world.gop.min(permute_rates.data(), permute_rates.size());
+    double costs[2] = {task_overhead, latency};
+    world.gop.max(costs, 2ul);
+    world.gop.min(&bandwidth, 1ul);
+    return KernelProfile(std::move(sizes), std::move(gemm_rates),
+                         std::move(permute_rates), costs[0], costs[1],
+                         bandwidth);
+  }
+
+  /// The cached profile of a world
+
+  /// The profile is measured by the first call for \c world , or by any call
+  /// with \c remeasure set; in that case this function is collective.
+  /// \param world The world whose processes are benchmarked
+  /// \param remeasure If \c true the cached profile is replaced
+  /// \return The profile of \c world
+  static const KernelProfile& get(World& world, const bool remeasure = false) {
+    static std::mutex mutex;
+    static std::map<unsigned long, KernelProfile> cache;
+    if (!remeasure) {
+      std::lock_guard<std::mutex> lock(mutex);
+      const auto it = cache.find(world.id());
+      if (it != cache.end()) return it->second;
+    }
+
+    // measure() is collective, so it must not run while holding the lock
+    KernelProfile profile = measure(world);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(world.id());
+    if (it == cache.end())
+      it = cache.emplace(world.id(), std::move(profile)).first;
+    else if (remeasure)
+      it->second = std::move(profile);
+    return it->second;
+  }
+
+  /// \return The measured tile sizes
+  const std::vector<size_type>& sizes() const { return sizes_; }
+
+  /// \param size A tile size
+  /// \return The GEMM rate of square tiles of size \c size , in flops/s
+  double gemm_rate(const double size) const {
+    return interpolate(gemm_rates_, size);
+  }
+
+  /// \param size A tile size
+  /// \return The permute rate of square tiles of size \c size , in bytes/s
+  double permute_rate(const double size) const {
+    return interpolate(permute_rates_, size);
+  }
+
+  /// \return The time to submit and run a task, in s
+  double task_overhead() const { return task_overhead_; }
+
+  /// \return The latency of a message, in s
+  double latency() const { return latency_; }
+
+  /// \return The bandwidth of messages, in bytes/s
+  double bandwidth() const { return bandwidth_; }
+
+  /// \param m The number of rows of the result
+  /// \param n The number of columns of the result
+  /// \param k The size of the contracted dimension
+  /// \return The time of a GEMM, in s
+  double gemm_time(const double m, const double n, const double k) const {
+    return 2.0 * m * n * k / gemm_rate(std::cbrt(m * n * k));
+  }
+
+  /// \param volume The number of elements of a tile
+  /// \return The time to permute a tile, in s
+  double permute_time(const double volume) const {
+    return volume * sizeof(double) / permute_rate(std::sqrt(volume));
+  }
+
+  /// \param bytes The size of a message
+  /// \return The time to send a message, in s
+  double message_time(const double bytes) const {
+    return latency_ + bytes / bandwidth_;
+  }
+};  // class KernelProfile
+
+inline std::ostream& operator<<(std::ostream& os,
+                                const KernelProfile& profile) {
+  os << "KernelProfile: task overhead " << profile.task_overhead()
+     << " s, message latency " << profile.latency() << " s, bandwidth "
+     << profile.bandwidth() << " bytes/s\n";
+  for (const auto size : profile.sizes())
+    os << "  tile size " << size << ": gemm " << profile.gemm_rate(size)
+       << " flops/s, permute " << profile.permute_rate(size) << " bytes/s\n";
+  return os;
+}
+
+/// Selects tilings from a model of the time of a tensor contraction
+
+/// The time of a contraction of two matrices, whose dimensions have the same
+/// extent and tiling, is modeled from a KernelProfile. Smaller tiles expose
+/// more tasks to the workers (the threads of all processes) but lower the
+/// GEMM rate and add task overhead and messages; larger tiles leave workers
+/// idle. A fraction of nonzero tiles below 1 removes tasks, hence sparse
+/// arrays favor smaller tiles. The tiling that minimizes the modeled time is
+/// recommended.
+class TileSizeAdvisor {
+ public:
+  typedef std::size_t size_type;  ///< Size type
+
+  /// The largest number of tiles that is considered for a dimension
+  static constexpr size_type max_tiles = 4096ul;
+
+ private:
+  KernelProfile profile_;  ///< The kernel performance
+  size_type nprocs_;       ///< The number of processes
+  size_type nthreads_;     ///< The number of threads per process
+  double density_;         ///< The fraction of nonzero tiles
+
+ public:
+  /// \param profile The kernel performance
+  /// \param nprocs The number of processes
+  /// \param nthreads The number of threads per process
+  /// \param density The fraction of nonzero tiles of the arguments
+  TileSizeAdvisor(const KernelProfile& profile, const size_type nprocs,
+                  const size_type nthreads, const double density = 1.0)
+      : profile_(profile),
+        nprocs_(nprocs),
+        nthreads_(nthreads),
+        density_(density) {
+    TA_ASSERT(nprocs_ > 0ul);
+    TA_ASSERT(nthreads_ > 0ul);
+    TA_ASSERT(density_ > 0.0 && density_ <= 1.0);
+  }
+
+  /// Construct an advisor from the cached profile of a world
+
+  /// This constructor is collective if the profile of \c world has not been
+  /// measured.
+  /// \param world The world in which the arrays are distributed
+  /// \param density The fraction of nonzero tiles of the arguments
+  explicit TileSizeAdvisor(World& world, const double density = 1.0)
+      : TileSizeAdvisor(KernelProfile::get(world), world.size(),
+                        madness::ThreadPool::size() + 1ul, density) {}
+
+  /// \return The kernel performance
+  const KernelProfile& profile() const { return profile_; }
+
+  /// Modeled time of a contraction
+
+  /// \param extent The extent of each dimension
+  /// \param ntiles The number of tiles of each dimension
+  /// \return The modeled time of the contraction, in s
+  double cost(const size_type extent, const size_type ntiles) const {
+    TA_ASSERT(ntiles > 0ul && ntiles <= extent);
+    const double n = ntiles;
+    const double size = double(extent) / n;
+    const double volume = size * size;
+    const double workers = double(nprocs_) * double(nthreads_);
+    const double overhead = profile_.task_overhead();
+
+    // The products of nonzero tiles are distributed to the workers
+    const double tasks = std::max(1.0, n * n * n * density_ * density_);
+    const double compute =
+        std::ceil(tasks / workers) *
+        (profile_.gemm_time(size, size, size) + overhead);
+
+    // The arguments are permuted to, and the result from, the GEMM layout
+    const double permutes = std::max(1.0, 3.0 * n * n * density_);
+    const double permute = std::ceil(permutes / workers) *
+                           (profile_.permute_time(volume) + overhead);
+
+    // Each process receives a row of left and a column of right tiles per
+    // step of SUMMA, which overlaps with the computation
+    double communication = 0.0;
+    if (nprocs_ > 1ul)
+      communication = 2.0 * n * n * density_ / std::sqrt(double(nprocs_)) *
+                      profile_.message_time(volume * sizeof(double));
+
+    return std::max(compute, communication) + permute;
+  }
+
+  /// Number of tiles of a dimension
+
+  /// \param extent The extent of the dimension
+  /// \return The number of tiles that minimizes the modeled time
+  size_type tile_count(const size_type extent) const {
+    TA_ASSERT(extent > 0ul);
+    size_type result = 1ul;
+    double min_cost = cost(extent, 1ul);
+    const size_type last = std::min(extent, max_tiles);
+    for (size_type ntiles = 2ul; ntiles <= last; ++ntiles) {
+      const double ntiles_cost = cost(extent, ntiles);
+      if (ntiles_cost < min_cost) {
+        min_cost = ntiles_cost;
+        result = ntiles;
+      }
+    }
+    return result;
+  }
+
+  /// Tiling of a dimension
+
+  /// \param extent The extent of the dimension
+  /// \param first The first index of the dimension
+  /// \return A tiling of <tt>[first, first + extent)</tt> with
+  /// tile_count(extent) tiles, whose sizes differ by at most 1
+  TiledRange1 make_tiling(const size_type extent,
+                          const size_type first = 0ul) const {
+    return make_uniform_tiling(extent, tile_count(extent), first);
+  }
+
+  /// Uniform tiling of a dimension
+
+  /// \param extent The extent of the dimension
+  /// \param ntiles The number of tiles
+  /// \param first The first index of the dimension
+  /// \return A tiling of <tt>[first, first + extent)</tt> with \c ntiles
+  /// tiles, whose sizes differ by at most 1
+  static TiledRange1 make_uniform_tiling(const size_type extent,
+                                         const size_type ntiles,
+                                         const size_type first = 0ul) {
+    TA_ASSERT(ntiles > 0ul && ntiles <= extent);
+    std::vector<size_type> hashmarks;
+    hashmarks.reserve(ntiles + 1ul);
+    hashmarks.push_back(first);
+    const size_type size = extent / ntiles, remainder = extent % ntiles;
+    for (size_type t = 0ul; t < ntiles; ++t)
+      hashmarks.push_back(hashmarks.back() + size +
+                          (t < remainder ? 1ul : 0ul));
+    return TiledRange1(hashmarks.begin(), hashmarks.end());
+  }
+};  // class TileSizeAdvisor
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_TILE_SIZE_H__INCLUDED
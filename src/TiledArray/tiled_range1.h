@@ -24,8 +24,8 @@
 #include <TiledArray/type_traits.h>
 #include <TiledArray/utility.h>
 #include <cassert>
+#include <algorithm>
 #include <initializer_list>
-#include <mutex>
 #include <vector>
 
 // Forward declaration of MADNESS archive type traits
@@ -64,7 +64,7 @@ class TiledRange1 {
   ///   assert(tr.begin() == tr.end());
   /// \endcode
   TiledRange1()
-      : range_(0, 0), elements_range_(0, 0), tiles_ranges_(), elem2tile_() {}
+      : range_(0, 0), elements_range_(0, 0), tiles_ranges_() {}
 
   /// Constructs a range with the boundaries provided by
   /// the range [ \p first , \p last ).
@@ -74,7 +74,7 @@ class TiledRange1 {
             typename std::enable_if<
                 detail::is_random_iterator<RandIter>::value>::type* = nullptr>
   explicit TiledRange1(RandIter first, RandIter last)
-      : range_(), elements_range_(), tiles_ranges_(), elem2tile_() {
+      : range_(), elements_range_(), tiles_ranges_() {
     init_tiles_(first, last, 0);
   }
 
@@ -186,21 +186,47 @@ class TiledRange1 {
   /// \code
   /// assert(i >= elements_range().first && i < elements_range().second);
   /// \endcode
-  /// \note element->tile map is memoized, thus complexity of the first call is
-  /// linear in the number of elements,
-  ///       complexity of subsequent calls is constant. Note that the
-  ///       memoization assumes infrequent (or serial) use as it is serialized
-  ///       across ALL TiledRange1 instances.
-  const index1_type& element_to_tile(const index1_type& i) const {
+  /// \note complexity is constant if the tiling is uniform (all tiles, except
+  /// possibly the last, have the same extent), otherwise logarithmic in the
+  /// number of tiles; no per-element data is stored.
+  index1_type element_to_tile(const index1_type& i) const {
     TA_ASSERT(includes(elements_range_, i));
-    if (elem2tile_.empty()) {
-      init_elem2tile_();
+    if (uniform_tile_extent_ != 0)
+      return range_.first + (i - elements_range_.first) / uniform_tile_extent_;
+    return range_.first + (find_tile_(i) - tiles_ranges_.begin());
+  }
+
+  /// Maps a sequence of element indices to tile indices
+
+  /// This is more efficient than mapping the elements one by one when
+  /// consecutive elements often belong to the same tile, e.g. when the
+  /// elements are sorted: the tile of the previous element is checked first.
+  /// \tparam InIter An input iterator type, with values convertible to
+  /// \c index1_type
+  /// \tparam OutIter An output iterator type, accepting \c index1_type values
+  /// \param first the beginning of the element index sequence
+  /// \param last the end of the element index sequence
+  /// \param result the beginning of the tile index sequence
+  /// \return the end of the tile index sequence
+  template <typename InIter, typename OutIter>
+  OutIter element_to_tile(InIter first, InIter last, OutIter result) const {
+    if (uniform_tile_extent_ != 0) {
+      for (; first != last; ++first, ++result)
+        *result = element_to_tile(*first);
+      return result;
     }
-    return elem2tile_[i - elements_range_.first];
+    auto tile_it = tiles_ranges_.begin();
+    for (; first != last; ++first, ++result) {
+      const index1_type i = *first;
+      TA_ASSERT(includes(elements_range_, i));
+      if (!includes(*tile_it, i)) tile_it = find_tile_(i);
+      *result = range_.first + (tile_it - tiles_ranges_.begin());
+    }
+    return result;
   }
 
   /// \deprecated use TiledRange1::element_to_tile()
-  [[deprecated]] const index1_type& element2tile(const index1_type& i) const {
+  [[deprecated]] index1_type element2tile(const index1_type& i) const {
     return element_to_tile(i);
   }
 
@@ -212,21 +238,22 @@ class TiledRange1 {
     std::swap(range_, other.range_);
     std::swap(elements_range_, other.elements_range_);
     std::swap(tiles_ranges_, other.tiles_ranges_);
-    std::swap(elem2tile_, other.elem2tile_);
+    std::swap(uniform_tile_extent_, other.uniform_tile_extent_);
   }
 
   template <typename Archive,
             typename std::enable_if<madness::archive::is_input_archive<
                 Archive>::value>::type* = nullptr>
   void serialize(const Archive& ar) {
-    ar& range_& elements_range_& tiles_ranges_& elem2tile_;
+    ar& range_& elements_range_& tiles_ranges_;
+    init_uniform_tile_extent_();
   }
 
   template <typename Archive,
             typename std::enable_if<madness::archive::is_output_archive<
                 Archive>::value>::type* = nullptr>
   void serialize(const Archive& ar) const {
-    ar& range_& elements_range_& tiles_ranges_& elem2tile_;
+    ar& range_& elements_range_& tiles_ranges_;
   }
 
  private:
@@ -268,26 +295,34 @@ class TiledRange1 {
     elements_range_.second = *(last - 1);
     for (; first != (last - 1); ++first)
       tiles_ranges_.emplace_back(*first, *(first + 1));
+    init_uniform_tile_extent_();
   }
 
-  /// Initialize elem2tile
-  void init_elem2tile_() const {
-    // check for 0 size range.
-    if ((elements_range_.second - elements_range_.first) == 0) return;
-
-    static std::mutex mtx;
-    {
-      std::lock_guard<std::mutex> lock(mtx);
-      if (elem2tile_.empty()) {
-        // initialize elem2tile map
-        elem2tile_.resize(elements_range_.second - elements_range_.first);
-        const auto end = range_.second - range_.first;
-        for (index1_type t = 0; t < end; ++t)
-          for (index1_type e = tiles_ranges_[t].first;
-               e < tiles_ranges_[t].second; ++e)
-            elem2tile_[e - elements_range_.first] = t + range_.first;
-      }
-    }
+  /// Detects uniform tilings
+
+  /// Sets \c uniform_tile_extent_ to the extent of the tiles if all tiles,
+  /// except possibly the last one, have the same extent, and the last tile is
+  /// not larger than the others; otherwise sets it to 0.
+  void init_uniform_tile_extent_() {
+    uniform_tile_extent_ = 0;
+    if (tiles_ranges_.empty()) return;
+    const index1_type extent =
+        tiles_ranges_.front().second - tiles_ranges_.front().first;
+    const auto last = tiles_ranges_.end() - 1;
+    for (auto it = tiles_ranges_.begin(); it != last; ++it)
+      if (it->second - it->first != extent) return;
+    if (last->second - last->first > extent) return;
+    uniform_tile_extent_ = extent;
+  }
+
+  /// \return the iterator to the tile that includes element \p i
+  const_iterator find_tile_(const index1_type i) const {
+    // the first tile whose lower bound is greater than i follows the result
+    return std::upper_bound(tiles_ranges_.begin(), tiles_ranges_.end(), i,
+                            [](const index1_type e, const range_type& tile) {
+                              return e < tile.first;
+                            }) -
+           1;
   }
 
   friend std::ostream& operator<<(std::ostream&, const TiledRange1&);
@@ -297,8 +332,8 @@ class TiledRange1 {
   range_type elements_range_;  ///< the range of element indices
   std::vector<range_type>
       tiles_ranges_;  ///< ranges of each tile (NO GAPS between tiles)
-  mutable std::vector<index1_type>
-      elem2tile_;  ///< maps element index to tile index (memoized data).
+  index1_type uniform_tile_extent_ =
+      0;  ///< the extent of the tiles if the tiling is uniform, 0 otherwise
 
 };  // class TiledRange1
 
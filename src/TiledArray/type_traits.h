@@ -327,6 +327,7 @@ GENERATE_HAS_MEMBER_FUNCTION(empty)
 GENERATE_HAS_MEMBER_FUNCTION_ANYRETURN(clear)
 GENERATE_HAS_MEMBER_FUNCTION(clear)
 GENERATE_HAS_MEMBER_FUNCTION_ANYRETURN(resize)
+GENERATE_HAS_MEMBER_FUNCTION(is_shared)
 
 GENERATE_HAS_MEMBER_FUNCTION_ANYRETURN(begin)
 GENERATE_HAS_MEMBER_FUNCTION(begin)
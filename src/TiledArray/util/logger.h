@@ -54,6 +54,9 @@ struct TileOpsLogger : public Singleton<TileOpsLogger<T>> {
   bool gemm_print_contributions = false;
   gemm_printer_t gemm_printer;
 
+  // report the tiles cloned by each expression
+  bool clone_report = false;
+
   // logging
   std::ostream* log = &std::cout;
 
@@ -73,6 +76,7 @@ struct TileOpsLogger : public Singleton<TileOpsLogger<T>> {
   TileOpsLogger(int log_level = TA_TILE_OPS_LOG_LEVEL) {
     if (log_level > 0) {
       gemm = true;
+      clone_report = true;
     }
   }
 };
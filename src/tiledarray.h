@@ -37,15 +37,19 @@
 #include <TiledArray/conversions/dense_to_sparse.h>
 #include <TiledArray/conversions/foreach.h>
 #include <TiledArray/conversions/make_array.h>
+#include <TiledArray/conversions/precision.h>
 #include <TiledArray/conversions/retile.h>
 #include <TiledArray/conversions/sparse_to_dense.h>
 #include <TiledArray/conversions/to_new_tile_type.h>
 #include <TiledArray/conversions/truncate.h>
+#include <TiledArray/expressions/contraction_path.h>
+#include <TiledArray/expressions/reduction_batch.h>
 #include <TiledArray/expressions/scal_expr.h>
 #include <TiledArray/expressions/tsr_expr.h>
 
 // Special Arrays
 #include <TiledArray/special/diagonal_array.h>
+#include <TiledArray/symm/symmetric_array.h>
 
 // Process maps
 #include <TiledArray/pmap/hash_pmap.h>
@@ -53,6 +57,7 @@
 
 // Utility functionality
 #include <TiledArray/conversions/eigen.h>
+#include <TiledArray/tile_size.h>
 
 // Linear algebra
 #include <TiledArray/math/linalg.h>
@@ -42,6 +42,7 @@ class TiledRange;
 // TiledArray Policy
 class DensePolicy;
 class SparsePolicy;
+class CompressedSparsePolicy;
 
 // TiledArray Tensors
 template <typename, typename>
@@ -0,0 +1,216 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/compressed_sparse_shape.h"
+#include "sparse_shape_fixture.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct CompressedSparseShapeFixture : public SparseShapeFixture {
+  CompressedSparseShapeFixture()
+      : c_sparse_shape(sparse_shape, tr),
+        c_left(left, tr),
+        c_right(right, tr) {}
+
+  /// checks that \p result has the same norms as \p reference
+
+  /// \param tol the relative tolerance, in percent; reordering of the
+  /// floating-point operations can cause differences of a few ulps
+  void check(const CompressedSparseShape<float>& result,
+             const SparseShape<float>& reference,
+             const float tol = 0.001) const {
+    BOOST_REQUIRE(result.validate(reference.data().range()));
+    const auto volume = reference.data().range().volume();
+    std::size_t nnz = 0;
+    for (std::size_t i = 0ul; i < volume; ++i) {
+      BOOST_CHECK_CLOSE(result[i], reference[i], tol);
+      BOOST_CHECK_EQUAL(result.is_zero(i), reference.is_zero(i));
+      if (!reference.is_zero(i)) ++nnz;
+    }
+    BOOST_CHECK_EQUAL(result.nnz(), nnz);
+    BOOST_CHECK(std::is_sorted(result.ordinals().begin(),
+                               result.ordinals().end()));
+  }
+
+  CompressedSparseShape<float> c_sparse_shape;
+  CompressedSparseShape<float> c_left;
+  CompressedSparseShape<float> c_right;
+};  // CompressedSparseShapeFixture
+
+BOOST_FIXTURE_TEST_SUITE(compressed_sparse_shape_suite,
+                         CompressedSparseShapeFixture)
+
+BOOST_AUTO_TEST_CASE(default_constructor) {
+  CompressedSparseShape<float> x;
+  BOOST_CHECK(x.empty());
+  BOOST_CHECK(!x.is_dense());
+  BOOST_CHECK(!x.validate(tr.tiles_range()));
+  BOOST_CHECK_THROW(x.nnz(), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(constructors) {
+  check(c_sparse_shape, sparse_shape);
+  BOOST_CHECK_CLOSE(c_sparse_shape.sparsity(), sparse_shape.sparsity(),
+                    tolerance);
+
+  // dense norm tensor
+  Tensor<float> tile_norms = make_norm_tensor(tr, 0.5, 42);
+  check(CompressedSparseShape<float>(tile_norms, tr),
+        SparseShape<float>(tile_norms, tr));
+
+  // sparse norm sequence
+  std::vector<std::pair<Range::index, float>> sparse_tile_norms;
+  for (std::size_t i = 0ul; i < tile_norms.size(); ++i)
+    if (tile_norms[i] > 0.0f)
+      sparse_tile_norms.emplace_back(tr.tiles_range().idx(i), tile_norms[i]);
+  check(CompressedSparseShape<float>(sparse_tile_norms, tr),
+        SparseShape<float>(tile_norms, tr));
+
+  // collective sparse norm sequence, each rank provides its local tiles
+  TiledArray::detail::BlockedPmap pmap(*GlobalFixture::world,
+                                       tr.tiles_range().volume());
+  std::vector<std::pair<std::size_t, float>> local_tile_norms;
+  for (std::size_t i = 0ul; i < tile_norms.size(); ++i)
+    if (pmap.is_local(i)) local_tile_norms.emplace_back(i, tile_norms[i]);
+  CompressedSparseShape<float> x(*GlobalFixture::world, local_tile_norms, tr);
+  check(x, SparseShape<float>(tile_norms, tr));
+  BOOST_CHECK(is_replicated(*GlobalFixture::world, x));
+}
+
+BOOST_AUTO_TEST_CASE(data) {
+  BOOST_CHECK(c_sparse_shape.data() == sparse_shape.data());
+  const auto tile_norms = c_sparse_shape.tile_norms();
+  for (std::size_t i = 0ul; i < tile_norms.size(); ++i)
+    BOOST_CHECK_CLOSE(tile_norms[i], sparse_shape.tile_norms()[i], tolerance);
+}
+
+BOOST_AUTO_TEST_CASE(permute) {
+  check(c_sparse_shape.perm(perm), sparse_shape.perm(perm));
+}
+
+BOOST_AUTO_TEST_CASE(scale) {
+  check(c_sparse_shape.scale(-4.1), sparse_shape.scale(-4.1));
+  check(c_sparse_shape.scale(-4.1, perm), sparse_shape.scale(-4.1, perm));
+  check(c_sparse_shape.scale(1e-6), sparse_shape.scale(1e-6));
+}
+
+BOOST_AUTO_TEST_CASE(block) {
+  auto less = std::less<std::size_t>();
+  for (auto lower_it = tr.tiles_range().begin();
+       lower_it != tr.tiles_range().end(); ++lower_it) {
+    const auto& lower = *lower_it;
+    for (auto upper_it = tr.tiles_range().begin();
+         upper_it != tr.tiles_range().end(); ++upper_it) {
+      auto upper = *upper_it;
+      for (auto it = upper.begin(); it != upper.end(); ++it) *it += 1;
+      if (!std::equal(lower.begin(), lower.end(), upper.begin(), less))
+        continue;
+
+      check(c_sparse_shape.block(lower, upper),
+            sparse_shape.block(lower, upper));
+      check(c_sparse_shape.block(lower, upper, -2.2, perm),
+            sparse_shape.block(lower, upper, -2.2, perm));
+
+      // update the block of the shape with the block of another
+      check(c_sparse_shape.update_block(lower, upper,
+                                        c_left.block(lower, upper)),
+            sparse_shape.update_block(lower, upper,
+                                      left.block(lower, upper)));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(mask) {
+  check(c_sparse_shape.mask(c_left), sparse_shape.mask(left));
+}
+
+BOOST_AUTO_TEST_CASE(add) {
+  check(c_left.add(c_right), left.add(right));
+  check(c_left.add(c_right, -2.2), left.add(right, -2.2));
+  check(c_left.add(c_right, perm), left.add(right, perm));
+  check(c_left.add(c_right, -2.2, perm), left.add(right, -2.2, perm));
+  check(c_left.add(-8.8), left.add(-8.8));
+  check(c_left.subt(c_right), left.subt(right));
+}
+
+BOOST_AUTO_TEST_CASE(mult) {
+  check(c_left.mult(c_right), left.mult(right));
+  check(c_left.mult(c_right, -2.2), left.mult(right, -2.2));
+  check(c_left.mult(c_right, -2.2, perm), left.mult(right, -2.2, perm));
+}
+
+BOOST_AUTO_TEST_CASE(gemm) {
+  math::GemmHelper gemm_helper(
+      TiledArray::math::blas::Op::NoTrans, TiledArray::math::blas::Op::NoTrans,
+      2u, left.data().range().rank(), right.data().range().rank());
+  check(c_left.gemm(c_right, -7.2, gemm_helper),
+        left.gemm(right, -7.2, gemm_helper));
+
+  // outer product
+  math::GemmHelper outer_gemm_helper(
+      TiledArray::math::blas::Op::NoTrans, TiledArray::math::blas::Op::NoTrans,
+      2u * left.data().range().rank(), left.data().range().rank(),
+      right.data().range().rank());
+  check(c_left.gemm(c_right, 1.5, outer_gemm_helper),
+        left.gemm(right, 1.5, outer_gemm_helper));
+
+  // permuted result
+  const Permutation perm2({1, 0});
+  check(c_left.gemm(c_right, -7.2, gemm_helper, perm2),
+        left.gemm(right, -7.2, gemm_helper, perm2));
+}
+
+BOOST_AUTO_TEST_CASE(array) {
+  // the same expression evaluated with both policies
+  typedef DistArray<Tensor<double>, SparsePolicy> array_type;
+  typedef DistArray<Tensor<double>, CompressedSparsePolicy> c_array_type;
+
+  auto fill = [](auto& array) {
+    for (auto it = array.begin(); it != array.end(); ++it) {
+      typename std::decay_t<decltype(array)>::value_type tile(
+          array.trange().make_tile_range(it.index()));
+      for (auto& x : tile) x = GlobalFixture::world->rand() % 101;
+      *it = tile;
+    }
+  };
+
+  GlobalFixture::world->srand(27);
+  array_type a(*GlobalFixture::world, tr, sparse_shape);
+  fill(a);
+  GlobalFixture::world->srand(27);
+  c_array_type c_a(*GlobalFixture::world, tr, c_sparse_shape);
+  fill(c_a);
+
+  array_type b;
+  c_array_type c_b;
+  b("a,b,c") = 2 * a("c,b,a") + a("a,b,c");
+  c_b("a,b,c") = 2 * c_a("c,b,a") + c_a("a,b,c");
+  array_type c;
+  c_array_type c_c;
+  c("a,d") = b("a,b,c") * a("d,b,c");
+  c_c("a,d") = c_b("a,b,c") * c_a("d,b,c");
+
+  check(c_c.shape(), c.shape());
+  const double norm = c("a,d").norm().get();
+  BOOST_CHECK_CLOSE(c_c("a,d").norm().get(), norm, 1e-8);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
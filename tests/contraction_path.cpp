@@ -0,0 +1,136 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <sstream>
+
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+using namespace TiledArray::expressions;
+
+struct ContractionPathFixture {
+  typedef DistArray<Tensor<double>, DensePolicy> array_type;
+
+  ContractionPathFixture()
+      : a(*GlobalFixture::world, TiledRange{tr1, tr2}),
+        b(*GlobalFixture::world, TiledRange{tr2, tr1}),
+        c(*GlobalFixture::world, TiledRange{tr1, tr3}),
+        d(*GlobalFixture::world, TiledRange{tr3, tr2}) {
+    a.fill_random();
+    b.fill_random();
+    c.fill_random();
+    d.fill_random();
+  }
+
+  /// The estimate of a dense matrix
+  static VolumeEstimate matrix(const std::string& indices,
+                               const TiledRange1& rows,
+                               const TiledRange1& cols,
+                               const double density = 1.0) {
+    return VolumeEstimate(IndexList(indices), TiledRange{rows, cols}, density,
+                          sizeof(double));
+  }
+
+  const TiledRange1 large{0, 50, 100};
+  const TiledRange1 small{0, 2};
+  const TiledRange1 tr1{0, 3, 8, 10};
+  const TiledRange1 tr2{0, 2, 5};
+  const TiledRange1 tr3{0, 4, 7, 9, 13};
+  array_type a;
+  array_type b;
+  array_type c;
+  array_type d;
+};  // ContractionPathFixture
+
+BOOST_FIXTURE_TEST_SUITE(contraction_path_suite, ContractionPathFixture)
+
+BOOST_AUTO_TEST_CASE(optimal_path) {
+  // (a * b) * c costs 80000 flops, a * (b * c) costs 1600 flops
+  const ContractionPathOptimizer path(
+      {matrix("i,j", large, small), matrix("j,k", small, large),
+       matrix("k,l", large, small)},
+      IndexList("i,l"));
+  BOOST_CHECK(path.optimal());
+  BOOST_REQUIRE_EQUAL(path.steps().size(), 2ul);
+  BOOST_CHECK(path.steps()[0] == ContractionPathOptimizer::step_type(1, 2));
+  BOOST_CHECK_EQUAL(path.step_indices()[0], IndexList("j,l"));
+  BOOST_CHECK(path.steps()[1] == ContractionPathOptimizer::step_type(0, 1));
+  BOOST_CHECK(path.step_indices()[1].is_permutation(IndexList("i,l")));
+  BOOST_CHECK_CLOSE(path.flops(), 1600.0, 1e-12);
+
+  std::stringstream report;
+  report << path;
+  BOOST_CHECK(report.str().find("optimal, 1600 flops") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(sparse_path) {
+  // if a is nearly zero, a * b is cheaper than b * c
+  const ContractionPathOptimizer path(
+      {matrix("i,j", large, small, 0.001), matrix("j,k", small, large),
+       matrix("k,l", large, small)},
+      IndexList("i,l"));
+  BOOST_CHECK(path.steps()[0] == ContractionPathOptimizer::step_type(0, 1));
+  BOOST_CHECK_CLOSE(path.flops(), 80.0, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(greedy_path) {
+  // a chain that is too long to be optimized exhaustively
+  const std::size_t n = ContractionPathOptimizer::max_optimal_operands + 2ul;
+  std::vector<VolumeEstimate> operands;
+  for (std::size_t i = 0ul; i < n; ++i)
+    operands.push_back(matrix(
+        "x" + std::to_string(i) + ",x" + std::to_string(i + 1ul),
+        (i % 2ul ? small : large), (i % 2ul ? large : small)));
+  const ContractionPathOptimizer path(
+      operands, IndexList("x0,x" + std::to_string(n)));
+  BOOST_CHECK(!path.optimal());
+  BOOST_CHECK_EQUAL(path.steps().size(), n - 1ul);
+  BOOST_CHECK(path.step_indices().back().is_permutation(
+      IndexList("x0,x" + std::to_string(n))));
+}
+
+BOOST_AUTO_TEST_CASE(invalid_path) {
+  // j is shared by three operands
+  BOOST_CHECK_THROW(
+      ContractionPathOptimizer(
+          {matrix("i,j", large, small), matrix("j,k", small, large),
+           matrix("j,l", small, large)},
+          IndexList("i,k,l")),
+      TiledArray::Exception);
+  // k is not contracted
+  BOOST_CHECK_THROW(
+      ContractionPathOptimizer(
+          {matrix("i,j", large, small), matrix("j,k", small, large)},
+          IndexList("i")),
+      TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(einsum_product) {
+  array_type ref, result;
+  ref("i,m") = a("i,j") * b("j,k") * c("k,l") * d("l,m");
+
+  einsum(result("i,m"), a("i,j") * b("j,k") * c("k,l") * d("l,m"));
+  BOOST_CHECK_SMALL((result("i,m") - ref("i,m")).norm().get(), 1e-8);
+
+  einsum(result("m,i"), 2 * a("i,j"), b("j,k"), c("k,l"), d("l,m"));
+  BOOST_CHECK_SMALL((result("i,m") - 2 * ref("i,m")).norm().get(), 1e-8);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -529,6 +529,22 @@ BOOST_AUTO_TEST_CASE(make_replicated) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(make_replicated_chunked) {
+  std::shared_ptr<ArrayN::pmap_interface> distributed_pmap = a.pmap();
+
+  // broadcast each tile in its own chunk
+  BOOST_REQUIRE_NO_THROW(a.make_replicated(1ul));
+  GlobalFixture::world->gop.fence();
+
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    BOOST_CHECK(a.is_local(i));
+    const auto tile = a.find(i).get();
+    BOOST_CHECK_EQUAL(tile.range(), a.trange().make_tile_range(i));
+    for (const auto& x : tile)
+      BOOST_CHECK_EQUAL(x, distributed_pmap->owner(i) + 1);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(serialization_by_tile) {
   decltype(a) acopy(a.world(), a.trange(), a.shape());
 
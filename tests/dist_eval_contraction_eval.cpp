@@ -472,4 +472,126 @@ BOOST_AUTO_TEST_CASE(sparse_eval) {
   do_sparse_eval(true);
 }
 
+BOOST_AUTO_TEST_CASE(sparse_screen) {
+  typedef TSpArrayD::value_type tile_type;
+  typedef UnaryWrapper<Noop<tile_type, tile_type, true>> noop_type;
+  typedef ContractReduce<tile_type, tile_type, tile_type, double> op_type;
+
+  // A[0][1] and B[1][*] are non-zero, but the contributions of A[0][1] to
+  // the result are below the screening threshold
+  const TiledRange1 tr1{0, 3, 8};
+  const TiledRange trange{tr1, tr1};
+  auto make_matrix = [&](const bool is_left) {
+    return make_array<TSpArrayD>(
+        *GlobalFixture::world, trange,
+        [=](tile_type& tile, const Range& range) -> float {
+          const bool small =
+              (is_left ? (range.lobound(0) == 0ul && range.lobound(1) != 0ul)
+                       : (range.lobound(0) != 0ul));
+          tile = tile_type(range, (small ? 0.01 : 1.0));
+          return tile.norm();
+        });
+  };
+  const float threshold = SparseShape<float>::threshold();
+  SparseShape<float>::threshold(0.001);
+  TSpArrayD left = make_matrix(true);
+  TSpArrayD right = make_matrix(false);
+
+  detail::ProcGrid grid(*GlobalFixture::world, 2ul, 2ul, 8ul, 8ul);
+  auto left_arg =
+      make_array_eval(left, left.world(), left.shape(),
+                      grid.make_row_phase_pmap(2ul), Permutation(),
+                      noop_type(Noop<tile_type, tile_type, true>()));
+  auto right_arg =
+      make_array_eval(right, right.world(), right.shape(),
+                      grid.make_col_phase_pmap(2ul), Permutation(),
+                      noop_type(Noop<tile_type, tile_type, true>()));
+  const op_type op(TiledArray::math::blas::Op::NoTrans,
+                   TiledArray::math::blas::Op::NoTrans, 1.0, 2u, 2u, 2u);
+  const SparseShape<float> result_shape =
+      left_arg.shape().gemm(right_arg.shape(), 1, op.gemm_helper());
+  BOOST_REQUIRE(!left_arg.shape().is_zero(1ul));
+
+  auto contract = make_contract_eval(
+      left_arg, right_arg, left_arg.world(), result_shape,
+      std::make_shared<detail::BlockedPmap>(*GlobalFixture::world, 4ul),
+      Permutation(), op);
+  BOOST_REQUIRE_NO_THROW(contract.eval());
+  BOOST_REQUIRE_NO_THROW(contract.wait());
+
+  // C[0][*] does not include the contribution of A[0][1]
+  for (auto index : *contract.pmap()) {
+    BOOST_REQUIRE(!contract.is_zero(index));
+    const tile_type tile = contract.get(index).get();
+    const double expected = (tile.range().lobound(0) == 0ul ? 3.0 : 3.05);
+    for (const double value : tile) BOOST_CHECK_CLOSE(value, expected, 1e-10);
+  }
+
+  SparseShape<float>::threshold(threshold);
+}
+
+BOOST_AUTO_TEST_CASE(sparse_screen_keeps_largest_contribution) {
+  typedef TSpArrayD::value_type tile_type;
+  typedef UnaryWrapper<Noop<tile_type, tile_type, true>> noop_type;
+  typedef ContractReduce<tile_type, tile_type, tile_type, double> op_type;
+
+  // All the contributions of A[0][*] are below the screening threshold, but
+  // C[0][*] is non-zero in the result shape
+  const TiledRange1 tr1{0, 3, 8};
+  const TiledRange trange{tr1, tr1};
+  TSpArrayD left = make_array<TSpArrayD>(
+      *GlobalFixture::world, trange,
+      [](tile_type& tile, const Range& range) -> float {
+        const double value =
+            (range.lobound(0) != 0ul ? 1.0
+                                     : (range.lobound(1) == 0ul ? 1e-4 : 2e-4));
+        tile = tile_type(range, value);
+        return tile.norm();
+      });
+  TSpArrayD right = make_array<TSpArrayD>(
+      *GlobalFixture::world, trange,
+      [](tile_type& tile, const Range& range) -> float {
+        tile = tile_type(range, 1.0);
+        return tile.norm();
+      });
+
+  // Raise the threshold after the argument shapes are constructed, so the
+  // small tiles of A are not zero
+  const float threshold = SparseShape<float>::threshold();
+  SparseShape<float>::threshold(0.001);
+
+  detail::ProcGrid grid(*GlobalFixture::world, 2ul, 2ul, 8ul, 8ul);
+  auto left_arg =
+      make_array_eval(left, left.world(), left.shape(),
+                      grid.make_row_phase_pmap(2ul), Permutation(),
+                      noop_type(Noop<tile_type, tile_type, true>()));
+  auto right_arg =
+      make_array_eval(right, right.world(), right.shape(),
+                      grid.make_col_phase_pmap(2ul), Permutation(),
+                      noop_type(Noop<tile_type, tile_type, true>()));
+  const op_type op(TiledArray::math::blas::Op::NoTrans,
+                   TiledArray::math::blas::Op::NoTrans, 1.0, 2u, 2u, 2u);
+  const SparseShape<float> result_shape(1.0f, trange);
+  BOOST_REQUIRE(!left_arg.shape().is_zero(0ul));
+  BOOST_REQUIRE(!left_arg.shape().is_zero(1ul));
+
+  auto contract = make_contract_eval(
+      left_arg, right_arg, left_arg.world(), result_shape,
+      std::make_shared<detail::BlockedPmap>(*GlobalFixture::world, 4ul),
+      Permutation(), op);
+  BOOST_REQUIRE_NO_THROW(contract.eval());
+  BOOST_REQUIRE_NO_THROW(contract.wait());
+
+  // C[0][*] only includes the largest contribution, A[0][1] * B[1][*]
+  for (auto index : *contract.pmap()) {
+    BOOST_REQUIRE(!contract.is_zero(index));
+    const tile_type tile = contract.get(index).get();
+    BOOST_REQUIRE(!tile.empty());
+    const double expected = (tile.range().lobound(0) == 0ul ? 1e-3 : 8.0);
+    for (const double value : tile) BOOST_CHECK_CLOSE(value, expected, 1e-10);
+  }
+
+  SparseShape<float>::threshold(threshold);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -101,4 +101,28 @@ BOOST_AUTO_TEST_CASE(array_operator) {
   BOOST_CHECK_THROW(t.get(t.max_size() + 2), TiledArray::Exception);
 }
 
+BOOST_AUTO_TEST_CASE(aggregated_messages) {
+  MessageAggregation::set_max_count(4);
+  MessageAggregation::reset_statistics();
+  Storage s(world, 10, pmap);
+  MessageAggregation::set_max_count(0);
+
+  // Set the elements from the next process, then get all of them
+  for (std::size_t i = 0; i < s.max_size(); ++i)
+    if (s.owner(i) == (world.rank() + 1) % world.size()) s.set(i, int(i));
+  std::vector<Future<int> > elements;
+  for (std::size_t i = 0; i < s.max_size(); ++i) elements.push_back(s.get(i));
+  world.gop.fence();
+
+  for (std::size_t i = 0; i < s.max_size(); ++i)
+    BOOST_CHECK_EQUAL(elements[i].get(), int(i));
+
+  // Each message carries at most 4 requests
+  const std::size_t messages = MessageAggregation::messages();
+  const std::size_t requests = MessageAggregation::requests();
+  BOOST_CHECK_LE(requests, 4 * messages);
+  BOOST_CHECK_EQUAL(MessageAggregation::messages_saved(), requests - messages);
+  if (world.size() == 1) BOOST_CHECK_EQUAL(requests, 0ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+using TiledArray::expressions::ExprDAG;
+
+struct ExprDAGFixture {
+  typedef DistArray<Tensor<double>, DensePolicy> array_type;
+
+  ExprDAGFixture()
+      : trange({tr1, tr1}),
+        a(*GlobalFixture::world, trange),
+        b(*GlobalFixture::world, trange) {
+    a.fill_random();
+    b.fill_random();
+  }
+
+  static double distance(const array_type& x, const array_type& y) {
+    return (x("i,j") - y("i,j")).norm().get();
+  }
+
+  const TiledRange1 tr1{0, 2, 5, 9, 10};
+  TiledRange trange;
+  array_type a;
+  array_type b;
+};  // ExprDAGFixture
+
+BOOST_FIXTURE_TEST_SUITE(expressions_dag_suite, ExprDAGFixture)
+
+BOOST_AUTO_TEST_CASE(shared_contraction) {
+  array_type c1, c2, c3;
+  ExprDAG dag;
+  dag.add(c1("i,j"), a("i,k") * b("k,j") + a("i,j"));
+  dag.add(c2("i,j"), a("i,k") * b("k,j") - b("i,j"));
+  dag.add(c3("i,j"), 2 * a("i,j") + b("j,i"));
+  BOOST_CHECK_EQUAL(dag.size(), 3ul);
+  dag.evaluate();
+  BOOST_CHECK_EQUAL(dag.size(), 0ul);
+  BOOST_CHECK_EQUAL(dag.nshared(), 1ul);
+
+  array_type r1, r2, r3;
+  r1("i,j") = a("i,k") * b("k,j") + a("i,j");
+  r2("i,j") = a("i,k") * b("k,j") - b("i,j");
+  r3("i,j") = 2 * a("i,j") + b("j,i");
+  BOOST_CHECK_SMALL(distance(c1, r1), 1e-10);
+  BOOST_CHECK_SMALL(distance(c2, r2), 1e-10);
+  BOOST_CHECK_SMALL(distance(c3, r3), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(shared_in_statement) {
+  // both consumers of the intermediate belong to the same statement and may
+  // consume its tiles
+  array_type c;
+  ExprDAG dag;
+  dag.add(c("i,j"), (a("i,j") + b("i,j")) * (a("i,j") + b("i,j")));
+  dag.evaluate();
+  BOOST_CHECK_EQUAL(dag.nshared(), 1ul);
+
+  array_type r;
+  r("i,j") = (a("i,j") + b("i,j")) * (a("i,j") + b("i,j"));
+  BOOST_CHECK_SMALL(distance(c, r), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(deferred_consumers) {
+  // the waits of the statements are deferred, hence the last consumer of
+  // the intermediate, which scales its tiles in place, may be created while
+  // the earlier consumers are still copying the tiles
+  array_type c1, c2, c3;
+  {
+    LazyEvalScope lazy(*GlobalFixture::world);
+    ExprDAG dag;
+    dag.add(c1("i,j"), a("i,k") * b("k,j") + a("i,j"));
+    dag.add(c2("i,j"), a("i,k") * b("k,j") - b("i,j"));
+    dag.add(c3("i,j"), 2 * (a("i,k") * b("k,j")));
+    dag.evaluate();
+    BOOST_CHECK_EQUAL(dag.nshared(), 1ul);
+  }
+
+  array_type r1, r2, r3;
+  r1("i,j") = a("i,k") * b("k,j") + a("i,j");
+  r2("i,j") = a("i,k") * b("k,j") - b("i,j");
+  r3("i,j") = 2 * (a("i,k") * b("k,j"));
+  BOOST_CHECK_SMALL(distance(c1, r1), 1e-10);
+  BOOST_CHECK_SMALL(distance(c2, r2), 1e-10);
+  BOOST_CHECK_SMALL(distance(c3, r3), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(modified_argument) {
+  // b is assigned between the consumers of a * b, which are not equivalent
+  array_type c1, c2, b0 = b;
+  ExprDAG dag;
+  dag.add(c1("i,j"), a("i,k") * b("k,j") + a("i,j"));
+  dag.add(b("i,j"), 2 * b("i,j"));
+  dag.add(c2("i,j"), a("i,k") * b("k,j") + a("i,j"));
+  dag.evaluate();
+  BOOST_CHECK_EQUAL(dag.nshared(), 0ul);
+
+  array_type r1, r2;
+  r1("i,j") = a("i,k") * b0("k,j") + a("i,j");
+  r2("i,j") = 2 * (a("i,k") * b0("k,j")) + a("i,j");
+  BOOST_CHECK_SMALL(distance(c1, r1), 1e-10);
+  BOOST_CHECK_SMALL(distance(c2, r2), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(scaling_factor) {
+  // subexpressions that differ only by a scaling factor are not shared
+  array_type c1, c2;
+  ExprDAG dag;
+  dag.add(c1("i,j"), 0.1 * a("i,j") + b("i,j"));
+  dag.add(c2("i,j"), 0.1000001 * a("i,j") + b("i,j"));
+  dag.evaluate();
+  BOOST_CHECK_EQUAL(dag.nshared(), 0ul);
+
+  array_type r;
+  r("i,j") = c1("i,j") - c2("i,j");
+  BOOST_CHECK_CLOSE(r("i,j").norm().get(), 1e-7 * a("i,j").norm().get(),
+                    1e-4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
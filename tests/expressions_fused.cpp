@@ -0,0 +1,193 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct FusedExpressionsFixture {
+  typedef DistArray<Tensor<double>, DensePolicy> array_type;
+  typedef DistArray<Tensor<double>, SparsePolicy> sparse_array_type;
+
+  FusedExpressionsFixture()
+      : trange({tr1, tr1}),
+        a(*GlobalFixture::world, trange),
+        b(*GlobalFixture::world, trange),
+        c(*GlobalFixture::world, trange),
+        sa(*GlobalFixture::world, trange, make_shape(trange, 0ul)),
+        sb(*GlobalFixture::world, trange, make_shape(trange, 1ul)) {
+    a.fill_random();
+    b.fill_random();
+    c.fill_random();
+    sa.fill_random();
+    sb.fill_random();
+  }
+
+  /// A sparse shape in which every third tile, starting at \c offset, is zero
+  static SparseShape<float> make_shape(const TiledRange& trange,
+                                       const std::size_t offset) {
+    Tensor<float> norms(trange.tiles_range(), 1.0f);
+    for (std::size_t i = offset; i < norms.size(); i += 3ul) norms[i] = 0.0f;
+    return SparseShape<float>(norms, trange);
+  }
+
+  /// The tile of \c array that corresponds to the tile \c index of a result
+  /// with permutation \c perm ; zero tiles are materialized
+  template <typename A>
+  static Tensor<double> source_tile(const A& array, const Permutation& perm,
+                                    const Range::index_type& index) {
+    const auto source = perm ? perm.inv() * index : index;
+    if (array.is_zero(source))
+      return Tensor<double>(array.trange().make_tile_range(source), 0.0);
+    return array.find(source).get();
+  }
+
+  /// Compare the local tiles of \c result with the tiles computed by \c op
+  /// from the corresponding tiles of \c args
+  template <typename R, typename Op, typename... A>
+  static void check(const R& result, const Permutation& perm, Op&& op,
+                    const A&... args) {
+    for (std::size_t ord = 0ul; ord < result.size(); ++ord) {
+      if (!result.is_local(ord)) continue;
+      const auto index = result.trange().tiles_range().idx(ord);
+      Tensor<double> expected = op(source_tile(args, perm, index)...);
+      if (perm) expected = expected.permute(perm);
+      if (result.is_zero(ord)) {
+        BOOST_CHECK_SMALL(expected.abs_max(), 1e-12);
+        continue;
+      }
+      const Tensor<double> tile = result.find(ord).get();
+      BOOST_REQUIRE_EQUAL(tile.range(), expected.range());
+      for (std::size_t i = 0ul; i < tile.size(); ++i)
+        BOOST_CHECK_CLOSE(tile[i], expected[i], 1e-10);
+    }
+  }
+
+  const TiledRange1 tr1{0, 2, 5, 9, 10};
+  TiledRange trange;
+  array_type a;
+  array_type b;
+  array_type c;
+  sparse_array_type sa;
+  sparse_array_type sb;
+};  // FusedExpressionsFixture
+
+BOOST_FIXTURE_TEST_SUITE(expressions_fused_suite, FusedExpressionsFixture)
+
+BOOST_AUTO_TEST_CASE(scal_add_subt) {
+  const std::size_t evaluators = detail::FusedEvalStats::evaluators();
+  array_type r;
+  r("i,j") = 2 * (a("i,j") - b("i,j")) + c("i,j");
+  BOOST_CHECK_EQUAL(detail::FusedEvalStats::evaluators(), evaluators + 1ul);
+  check(
+      r, Permutation(),
+      [](const auto& x, const auto& y, const auto& z) {
+        return x.subt(y).scale(2).add(z);
+      },
+      a, b, c);
+}
+
+BOOST_AUTO_TEST_CASE(permuted_result) {
+  array_type r;
+  r("j,i") = 3 * (a("i,j") + b("i,j")) - 0.5 * c("i,j");
+  check(
+      r, Permutation{1, 0},
+      [](const auto& x, const auto& y, const auto& z) {
+        return x.add(y).scale(3).subt(z.scale(0.5));
+      },
+      a, b, c);
+}
+
+BOOST_AUTO_TEST_CASE(hadamard) {
+  array_type r;
+  r("i,j") = 2 * (a("i,j") * b("i,j")) + a("i,j") * c("i,j");
+  check(
+      r, Permutation(),
+      [](const auto& x, const auto& y, const auto& x2, const auto& z) {
+        return x.mult(y).scale(2).add(x2.mult(z));
+      },
+      a, b, a, c);
+}
+
+BOOST_AUTO_TEST_CASE(permuted_leaf) {
+  // the tiles of the permuted leaf are read in place by the fused kernel
+  array_type bt;
+  bt("i,j") = b("j,i");
+  const std::size_t evaluators = detail::FusedEvalStats::evaluators();
+  array_type r;
+  r("i,j") = a("i,j") + b("j,i") + c("i,j");
+  BOOST_CHECK_EQUAL(detail::FusedEvalStats::evaluators(), evaluators + 1ul);
+  check(
+      r, Permutation(),
+      [](const auto& x, const auto& y, const auto& z) {
+        return x.add(y).add(z);
+      },
+      a, bt, c);
+
+  // permuted leaves and a permuted result
+  r("j,i") = 2 * a("i,j") * b("j,i");
+  BOOST_CHECK_EQUAL(detail::FusedEvalStats::evaluators(), evaluators + 2ul);
+  check(
+      r, Permutation{1, 0},
+      [](const auto& x, const auto& y) { return x.mult(y).scale(2); }, a, bt);
+}
+
+BOOST_AUTO_TEST_CASE(conj) {
+  typedef DistArray<Tensor<std::complex<double>>, DensePolicy> array_z;
+  array_z x(*GlobalFixture::world, trange);
+  array_z y(*GlobalFixture::world, trange);
+  x.fill_random();
+  y.fill_random();
+
+  const std::size_t evaluators = detail::FusedEvalStats::evaluators();
+  array_z r;
+  r("i,j") = x("i,j").conj() - 2.0 * y("j,i");
+  BOOST_CHECK_EQUAL(detail::FusedEvalStats::evaluators(), evaluators + 1ul);
+
+  for (std::size_t ord = 0ul; ord < r.size(); ++ord) {
+    if (!r.is_local(ord)) continue;
+    const auto index = r.trange().tiles_range().idx(ord);
+    const Tensor<std::complex<double>> tile = r.find(ord).get();
+    const Tensor<std::complex<double>> x_tile = x.find(index).get();
+    const Tensor<std::complex<double>> y_tile =
+        y.find(Permutation{1, 0} * index).get();
+    for (const auto& i : tile.range()) {
+      const std::complex<double> expected =
+          std::conj(x_tile(i)) - 2.0 * y_tile(i[1], i[0]);
+      BOOST_CHECK_SMALL(std::abs(tile(i) - expected), 1e-10);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sparse) {
+  sparse_array_type r;
+  r("i,j") = 2 * sa("i,j") - sb("i,j");
+  check(
+      r, Permutation(),
+      [](const auto& x, const auto& y) { return x.scale(2).subt(y); }, sa,
+      sb);
+
+  r("j,i") = sa("i,j") * sb("i,j");
+  check(
+      r, Permutation{1, 0},
+      [](const auto& x, const auto& y) { return x.mult(y); }, sa, sb);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
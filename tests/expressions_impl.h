@@ -227,6 +227,35 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(reduce_factories, F, Fixtures, F) {
   BOOST_CHECK_NO_THROW(a("a,b,c").abs_max().get());
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(reduction_batch, F, Fixtures, F) {
+  auto& a = F::a;
+  auto& b = F::b;
+
+  const auto sum_ref = a("a,b,c").sum().get();
+  const auto squared_norm_ref = a("a,b,c").squared_norm().get();
+  const auto abs_max_ref = b("a,b,c").abs_max().get();
+  const auto dot_ref = a("a,b,c").dot(b("a,b,c")).get();
+  const auto dot_permute_ref = (2 * a("a,b,c")).dot(b("c,b,a")).get();
+
+  ReductionBatch batch(*GlobalFixture::world);
+  auto sum = batch.sum(a("a,b,c"));
+  auto squared_norm = batch.squared_norm(a("a,b,c"));
+  auto abs_max = batch.abs_max(b("a,b,c"));
+  auto dot = batch.dot(a("a,b,c"), b("a,b,c"));
+  auto dot_permute = batch.dot(2 * a("a,b,c"), b("c,b,a"));
+  BOOST_CHECK_EQUAL(batch.size(), 5ul);
+  BOOST_REQUIRE_NO_THROW(batch.submit());
+
+  using std::abs;
+  BOOST_CHECK(abs(sum.get() - sum_ref) <= 1e-10 * abs(sum_ref));
+  BOOST_CHECK(abs(squared_norm.get() - squared_norm_ref) <=
+              1e-10 * abs(squared_norm_ref));
+  BOOST_CHECK_EQUAL(abs_max.get(), abs_max_ref);
+  BOOST_CHECK(abs(dot.get() - dot_ref) <= 1e-10 * abs(dot_ref));
+  BOOST_CHECK(abs(dot_permute.get() - dot_permute_ref) <=
+              1e-10 * abs(dot_permute_ref));
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(permute, F, Fixtures, F) {
   auto& a = F::a;
   auto& b = F::b;
@@ -584,6 +613,103 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(permute_block, F, Fixtures, F) {
   }
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(element_block, F, Fixtures, F) {
+  typedef typename F::TArray::value_type tile_type;
+  typedef typename F::element_type element_type;
+
+  // Boundary tiles are cut from TiledArray::Tensor tiles only
+  if constexpr (TiledArray::detail::is_ta_tensor_v<tile_type>) {
+    auto& a = F::a;
+    auto& c = F::c;
+
+    // cuts through the tiles of a, except for the last dimension
+    const std::vector<long> lobound{1, 3, 5};
+    const std::vector<long> upbound{12, 27, 17};
+    const auto tile_lobound = a.trange().element_to_tile(lobound);
+
+    // Compare c with the elements of a; perm maps the dimensions of a to c
+    auto check = [&](const Permutation& perm, const element_type factor) {
+      for (unsigned int d = 0u; d < lobound.size(); ++d)
+        BOOST_CHECK_EQUAL(long(c.trange().elements_range().extent(perm[d])),
+                          upbound[d] - lobound[d]);
+
+      const auto inv_perm = perm.inv();
+      for (std::size_t ord = 0ul; ord < c.size(); ++ord) {
+        if (!c.is_local(ord)) continue;
+
+        // the tile of a that holds the elements of the result tile
+        auto source_index = inv_perm * c.trange().tiles_range().idx(ord);
+        for (unsigned int d = 0u; d < source_index.size(); ++d)
+          source_index[d] += tile_lobound[d];
+        if (a.is_zero(source_index)) {
+          BOOST_CHECK(c.is_zero(ord));
+          continue;
+        }
+        BOOST_REQUIRE(!c.is_zero(ord));
+
+        const auto source = a.find(source_index).get();
+        const auto tile = c.find(ord).get();
+        for (const auto& i : tile.range()) {
+          auto j = inv_perm * i;
+          for (unsigned int d = 0u; d < j.size(); ++d) j[d] += lobound[d];
+          BOOST_CHECK_EQUAL(tile[i], factor * source[j]);
+        }
+      }
+    };
+
+    BOOST_REQUIRE_NO_THROW(c("a,b,c") =
+                               a("a,b,c").element_block(lobound, upbound));
+    check(Permutation{0, 1, 2}, element_type(1));
+
+    BOOST_REQUIRE_NO_THROW(c("a,b,c") =
+                               2 * a("c,b,a").element_block(lobound, upbound));
+    check(Permutation{2, 1, 0}, element_type(2));
+
+    // a block that is aligned with the tile boundaries is an ordinary block
+    BOOST_REQUIRE_NO_THROW(
+        c("a,b,c") = a("a,b,c").element_block({2, 2, 5}, {10, 17, 17}));
+    BOOST_CHECK_EQUAL(c.trange().tiles_range().volume(), 12ul);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(clone_count, F, Fixtures, F) {
+  auto& a = F::a;
+  auto& b = F::b;
+  auto& c = F::c;
+  const std::array<int, 3> lobound{{3, 3, 3}};
+  const std::array<int, 3> upbound{{5, 5, 5}};
+
+  // the leaves of a chained expression are read in place, the temporaries
+  // are consumed
+  {
+    CloneCounter clones;
+    c("a,b,c") = 2 * (a("a,b,c") + b("a,b,c")) - a("a,b,c");
+    BOOST_CHECK_EQUAL(clones.count(), 0ul);
+  }
+
+  // the local tiles of a block are cloned before their range is shifted,
+  // remote tiles are copies that are shifted in place
+  CloneCounter outer;
+  std::size_t block_clones = 0ul;
+  {
+    CloneCounter clones;
+    c("a,b,c") = a("a,b,c").block(lobound, upbound) +
+                 b("a,b,c").block(lobound, upbound);
+    block_clones = clones.count();
+  }
+
+  const BlockRange block_range(a.trange().tiles_range(), lobound, upbound);
+  std::size_t expected = 0ul;
+  for (std::size_t ord = 0ul; ord < c.size(); ++ord) {
+    if (!c.is_local(ord)) continue;
+    const auto source = block_range.ordinal(ord);
+    for (const auto* arg : {&a, &b})
+      if (arg->is_local(source) && !arg->is_zero(source)) ++expected;
+  }
+  BOOST_CHECK_EQUAL(block_clones, expected);
+  BOOST_CHECK_EQUAL(outer.count(), block_clones);
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(assign_subblock_block, F, Fixtures, F) {
   auto& a = F::a;
   auto& b = F::b;
@@ -0,0 +1,118 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct LazyEvalFixture {
+  typedef DistArray<Tensor<double>, DensePolicy> array_type;
+
+  LazyEvalFixture()
+      : trange({tr1, tr1}),
+        a(*GlobalFixture::world, trange),
+        b(*GlobalFixture::world, trange) {
+    a.fill_random();
+    b.fill_random();
+  }
+
+  static double distance(const array_type& x, const array_type& y) {
+    return (x("i,j") - y("i,j")).norm().get();
+  }
+
+  const TiledRange1 tr1{0, 2, 5, 9, 10};
+  TiledRange trange;
+  array_type a;
+  array_type b;
+};  // LazyEvalFixture
+
+BOOST_FIXTURE_TEST_SUITE(lazy_eval_suite, LazyEvalFixture)
+
+BOOST_AUTO_TEST_CASE(statements) {
+  array_type c1, c2, c3, c4;
+  {
+    LazyEvalScope lazy(*GlobalFixture::world);
+    BOOST_CHECK(LazyEvalScope::active() == &lazy);
+    c1("i,j") = a("i,k") * b("k,j");
+    c2("i,j") = b("i,k") * a("j,k");
+    BOOST_CHECK_NE(lazy.size(), 0ul);
+    // consume the results of the preceding statements
+    c3("i,j") = c1("i,j") + 2 * c2("j,i");
+    c3("i,j") = c3("i,k") * c1("k,j");
+    // tiles are accessible via futures before the barrier
+    c4("i,j") = c2("i,j");
+    const auto tile = c4.find(0).get();
+    BOOST_CHECK_EQUAL(tile.range(), trange.make_tile_range(0));
+    lazy.fence();
+    BOOST_CHECK_EQUAL(lazy.size(), 0ul);
+  }
+  BOOST_CHECK(LazyEvalScope::active() == nullptr);
+
+  array_type r1, r2, r3;
+  r1("i,j") = a("i,k") * b("k,j");
+  r2("i,j") = b("i,k") * a("j,k");
+  r3("i,j") = r1("i,j") + 2 * r2("j,i");
+  r3("i,j") = r3("i,k") * r1("k,j");
+  BOOST_CHECK_SMALL(distance(c1, r1), 1e-10);
+  BOOST_CHECK_SMALL(distance(c2, r2), 1e-10);
+  BOOST_CHECK_SMALL(distance(c3, r3), 1e-8);
+  BOOST_CHECK_SMALL(distance(c4, r2), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(nested) {
+  array_type c1, c2;
+  LazyEvalScope outer(*GlobalFixture::world);
+  c1("i,j") = a("i,j") + b("i,j");
+  const auto outer_size = outer.size();
+  {
+    LazyEvalScope inner(*GlobalFixture::world);
+    c2("i,j") = 2 * c1("i,j");
+    BOOST_CHECK_EQUAL(outer.size(), outer_size);
+    BOOST_CHECK_NE(inner.size(), 0ul);
+  }
+  BOOST_CHECK(LazyEvalScope::active() == &outer);
+  outer.fence();
+
+  array_type r;
+  r("i,j") = 2 * (a("i,j") + b("i,j"));
+  BOOST_CHECK_SMALL(distance(c2, r), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(release) {
+  array_type c;
+  std::vector<LazyEvalScope::Deferred> waits;
+  {
+    LazyEvalScope lazy(*GlobalFixture::world);
+    c("i,j") = a("i,k") * b("k,j");
+    waits = lazy.release();
+    BOOST_CHECK_EQUAL(lazy.size(), 0ul);
+  }  // no barrier
+  BOOST_CHECK(LazyEvalScope::active() == nullptr);
+  BOOST_REQUIRE(!waits.empty());
+  for (auto& wait : waits) wait.wait();
+  for (const auto& wait : waits) BOOST_CHECK(wait.probe());
+  GlobalFixture::world->gop.fence();
+
+  array_type r;
+  r("i,j") = a("i,k") * b("k,j");
+  BOOST_CHECK_SMALL(distance(c, r), 1e-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
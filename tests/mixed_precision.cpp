@@ -0,0 +1,199 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+
+#include "TiledArray/conversions/precision.h"
+#include "TiledArray/tile_op/contract_reduce.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+using TiledArray::detail::ContractReduce;
+
+struct MixedPrecisionFixture {
+  typedef Tensor<float> tensor_f;
+  typedef Tensor<double> tensor_d;
+
+  // k spans more than one widened panel
+  MixedPrecisionFixture()
+      : left(Range(m, k)), right(Range(k, n)), left_t(Range(k, m)) {
+    for (std::size_t i = 0ul; i < left.size(); ++i)
+      left[i] = 1.0f / float(1ul + i % 7ul);
+    for (std::size_t i = 0ul; i < right.size(); ++i)
+      right[i] = 1.0f / float(1ul + i % 11ul);
+    for (std::size_t i = 0ul; i < m; ++i)
+      for (std::size_t p = 0ul; p < k; ++p) left_t(p, i) = left(i, p);
+  }
+
+  /// <tt>left * right</tt> computed in double precision
+  tensor_d reference() const {
+    tensor_d result(Range(m, n), 0.0);
+    for (std::size_t i = 0ul; i < m; ++i)
+      for (std::size_t j = 0ul; j < n; ++j)
+        for (std::size_t p = 0ul; p < k; ++p)
+          result(i, j) += double(left(i, p)) * double(right(p, j));
+    return result;
+  }
+
+  static void check_close(const tensor_d& result, const tensor_d& ref) {
+    BOOST_REQUIRE_EQUAL(result.range(), ref.range());
+    for (std::size_t i = 0ul; i < ref.size(); ++i)
+      BOOST_CHECK_CLOSE(result[i], ref[i], 1e-10);
+  }
+
+  static constexpr std::size_t m = 5ul, n = 3ul, k = 300ul;
+  tensor_f left;
+  tensor_f right;
+  tensor_f left_t;  ///< The transpose of left
+};  // MixedPrecisionFixture
+
+BOOST_FIXTURE_TEST_SUITE(mixed_precision_suite, MixedPrecisionFixture)
+
+BOOST_AUTO_TEST_CASE(blas_gemm) {
+  static_assert(
+      math::blas::detail::is_mixed_precision_gemm_v<float, float, double>);
+  static_assert(
+      math::blas::detail::is_mixed_precision_gemm_v<double, float, double>);
+  static_assert(
+      !math::blas::detail::is_mixed_precision_gemm_v<double, double, double>);
+  static_assert(
+      !math::blas::detail::is_mixed_precision_gemm_v<float, float, float>);
+
+  const tensor_d ref = reference();
+
+  std::vector<double> c(m * n, 1.0);
+  math::blas::gemm(math::blas::NoTranspose, math::blas::NoTranspose, m, n, k,
+                   1.0, left.data(), k, right.data(), n, 0.0, c.data(), n);
+  for (std::size_t i = 0ul; i < c.size(); ++i)
+    BOOST_CHECK_CLOSE(c[i], ref[i], 1e-10);
+
+  // accumulate the transposed left argument
+  math::blas::gemm(math::blas::Transpose, math::blas::NoTranspose, m, n, k,
+                   2.0, left_t.data(), m, right.data(), n, 1.0, c.data(), n);
+  for (std::size_t i = 0ul; i < c.size(); ++i)
+    BOOST_CHECK_CLOSE(c[i], 3.0 * ref[i], 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(tensor_gemm) {
+  const math::GemmHelper gemm_helper(math::blas::NoTranspose,
+                                     math::blas::NoTranspose, 2u, 2u, 2u);
+  const tensor_d ref = reference();
+
+  tensor_d result;
+  result.gemm(left, right, 1.0, gemm_helper);
+  check_close(result, ref);
+
+  result.gemm(left, right, 1.0, gemm_helper);
+  check_close(result, ref * 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(contract_reduce) {
+  const ContractReduce<tensor_d, tensor_f, tensor_f, double> op(
+      math::blas::NoTranspose, math::blas::NoTranspose, 1.0, 2u, 2u, 2u);
+  static_assert(decltype(op)::mixed_precision);
+
+  tensor_d result = op();
+  op(result, left, right);
+  op(result, left, right);
+  check_close(op(result), reference() * 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(permute) {
+  const Permutation perm({1, 0});
+  const tensor_d result =
+      TiledArray::Permute<tensor_d, tensor_f>()(left, perm);
+  BOOST_REQUIRE_EQUAL(result.range(), Range(k, m));
+  for (std::size_t i = 0ul; i < m; ++i)
+    for (std::size_t p = 0ul; p < k; ++p)
+      BOOST_CHECK_EQUAL(result(p, i), double(left(i, p)));
+}
+
+BOOST_AUTO_TEST_CASE(expression) {
+  typedef DistArray<tensor_f, DensePolicy> array_f;
+  typedef DistArray<tensor_d, DensePolicy> array_d;
+
+  const auto copy_of = [](const tensor_f& source) {
+    return [source](const Range& range) {
+      tensor_f tile(range);
+      for (const auto& idx : range) tile(idx) = source(idx);
+      return tile;
+    };
+  };
+  array_f a(*GlobalFixture::world, TiledRange{{0, 2, 5}, {0, 100, 300}});
+  array_f b(*GlobalFixture::world, TiledRange{{0, 100, 300}, {0, 1, 3}});
+  a.init_tiles(copy_of(left));
+  b.init_tiles(copy_of(right));
+
+  // float arguments are contracted into double-precision tiles
+  const tensor_d ref = reference();
+  array_d c;
+  c("i,j") = (a("i,k") * b("k,j")).accumulate_as<tensor_d>();
+  array_d c_t;
+  c_t("j,i") = (a("i,k") * b("k,j")).accumulate_as<tensor_d>();
+  for (const auto& tile : c) {
+    const tensor_d t = tile.get();
+    for (const auto& idx : t.range())
+      BOOST_CHECK_CLOSE(t(idx), ref(idx), 1e-10);
+  }
+  for (const auto& tile : c_t) {
+    const tensor_d t = tile.get();
+    for (const auto& idx : t.range())
+      BOOST_CHECK_CLOSE(t(idx), ref(idx[1], idx[0]), 1e-10);
+  }
+
+  // element-wise products are converted to the result tile type
+  array_d h;
+  h("i,j") = (a("i,j") * a("i,j")).accumulate_as<tensor_d>();
+  for (const auto& tile : h) {
+    const tensor_d t = tile.get();
+    for (const auto& idx : t.range())
+      BOOST_CHECK_EQUAL(t(idx), double(left(idx) * left(idx)));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(policy) {
+  typedef DistArray<tensor_d, SparsePolicy> array_d;
+  typedef DistArray<tensor_f, SparsePolicy> array_f;
+
+  const TiledRange trange{{0, 3, 8}, {0, 2, 5}};
+  array_d a(*GlobalFixture::world, trange);
+  a.fill(1.0);
+
+  const double error = PrecisionPolicy::rounding_error(a.shape(),
+                                                       Precision::Single);
+  BOOST_CHECK_CLOSE(error, unit_roundoff(Precision::Single) * std::sqrt(40.0),
+                    1e-8);
+  BOOST_CHECK_LT(PrecisionPolicy::rounding_error(a.shape(), Precision::Double),
+                 error);
+  BOOST_CHECK_EQUAL(PrecisionPolicy(1e-5).select(a), Precision::Single);
+  BOOST_CHECK_EQUAL(PrecisionPolicy(1e-8).select(a), Precision::Double);
+  BOOST_CHECK_EQUAL(PrecisionPolicy(1.0).select(DenseShape()),
+                    Precision::Double);
+
+  const array_f a_f = to_precision<float>(a);
+  BOOST_CHECK_EQUAL(a_f.trange(), trange);
+  const array_d a_d = to_precision<double>(a_f);
+  for (const auto& tile : a_d) {
+    const tensor_d t = tile.get();
+    for (const double x : t) BOOST_CHECK_EQUAL(x, 1.0);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
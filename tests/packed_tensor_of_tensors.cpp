@@ -0,0 +1,315 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+namespace {
+
+/// The number of allocations made by the current thread
+thread_local std::size_t nallocations = 0ul;
+
+}  // namespace
+
+// Count the allocations, so that the tests can check that the built-in inner
+// products do not allocate the inner tensors
+void* operator new(std::size_t size) {
+  ++nallocations;
+  if (void* ptr = std::malloc(size ? size : 1ul)) return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+struct PackedTensorOfTensorsFixture {
+  typedef Tensor<double> inner_type;
+  typedef Tensor<inner_type> tot_type;
+  typedef PackedTensorOfTensors<double> packed_type;
+
+  PackedTensorOfTensorsFixture()
+      : a(make_tot(Range{3, 4}, 1)), b(make_tot(Range{3, 4}, 23)) {}
+
+  /// A tensor of tensors with inner tensors of different shapes; every
+  /// fifth inner tensor is empty if \c empties is \c true
+  static tot_type make_tot(const Range& range, const int seed,
+                           const bool empties = true) {
+    tot_type result(range);
+    for (std::size_t i = 0ul; i < result.size(); ++i) {
+      if (empties && i % 5ul == 4ul) continue;
+      result[i] = inner_type(Range{i % 3ul + 1ul, 2ul});
+      for (std::size_t j = 0ul; j < result[i].size(); ++j)
+        result[i][j] = seed + 10 * i + j;
+    }
+    return result;
+  }
+
+  /// A tensor of tensors whose inner tensors have the range \c inner
+  static tot_type make_uniform_tot(const Range& range, const Range& inner,
+                                   const int seed) {
+    tot_type result(range);
+    for (std::size_t i = 0ul; i < result.size(); ++i) {
+      result[i] = inner_type(inner);
+      for (std::size_t j = 0ul; j < result[i].size(); ++j)
+        result[i][j] = double((seed + 7 * i + 3 * j) % 11) / 11.0;
+    }
+    return result;
+  }
+
+  /// Compare a packed tile with a tensor of tensors
+  static void check(const packed_type& packed, const tot_type& tot) {
+    BOOST_REQUIRE_EQUAL(packed.range(), tot.range());
+    for (std::size_t i = 0ul; i < tot.size(); ++i) {
+      if (tot[i].empty()) {
+        BOOST_CHECK_EQUAL(packed.inner_range(i).volume(), 0ul);
+        continue;
+      }
+      BOOST_REQUIRE_EQUAL(packed.inner_range(i), tot[i].range());
+      const auto view = packed[i];
+      for (std::size_t j = 0ul; j < tot[i].size(); ++j)
+        BOOST_CHECK_CLOSE(view[j], tot[i][j], 1e-12);
+    }
+  }
+
+  tot_type a;
+  tot_type b;
+};  // PackedTensorOfTensorsFixture
+
+BOOST_FIXTURE_TEST_SUITE(packed_tensor_of_tensors_suite,
+                         PackedTensorOfTensorsFixture)
+
+BOOST_AUTO_TEST_CASE(pack_unpack) {
+  static_assert(detail::is_tensor_of_tensor_v<packed_type>);
+  static_assert(!detail::is_tensor_v<packed_type>);
+
+  const packed_type packed(a);
+  BOOST_CHECK(!packed.empty());
+  BOOST_CHECK_EQUAL(packed.size(), a.size());
+  check(packed, a);
+
+  // the inner tensors are stored back to back in one buffer
+  std::size_t volume = 0ul;
+  for (const auto& inner : a) volume += inner.size();
+  BOOST_CHECK_EQUAL(packed.packed_data().size(), volume);
+  BOOST_CHECK_EQUAL(packed[1].data(), packed[0].data() + a[0].size());
+
+  const auto unpacked = static_cast<tot_type>(packed);
+  BOOST_REQUIRE_EQUAL(unpacked.range(), a.range());
+  for (std::size_t i = 0ul; i < a.size(); ++i) {
+    BOOST_REQUIRE_EQUAL(unpacked[i].empty(), a[i].empty());
+    if (a[i].empty()) continue;
+    BOOST_CHECK_EQUAL(unpacked[i].range(), a[i].range());
+    BOOST_CHECK_EQUAL_COLLECTIONS(unpacked[i].begin(), unpacked[i].end(),
+                                  a[i].begin(), a[i].end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(views) {
+  packed_type packed(a);
+  packed[std::vector<std::size_t>{1, 2}][0] = -1.0;
+  BOOST_CHECK_EQUAL(packed[6][0], -1.0);
+
+  // copies are shallow
+  packed_type copy = packed;
+  BOOST_CHECK(packed.is_shared());
+  copy = packed.clone();
+  copy[6][0] = 2.0;
+  BOOST_CHECK_EQUAL(packed[6][0], -1.0);
+}
+
+BOOST_AUTO_TEST_CASE(element_wise_ops) {
+  const packed_type pa(a), pb(b);
+
+  tot_type sum(a.range()), diff(a.range()), prod(a.range());
+  double dot = 0.0;
+  for (std::size_t i = 0ul; i < a.size(); ++i) {
+    if (a[i].empty()) continue;
+    sum[i] = a[i].add(b[i], 2);
+    diff[i] = a[i].subt(b[i]);
+    prod[i] = a[i].mult(b[i]);
+    dot += a[i].dot(b[i]);
+  }
+
+  check(pa.add(pb, 2), sum);
+  check(pa.scale(2).add(pb.scale(2)), sum);
+  check(pa.subt(pb), diff);
+  check(pa.mult(pb), prod);
+  BOOST_CHECK_CLOSE(pa.dot(pb), dot, 1e-12);
+
+  packed_type result = pa.clone();
+  result.subt_to(pb);
+  check(result, diff);
+  result.neg_to();
+  check(result.neg(), diff);
+
+  // the arguments of binary operations must have the same layout
+  const packed_type other(make_tot(Range{3, 4}, 1, false));
+  BOOST_CHECK_THROW(pa.add(other), TiledArray::Exception);
+  BOOST_CHECK_THROW(result.mult_to(other), TiledArray::Exception);
+  BOOST_CHECK_THROW(pa.dot(packed_type()), TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(permute) {
+  const auto tot = make_tot(Range{3, 4}, 1, false);
+  const packed_type packed(tot);
+  const BipartitePermutation perm(Permutation{1, 0, 3, 2}, 2);
+  check(packed.permute(perm), tot.permute(perm));
+  check(packed.permute(Permutation{1, 0}), tot.permute(Permutation{1, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(serialization) {
+  const packed_type packed(a);
+
+  madness::archive::BufferOutputArchive count_ar;
+  count_ar& packed;
+  const std::size_t buf_size = count_ar.size();
+  std::vector<unsigned char> buf(buf_size);
+  madness::archive::BufferOutputArchive oar(buf.data(), buf_size);
+  BOOST_REQUIRE_NO_THROW(oar & packed);
+  const std::size_t nbyte = oar.size();
+  oar.close();
+
+  packed_type result;
+  madness::archive::BufferInputArchive iar(buf.data(), nbyte);
+  BOOST_REQUIRE_NO_THROW(iar & result);
+  iar.close();
+
+  check(result, a);
+  BOOST_CHECK_EQUAL(result.packed_data().size(), packed.packed_data().size());
+}
+
+BOOST_AUTO_TEST_CASE(native_inner_products) {
+  typedef packed_type::elem_muladd_kernel_type kernel_type;
+  const auto notrans = math::blas::NoTranspose;
+  const tot_type xt = make_uniform_tot(Range{4, 5}, Range{2, 3}, 1);
+  const tot_type yt = make_uniform_tot(Range{6, 5}, Range{2, 3}, 5);
+  const tot_type zt = make_uniform_tot(Range{4, 5}, Range{3, 2}, 9);
+  const packed_type x(xt), y(yt), z(zt);
+
+  // outer Hadamard product, inner contraction
+  const kernel_type contraction =
+      kernel_type::contraction(math::GemmHelper(notrans, notrans, 2, 2, 2), 2);
+  std::size_t n = nallocations;
+  const packed_type r = x.binary(z, contraction);
+  n = nallocations - n;
+  BOOST_CHECK_LT(n, x.size());
+  check(r, xt.binary(zt, contraction));
+
+  // outer contraction, inner Hadamard product
+  const kernel_type hadamard = kernel_type::hadamard(1);
+  const math::GemmHelper gemm_helper(notrans, math::blas::Transpose, 2, 2, 2);
+  packed_type s;
+  tot_type st;
+  n = nallocations;
+  s.gemm(x, y, gemm_helper, hadamard);
+  n = nallocations - n;
+  BOOST_CHECK_LT(n, s.size());
+  st.gemm(xt, yt, gemm_helper, hadamard);
+  check(s, st);
+
+  // the products accumulate into the packed elements
+  n = nallocations;
+  s.gemm(x, y, gemm_helper, hadamard);
+  BOOST_CHECK_EQUAL(nallocations - n, 0ul);
+  st.gemm(xt, yt, gemm_helper, hadamard);
+  check(s, st);
+}
+
+BOOST_AUTO_TEST_CASE(expressions) {
+  typedef DistArray<packed_type, DensePolicy> array_type;
+  const TiledRange trange{{0, 2, 5}, {0, 3, 4}};
+  auto init = [](const int seed) {
+    return [seed](const Range& range) {
+      return packed_type(make_tot(range, seed));
+    };
+  };
+  array_type x(*GlobalFixture::world, trange);
+  array_type y(*GlobalFixture::world, trange);
+  x.init_tiles(init(1));
+  y.init_tiles(init(23));
+
+  array_type r;
+  r("i,j;k,l") = 2 * x("i,j;k,l") - y("i,j;k,l");
+  for (std::size_t ord = 0ul; ord < r.size(); ++ord) {
+    if (!r.is_local(ord)) continue;
+    const auto range = trange.make_tile_range(ord);
+    const auto xt = make_tot(range, 1), yt = make_tot(range, 23);
+    tot_type expected(range);
+    for (std::size_t i = 0ul; i < expected.size(); ++i)
+      if (!xt[i].empty()) expected[i] = xt[i].scale(2).subt(yt[i]);
+    check(r.find(ord).get(), expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(nested_expressions) {
+  typedef DistArray<packed_type, DensePolicy> array_type;
+  typedef DistArray<tot_type, DensePolicy> tot_array_type;
+  const TiledRange trange{{0, 2, 5}, {0, 3, 5}};
+
+  // the same arrays with packed and unpacked tiles
+  auto init = [](const Range& inner, const int seed) {
+    return [inner, seed](const Range& range) {
+      return make_uniform_tot(range, inner, seed);
+    };
+  };
+  auto make_arrays = [&](const Range& inner, const int seed) {
+    tot_array_type tot(*GlobalFixture::world, trange);
+    tot.init_tiles(init(inner, seed));
+    array_type packed(*GlobalFixture::world, trange);
+    packed.init_tiles([=](const Range& range) {
+      return packed_type(init(inner, seed)(range));
+    });
+    return std::make_pair(packed, tot);
+  };
+  auto compare = [](const array_type& packed, const tot_array_type& tot) {
+    for (std::size_t ord = 0ul; ord < tot.size(); ++ord) {
+      if (!tot.is_local(ord)) continue;
+      check(packed.find(ord).get(), tot.find(ord).get());
+    }
+  };
+
+  const auto [x, xt] = make_arrays(Range{2, 3}, 1);
+  const auto [y, yt] = make_arrays(Range{2, 3}, 5);
+  const auto [z, zt] = make_arrays(Range{3, 2}, 9);
+
+  // outer contraction, inner Hadamard product
+  array_type r;
+  tot_array_type rt;
+  r("i,k;m,n") = x("i,j;m,n") * y("k,j;m,n");
+  rt("i,k;m,n") = xt("i,j;m,n") * yt("k,j;m,n");
+  compare(r, rt);
+
+  // outer Hadamard product, inner contraction
+  r("i,j;m,n") = x("i,j;m,k") * z("i,j;k,n");
+  rt("i,j;m,n") = xt("i,j;m,k") * zt("i,j;k,n");
+  compare(r, rt);
+
+  // inner permutation
+  r("j,i;n,m") = x("i,j;m,n") + 2 * y("i,j;m,n");
+  rt("j,i;n,m") = xt("i,j;m,n") + 2 * yt("i,j;m,n");
+  compare(r, rt);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
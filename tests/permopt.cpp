@@ -0,0 +1,140 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <sstream>
+
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+using namespace TiledArray::expressions;
+
+struct PermOptFixture {
+  PermOptFixture()
+      : big{0, 50, 100},
+        small{0, 2, 4},
+        big_trange{big, small, small},
+        small_trange{small, small, small} {}
+
+  TiledRange1 big;
+  TiledRange1 small;
+  TiledRange big_trange;
+  TiledRange small_trange;
+};  // PermOptFixture
+
+BOOST_FIXTURE_TEST_SUITE(permopt_suite, PermOptFixture)
+
+BOOST_AUTO_TEST_CASE(volume_estimate) {
+  const VolumeEstimate a(IndexList("i,k,l"), big_trange, 0.5, sizeof(double));
+  const VolumeEstimate b(IndexList("l,k,j"), small_trange, 0.5,
+                         sizeof(double));
+  BOOST_CHECK(!a.empty());
+  BOOST_CHECK(VolumeEstimate().empty());
+  BOOST_CHECK_CLOSE(a.elements(), 800.0, 1e-12);
+  BOOST_CHECK_CLOSE(a.bytes(), 6400.0, 1e-12);
+  BOOST_CHECK_EQUAL(a.extent("i").tiles, 2.0);
+
+  // the result has the free indices; a result tile is zero only if all 4
+  // products of the contributing tiles are zero
+  const auto c = VolumeEstimate::contraction(a, b);
+  BOOST_CHECK_EQUAL(c.extent("i").elements, 100.0);
+  BOOST_CHECK_EQUAL(c.extent("j").elements, 4.0);
+  BOOST_CHECK_CLOSE(c.density(), 1.0 - std::pow(0.75, 4), 1e-12);
+  BOOST_CHECK_CLOSE(c.elements(), 400.0 * c.density(), 1e-12);
+
+  BOOST_CHECK_CLOSE(VolumeEstimate::elementwise(a, a, true).density(), 0.25,
+                    1e-12);
+  BOOST_CHECK_CLOSE(VolumeEstimate::elementwise(a, a, false).density(), 1.0,
+                    1e-12);
+  BOOST_CHECK(VolumeEstimate::elementwise(a, VolumeEstimate(), false).empty());
+}
+
+BOOST_AUTO_TEST_CASE(contraction) {
+  const IndexList left("i,k,l"), right("l,k,j");
+  const VolumeEstimate big_left(left, big_trange, 1.0, sizeof(double));
+  const VolumeEstimate small_right(right, small_trange, 1.0, sizeof(double));
+
+  // the static preference is to permute the left argument, but the right
+  // argument is much smaller
+  {
+    const CostBasedPermutationOptimizer opt(
+        TensorProduct::Contraction, left, right, big_left, small_right,
+        VolumeEstimate::contraction(big_left, small_right), true);
+    BOOST_CHECK(opt.costed());
+    BOOST_CHECK_EQUAL(opt.target_left_indices(), left);
+    BOOST_CHECK_EQUAL(opt.left_permtype(), PermutationType::identity);
+    BOOST_CHECK_EQUAL(opt.target_right_indices(), IndexList("k,l,j"));
+    BOOST_CHECK_EQUAL(opt.target_result_indices(), IndexList("i,j"));
+    BOOST_CHECK_CLOSE(opt.cost(), small_right.bytes(), 1e-12);
+
+    std::stringstream report;
+    report << opt;
+    BOOST_CHECK(report.str().find("moves 512 bytes") != std::string::npos);
+  }
+
+  // with the sizes swapped the left argument is permuted
+  {
+    const VolumeEstimate small_left(left, small_trange, 1.0, sizeof(double));
+    const VolumeEstimate big_right(right, big_trange, 1.0, sizeof(double));
+    const CostBasedPermutationOptimizer opt(
+        TensorProduct::Contraction, left, right, small_left, big_right,
+        VolumeEstimate::contraction(small_left, big_right), false);
+    BOOST_CHECK_EQUAL(opt.target_left_indices(), IndexList("i,l,k"));
+    BOOST_CHECK_EQUAL(opt.target_right_indices(), right);
+    BOOST_CHECK_CLOSE(opt.cost(), small_left.bytes(), 1e-12);
+  }
+
+  // without volumes the index-based optimizer is used
+  {
+    const CostBasedPermutationOptimizer opt(
+        TensorProduct::Contraction, left, right, VolumeEstimate(),
+        VolumeEstimate(), VolumeEstimate(), true);
+    const GEMMPermutationOptimizer gemm(left, right, true);
+    BOOST_CHECK(!opt.costed());
+    BOOST_CHECK_EQUAL(opt.target_left_indices(), gemm.target_left_indices());
+    BOOST_CHECK_EQUAL(opt.target_right_indices(), gemm.target_right_indices());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(hadamard) {
+  const TiledRange trange{big, small};
+  const IndexList left("i,j"), right("j,i"), result("i,j");
+  const VolumeEstimate dense(left, trange, 1.0, sizeof(double));
+  const VolumeEstimate sparse(left, trange, 0.1, sizeof(double));
+
+  // the sparse left argument is permuted even though the result is wanted in
+  // its layout, since permuting the result is cheaper than permuting the
+  // dense right argument
+  const CostBasedPermutationOptimizer opt(
+      TensorProduct::Hadamard, result, left, right, sparse, dense,
+      VolumeEstimate::elementwise(sparse, dense, true), false);
+  BOOST_CHECK_EQUAL(opt.target_left_indices(), right);
+  BOOST_CHECK_EQUAL(opt.target_right_indices(), right);
+  BOOST_CHECK_EQUAL(opt.target_result_indices(), right);
+  BOOST_CHECK_CLOSE(opt.cost(), 2 * sparse.bytes(), 1e-12);
+
+  // a dense left argument is not permuted
+  const CostBasedPermutationOptimizer dense_opt(
+      TensorProduct::Hadamard, result, left, right, dense, dense,
+      VolumeEstimate::elementwise(dense, dense, true), true);
+  BOOST_CHECK_EQUAL(dense_opt.target_result_indices(), left);
+  BOOST_CHECK_CLOSE(dense_opt.cost(), dense.bytes(), 1e-12);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -18,7 +18,9 @@
  */
 
 #include "TiledArray/reduce_task.h"
+#include <atomic>
 #include <functional>
+#include <vector>
 #include "unit_test_config.h"
 
 using namespace TiledArray;
@@ -210,3 +212,151 @@ BOOST_AUTO_TEST_CASE(reduce_zero) {
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+struct ConcurrentReduceTaskFixture {
+  ConcurrentReduceTaskFixture() : world(*GlobalFixture::world), rt(world) {}
+
+  TiledArray::World& world;
+  ConcurrentReduceTask<plus<int> > rt;
+
+};  // struct ConcurrentReduceTaskFixture
+
+BOOST_FIXTURE_TEST_SUITE(concurrent_reduce_task_suite,
+                         ConcurrentReduceTaskFixture)
+
+BOOST_AUTO_TEST_CASE(reduce_value) {
+  int sum = 0;
+  for (int i = 0; i < 100; ++i) {
+    sum += i;
+    rt.add(i);
+  }
+  BOOST_CHECK_EQUAL(rt.count(), 100);
+
+  Future<int> result = rt.submit();
+
+  BOOST_CHECK_EQUAL(result.get(), sum);
+}
+
+BOOST_AUTO_TEST_CASE(reduce_future) {
+  std::vector<Future<int> > fut_vec;
+
+  for (int i = 0; i < 100; ++i) {
+    Future<int> f;
+    fut_vec.push_back(f);
+    rt.add(f);
+  }
+
+  Future<int> result = rt.submit();
+
+  BOOST_CHECK(!(result.probe()));
+
+  int sum = 0;
+  for (int i = 0; i < 99; ++i) {
+    sum += i;
+    fut_vec[i].set(i);
+    BOOST_CHECK(!(result.probe()));
+  }
+
+  sum += 99;
+  fut_vec[99].set(99);
+
+  world.gop.fence();
+
+  BOOST_CHECK(result.probe());
+
+  BOOST_CHECK_EQUAL(result.get(), sum);
+}
+
+BOOST_AUTO_TEST_CASE(reduce_zero) {
+  Future<int> result = rt.submit();
+
+  BOOST_CHECK_EQUAL(result.get(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(reduce_high_fan_in) {
+  // arguments that become ready concurrently, with one and with several
+  // partial results
+  for (unsigned int max_partials : {1u, 2u, 0u}) {
+    ConcurrentReduceTask<plus<long> > task(world, plus<long>(), nullptr,
+                                           max_partials);
+    long sum = 0;
+    for (long i = 0; i < 10000; ++i) {
+      sum += i;
+      task.add(world.taskq.add([i]() { return i; }));
+    }
+
+    BOOST_CHECK_EQUAL(task.submit().get(), sum);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(reduce_bounded_burst) {
+  // a burst of arguments, with at most max_pending of them held unreduced
+  constexpr std::size_t max_pending = 16ul;
+  ConcurrentReduceTask<plus<long> > task(world, plus<long>(), nullptr, 2u,
+                                         max_pending);
+  long sum = 0;
+  std::size_t max_observed = 0ul;
+  for (long i = 0; i < 10000; ++i) {
+    sum += i;
+    task.add(world.taskq.add([i]() { return i; }));
+    max_observed = std::max(max_observed, task.pending());
+  }
+  BOOST_CHECK_LE(max_observed, max_pending);
+  BOOST_CHECK_EQUAL(task.count(), 10000);
+
+  BOOST_CHECK_EQUAL(task.submit().get(), sum);
+}
+
+BOOST_AUTO_TEST_CASE(reduce_bounded_producers) {
+  // several producers that add arguments concurrently share the bound
+  constexpr std::size_t max_pending = 4ul;
+  ConcurrentReduceTask<plus<long> > task(world, plus<long>(), nullptr, 2u,
+                                         max_pending);
+  std::atomic<std::size_t> max_observed{0ul};
+  std::vector<Future<bool> > producers;
+  for (long p = 0; p < 8; ++p)
+    producers.push_back(world.taskq.add([&task, &max_observed, p]() {
+      for (long i = 0; i < 1000; ++i) {
+        task.add(p * 1000 + i);
+        std::size_t observed = max_observed.load();
+        const std::size_t pending = task.pending();
+        while (pending > observed &&
+               !max_observed.compare_exchange_weak(observed, pending))
+          ;
+      }
+      return true;
+    }));
+  for (auto& producer : producers) producer.get();
+  BOOST_CHECK_LE(max_observed.load(), max_pending);
+  BOOST_CHECK_EQUAL(task.count(), 8000);
+
+  BOOST_CHECK_EQUAL(task.submit().get(), 7999l * 8000l / 2l);
+}
+
+BOOST_AUTO_TEST_CASE(reduce_pair) {
+  ConcurrentReducePairTask<ReduceOp> pair_task(world);
+  std::vector<Future<int> > fut1_vec;
+  std::vector<Future<int> > fut2_vec;
+
+  int sum = 0;
+  for (int i = 0; i < 100; ++i) {
+    Future<int> f1;
+    Future<int> f2;
+    fut1_vec.push_back(f1);
+    fut2_vec.push_back(f2);
+    pair_task.add(f1, f2);
+    sum += i * i;
+  }
+
+  Future<int> result = pair_task.submit();
+
+  for (int i = 0; i < 100; ++i) {
+    BOOST_CHECK(!(result.probe()));
+    fut1_vec[i].set(i);
+    fut2_vec[i].set(i);
+  }
+
+  BOOST_CHECK_EQUAL(result.get(), sum);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
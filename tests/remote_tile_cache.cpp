@@ -0,0 +1,183 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/remote_tile_cache.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct RemoteTileCacheFixture {
+  typedef Tensor<double> tile_type;
+
+  RemoteTileCacheFixture()
+      : cache(RemoteTileCache::instance()),
+        id(GlobalFixture::world->unique_obj_id()),
+        nfetch(0ul) {
+    cache.set_budget(1ul << 20);
+    cache.reset_statistics();
+  }
+
+  ~RemoteTileCacheFixture() {
+    cache.share_within_node(*GlobalFixture::world, 0ul);
+    cache.set_budget(0ul);
+    cache.reset_statistics();
+  }
+
+  static constexpr std::size_t tile_bytes = 100ul * sizeof(double);
+
+  /// Get tile \c i, counting the requests that miss the cache
+  Future<tile_type> get(const std::size_t i) {
+    return cache.find_or_fetch<tile_type>(
+        *GlobalFixture::world, id, i, tile_bytes, [this, i]() {
+          ++nfetch;
+          return Future<tile_type>(tile_type(Range(10, 10), double(i)));
+        });
+  }
+
+  RemoteTileCache& cache;
+  madness::uniqueidT id;
+  std::size_t nfetch;
+};  // RemoteTileCacheFixture
+
+BOOST_FIXTURE_TEST_SUITE(remote_tile_cache_suite, RemoteTileCacheFixture)
+
+BOOST_AUTO_TEST_CASE(hits) {
+  for (std::size_t i = 0ul; i < 4ul; ++i) get(i);
+  for (std::size_t i = 0ul; i < 4ul; ++i)
+    BOOST_CHECK_EQUAL(get(i).get()[0], double(i));
+  BOOST_CHECK_EQUAL(nfetch, 4ul);
+  BOOST_CHECK_EQUAL(cache.size(), 4ul);
+  BOOST_CHECK_GE(cache.size_bytes(), 4 * 100 * sizeof(double));
+
+  const auto stats = cache.statistics();
+  BOOST_CHECK_EQUAL(stats.hits, 4ul);
+  BOOST_CHECK_EQUAL(stats.misses, 4ul);
+  BOOST_CHECK_EQUAL(stats.evictions, 0ul);
+  BOOST_CHECK_CLOSE(stats.hit_rate(), 0.5, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(eviction) {
+  // the budget only holds two tiles
+  get(0);
+  const std::size_t tile_bytes = cache.size_bytes();
+  cache.set_budget(2 * tile_bytes + tile_bytes / 2);
+  get(1);
+  get(0);  // 0 is now the most recently used tile
+  get(2);
+  BOOST_CHECK_EQUAL(cache.size(), 2ul);
+  BOOST_CHECK_EQUAL(cache.size_bytes(), 2 * tile_bytes);
+  BOOST_CHECK_EQUAL(cache.statistics().evictions, 1ul);
+
+  nfetch = 0ul;
+  get(0);
+  get(2);
+  BOOST_CHECK_EQUAL(nfetch, 0ul);
+  get(1);
+  BOOST_CHECK_EQUAL(nfetch, 1ul);
+}
+
+BOOST_AUTO_TEST_CASE(erase) {
+  const madness::uniqueidT other = GlobalFixture::world->unique_obj_id();
+  get(0);
+  cache.find_or_fetch<tile_type>(
+      *GlobalFixture::world, other, 0, tile_bytes,
+      []() { return Future<tile_type>(tile_type(Range(10, 10), 1.0)); });
+  BOOST_CHECK_EQUAL(cache.size(), 2ul);
+  cache.erase(id);
+  BOOST_CHECK_EQUAL(cache.size(), 1ul);
+  get(0);
+  BOOST_CHECK_EQUAL(nfetch, 2ul);
+
+  cache.set_budget(0ul);
+  BOOST_CHECK(!cache.enabled());
+  BOOST_CHECK_EQUAL(cache.size(), 0ul);
+  BOOST_CHECK_EQUAL(cache.size_bytes(), 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(shared) {
+  // the tiles served by the cache share their data with the cached tile
+  const tile_type t1 = get(1).get();
+  const tile_type t2 = get(1).get();
+  BOOST_CHECK_EQUAL(t1.data(), t2.data());
+  BOOST_CHECK_EQUAL(t2[0], 1.0);
+  BOOST_CHECK_EQUAL(nfetch, 1ul);
+}
+
+BOOST_AUTO_TEST_CASE(reservation) {
+  // the expected size of a tile in flight is reserved in the budget
+  Future<tile_type> pending;
+  cache.find_or_fetch<tile_type>(*GlobalFixture::world, id, 0, tile_bytes,
+                                 [pending]() { return pending; });
+  BOOST_CHECK_EQUAL(cache.size(), 1ul);
+  BOOST_CHECK_EQUAL(cache.size_bytes(), tile_bytes);
+
+  // tiles in flight are evicted like the others
+  cache.set_budget(tile_bytes + tile_bytes / 2);
+  get(1).get();
+  BOOST_CHECK_EQUAL(cache.size(), 1ul);
+  BOOST_CHECK_EQUAL(cache.statistics().evictions, 1ul);
+
+  // an evicted tile is not cached when it arrives
+  pending.set(tile_type(Range(10, 10), 0.0));
+  BOOST_CHECK_EQUAL(cache.size(), 1ul);
+  get(0);
+  BOOST_CHECK_EQUAL(nfetch, 2ul);
+}
+
+BOOST_AUTO_TEST_CASE(node) {
+  if (!detail::NodeTileStore::supported()) return;
+  BOOST_REQUIRE(cache.share_within_node(*GlobalFixture::world, 1ul << 20));
+  BOOST_CHECK(cache.node_shared());
+
+  // each process stores its own tiles in the node store
+  const std::size_t i = GlobalFixture::world->rank();
+  get(i).get();
+  GlobalFixture::world->gop.fence();
+  BOOST_CHECK_GE(cache.node_size_bytes(), tile_bytes);
+
+  // a tile that is dropped by the process is read from the node store
+  cache.set_budget(0ul);
+  cache.set_budget(1ul << 20);
+  BOOST_CHECK_EQUAL(get(i).get()[0], double(i));
+  BOOST_CHECK_EQUAL(nfetch, 1ul);
+  BOOST_CHECK_EQUAL(cache.statistics().node_hits, 1ul);
+
+  GlobalFixture::world->gop.fence();
+  cache.share_within_node(*GlobalFixture::world, 0ul);
+  BOOST_CHECK(!cache.node_shared());
+  BOOST_CHECK_EQUAL(cache.node_size_bytes(), 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(expressions) {
+  // remote tiles are shared with the cache, hence they are not consumed
+  typedef DistArray<tile_type, DensePolicy> array_type;
+  const TiledRange1 tr1{0, 2, 5, 9, 10};
+  array_type a(*GlobalFixture::world, TiledRange({tr1, tr1}));
+  a.fill_random();
+
+  array_type r, c1, c2;
+  r("i,j") = a("i,k") * a("k,j") + a("j,i");
+  c1("i,j") = a("i,k") * a("k,j") + a("j,i");
+  c2("i,j") = a("i,k") * a("k,j") + a("j,i");
+  BOOST_CHECK_SMALL((c1("i,j") - r("i,j")).norm().get(), 1e-10);
+  BOOST_CHECK_SMALL((c2("i,j") - r("i,j")).norm().get(), 1e-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -178,4 +178,141 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(conjugate_gradient, Array, array_types) {
   BOOST_CHECK(validate<Array>{}(x));
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(pipelined_conjugate_gradient, Array,
+                              array_types) {
+  auto Ax = make_Ax<Array>{}();
+  auto b = make_b<Array>{}();
+  auto pc = make_pc<Array>{}();
+  Array x;
+  PipelinedConjugateGradientSolver<Array, decltype(Ax)>{}(Ax, b, x, pc,
+                                                          1e-11);
+  BOOST_CHECK(validate<Array>{}(x));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(batched_dot, Array, array_types) {
+  TiledRange trange{TiledRange1{0, 2, 5, 7}, TiledRange1{0, 3, 6}};
+  std::vector<Array> ys;
+  std::vector<const Array*> y_ptrs;
+  for (int k = 0; k != 4; ++k) {
+    ys.emplace_back(get_default_world(), trange);
+    ys.back().fill_random();
+  }
+  for (const auto& y : ys) y_ptrs.push_back(&y);
+  Array x(get_default_world(), trange);
+  x.fill_random();
+
+  using TiledArray::math::linalg::dot;
+  const auto result = dot(x, y_ptrs);
+  BOOST_REQUIRE_EQUAL(result.size(), ys.size());
+  for (std::size_t k = 0; k != ys.size(); ++k)
+    BOOST_CHECK_CLOSE(result[k], TiledArray::dot(x, ys[k]), 1e-10);
+
+  // pairwise batch, awaited after launching other work
+  auto result_async = TiledArray::math::linalg::dot_async(
+      std::vector<const Array*>{&ys[0], &ys[1], &x},
+      std::vector<const Array*>{&ys[2], &ys[3], &x});
+  Array z;
+  z("i,j") = 2.0 * x("i,j");
+  const auto& pair_dots = result_async.get();
+  BOOST_REQUIRE_EQUAL(pair_dots.size(), 3ul);
+  BOOST_CHECK_CLOSE(pair_dots[0], TiledArray::dot(ys[0], ys[2]), 1e-10);
+  BOOST_CHECK_CLOSE(pair_dots[1], TiledArray::dot(ys[1], ys[3]), 1e-10);
+  BOOST_CHECK_CLOSE(pair_dots[2], TiledArray::dot(x, x), 1e-10);
+}
+
+/// A sparse array in which every third tile is zero, shifted by \c seed
+TSpArrayD make_sparse_array(const TiledRange& trange, const int seed) {
+  return make_array<TSpArrayD>(
+      get_default_world(), trange,
+      [seed](TensorD& tile, const Range& range) -> float {
+        const auto ordinal = range.lobound(0) + range.lobound(1);
+        if ((ordinal + seed) % 3 == 0) return 0.0f;
+        tile = TensorD(range);
+        for (std::size_t i = 0ul; i != tile.size(); ++i)
+          tile[i] = std::sin(double(i + ordinal + seed) + 0.5);
+        return tile.norm();
+      });
+}
+
+BOOST_AUTO_TEST_CASE(batched_dot_zero_tiles) {
+  TiledRange trange{TiledRange1{0, 2, 5, 7}, TiledRange1{0, 3, 6}};
+  std::vector<TSpArrayD> ys;
+  std::vector<const TSpArrayD*> y_ptrs;
+  for (int k = 0; k != 4; ++k) ys.push_back(make_sparse_array(trange, k));
+  for (const auto& y : ys) y_ptrs.push_back(&y);
+  const TSpArrayD x = make_sparse_array(trange, 1);
+  BOOST_REQUIRE(x.shape().sparsity() > 0.0f);
+
+  using TiledArray::math::linalg::dot;
+  const auto result = dot(x, y_ptrs);
+  BOOST_REQUIRE_EQUAL(result.size(), ys.size());
+  for (std::size_t k = 0; k != ys.size(); ++k)
+    BOOST_CHECK_CLOSE(result[k], TiledArray::dot(x, ys[k]), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(linear_combination, Array, array_types) {
+  TiledRange trange{TiledRange1{0, 2, 5, 7}, TiledRange1{0, 3, 6}};
+  Array x0(get_default_world(), trange);
+  Array x1(get_default_world(), trange);
+  Array x2(get_default_world(), trange);
+  x0.fill_random();
+  x1.fill_random();
+  x2.fill_random();
+
+  Array ref;
+  ref("i,j") = 0.5 * x0("i,j") - 2.0 * x1("i,j") + 3.0 * x2("i,j");
+
+  // the result aliases one of the arguments
+  Array y = x1;
+  TiledArray::math::linalg::linear_combination(
+      y, std::vector<double>{0.5, -2.0, 3.0},
+      std::vector<const Array*>{&x0, &x1, &x2});
+
+  Array delta;
+  delta("i,j") = y("i,j") - ref("i,j");
+  BOOST_CHECK_SMALL(TiledArray::norm2(delta), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(fused_diis, Array, array_types) {
+  TiledRange trange{TiledRange1{0, 2, 5}};
+  DIIS<Array> diis(1, 3);
+  DIIS<Array> fused_diis(1, 3, 0, 1, 1, 0, 0, true);
+  for (int iter = 0; iter != 5; ++iter) {
+    Array x(get_default_world(), trange);
+    Array e(get_default_world(), trange);
+    x.fill_random();
+    e.fill_random();
+    Array fused_x = clone(x);
+    Array fused_e = clone(e);
+    diis.extrapolate(x, e, true);
+    fused_diis.extrapolate(fused_x, fused_e, true);
+
+    Array delta;
+    delta("i") = x("i") - fused_x("i");
+    BOOST_CHECK_SMALL(TiledArray::norm2(delta), 1e-10);
+    delta("i") = e("i") - fused_e("i");
+    BOOST_CHECK_SMALL(TiledArray::norm2(delta), 1e-10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(fused_diis_zero_tiles) {
+  TiledRange trange{TiledRange1{0, 2, 5, 7}, TiledRange1{0, 3, 6}};
+  DIIS<TSpArrayD> diis(1, 3);
+  DIIS<TSpArrayD> fused_diis(1, 3, 0, 1, 1, 0, 0, true);
+  for (int iter = 0; iter != 5; ++iter) {
+    TSpArrayD x = make_sparse_array(trange, iter);
+    TSpArrayD e = make_sparse_array(trange, 2 * iter + 1);
+    TSpArrayD fused_x = clone(x);
+    TSpArrayD fused_e = clone(e);
+    diis.extrapolate(x, e, true);
+    fused_diis.extrapolate(fused_x, fused_e, true);
+
+    TSpArrayD delta;
+    delta("i,j") = x("i,j") - fused_x("i,j");
+    BOOST_CHECK_SMALL(TiledArray::norm2(delta), 1e-10);
+    delta("i,j") = e("i,j") - fused_e("i,j");
+    BOOST_CHECK_SMALL(TiledArray::norm2(delta), 1e-10);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
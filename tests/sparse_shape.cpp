@@ -233,6 +233,73 @@ BOOST_AUTO_TEST_CASE(copy_constructor) {
   BOOST_CHECK_EQUAL(y.sparsity(), sparse_shape.sparsity());
 }
 
+BOOST_AUTO_TEST_CASE(update) {
+  Tensor<float> tile_norms = sparse_shape.tile_norms().clone();
+
+  // Update a few tiles: zero a nonzero tile, fill a zero tile, and change a
+  // tile by ordinal and by coordinate index
+  std::vector<std::pair<size_type, float>> updates;
+  const auto volume = tr.tiles_range().volume();
+  for (size_type i = 0ul; i < volume; i += 7) {
+    const float norm = (sparse_shape.is_zero(i) ? 42.0f : 0.0f);
+    updates.emplace_back(i, norm);
+    tile_norms[i] = norm;
+  }
+  std::vector<std::pair<Range::index, float>> idx_updates;
+  idx_updates.emplace_back(tr.tiles_range().idx(1), 3.0f);
+  tile_norms[1] = 3.0f;
+
+  SparseShape<float> result;
+  BOOST_REQUIRE_NO_THROW(result = sparse_shape.update(updates));
+  BOOST_REQUIRE_NO_THROW(result = std::move(result).update(idx_updates));
+  SparseShape<float> reference(tile_norms, tr);
+
+  for (size_type i = 0ul; i < volume; ++i) {
+    BOOST_CHECK_CLOSE(result[i], reference[i], tolerance);
+    BOOST_CHECK_CLOSE(result.tile_norms()[i], reference.tile_norms()[i],
+                      tolerance);
+  }
+  BOOST_CHECK_EQUAL(result.sparsity(), reference.sparsity());
+
+  // Check that this was not modified
+  BOOST_CHECK_NE(result.data().data(), sparse_shape.data().data());
+  for (size_type i = 0ul; i < volume; i += 7)
+    BOOST_CHECK_NE(result.is_zero(i), sparse_shape.is_zero(i));
+}
+
+BOOST_AUTO_TEST_CASE(update_collective) {
+  Tensor<float> tile_norms = sparse_shape.tile_norms().clone();
+
+  // Each rank updates its local tiles, tile 0 is updated by every rank
+  TiledArray::detail::BlockedPmap pmap(*GlobalFixture::world,
+                                       tr.tiles_range().volume());
+  std::vector<std::pair<size_type, float>> local_updates;
+  const auto volume = tr.tiles_range().volume();
+  for (size_type i = 0ul; i < volume; i += 5) {
+    const float norm = (sparse_shape.is_zero(i) ? 42.0f : 0.0f);
+    if (pmap.is_local(i)) local_updates.emplace_back(i, norm);
+    tile_norms[i] = norm;
+  }
+  const auto rank = GlobalFixture::world->rank();
+  local_updates.emplace_back(0, 100.0f + rank);
+  tile_norms[0] = 100.0f + GlobalFixture::world->size() - 1;
+
+  SparseShape<float> result;
+  BOOST_REQUIRE_NO_THROW(
+      result = sparse_shape.update(*GlobalFixture::world, local_updates));
+  SparseShape<float> reference(tile_norms, tr);
+
+  for (size_type i = 0ul; i < volume; ++i)
+    BOOST_CHECK_CLOSE(result[i], reference[i], tolerance);
+  BOOST_CHECK_EQUAL(result.sparsity(), reference.sparsity());
+
+  // No updates on any rank
+  local_updates.clear();
+  BOOST_REQUIRE_NO_THROW(
+      result = sparse_shape.update(*GlobalFixture::world, local_updates));
+  BOOST_CHECK(result == sparse_shape);
+}
+
 BOOST_AUTO_TEST_CASE(permute) {
   SparseShape<float> result;
   BOOST_REQUIRE_NO_THROW(result = sparse_shape.perm(perm));
@@ -0,0 +1,122 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/symm/symmetric_array.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+using TiledArray::symmetry::PermutationGroup;
+using TiledArray::symmetry::TileSymmetry;
+
+struct SymmetricArrayFixture {
+  typedef DistArray<Tensor<double>, SparsePolicy> array_type;
+  typedef TiledArray::symmetry::Permutation symm_permutation;
+
+  SymmetricArrayFixture()
+      : trange({tr1, tr1, tr1, tr1}),
+        sym(PermutationGroup{{symm_permutation{1, 0, 2, 3},
+                              symm_permutation{0, 1, 3, 2}}},
+            TileSymmetry::antisymmetric) {
+    // make a tensor that is antisymmetric in (0,1) and in (2,3)
+    array_type r(*GlobalFixture::world, trange);
+    r.fill_random();
+    a("i,j,a,b") = r("i,j,a,b") - r("j,i,a,b") - r("i,j,b,a") + r("j,i,b,a");
+  }
+
+  static double distance(const array_type& x, const array_type& y) {
+    return (x("i,j,a,b") - y("i,j,a,b")).norm().get();
+  }
+
+  const TiledRange1 tr1{0, 2, 5, 6};
+  TiledRange trange;
+  TileSymmetry sym;
+  array_type a;
+};  // SymmetricArrayFixture
+
+BOOST_FIXTURE_TEST_SUITE(symm_symmetric_array_suite, SymmetricArrayFixture)
+
+BOOST_AUTO_TEST_CASE(orbit) {
+  BOOST_CHECK_EQUAL(sym.rank(), 4u);
+  BOOST_CHECK(sym.validate(trange));
+  BOOST_CHECK(!sym.validate(TiledRange({tr1, TiledRange1{0, 3, 6}, tr1, tr1})));
+
+  std::size_t nunique = 0ul;
+  for (const auto& index : trange.tiles_range()) {
+    const auto orbit = sym.orbit(index);
+    BOOST_CHECK(sym.is_unique(orbit.index));
+    BOOST_CHECK_EQUAL(sym.is_unique(index), !orbit.perm);
+    if (sym.is_unique(index)) {
+      ++nunique;
+      BOOST_CHECK_EQUAL(orbit.sign, 1);
+    } else {
+      // the unique tile is mapped onto the tile
+      BOOST_CHECK(orbit.perm * orbit.index == index);
+    }
+  }
+  // 6 unique (i,j) pairs times 6 unique (a,b) pairs
+  BOOST_CHECK_EQUAL(nunique, 36ul);
+
+  // odd permutations flip the sign
+  BOOST_CHECK_EQUAL(sym.orbit(Range::index_type{1, 0, 0, 0}).sign, -1);
+  BOOST_CHECK_EQUAL(sym.orbit(Range::index_type{1, 0, 2, 1}).sign, 1);
+}
+
+BOOST_AUTO_TEST_CASE(pack_unpack) {
+  array_type packed = symmetry::pack(a, sym);
+  for (const auto& index : trange.tiles_range())
+    BOOST_CHECK_EQUAL(packed.is_zero(index), !sym.is_unique(index));
+
+  // generate tiles on access
+  for (const auto& index : trange.tiles_range()) {
+    if (!a.is_local(index)) continue;
+    const auto tile = symmetry::find(packed, index, sym).get();
+    const auto ref_tile = a.find(index).get();
+    BOOST_CHECK_EQUAL(tile.range(), ref_tile.range());
+    for (std::size_t i = 0ul; i < tile.size(); ++i)
+      BOOST_CHECK_CLOSE(tile[i], ref_tile[i], 1e-10);
+  }
+
+  array_type unpacked = symmetry::unpack(packed, sym);
+  for (const auto& index : trange.tiles_range())
+    BOOST_CHECK(!unpacked.is_zero(index));
+  BOOST_CHECK_SMALL(distance(unpacked, a), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(contraction) {
+  // the product of the antisymmetric tensors is antisymmetric in (i,j) and in
+  // (a,b); compute only its unique blocks
+  array_type c_packed;
+  c_packed("i,j,a,b") = (a("i,j,c,d") * a("c,d,a,b")).set_symmetry(sym);
+  for (const auto& index : trange.tiles_range())
+    if (!sym.is_unique(index)) BOOST_CHECK(c_packed.is_zero(index));
+
+  array_type c;
+  c("i,j,a,b") = a("i,j,c,d") * a("c,d,a,b");
+  const double norm = c("i,j,a,b").norm().get();
+  BOOST_CHECK_SMALL(distance(symmetry::unpack(c_packed, sym), c), 1e-10 * norm);
+
+  // the symmetry of the result may be set for any expression
+  array_type a_packed;
+  a_packed("i,j,a,b") = (2 * a("i,j,a,b")).set_symmetry(sym);
+  c("i,j,a,b") = 2 * a("i,j,a,b");
+  BOOST_CHECK_SMALL(distance(symmetry::unpack(a_packed, sym), c), 1e-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -129,6 +129,23 @@ BOOST_AUTO_TEST_CASE(copy_constructor) {
   BOOST_CHECK_EQUAL_COLLECTIONS(tc.begin(), tc.end(), t.begin(), t.end());
 }
 
+BOOST_AUTO_TEST_CASE(exclusive_tile) {
+  // a shallow copy shares the data of the original
+  TensorN tc(t);
+  BOOST_CHECK(!detail::is_exclusive_tile(tc));
+
+  // a deep copy owns its data and may be consumed
+  TensorN x = t.clone();
+  BOOST_CHECK(detail::is_exclusive_tile(x));
+  tc = TensorN();
+  BOOST_CHECK(detail::is_exclusive_tile(t));
+
+  // the elements of a tensor of tensors may be shared even if it is not
+  Tensor<TensorN> tot(Range(2), t);
+  BOOST_CHECK(!tot.is_shared());
+  BOOST_CHECK(!detail::is_exclusive_tile(tot));
+}
+
 BOOST_AUTO_TEST_CASE(permute_constructor) {
   Permutation perm = make_perm();
 
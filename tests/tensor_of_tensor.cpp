@@ -30,6 +30,7 @@
 #include "btas/generic/contract.h"
 #endif
 
+#include <TiledArray/math/elem_muladd.h>
 #include <TiledArray/tensor.h>
 #include <TiledArray/tile_interface/add.h>
 #include <TiledArray/tile_interface/scale.h>
@@ -1210,6 +1211,58 @@ BOOST_AUTO_TEST_CASE(reduce) {
 }
 #endif
 
+BOOST_AUTO_TEST_CASE(gemm) {
+  using inner_type = Tensor<double>;
+  using tot_type = Tensor<inner_type>;
+  using math::blas::NoTranspose;
+  using math::blas::Transpose;
+  auto make_tot = [](const Range& range, const Range& inner_range) {
+    tot_type result(range);
+    for (auto& inner : result) {
+      inner = inner_type(inner_range);
+      for (auto& x : inner) x = GlobalFixture::world->rand() % 42 + 1;
+    }
+    return result;
+  };
+
+  // the outer dimensions exceed the block size of the gemm kernel
+  const std::size_t M = 37, N = 34, K = 35;
+  const math::GemmHelper inner_helper(NoTranspose, NoTranspose, 2u, 2u, 2u);
+  for (const auto left_op : {NoTranspose, Transpose}) {
+    const math::GemmHelper helper(left_op, NoTranspose, 2u, 2u, 2u);
+    for (const bool inner_gemm : {false, true}) {
+      const auto a = make_tot(
+          left_op == NoTranspose ? Range{M, K} : Range{K, M}, Range{2, 3});
+      const auto b =
+          make_tot(Range{K, N}, inner_gemm ? Range{3, 4} : Range{2, 3});
+      const auto op =
+          inner_gemm ? math::ElemMulAdd<double>::contraction(inner_helper, 2.0)
+                     : math::ElemMulAdd<double>::hadamard(2.0);
+
+      tot_type result;
+      result.gemm(a, b, helper, op);
+
+      BOOST_REQUIRE_EQUAL(result.range(), Range({M, N}));
+      for (std::size_t m = 0ul; m < M; ++m) {
+        for (std::size_t n = 0ul; n < N; ++n) {
+          inner_type expected;
+          for (std::size_t k = 0ul; k < K; ++k) {
+            const auto& a_mk = (left_op == NoTranspose ? a(m, k) : a(k, m));
+            const auto contribution =
+                inner_gemm ? a_mk.gemm(b(k, n), 2.0, inner_helper)
+                           : a_mk.mult(b(k, n), 2.0);
+            expected = expected.empty() ? contribution
+                                        : expected.add(contribution);
+          }
+          BOOST_REQUIRE_EQUAL(result(m, n).range(), expected.range());
+          for (std::size_t i = 0ul; i < expected.size(); ++i)
+            BOOST_CHECK_EQUAL(result(m, n)[i], expected[i]);
+        }
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(serialization, ITensor, itensor_types) {
   const auto& a = ToT<ITensor>(0);
   std::size_t buf_size = 10000000;  // enough to store: impossible to compute
@@ -0,0 +1,117 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2020  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <limits>
+#include <sstream>
+
+#include "TiledArray/tile_size.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct TileSizeFixture {
+  TileSizeFixture() {}
+
+  /// A profile with the given task overhead and no communication cost
+  static KernelProfile profile(const double task_overhead) {
+    return KernelProfile({16ul, 64ul, 256ul}, {1.0e9, 4.0e9, 8.0e9},
+                         {2.0e9, 4.0e9, 4.0e9}, task_overhead, 0.0,
+                         std::numeric_limits<double>::max());
+  }
+
+  /// Check that a tiling covers [first, first + extent) with tiles whose
+  /// sizes differ by at most 1
+  static void check_uniform(const TiledRange1& tiling, const std::size_t first,
+                            const std::size_t extent) {
+    BOOST_CHECK_EQUAL(tiling.elements_range().first, first);
+    BOOST_CHECK_EQUAL(tiling.elements_range().second, first + extent);
+    const std::size_t size = extent / tiling.tile_extent();
+    for (const auto& tile : tiling) {
+      const std::size_t tile_size = tile.second - tile.first;
+      BOOST_CHECK_GE(tile_size, size);
+      BOOST_CHECK_LE(tile_size, size + 1ul);
+    }
+  }
+};  // TileSizeFixture
+
+BOOST_FIXTURE_TEST_SUITE(tile_size_suite, TileSizeFixture)
+
+BOOST_AUTO_TEST_CASE(kernel_profile) {
+  const KernelProfile p = profile(1.0e-5);
+
+  // rates are interpolated in the logarithm of the tile size and clamped
+  BOOST_CHECK_CLOSE(p.gemm_rate(32.0), 2.5e9, 1e-10);
+  BOOST_CHECK_CLOSE(p.gemm_rate(4.0), 1.0e9, 1e-10);
+  BOOST_CHECK_CLOSE(p.gemm_rate(1024.0), 8.0e9, 1e-10);
+  BOOST_CHECK_CLOSE(p.gemm_time(64.0, 64.0, 64.0), 2.0 * 64 * 64 * 64 / 4.0e9,
+                    1e-10);
+  BOOST_CHECK_CLOSE(p.permute_time(256.0), 256.0 * sizeof(double) / 2.0e9,
+                    1e-10);
+  BOOST_CHECK_EQUAL(p.message_time(0.0), 0.0);
+
+  std::stringstream report;
+  report << p;
+  BOOST_CHECK(report.str().find("tile size 64") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(measure) {
+  const KernelProfile& p = KernelProfile::get(*GlobalFixture::world);
+  BOOST_CHECK_EQUAL(&p, &KernelProfile::get(*GlobalFixture::world));
+  BOOST_CHECK_EQUAL(p.sizes().size(), KernelProfile::default_sizes().size());
+  for (const auto size : p.sizes()) {
+    BOOST_CHECK_GT(p.gemm_rate(size), 0.0);
+    BOOST_CHECK_GT(p.permute_rate(size), 0.0);
+  }
+  BOOST_CHECK_GE(p.task_overhead(), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(uniform_tiling) {
+  check_uniform(TileSizeAdvisor::make_uniform_tiling(10ul, 3ul), 0ul, 10ul);
+  const TiledRange1 tiling =
+      TileSizeAdvisor::make_uniform_tiling(10ul, 3ul, 5ul);
+  BOOST_CHECK_EQUAL(tiling, (TiledRange1{5, 9, 12, 15}));
+  BOOST_CHECK_EQUAL(
+      TileSizeAdvisor::make_uniform_tiling(7ul, 7ul).tile_extent(), 7ul);
+}
+
+BOOST_AUTO_TEST_CASE(recommend) {
+  // a serial run with expensive tasks uses a single tile
+  BOOST_CHECK_EQUAL(TileSizeAdvisor(profile(1.0), 1ul, 1ul).tile_count(1000ul),
+                    1ul);
+
+  // 64 workers are kept busy by 4 x 4 x 4 tile products
+  const TileSizeAdvisor dense(profile(1.0e-6), 4ul, 16ul);
+  BOOST_CHECK_EQUAL(dense.tile_count(1024ul), 4ul);
+  check_uniform(dense.make_tiling(1000ul), 0ul, 1000ul);
+  BOOST_CHECK_EQUAL(dense.make_tiling(1000ul).tile_extent(), 4ul);
+
+  // sparse arguments need more tiles to keep the workers busy
+  const TileSizeAdvisor sparse(profile(1.0e-6), 4ul, 16ul, 0.1);
+  BOOST_CHECK_GT(sparse.tile_count(1024ul), dense.tile_count(1024ul));
+
+  // communication cost favors larger tiles
+  const KernelProfile slow_network({16ul, 64ul, 256ul}, {1.0e9, 4.0e9, 8.0e9},
+                                   {2.0e9, 4.0e9, 4.0e9}, 1.0e-6, 1.0e-2,
+                                   1.0e6);
+  BOOST_CHECK_LT(TileSizeAdvisor(slow_network, 4ul, 16ul).tile_count(1024ul),
+                 dense.tile_count(1024ul));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -195,6 +195,34 @@ BOOST_AUTO_TEST_CASE(element_to_tile) {
 
   // Check that the expected and internal element to tile maps match.
   BOOST_CHECK_EQUAL_COLLECTIONS(c.begin(), c.end(), e.begin(), e.end());
+
+  // Check the batched lookup
+  std::vector<std::size_t> elements;
+  for (auto i = tr1.elements_range().first; i < tr1.elements_range().second;
+       ++i)
+    elements.push_back(i);
+  std::vector<std::size_t> b(elements.size());
+  BOOST_CHECK(tr1.element_to_tile(elements.begin(), elements.end(),
+                                  b.begin()) == b.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(b.begin(), b.end(), e.begin(), e.end());
+
+  // Check non-uniform and uniform tilings, including unsorted batches
+  for (auto&& r : {TiledRange1{3, 4, 8, 9, 15, 16}, TiledRange1{2, 5, 8, 11},
+                   TiledRange1{0, 4, 8, 10}, TiledRange1{1, 2}}) {
+    std::vector<std::size_t> expected, elems;
+    for (auto t = r.tiles_range().first; t < r.tiles_range().second; ++t)
+      for (auto i = r.tile(t).first; i < r.tile(t).second; ++i) {
+        expected.push_back(t);
+        elems.push_back(i);
+        BOOST_CHECK_EQUAL(r.element_to_tile(i), t);
+      }
+    std::reverse(expected.begin(), expected.end());
+    std::reverse(elems.begin(), elems.end());
+    std::vector<std::size_t> tiles;
+    r.element_to_tile(elems.begin(), elems.end(), std::back_inserter(tiles));
+    BOOST_CHECK_EQUAL_COLLECTIONS(tiles.begin(), tiles.end(),
+                                  expected.begin(), expected.end());
+  }
 }
 
 BOOST_AUTO_TEST_CASE(comparison) {